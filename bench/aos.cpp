@@ -0,0 +1,244 @@
+//
+// Benchmarks moving arrays of structs into and out of a dori::vector: a loop
+// of push_back() of the members of each struct, and of assignments from each
+// row, against dori::append_from_aos() and dori::export_to_aos(), for structs
+// of four and of three 4-byte fields, of two and of three 8-byte fields, and
+// of padded fields.
+//
+
+#include "harness.h"
+
+#include <dori/aos.h>
+#include <dori/vector.h>
+
+#include <cstdint>
+#include <span>
+#include <tuple>
+#include <vector>
+
+namespace
+{
+
+struct tick {
+    std::int32_t id;
+    float px;
+    float qty;
+    std::uint32_t ts;
+};
+struct xyz {
+    float x, y, z;
+};
+struct pair64 {
+    double x;
+    std::int64_t y;
+};
+struct triple64 {
+    double a;
+    std::int64_t b;
+    double c;
+};
+struct padded {
+    std::int16_t a;
+    double b;
+    float c;
+};
+
+// The vector of the members of S, and ways of moving them in and out of it
+template <class S>
+struct aos;
+template <>
+struct aos<tick> {
+    using vec = dori::vector<std::int32_t, float, float, std::uint32_t>;
+    static tick make(std::size_t i)
+    {
+        return {static_cast<std::int32_t>(i), i * 0.5f,
+                static_cast<float>(i % 9), static_cast<std::uint32_t>(i * 3)};
+    }
+    static void push(vec &v, const tick &r)
+    {
+        v.push_back(r.id, r.px, r.qty, r.ts);
+    }
+    static void assign(tick &r, vec::const_reference x)
+    {
+        std::tie(r.id, r.px, r.qty, r.ts) = x;
+    }
+    static void append(vec &v, std::span<const tick> rs)
+    {
+        dori::append_from_aos(v, rs, &tick::id, &tick::px, &tick::qty,
+                              &tick::ts);
+    }
+    static void to(const vec &v, std::span<tick> out)
+    {
+        dori::export_to_aos(v, out, &tick::id, &tick::px, &tick::qty,
+                            &tick::ts);
+    }
+};
+template <>
+struct aos<xyz> {
+    using vec = dori::vector<float, float, float>;
+    static xyz make(std::size_t i) { return {i * 0.5f, i * 1.5f, i * 2.5f}; }
+    static void push(vec &v, const xyz &r) { v.push_back(r.x, r.y, r.z); }
+    static void assign(xyz &r, vec::const_reference x)
+    {
+        std::tie(r.x, r.y, r.z) = x;
+    }
+    static void append(vec &v, std::span<const xyz> rs)
+    {
+        dori::append_from_aos(v, rs, &xyz::x, &xyz::y, &xyz::z);
+    }
+    static void to(const vec &v, std::span<xyz> out)
+    {
+        dori::export_to_aos(v, out, &xyz::x, &xyz::y, &xyz::z);
+    }
+};
+template <>
+struct aos<pair64> {
+    using vec = dori::vector<double, std::int64_t>;
+    static pair64 make(std::size_t i)
+    {
+        return {i * 0.5, static_cast<std::int64_t>(i)};
+    }
+    static void push(vec &v, const pair64 &r) { v.push_back(r.x, r.y); }
+    static void assign(pair64 &r, vec::const_reference x)
+    {
+        std::tie(r.x, r.y) = x;
+    }
+    static void append(vec &v, std::span<const pair64> rs)
+    {
+        dori::append_from_aos(v, rs, &pair64::x, &pair64::y);
+    }
+    static void to(const vec &v, std::span<pair64> out)
+    {
+        dori::export_to_aos(v, out, &pair64::x, &pair64::y);
+    }
+};
+template <>
+struct aos<triple64> {
+    using vec = dori::vector<double, std::int64_t, double>;
+    static triple64 make(std::size_t i)
+    {
+        return {i * 0.5, static_cast<std::int64_t>(i), i * 1.5};
+    }
+    static void push(vec &v, const triple64 &r) { v.push_back(r.a, r.b, r.c); }
+    static void assign(triple64 &r, vec::const_reference x)
+    {
+        std::tie(r.a, r.b, r.c) = x;
+    }
+    static void append(vec &v, std::span<const triple64> rs)
+    {
+        dori::append_from_aos(v, rs, &triple64::a, &triple64::b, &triple64::c);
+    }
+    static void to(const vec &v, std::span<triple64> out)
+    {
+        dori::export_to_aos(v, out, &triple64::a, &triple64::b, &triple64::c);
+    }
+};
+template <>
+struct aos<padded> {
+    using vec = dori::vector<std::int16_t, double, float>;
+    static padded make(std::size_t i)
+    {
+        return {static_cast<std::int16_t>(i), i * 0.5, i * 0.25f};
+    }
+    static void push(vec &v, const padded &r) { v.push_back(r.a, r.b, r.c); }
+    static void assign(padded &r, vec::const_reference x)
+    {
+        std::tie(r.a, r.b, r.c) = x;
+    }
+    static void append(vec &v, std::span<const padded> rs)
+    {
+        dori::append_from_aos(v, rs, &padded::a, &padded::b, &padded::c);
+    }
+    static void to(const vec &v, std::span<padded> out)
+    {
+        dori::export_to_aos(v, out, &padded::a, &padded::b, &padded::c);
+    }
+};
+
+template <class S>
+std::vector<S> structs(std::size_t n)
+{
+    std::vector<S> res(n);
+    for (std::size_t i = 0; i < n; ++i)
+        res[i] = aos<S>::make(i);
+    return res;
+}
+
+template <class S>
+void push_back(bench::state &st)
+{
+    const auto rs = structs<S>(st.rows());
+    st.measure(rs.size(), [&] {
+        typename aos<S>::vec v;
+        v.reserve(rs.size());
+        for (const auto &r : rs)
+            aos<S>::push(v, r);
+        bench::do_not_optimize(v);
+    });
+}
+
+template <class S>
+void append_from_aos(bench::state &st)
+{
+    const auto rs = structs<S>(st.rows());
+    st.measure(rs.size(), [&] {
+        typename aos<S>::vec v;
+        v.reserve(rs.size());
+        aos<S>::append(v, rs);
+        bench::do_not_optimize(v);
+    });
+}
+
+template <class S>
+void assign(bench::state &st)
+{
+    const auto rs = structs<S>(st.rows());
+    typename aos<S>::vec v;
+    aos<S>::append(v, rs);
+    std::vector<S> out(v.size());
+    st.measure(v.size(), [&] {
+        for (std::size_t i = 0; i < v.size(); ++i)
+            aos<S>::assign(out[i], v[i]);
+        bench::do_not_optimize(out);
+    });
+}
+
+template <class S>
+void export_to_aos(bench::state &st)
+{
+    const auto rs = structs<S>(st.rows());
+    typename aos<S>::vec v;
+    aos<S>::append(v, rs);
+    std::vector<S> out(v.size());
+    st.measure(v.size(), [&] {
+        aos<S>::to(v, out);
+        bench::do_not_optimize(out);
+    });
+}
+
+[[maybe_unused]] const bool registered =
+    (bench::registrar{"aos/in/4x4B/push_back", push_back<tick>},
+     bench::registrar{"aos/in/4x4B/append_from_aos", append_from_aos<tick>},
+     bench::registrar{"aos/in/3x4B/push_back", push_back<xyz>},
+     bench::registrar{"aos/in/3x4B/append_from_aos", append_from_aos<xyz>},
+     bench::registrar{"aos/in/2x8B/push_back", push_back<pair64>},
+     bench::registrar{"aos/in/2x8B/append_from_aos", append_from_aos<pair64>},
+     bench::registrar{"aos/in/3x8B/push_back", push_back<triple64>},
+     bench::registrar{"aos/in/3x8B/append_from_aos",
+                      append_from_aos<triple64>},
+     bench::registrar{"aos/in/padded/push_back", push_back<padded>},
+     bench::registrar{"aos/in/padded/append_from_aos",
+                      append_from_aos<padded>},
+     bench::registrar{"aos/out/4x4B/assign", assign<tick>},
+     bench::registrar{"aos/out/4x4B/export_to_aos", export_to_aos<tick>},
+     bench::registrar{"aos/out/3x4B/assign", assign<xyz>},
+     bench::registrar{"aos/out/3x4B/export_to_aos", export_to_aos<xyz>},
+     bench::registrar{"aos/out/2x8B/assign", assign<pair64>},
+     bench::registrar{"aos/out/2x8B/export_to_aos", export_to_aos<pair64>},
+     bench::registrar{"aos/out/3x8B/assign", assign<triple64>},
+     bench::registrar{"aos/out/3x8B/export_to_aos", export_to_aos<triple64>},
+     bench::registrar{"aos/out/padded/assign", assign<padded>},
+     bench::registrar{"aos/out/padded/export_to_aos", export_to_aos<padded>},
+     true);
+
+} // namespace
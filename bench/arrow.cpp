@@ -0,0 +1,86 @@
+//
+// Benchmarks handing a dori::vector to an Arrow consumer: copying each column
+// into a buffer of its own, as Arrow builders would, packing the flags into a
+// bitmap, against dori::export_arrow() of the vector.
+//
+
+#include "harness.h"
+
+#include <dori/arrow.h>
+#include <dori/vector.h>
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
+
+namespace
+{
+
+using vec = dori::vector<std::int64_t, double, float, bool>;
+
+vec make(std::size_t n)
+{
+    vec v;
+    v.reserve(n);
+    for (std::size_t i = 0; i < n; ++i)
+        v.push_back(static_cast<std::int64_t>(i), i * 0.5,
+                    static_cast<float>(i), i % 3 == 0);
+    return v;
+}
+
+template <class T>
+std::unique_ptr<T[]> copy_column(const T *p, std::size_t n)
+{
+    auto res = std::make_unique_for_overwrite<T[]>(n);
+    std::memcpy(res.get(), p, n * sizeof(T));
+    return res;
+}
+
+void copy(bench::state &st)
+{
+    const vec v = make(st.rows());
+    st.measure(v.size(), [&] {
+        const auto n = v.size();
+        auto a       = copy_column(v.data<0>(), n);
+        auto b       = copy_column(v.data<1>(), n);
+        auto c       = copy_column(v.data<2>(), n);
+        auto d       = std::make_unique<std::uint8_t[]>((n + 7) / 8);
+        const auto f = v.data<3>();
+        for (std::size_t i = 0; i < n; ++i)
+            d[i / 8] |= static_cast<std::uint8_t>(f[i] << (i % 8));
+        bench::do_not_optimize(a);
+        bench::do_not_optimize(b);
+        bench::do_not_optimize(c);
+        bench::do_not_optimize(d);
+    });
+}
+
+void export_arrow(bench::state &st)
+{
+    const vec src = make(st.rows());
+    using bvec    = dori::vector<std::int64_t, double, float, dori::bit>;
+    bvec v;
+    st.measure(
+        src.size(),
+        [&] {
+            v = bvec{};
+            v.reserve(src.size());
+            for (std::size_t i = 0; i < src.size(); ++i)
+                v.push_back(src[i]);
+        },
+        [&] {
+            ArrowArray a;
+            ArrowSchema s;
+            dori::export_arrow(std::move(v), &a, &s);
+            bench::do_not_optimize(a);
+            s.release(&s);
+            a.release(&a);
+        });
+}
+
+[[maybe_unused]] const bool registered =
+    (bench::registrar{"arrow/export/copy", copy},
+     bench::registrar{"arrow/export/export_arrow", export_arrow}, true);
+
+} // namespace
@@ -0,0 +1,183 @@
+//
+// Benchmarks handing rows from a producer thread to a consumer thread that
+// sums them: a std::mutex and std::deque of the rows' tuples, copied in one
+// at a time as user code would, a std::deque of moved batches of 1024 rows,
+// and a dori::channel of the batches. Latency is measured as the round trip
+// of a batch of one row between two threads, over a std::deque with a
+// std::condition_variable against a pair of dori::channels.
+//
+
+#include "harness.h"
+
+#include <dori/channel.h>
+#include <dori/vector.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <utility>
+
+namespace
+{
+
+using vec = dori::vector<std::uint64_t, float>;
+
+constexpr std::size_t batch = 1024;
+
+// A queue of Ts guarded by a mutex, as user code would
+template <class T>
+class locked_queue
+{
+    std::mutex m_;
+    std::condition_variable cv_;
+    std::deque<T> q_;
+
+  public:
+    void push(T x)
+    {
+        {
+            std::lock_guard l{m_};
+            q_.push_back(std::move(x));
+        }
+        cv_.notify_one();
+    }
+    T pop()
+    {
+        std::unique_lock l{m_};
+        cv_.wait(l, [&] { return !q_.empty(); });
+        T x = std::move(q_.front());
+        q_.pop_front();
+        return x;
+    }
+};
+
+void mutex_rows(bench::state &st)
+{
+    const auto n = st.rows();
+    st.measure(n, [&] {
+        locked_queue<std::tuple<std::uint64_t, float>> q;
+        std::thread t{[&] {
+            for (std::size_t i = 0; i < n; ++i)
+                q.push({i, static_cast<float>(i)});
+        }};
+        std::uint64_t s = 0;
+        for (std::size_t i = 0; i < n; ++i)
+            s += std::get<0>(q.pop());
+        t.join();
+        bench::do_not_optimize(s);
+    });
+}
+
+void mutex_batches(bench::state &st)
+{
+    const auto n = st.rows() / batch;
+    st.measure(n * batch, [&] {
+        locked_queue<vec> q;
+        std::thread t{[&] {
+            for (std::size_t i = 0; i < n; ++i) {
+                vec b;
+                b.reserve(batch);
+                for (std::size_t j = 0; j < batch; ++j)
+                    b.push_back(j, static_cast<float>(j));
+                q.push(std::move(b));
+            }
+        }};
+        std::uint64_t s = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            const auto b = q.pop();
+            const auto p = b.data<0>();
+            for (std::size_t j = 0; j < b.size(); ++j)
+                s += p[j];
+        }
+        t.join();
+        bench::do_not_optimize(s);
+    });
+}
+
+void channel(bench::state &st)
+{
+    const auto n = st.rows() / batch;
+    st.measure(n * batch, [&] {
+        dori::channel<vec> ch{16};
+        std::thread t{[&] {
+            vec b;
+            for (std::size_t i = 0; i < n; ++i) {
+                if (b.capacity() < batch)
+                    b.reserve(batch);
+                for (std::size_t j = 0; j < batch; ++j)
+                    b.push_back(j, static_cast<float>(j));
+                ch.send(b);
+            }
+            ch.close();
+        }};
+        std::uint64_t s = 0;
+        vec b;
+        while (ch.receive(b)) {
+            const auto p = b.data<0>();
+            for (std::size_t j = 0; j < b.size(); ++j)
+                s += p[j];
+        }
+        t.join();
+        bench::do_not_optimize(s);
+    });
+}
+
+vec one_row()
+{
+    vec b;
+    b.reserve(1);
+    b.push_back(1, 1.0f);
+    return b;
+}
+
+void mutex_latency(bench::state &st)
+{
+    const auto n = st.rows() / 64;
+    st.measure(n, [&] {
+        locked_queue<vec> there, back;
+        std::thread t{[&] {
+            for (std::size_t i = 0; i < n; ++i)
+                back.push(there.pop());
+        }};
+        auto b = one_row();
+        for (std::size_t i = 0; i < n; ++i) {
+            there.push(std::move(b));
+            b = back.pop();
+        }
+        t.join();
+        bench::do_not_optimize(b);
+    });
+}
+
+void channel_latency(bench::state &st)
+{
+    const auto n = st.rows() / 64;
+    st.measure(n, [&] {
+        dori::channel<vec> there{1}, back{1};
+        std::thread t{[&] {
+            vec b;
+            while (there.receive(b))
+                back.send(b);
+        }};
+        auto b = one_row();
+        for (std::size_t i = 0; i < n; ++i) {
+            there.send(b);
+            back.receive(b);
+        }
+        there.close();
+        t.join();
+        bench::do_not_optimize(b);
+    });
+}
+
+[[maybe_unused]] const bool registered =
+    (bench::registrar{"channel/throughput/mutex_rows", mutex_rows},
+     bench::registrar{"channel/throughput/mutex_batches", mutex_batches},
+     bench::registrar{"channel/throughput/channel", channel},
+     bench::registrar{"channel/latency/mutex", mutex_latency},
+     bench::registrar{"channel/latency/channel", channel_latency}, true);
+
+} // namespace
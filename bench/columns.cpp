@@ -0,0 +1,67 @@
+//
+// Benchmarks adding a column to a dori::vector: rebuilding it row by row
+// through push_back() against dori::with_column(), which moves each column of
+// the old vector with a memcpy().
+//
+
+#include "harness.h"
+
+#include <dori/columns.h>
+#include <dori/vector.h>
+
+#include <cstdint>
+#include <optional>
+
+namespace
+{
+
+using vec  = dori::vector<std::uint32_t, std::uint64_t, double, float>;
+using wide = dori::vector<std::uint32_t, std::uint64_t, double, float, double>;
+
+vec make(std::size_t n)
+{
+    vec v;
+    v.reserve(n);
+    for (std::size_t i = 0; i < n; ++i)
+        v.push_back(static_cast<std::uint32_t>(i), i, i * 0.5,
+                    static_cast<float>(i));
+    return v;
+}
+
+void push_back(bench::state &st)
+{
+    const auto src = make(st.rows());
+    std::optional<vec> v;
+    st.measure(
+        src.size(), [&] { v.emplace(src); },
+        [&] {
+            wide w;
+            w.reserve(v->size());
+            const auto a = v->data<0>();
+            const auto b = v->data<1>();
+            const auto c = v->data<2>();
+            const auto d = v->data<3>();
+            for (std::size_t i = 0; i < v->size(); ++i)
+                w.push_back(a[i], b[i], c[i], d[i], 0.0);
+            *v = {};
+            bench::do_not_optimize(w.data<4>());
+        });
+}
+
+void with_column(bench::state &st)
+{
+    const auto src = make(st.rows());
+    std::optional<vec> v;
+    st.measure(
+        src.size(), [&] { v.emplace(src); },
+        [&] {
+            auto w = dori::with_column<double>(std::move(*v), 0.0);
+            bench::do_not_optimize(w.data<4>());
+        });
+}
+
+[[maybe_unused]] const bool registered =
+    (bench::registrar{"add_column/push_back", push_back},
+     bench::registrar{"add_column/with_column", with_column}, true);
+
+} // namespace
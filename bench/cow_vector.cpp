@@ -0,0 +1,63 @@
+//
+// Benchmarks a tick of a writer that hands out a read snapshot and then
+// updates one of eight columns: a deep copy of a dori::vector against a
+// dori::cow_vector snapshot, which copies just the column written to.
+//
+
+#include "harness.h"
+
+#include <dori/cow_vector.h>
+#include <dori/vector.h>
+
+#include <cstdint>
+
+namespace
+{
+
+#define BENCH_columns                                                          \
+    std::uint64_t, std::uint64_t, std::uint64_t, std::uint64_t, double,       \
+        double, double, double
+
+template <class Vec>
+Vec make(std::size_t n)
+{
+    Vec v;
+    v.reserve(n);
+    for (std::size_t i = 0; i < n; ++i)
+        v.push_back(i, i, i, i, 0.5, 0.5, 0.5, 0.5);
+    return v;
+}
+
+void copy(bench::state &st)
+{
+    using vec = dori::vector<BENCH_columns>;
+    auto v    = make<vec>(st.rows());
+    vec snap;
+    st.measure(v.size(), [&] {
+        snap         = v;
+        const auto p = v.data<4>();
+        for (std::size_t i = 0; i < v.size(); ++i)
+            p[i] += 1;
+        bench::do_not_optimize(snap.data<4>());
+    });
+}
+
+void cow(bench::state &st)
+{
+    using vec = dori::cow_vector<BENCH_columns>;
+    auto v    = make<vec>(st.rows());
+    vec snap;
+    st.measure(v.size(), [&] {
+        snap         = v.snapshot();
+        const auto p = v.mutable_data<4>();
+        for (std::size_t i = 0; i < v.size(); ++i)
+            p[i] += 1;
+        bench::do_not_optimize(snap.data<4>());
+    });
+}
+
+[[maybe_unused]] const bool registered =
+    (bench::registrar{"snapshot/copy", copy},
+     bench::registrar{"snapshot/cow_vector", cow}, true);
+
+} // namespace
@@ -0,0 +1,116 @@
+//
+// Benchmarks building, and looking up keys in, a std::unordered_map from keys
+// to rows of a dori::vector of the values, as user code would, against a
+// dori::flat_hash_map of the keys and values, for hits and misses.
+//
+
+#include "harness.h"
+
+#include <dori/flat_hash_map.h>
+#include <dori/vector.h>
+
+#include <cstdint>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+
+using vals = dori::vector<std::uint32_t, float>;
+using map  = dori::flat_hash_map<std::uint64_t, std::uint32_t, float>;
+
+std::vector<std::uint64_t> keys(std::size_t n, std::uint64_t seed)
+{
+    std::mt19937_64 rng{seed};
+    std::vector<std::uint64_t> res(n);
+    for (auto &k : res)
+        k = rng();
+    return res;
+}
+
+struct indexed {
+    std::unordered_map<std::uint64_t, std::size_t> idx;
+    vals v;
+
+    explicit indexed(const std::vector<std::uint64_t> &ks)
+    {
+        v.reserve(ks.size());
+        for (const auto k : ks)
+            if (idx.try_emplace(k, v.size()).second)
+                v.push_back(static_cast<std::uint32_t>(k), 1.0f);
+    }
+};
+
+map build(const std::vector<std::uint64_t> &ks)
+{
+    map m;
+    for (const auto k : ks)
+        m.try_emplace(k, static_cast<std::uint32_t>(k), 1.0f);
+    return m;
+}
+
+void unordered_map_build(bench::state &st)
+{
+    const auto ks = keys(st.rows(), 1);
+    st.measure(ks.size(), [&] {
+        indexed x{ks};
+        bench::do_not_optimize(x);
+    });
+}
+
+void flat_hash_map_build(bench::state &st)
+{
+    const auto ks = keys(st.rows(), 1);
+    st.measure(ks.size(), [&] {
+        auto m = build(ks);
+        bench::do_not_optimize(m);
+    });
+}
+
+// Looks up the keys of seed 1 (hits) or 2 (misses)
+template <std::uint64_t Seed>
+void unordered_map_find(bench::state &st)
+{
+    const indexed x{keys(st.rows(), 1)};
+    const auto qs = keys(st.rows(), Seed);
+    st.measure(qs.size(), [&] {
+        std::uint64_t s = 0;
+        const auto p    = x.v.data<0>();
+        for (const auto q : qs)
+            if (const auto it = x.idx.find(q); it != x.idx.end())
+                s += p[it->second];
+        bench::do_not_optimize(s);
+    });
+}
+
+template <std::uint64_t Seed>
+void flat_hash_map_find(bench::state &st)
+{
+    const auto m  = build(keys(st.rows(), 1));
+    const auto qs = keys(st.rows(), Seed);
+    st.measure(qs.size(), [&] {
+        std::uint64_t s = 0;
+        for (const auto q : qs)
+            if (const auto it = m.find(q); it != m.end())
+                s += std::get<1>(*it);
+        bench::do_not_optimize(s);
+    });
+}
+
+[[maybe_unused]] const bool registered =
+    (bench::registrar{"flat_hash_map/build/unordered_map",
+                      unordered_map_build},
+     bench::registrar{"flat_hash_map/build/flat_hash_map",
+                      flat_hash_map_build},
+     bench::registrar{"flat_hash_map/hit/unordered_map",
+                      unordered_map_find<1>},
+     bench::registrar{"flat_hash_map/hit/flat_hash_map",
+                      flat_hash_map_find<1>},
+     bench::registrar{"flat_hash_map/miss/unordered_map",
+                      unordered_map_find<2>},
+     bench::registrar{"flat_hash_map/miss/flat_hash_map",
+                      flat_hash_map_find<2>},
+     true);
+
+} // namespace
@@ -0,0 +1,84 @@
+//
+// Benchmarks a per-key sum and count over a dori::vector built with a
+// std::unordered_map of the rows' tuples, as user code would, against
+// dori::group_by, serial and parallel, for few keys and for nearly unique
+// ones.
+//
+
+#include "harness.h"
+
+#include <dori/group_by.h>
+
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+
+namespace
+{
+
+using vec = dori::vector<std::uint32_t, std::uint64_t, double>;
+
+vec make(std::size_t n, std::size_t keys)
+{
+    vec v;
+    v.reserve(n);
+    for (std::size_t i = 0; i < n; ++i)
+        v.push_back(static_cast<std::uint32_t>(i * 2654435761u % keys), i,
+                    static_cast<double>(i) / 3);
+    return v;
+}
+
+// Keys per row out of 1024
+template <std::size_t Keys>
+std::size_t keys_for(std::size_t rows)
+{
+    return Keys ? std::max<std::size_t>(rows * Keys / 1024, 1) : 1000;
+}
+
+template <std::size_t Keys>
+void unordered_map(bench::state &st)
+{
+    const vec v = make(st.rows(), keys_for<Keys>(st.rows()));
+    st.measure(v.size(), [&] {
+        std::unordered_map<std::uint32_t, std::pair<std::uint64_t, std::size_t>>
+            m;
+        for (const auto &[k, x, d] : v) {
+            auto &[s, c] = m[k];
+            s += x;
+            ++c;
+        }
+        bench::do_not_optimize(m);
+    });
+}
+
+template <std::size_t Keys>
+void grouped(bench::state &st)
+{
+    const vec v = make(st.rows(), keys_for<Keys>(st.rows()));
+    st.measure(v.size(), [&] {
+        auto r = dori::group_by<0>(v).aggregate<dori::sum<1>, dori::count>();
+        bench::do_not_optimize(r);
+    });
+}
+
+template <std::size_t Keys>
+void parallel_grouped(bench::state &st)
+{
+    const vec v = make(st.rows(), keys_for<Keys>(st.rows()));
+    st.measure(v.size(), [&] {
+        auto r = dori::group_by<0>(v)
+                     .parallel_aggregate<dori::sum<1>, dori::count>(65536);
+        bench::do_not_optimize(r);
+    });
+}
+
+[[maybe_unused]] const bool registered =
+    (bench::registrar{"group_by/1k-keys/unordered_map", unordered_map<0>},
+     bench::registrar{"group_by/1k-keys/group_by", grouped<0>},
+     bench::registrar{"group_by/1k-keys/parallel", parallel_grouped<0>},
+     bench::registrar{"group_by/unique/unordered_map", unordered_map<1024>},
+     bench::registrar{"group_by/unique/group_by", grouped<1024>},
+     bench::registrar{"group_by/unique/parallel", parallel_grouped<1024>},
+     true);
+
+} // namespace
@@ -0,0 +1,239 @@
+#pragma once
+
+//
+// A minimal benchmarking harness: benchmarks register themselves at static
+// initialization time and are run by main.cpp. Each benchmark measures a
+// callable repeatedly until a minimum duration has passed and reports the
+// time per processed element. On Linux, hardware counters may optionally be
+// sampled through perf_event_open(2).
+//
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace bench
+{
+
+template <class T>
+inline void do_not_optimize(T &&x) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(&x) : "memory");
+#else
+    static volatile const void *sink;
+    sink = &x;
+#endif
+}
+
+inline void clobber_memory() noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : : "memory");
+#endif
+}
+
+//
+// Hardware counters. All events are in one group so that they're scheduled
+// onto the PMU together; if opening any of them fails (no PMU access in
+// containers, perf_event_paranoid, non-Linux), the counters stay disabled.
+//
+
+class perf_counters
+{
+  public:
+    enum event { cycles, instructions, cache_references, cache_misses, count };
+
+    perf_counters() = default;
+    perf_counters(const perf_counters &) = delete;
+    perf_counters &operator=(const perf_counters &) = delete;
+    ~perf_counters() { close(); }
+
+    bool open()
+    {
+#ifdef __linux__
+        constexpr std::uint64_t configs[count]{
+            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_REFERENCES, PERF_COUNT_HW_CACHE_MISSES};
+        for (int i = 0; i < count; ++i) {
+            perf_event_attr attr{};
+            attr.size           = sizeof(attr);
+            attr.type           = PERF_TYPE_HARDWARE;
+            attr.config         = configs[i];
+            attr.disabled       = i == 0;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv     = 1;
+            attr.read_format    = PERF_FORMAT_GROUP;
+            fds_[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0,
+                                               -1, i ? fds_[0] : -1, 0));
+            if (fds_[i] < 0) {
+                close();
+                return false;
+            }
+        }
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    bool enabled() const noexcept { return fds_[0] >= 0; }
+
+    void start() noexcept
+    {
+#ifdef __linux__
+        if (enabled()) {
+            ioctl(fds_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(fds_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+#endif
+    }
+
+    void stop() noexcept
+    {
+#ifdef __linux__
+        if (!enabled())
+            return;
+        ioctl(fds_[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        struct {
+            std::uint64_t nr;
+            std::uint64_t values[count];
+        } buf{};
+        if (::read(fds_[0], &buf, sizeof(buf)) == sizeof(buf))
+            for (int i = 0; i < count; ++i)
+                totals_[i] += buf.values[i];
+#endif
+    }
+
+    std::uint64_t total(event e) const noexcept { return totals_[e]; }
+    void reset() noexcept
+    {
+        for (auto &t : totals_)
+            t = 0;
+    }
+
+  private:
+    void close() noexcept
+    {
+        for (auto &fd : fds_) {
+#ifdef __linux__
+            if (fd >= 0)
+                ::close(fd);
+#endif
+            fd = -1;
+        }
+    }
+
+    int fds_[count]{-1, -1, -1, -1};
+    std::uint64_t totals_[count]{};
+};
+
+struct options {
+    std::string filter;
+    std::size_t rows          = 1 << 16;
+    double min_time_ms        = 100;
+    perf_counters *counters   = nullptr;
+};
+
+class state
+{
+  public:
+    state(const std::string &name, const options &opts) noexcept
+        : name_{name}, opts_{opts}
+    {
+    }
+
+    std::size_t rows() const noexcept { return opts_.rows; }
+
+    //
+    // Runs `setup` untimed and `body` timed until the minimum duration has
+    // been reached; `elems` is the number of elements processed per run.
+    //
+    template <class Setup, class Body>
+    void measure(std::size_t elems, Setup &&setup, Body &&body)
+    {
+        using clock = std::chrono::steady_clock;
+        auto *pc    = opts_.counters;
+        if (pc)
+            pc->reset();
+        setup();
+        body(); // warm-up
+        clock::duration total{};
+        std::size_t runs = 0;
+        while (std::chrono::duration<double, std::milli>(total).count() <
+               opts_.min_time_ms) {
+            setup();
+            clobber_memory();
+            if (pc)
+                pc->start();
+            const auto t0 = clock::now();
+            body();
+            clobber_memory();
+            total += clock::now() - t0;
+            if (pc)
+                pc->stop();
+            ++runs;
+        }
+        report(elems * runs,
+               std::chrono::duration<double, std::nano>(total).count());
+    }
+
+    template <class Body>
+    void measure(std::size_t elems, Body &&body)
+    {
+        measure(elems, [] {}, static_cast<Body &&>(body));
+    }
+
+  private:
+    void report(std::size_t elems, double ns) const
+    {
+        std::printf("%-48s %10zu %10.3f", name_.c_str(), opts_.rows,
+                    ns / static_cast<double>(elems));
+        if (auto *pc = opts_.counters) {
+            using pcs     = perf_counters;
+            const auto e  = static_cast<double>(elems);
+            const auto cy = static_cast<double>(pc->total(pcs::cycles));
+            const auto in = static_cast<double>(pc->total(pcs::instructions));
+            const auto cr = pc->total(pcs::cache_references);
+            const auto cm = static_cast<double>(pc->total(pcs::cache_misses));
+            std::printf(" %10.3f %6.2f %10.4f %6.1f%%", cy / e,
+                        cy ? in / cy : 0., cm / e,
+                        cr ? 100. * cm / static_cast<double>(cr) : 0.);
+        }
+        std::printf("\n");
+    }
+
+    const std::string &name_;
+    const options &opts_;
+};
+
+struct entry {
+    std::string name;
+    std::function<void(state &)> fn;
+};
+
+inline std::vector<entry> &registry()
+{
+    static std::vector<entry> r;
+    return r;
+}
+
+struct registrar {
+    registrar(std::string name, std::function<void(state &)> fn)
+    {
+        registry().push_back({std::move(name), std::move(fn)});
+    }
+};
+
+} // namespace bench
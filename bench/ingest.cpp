@@ -0,0 +1,139 @@
+//
+// Benchmarks loading CSV text and binary records into a dori::vector: a row
+// parser splitting each line into a std::tuple for push_back(), as user code
+// would, against dori::ingest::csv() on one thread and on the global pool;
+// and a push_back() per record against dori::ingest::records().
+//
+
+#include "harness.h"
+
+#include <dori/ingest.h>
+#include <dori/vector.h>
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+namespace
+{
+
+using vec = dori::vector<std::int64_t, double, float, std::uint32_t>;
+
+std::string text(std::size_t n)
+{
+    std::string res;
+    for (std::size_t i = 0; i < n; ++i)
+        res += std::to_string(i * 7919) + ',' + std::to_string(i * 0.25) +
+               ',' + std::to_string(i % 100) + ',' + std::to_string(i % 977) +
+               '\n';
+    return res;
+}
+
+template <class T>
+T field(std::string_view &line)
+{
+    const auto d = line.find(',');
+    const auto f = line.substr(0, d);
+    line.remove_prefix(d == line.npos ? line.size() : d + 1);
+    T res{};
+    std::from_chars(f.data(), f.data() + f.size(), res);
+    return res;
+}
+
+void row_parser(bench::state &st)
+{
+    const auto t = text(st.rows());
+    st.measure(st.rows(), [&] {
+        vec v;
+        v.reserve(64);
+        std::string_view s = t;
+        while (!s.empty()) {
+            const auto nl = s.find('\n');
+            auto line     = s.substr(0, nl);
+            s.remove_prefix(nl + 1);
+            std::tuple<std::int64_t, double, float, std::uint32_t> row{
+                field<std::int64_t>(line), field<double>(line),
+                field<float>(line), field<std::uint32_t>(line)};
+            if (v.size() == v.capacity())
+                v.reserve(2 * v.capacity());
+            v.push_back(row);
+        }
+        bench::do_not_optimize(v);
+    });
+}
+
+template <bool Parallel>
+void csv(bench::state &st)
+{
+    const auto t = text(st.rows());
+    dori::thread_pool one{1};
+    auto &pool = Parallel ? dori::thread_pool::global() : one;
+    st.measure(st.rows(), [&] {
+        vec v;
+        dori::ingest::csv(pool, v, t);
+        bench::do_not_optimize(v);
+    });
+}
+
+struct rec {
+    std::int64_t id;
+    double px;
+    float qty;
+    std::uint32_t n;
+    char note[40];
+};
+
+std::vector<rec> recs(std::size_t n)
+{
+    std::vector<rec> res(n);
+    for (std::size_t i = 0; i < n; ++i)
+        res[i] = {static_cast<std::int64_t>(i), i * 0.25,
+                  static_cast<float>(i), static_cast<std::uint32_t>(i), {}};
+    return res;
+}
+
+void push_back_records(bench::state &st)
+{
+    const auto rs    = recs(st.rows());
+    const auto bytes = std::as_bytes(std::span{rs});
+    st.measure(rs.size(), [&] {
+        vec v;
+        v.reserve(rs.size());
+        for (auto p = bytes.data(); p != bytes.data() + bytes.size();
+             p += sizeof(rec)) {
+            rec r;
+            std::memcpy(&r, p, sizeof(r));
+            v.push_back(r.id, r.px, r.qty, r.n);
+        }
+        bench::do_not_optimize(v);
+    });
+}
+
+void records(bench::state &st)
+{
+    const auto rs    = recs(st.rows());
+    const auto bytes = std::as_bytes(std::span{rs});
+    st.measure(rs.size(), [&] {
+        vec v;
+        dori::ingest::records(v, bytes, sizeof(rec),
+                              std::array{offsetof(rec, id), offsetof(rec, px),
+                                         offsetof(rec, qty),
+                                         offsetof(rec, n)});
+        bench::do_not_optimize(v);
+    });
+}
+
+[[maybe_unused]] const bool registered =
+    (bench::registrar{"ingest/csv/row_parser", row_parser},
+     bench::registrar{"ingest/csv/ingest_1_thread", csv<false>},
+     bench::registrar{"ingest/csv/ingest", csv<true>},
+     bench::registrar{"ingest/records/push_back", push_back_records},
+     bench::registrar{"ingest/records/ingest", records}, true);
+
+} // namespace
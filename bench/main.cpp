@@ -0,0 +1,62 @@
+//
+// Entry point of dori-bench. Usage:
+//
+//   dori-bench [--filter <substring>] [--rows <n>] [--min-time <ms>] [--perf]
+//
+// Every registered benchmark whose name contains the filter is run, and the
+// time per processed element is printed. With --perf, cycles and IPC as well
+// as cache misses per element and the cache miss rate are reported too.
+//
+
+#include "harness.h"
+
+#include <cstdlib>
+#include <cstring>
+
+int main(int argc, char **argv)
+{
+    bench::options opts;
+    bool use_perf = false;
+    for (int i = 1; i < argc; ++i) {
+        const auto arg = [&](const char *name) {
+            return !std::strcmp(argv[i], name) && i + 1 < argc;
+        };
+        if (arg("--filter"))
+            opts.filter = argv[++i];
+        else if (arg("--rows"))
+            opts.rows = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg("--min-time"))
+            opts.min_time_ms = std::strtod(argv[++i], nullptr);
+        else if (!std::strcmp(argv[i], "--perf"))
+            use_perf = true;
+        else {
+            std::fprintf(stderr,
+                         "usage: %s [--filter <substring>] [--rows <n>] "
+                         "[--min-time <ms>] [--perf]\n",
+                         argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    bench::perf_counters counters;
+    if (use_perf) {
+        if (counters.open())
+            opts.counters = &counters;
+        else
+            std::fprintf(stderr, "note: hardware counters unavailable "
+                                 "(check perf_event_paranoid)\n");
+    }
+
+    std::printf("%-48s %10s %10s", "benchmark", "rows", "ns/elem");
+    if (opts.counters)
+        std::printf(" %10s %6s %10s %7s", "cyc/elem", "IPC", "miss/elem",
+                    "miss%");
+    std::printf("\n");
+
+    for (auto &[name, fn] : bench::registry()) {
+        if (name.find(opts.filter) == std::string::npos)
+            continue;
+        bench::state st{name, opts};
+        fn(st);
+    }
+}
@@ -0,0 +1,84 @@
+//
+// Benchmarks columns of int32 with missing values: std::optional<int32>, which
+// takes twice the bytes of the values, against dori::nullable<int32> keeping
+// the values dense and their validity as a bitmap. Summing the rows that
+// aren't null, with a tenth of them null and with none, and filtering them by
+// a predicate into a bit column.
+//
+
+#include "harness.h"
+
+#include <dori/nullable.h>
+#include <dori/vector.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+
+namespace
+{
+
+using optionals = dori::vector<std::optional<std::int32_t>>;
+using nullables = dori::vector<dori::nullable<std::int32_t>>;
+
+template <class Vec>
+Vec make(std::size_t n, std::size_t null_every)
+{
+    Vec v;
+    v.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        std::optional<std::int32_t> x;
+        if (!null_every || i % null_every)
+            x = static_cast<std::int32_t>(i * 7 % 1000);
+        v.push_back(x);
+    }
+    return v;
+}
+
+template <class Vec, std::size_t NullEvery>
+void sum(bench::state &st)
+{
+    const auto v = make<Vec>(st.rows(), NullEvery);
+    st.measure(v.size(), [&] {
+        std::int64_t acc = 0;
+        const auto p     = v.template data<0>();
+        if constexpr (std::is_same_v<Vec, nullables>)
+            acc = dori::valid::sum(p, v.size());
+        else
+            for (std::size_t i = 0; i < v.size(); ++i)
+                acc += p[i] ? *p[i] : 0;
+        bench::do_not_optimize(acc);
+    });
+}
+
+template <class Vec>
+void filter(bench::state &st)
+{
+    const auto v = make<Vec>(st.rows(), 10);
+    dori::vector<dori::bit> m;
+    m.reserve(v.size());
+    m.resize(v.size());
+    st.measure(v.size(), [&] {
+        const auto p    = v.template data<0>();
+        const auto pred = [](std::int32_t x) { return x < 500; };
+        if constexpr (std::is_same_v<Vec, nullables>)
+            dori::valid::where(p, v.size(), pred, m.data<0>());
+        else {
+            auto d = m.data<0>();
+            for (std::size_t i = 0; i < v.size(); ++i)
+                d[static_cast<std::ptrdiff_t>(i)] = p[i] && pred(*p[i]);
+        }
+        bench::do_not_optimize(m);
+    });
+}
+
+[[maybe_unused]] const bool registered =
+    (bench::registrar{"nullable/sum/optional", sum<optionals, 10>},
+     bench::registrar{"nullable/sum/nullable", sum<nullables, 10>},
+     bench::registrar{"nullable/sum_no_nulls/optional", sum<optionals, 0>},
+     bench::registrar{"nullable/sum_no_nulls/nullable", sum<nullables, 0>},
+     bench::registrar{"nullable/filter/optional", filter<optionals>},
+     bench::registrar{"nullable/filter/nullable", filter<nullables>}, true);
+
+} // namespace
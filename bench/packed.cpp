@@ -0,0 +1,89 @@
+//
+// Benchmarks flag columns: bool columns taking a byte per row against
+// dori::bit columns packed into words and worked on by the dori::mask
+// kernels. Counting the set rows, and selecting the rows where two flags are
+// both set.
+//
+
+#include "harness.h"
+
+#include <dori/packed.h>
+#include <dori/vector.h>
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace
+{
+
+using bytes = dori::vector<bool, bool, std::uint32_t>;
+using bits  = dori::vector<dori::bit, dori::bit, std::uint32_t>;
+
+template <class Vec>
+Vec make(std::size_t n)
+{
+    Vec v;
+    v.reserve(n);
+    for (std::size_t i = 0; i < n; ++i)
+        v.push_back(i % 3 == 0, i % 7 < 3, static_cast<std::uint32_t>(i));
+    return v;
+}
+
+void count_bytes(bench::state &st)
+{
+    const auto v = make<bytes>(st.rows());
+    st.measure(v.size(), [&] {
+        std::size_t acc = 0;
+        for (auto f = v.data<0>(), l = f + v.size(); f != l; ++f)
+            acc += *f;
+        bench::do_not_optimize(acc);
+    });
+}
+
+void count_bits(bench::state &st)
+{
+    const auto v = make<bits>(st.rows());
+    st.measure(v.size(), [&] {
+        auto acc = dori::mask::count(v.data<0>(), v.size());
+        bench::do_not_optimize(acc);
+    });
+}
+
+void select_bytes(bench::state &st)
+{
+    const auto v = make<bytes>(st.rows());
+    std::vector<std::size_t> idx(v.size());
+    st.measure(v.size(), [&] {
+        auto out     = idx.data();
+        const auto a = v.data<0>(), b = v.data<1>();
+        for (std::size_t i = 0; i < v.size(); ++i)
+            if (a[i] & b[i])
+                *out++ = i;
+        bench::do_not_optimize(out);
+    });
+}
+
+void select_bits(bench::state &st)
+{
+    auto v = make<bits>(st.rows());
+    bits tmp;
+    tmp.reserve(v.size());
+    tmp.resize(v.size());
+    std::vector<std::size_t> idx(v.size());
+    st.measure(v.size(), [&] {
+        dori::mask::combine(tmp.data<0>(), v.data<0>(), v.data<1>(), v.size(),
+                            std::bit_and<>{});
+        auto out =
+            dori::mask::to_indices(tmp.data<0>(), tmp.size(), idx.data());
+        bench::do_not_optimize(out);
+    });
+}
+
+[[maybe_unused]] const bool registered =
+    (bench::registrar{"bool/count", count_bytes},
+     bench::registrar{"dori::bit/count", count_bits},
+     bench::registrar{"bool/select", select_bytes},
+     bench::registrar{"dori::bit/select", select_bits}, true);
+
+} // namespace
@@ -0,0 +1,101 @@
+//
+// Benchmarks a reduction and an in-place update over the rows of a
+// dori::vector, serially against parallel_reduce() and
+// parallel_for_each_chunk() on the global thread pool, for a few grains.
+//
+
+#include "harness.h"
+
+#include <dori/parallel.h>
+#include <dori/vector.h>
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace
+{
+
+using vec = dori::vector<std::uint64_t, std::uint32_t, float>;
+
+vec make(std::size_t n)
+{
+    vec v;
+    v.reserve(n);
+    for (std::size_t i = 0; i < n; ++i)
+        v.push_back(i, static_cast<std::uint32_t>(i * 2654435761u),
+                    static_cast<float>(i));
+    return v;
+}
+
+std::uint64_t sum(const vec &v, std::size_t f, std::size_t l)
+{
+    const auto a = v.data<0>();
+    const auto b = v.data<1>();
+    std::uint64_t acc = 0;
+    for (auto i = f; i < l; ++i)
+        acc += a[i] ^ b[i];
+    return acc;
+}
+
+void update(vec &v, std::size_t f, std::size_t l)
+{
+    const auto b = v.data<1>();
+    const auto c = v.data<2>();
+    for (auto i = f; i < l; ++i)
+        c[i] = c[i] * 0.5f + static_cast<float>(b[i] & 0xff);
+}
+
+void serial_reduce(bench::state &st)
+{
+    const auto v = make(st.rows());
+    st.measure(v.size(), [&] {
+        auto acc = sum(v, 0, v.size());
+        bench::do_not_optimize(acc);
+    });
+}
+
+void serial_update(bench::state &st)
+{
+    auto v = make(st.rows());
+    st.measure(v.size(), [&] {
+        update(v, 0, v.size());
+        bench::clobber_memory();
+    });
+}
+
+template <std::size_t Grain>
+void parallel_reduce(bench::state &st)
+{
+    const auto v = make(st.rows());
+    st.measure(v.size(), [&] {
+        auto acc = dori::parallel_reduce(
+            v, Grain, std::uint64_t{0},
+            [&](std::size_t f, std::size_t l) { return sum(v, f, l); },
+            std::plus<>{});
+        bench::do_not_optimize(acc);
+    });
+}
+
+template <std::size_t Grain>
+void parallel_update(bench::state &st)
+{
+    auto v = make(st.rows());
+    st.measure(v.size(), [&] {
+        dori::parallel_for_each_chunk(
+            v, Grain, [&](std::size_t f, std::size_t l) { update(v, f, l); });
+        bench::clobber_memory();
+    });
+}
+
+#define BENCH_grains(Name)                                                     \
+    bench::registrar{"parallel/" #Name "/g4k", Name<4096>},                    \
+        bench::registrar{"parallel/" #Name "/g64k", Name<65536>},              \
+        bench::registrar{"parallel/" #Name "/g1m", Name<1048576>}
+
+[[maybe_unused]] const bool registered =
+    (bench::registrar{"serial/reduce", serial_reduce},
+     bench::registrar{"serial/update", serial_update},
+     BENCH_grains(parallel_reduce), BENCH_grains(parallel_update), true);
+
+} // namespace
@@ -0,0 +1,85 @@
+//
+// Benchmarks sharding a dori::vector of four columns into 64 buckets by the
+// hash of a key: a scan calling push_back() on the vector of each row's
+// bucket, growing them as it goes, against dori::partition_by() on one thread
+// and on the global pool, and dori::reorder_by() into one vector.
+//
+
+#include "harness.h"
+
+#include <dori/partition.h>
+#include <dori/vector.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+
+using vec = dori::vector<std::uint64_t, double, float, std::uint32_t>;
+
+constexpr std::size_t buckets = 64;
+
+vec make(std::size_t n)
+{
+    vec v;
+    v.reserve(n);
+    for (std::size_t i = 0; i < n; ++i)
+        v.push_back(i * 0x9e3779b97f4a7c15u, i * .25, static_cast<float>(i),
+                    static_cast<std::uint32_t>(i));
+    return v;
+}
+
+std::size_t bucket_of(std::uint64_t key) { return key >> 58; }
+
+void push_back(bench::state &st)
+{
+    const auto v = make(st.rows());
+    st.measure(st.rows(), [&] {
+        std::vector<vec> res(buckets);
+        for (std::size_t i = 0; i < v.size(); ++i) {
+            const auto [k, a, b, c] = v[i];
+            auto &d                 = res[bucket_of(k)];
+            if (d.size() == d.capacity())
+                d.reserve(d.size() ? 2 * d.size() : 64);
+            d.push_back(k, a, b, c);
+        }
+        bench::do_not_optimize(res);
+    });
+}
+
+void partition_by(bench::state &st)
+{
+    const auto v = make(st.rows());
+    st.measure(st.rows(), [&] {
+        auto res = dori::partition_by<0>(v, buckets, bucket_of);
+        bench::do_not_optimize(res);
+    });
+}
+
+void parallel_partition_by(bench::state &st)
+{
+    const auto v = make(st.rows());
+    st.measure(st.rows(), [&] {
+        auto res = dori::parallel_partition_by<0>(v, buckets, bucket_of);
+        bench::do_not_optimize(res);
+    });
+}
+
+void reorder_by(bench::state &st)
+{
+    const auto v = make(st.rows());
+    st.measure(st.rows(), [&] {
+        auto res = dori::reorder_by<0>(v, buckets, bucket_of);
+        bench::do_not_optimize(res);
+    });
+}
+
+[[maybe_unused]] const bool registered =
+    (bench::registrar{"partition/push_back", push_back},
+     bench::registrar{"partition/partition_by", partition_by},
+     bench::registrar{"partition/parallel_partition_by", parallel_partition_by},
+     bench::registrar{"partition/reorder_by", reorder_by}, true);
+
+} // namespace
@@ -0,0 +1,91 @@
+//
+// Benchmarks a filter-map-reduce over a dori::vector done in separate passes,
+// each materializing its result for the whole vector, against the fused
+// dori::query and a hand-written single loop.
+//
+
+#include "harness.h"
+
+#include <dori/vector.h>
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace
+{
+
+using vec = dori::vector<std::uint32_t, std::uint32_t, double, std::uint64_t,
+                         std::uint64_t>;
+
+vec make(std::size_t n)
+{
+    vec v;
+    v.reserve(n);
+    for (std::size_t i = 0; i < n; ++i)
+        v.push_back(static_cast<std::uint32_t>(i),
+                    static_cast<std::uint32_t>(i * 2654435761u),
+                    static_cast<double>(i) / 3, i, ~i);
+    return v;
+}
+
+constexpr auto keep = [](std::uint32_t x) noexcept { return x % 4 == 0; };
+
+void passes(bench::state &st)
+{
+    const auto v = make(st.rows());
+    std::vector<std::uint32_t> sel;
+    std::vector<std::uint64_t> vals;
+    st.measure(v.size(), [&] {
+        sel.clear();
+        vals.clear();
+        const auto b = v.data<1>();
+        for (std::size_t i = 0; i < v.size(); ++i)
+            if (keep(b[i]))
+                sel.push_back(static_cast<std::uint32_t>(i));
+        const auto a = v.data<0>();
+        const auto d = v.data<3>();
+        for (auto i : sel)
+            vals.push_back(a[i] * d[i]);
+        std::uint64_t acc = 0;
+        for (auto x : vals)
+            acc += x;
+        bench::do_not_optimize(acc);
+    });
+}
+
+void fused(bench::state &st)
+{
+    const auto v = make(st.rows());
+    st.measure(v.size(), [&] {
+        auto acc = v.query()
+                       .where<1>(keep)
+                       .select<0, 3>([](std::uint32_t a, std::uint64_t d) {
+                           return a * d;
+                       })
+                       .reduce(std::plus<>{});
+        bench::do_not_optimize(acc);
+    });
+}
+
+void loop(bench::state &st)
+{
+    const auto v = make(st.rows());
+    st.measure(v.size(), [&] {
+        const auto a = v.data<0>();
+        const auto b = v.data<1>();
+        const auto d      = v.data<3>();
+        std::uint64_t acc = 0;
+        for (std::size_t i = 0; i < v.size(); ++i)
+            if (keep(b[i]))
+                acc += a[i] * d[i];
+        bench::do_not_optimize(acc);
+    });
+}
+
+[[maybe_unused]] const bool registered =
+    (bench::registrar{"query/passes", passes},
+     bench::registrar{"query/fused", fused},
+     bench::registrar{"query/loop", loop}, true);
+
+} // namespace
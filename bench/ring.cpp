@@ -0,0 +1,72 @@
+//
+// Benchmarks a sliding window of 4096 rows, appended to in batches of 256 and
+// summed after each, kept in a dori::vector whose first rows are erased as
+// user code would, against a dori::ring.
+//
+
+#include "harness.h"
+
+#include <dori/ring.h>
+#include <dori/vector.h>
+
+#include <cstdint>
+#include <iterator>
+#include <tuple>
+#include <utility>
+
+namespace
+{
+
+using vec = dori::vector<std::uint64_t, float>;
+
+constexpr std::size_t window = 4096;
+constexpr std::size_t batch  = 256;
+
+vec make(std::size_t n)
+{
+    vec v;
+    v.reserve(n);
+    for (std::size_t i = 0; i < n; ++i)
+        v.push_back(i, static_cast<float>(i) / 3);
+    return v;
+}
+
+void vector(bench::state &st)
+{
+    const vec src = make(st.rows());
+    st.measure(src.size(), [&] {
+        vec w;
+        w.reserve(window + batch);
+        std::uint64_t s = 0;
+        for (std::size_t i = 0; i + batch <= src.size(); i += batch) {
+            if (w.size() == window)
+                w.erase(w.begin(), std::next(w.begin(), batch));
+            for (std::size_t j = i; j < i + batch; ++j)
+                w.push_back(src[j]);
+            const auto p = w.data<0>();
+            for (std::size_t j = 0; j < w.size(); ++j)
+                s += p[j];
+        }
+        bench::do_not_optimize(s);
+    });
+}
+
+void ring(bench::state &st)
+{
+    const vec src = make(st.rows());
+    st.measure(src.size(), [&] {
+        dori::ring<std::uint64_t, float> r{window};
+        std::uint64_t s = 0;
+        for (std::size_t i = 0; i + batch <= src.size(); i += batch) {
+            r.append(batch, src.data<0>() + i, src.data<1>() + i);
+            s += std::get<0>(r.aggregate<dori::sum<0>>(r.size()));
+        }
+        bench::do_not_optimize(s);
+    });
+}
+
+[[maybe_unused]] const bool registered =
+    (bench::registrar{"ring/window/vector", vector},
+     bench::registrar{"ring/window/ring", ring}, true);
+
+} // namespace
@@ -0,0 +1,149 @@
+//
+// Benchmarks workloads of many short-lived containers with few rows each,
+// where the allocation dominates: dori::small_vector against dori::vector and
+// std::vector of a struct, both of which reserve exactly the rows needed.
+//
+
+#include "harness.h"
+
+#include <dori/small_vector.h>
+#include <dori/vector.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+
+using namespace boost::mp11;
+
+struct row {
+    std::uint64_t a;
+    std::uint32_t b;
+    std::uint16_t c;
+};
+
+// Shared by both dori containers, which differ in construction only
+template <class Vec>
+struct dori_ops {
+    using vec = Vec;
+    static void push(vec &v, std::uint64_t x)
+    {
+        v.push_back(x, static_cast<std::uint32_t>(x),
+                    static_cast<std::uint16_t>(x));
+    }
+    static std::uint64_t sum(const vec &v)
+    {
+        std::uint64_t acc = 0;
+        v.for_each([&](const auto *f, const auto *l) {
+            for (; f != l; ++f)
+                acc += *f;
+        });
+        return acc;
+    }
+};
+
+struct soa
+    : dori_ops<dori::vector<std::uint64_t, std::uint32_t, std::uint16_t>> {
+    static constexpr auto label = "dori::vector";
+    static void reserve(vec &v, std::size_t n) { v.reserve(n); }
+};
+
+struct small : dori_ops<dori::small_vector<16, std::uint64_t, std::uint32_t,
+                                           std::uint16_t>> {
+    static constexpr auto label = "dori::small_vector<16>";
+    static void reserve(vec &v, std::size_t n)
+    {
+        if (n > v.capacity())
+            v.reserve(n);
+    }
+};
+
+struct aos {
+    using vec                   = std::vector<row>;
+    static constexpr auto label = "std::vector";
+    static void reserve(vec &v, std::size_t n) { v.reserve(n); }
+    static void push(vec &v, std::uint64_t x)
+    {
+        v.push_back({x, static_cast<std::uint32_t>(x),
+                     static_cast<std::uint16_t>(x)});
+    }
+    static std::uint64_t sum(const vec &v)
+    {
+        std::uint64_t acc = 0;
+        for (auto &r : v)
+            acc += r.a + r.b + r.c;
+        return acc;
+    }
+};
+
+//
+// Build a container of k rows, sum it, and drop it; repeat for rows() rows.
+//
+template <class C, std::size_t K>
+void build_sum(bench::state &st)
+{
+    const auto n = st.rows() / K * K;
+    st.measure(n, [&] {
+        std::uint64_t acc = 0;
+        for (std::size_t i = 0; i < n; i += K) {
+            typename C::vec v;
+            C::reserve(v, K);
+            for (std::size_t j = 0; j < K; ++j)
+                C::push(v, i + j);
+            acc += C::sum(v);
+        }
+        bench::do_not_optimize(acc);
+    });
+}
+
+//
+// As above, but keep the containers alive in a std::vector, as e.g. adjacency
+// lists would be, and sum them afterwards.
+//
+template <class C, std::size_t K>
+void nested(bench::state &st)
+{
+    const auto n = st.rows() / K * K;
+    std::vector<typename C::vec> vs;
+    st.measure(
+        n, [&] { vs = {}; },
+        [&] {
+            vs.resize(n / K);
+            for (std::size_t i = 0; i < vs.size(); ++i) {
+                C::reserve(vs[i], K);
+                for (std::size_t j = 0; j < K; ++j)
+                    C::push(vs[i], i * K + j);
+            }
+            std::uint64_t acc = 0;
+            for (auto &v : vs)
+                acc += C::sum(v);
+            bench::do_not_optimize(acc);
+        });
+}
+
+template <template <class, std::size_t> class Op>
+void add(const char *name)
+{
+    mp_for_each<mp_list<mp_size_t<4>, mp_size_t<12>, mp_size_t<64>>>(
+        [&](auto k) {
+            mp_for_each<mp_list<small, soa, aos>>([&]<class C>(C) {
+                bench::registrar{std::string{C::label} + "/" + name + "/k" +
+                                     std::to_string(k),
+                                 Op<C, k>{}};
+            });
+        });
+}
+
+#define BENCH_op(Name)                                                         \
+    template <class C, std::size_t K>                                          \
+    struct Name##_op {                                                         \
+        void operator()(bench::state &st) const { Name<C, K>(st); }            \
+    }
+BENCH_op(build_sum);
+BENCH_op(nested);
+
+[[maybe_unused]] const bool registered =
+    (add<build_sum_op>("build_sum"), add<nested_op>("nested"), true);
+
+} // namespace
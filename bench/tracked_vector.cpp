@@ -0,0 +1,74 @@
+//
+// Benchmarks bringing a replica up to date each tick with a vector of which a
+// few rows of one column change: copying every row, as a replica is brought
+// up to date without knowing what changed, against applying the deltas of a
+// dori::tracked_vector.
+//
+
+#include "harness.h"
+
+#include <dori/tracked_vector.h>
+#include <dori/vector.h>
+
+#include <cstdint>
+#include <random>
+
+namespace
+{
+
+using vec = dori::vector<std::int64_t, double, float, std::uint32_t>;
+using tracked =
+    dori::tracked_vector<std::int64_t, double, float, std::uint32_t>;
+
+// Rows changed per tick, of 1000
+constexpr std::size_t changed_per_mille = 10;
+
+template <class V>
+V make(std::size_t n)
+{
+    V v;
+    v.reserve(n);
+    for (std::size_t i = 0; i < n; ++i)
+        v.push_back(static_cast<std::int64_t>(i), i * 0.5,
+                    static_cast<float>(i), static_cast<std::uint32_t>(i));
+    return v;
+}
+
+void copy(bench::state &st)
+{
+    auto v = make<vec>(st.rows());
+    vec r  = v;
+    std::mt19937_64 rng{1};
+    const auto n = v.size() * changed_per_mille / 1000;
+    st.measure(v.size(), [&] {
+        const auto p = v.data<1>();
+        for (std::size_t i = 0; i < n; ++i)
+            p[rng() % v.size()] += 1;
+        r = v;
+        bench::do_not_optimize(r);
+    });
+}
+
+void deltas(bench::state &st)
+{
+    auto v = make<tracked>(st.rows());
+    vec r;
+    dori::apply_deltas(r, v.collect_deltas());
+    std::mt19937_64 rng{1};
+    const auto n = v.size() * changed_per_mille / 1000;
+    st.measure(v.size(), [&] {
+        const auto p = v.data<1>();
+        for (std::size_t i = 0; i < n; ++i) {
+            const auto j = rng() % v.size();
+            v.set<1>(j, p[j] + 1);
+        }
+        dori::apply_deltas(r, v.collect_deltas());
+        bench::do_not_optimize(r);
+    });
+}
+
+[[maybe_unused]] const bool registered =
+    (bench::registrar{"tracked_vector/tick/copy", copy},
+     bench::registrar{"tracked_vector/tick/deltas", deltas}, true);
+
+} // namespace
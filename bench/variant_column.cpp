@@ -0,0 +1,112 @@
+//
+// Benchmarks a column of shapes of three types mixed at random: a std::variant
+// per row of a dori::vector, visited with std::visit() one row at a time,
+// against a dori::variant_column visited a type at a time by
+// visit_by_type(). Summing the areas of all shapes, and writing the area of
+// each back to its row.
+//
+
+#include "harness.h"
+
+#include <dori/variant_column.h>
+#include <dori/vector.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+namespace
+{
+
+struct circle {
+    float r;
+};
+struct rect {
+    float w, h;
+};
+struct box {
+    float w, h, d;
+};
+
+float area(const circle &x) { return 3.14159f * x.r * x.r; }
+float area(const rect &x) { return x.w * x.h; }
+float area(const box &x) { return 2 * (x.w * x.h + x.w * x.d + x.h * x.d); }
+
+using shape    = std::variant<circle, rect, box>;
+using variants = dori::vector<shape>;
+using splits   = dori::variant_column<circle, rect, box>;
+
+shape shape_of(std::size_t i)
+{
+    const auto x = static_cast<float>(i % 100) * .01f;
+    switch (i * 2654435761u >> 7 & 3) {
+    case 0: return circle{x};
+    case 1: return rect{x, 2 * x};
+    default: return box{x, x, 3 * x};
+    }
+}
+
+template <class Col>
+Col make(std::size_t n)
+{
+    Col c;
+    c.reserve(n);
+    for (std::size_t i = 0; i < n; ++i)
+        c.push_back(shape_of(i));
+    return c;
+}
+
+template <class Col>
+void sum(bench::state &st)
+{
+    const auto c = make<Col>(st.rows());
+    st.measure(c.size(), [&] {
+        float acc = 0;
+        if constexpr (std::is_same_v<Col, splits>)
+            c.visit_by_type([&](auto xs) {
+                for (const auto &x : xs)
+                    acc += area(x);
+            });
+        else {
+            const auto p = c.template data<0>();
+            for (std::size_t i = 0; i < c.size(); ++i)
+                acc += std::visit([](const auto &x) { return area(x); }, p[i]);
+        }
+        bench::do_not_optimize(acc);
+    });
+}
+
+template <class Col>
+void scatter(bench::state &st)
+{
+    const auto c = make<Col>(st.rows());
+    std::vector<float> out(c.size());
+    st.measure(c.size(), [&] {
+        if constexpr (std::is_same_v<Col, splits>)
+            c.visit_by_type(
+                [&](auto xs, std::span<const splits::slot_type> rows) {
+                    for (std::size_t k = 0; k < xs.size(); ++k)
+                        out[rows[k]] = area(xs[k]);
+                });
+        else {
+            const auto p = c.template data<0>();
+            for (std::size_t i = 0; i < c.size(); ++i)
+                out[i] =
+                    std::visit([](const auto &x) { return area(x); }, p[i]);
+        }
+        bench::do_not_optimize(out);
+    });
+}
+
+[[maybe_unused]] const bool registered =
+    (bench::registrar{"variant_column/sum/std_variant", sum<variants>},
+     bench::registrar{"variant_column/sum/variant_column", sum<splits>},
+     bench::registrar{"variant_column/scatter/std_variant", scatter<variants>},
+     bench::registrar{"variant_column/scatter/variant_column",
+                      scatter<splits>},
+     true);
+
+} // namespace
@@ -0,0 +1,121 @@
+//
+// Benchmarks string columns: a std::string per row, each longer than fits
+// inline and so on the heap, against dori::varlen<char> keeping the values of
+// all rows in one buffer. Building the column by push_back(), and scanning it
+// for the rows that hold a given character. Then, for varlen<char> columns,
+// copying the rows of one into another by push_back() against append(), and
+// keeping a window of 256 rows as a queue would, erasing the front row for
+// each appended.
+//
+
+#include "harness.h"
+
+#include <dori/varlen.h>
+#include <dori/vector.h>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+
+using strings = dori::vector<std::uint32_t, std::string>;
+using varlens = dori::vector<std::uint32_t, dori::varlen<char>>;
+
+std::vector<std::string> words(std::size_t n)
+{
+    std::vector<std::string> res(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        res[i].assign(16 + i % 24, static_cast<char>('a' + i % 23));
+        res[i][i % 16] = 'z';
+    }
+    return res;
+}
+
+template <class Vec>
+Vec make(const std::vector<std::string> &ws)
+{
+    Vec v;
+    v.reserve(ws.size());
+    for (std::size_t i = 0; i < ws.size(); ++i)
+        v.push_back(static_cast<std::uint32_t>(i), ws[i]);
+    return v;
+}
+
+template <class Vec>
+void build(bench::state &st)
+{
+    const auto ws = words(st.rows());
+    st.measure(ws.size(), [&] {
+        auto v = make<Vec>(ws);
+        bench::do_not_optimize(v);
+    });
+}
+
+template <class Vec>
+void scan(bench::state &st)
+{
+    const auto v = make<Vec>(words(st.rows()));
+    st.measure(v.size(), [&] {
+        std::size_t acc = 0;
+        const auto p    = v.template data<1>();
+        for (std::size_t i = 0; i < v.size(); ++i) {
+            const std::string_view s = p[i];
+            acc += std::memchr(s.data(), 'c', s.size()) != nullptr;
+        }
+        bench::do_not_optimize(acc);
+    });
+}
+
+void copy_push_back(bench::state &st)
+{
+    const auto v = make<varlens>(words(st.rows()));
+    st.measure(v.size(), [&] {
+        varlens w;
+        w.reserve(v.size());
+        for (const auto [k, s] : v)
+            w.push_back(k, s);
+        bench::do_not_optimize(w);
+    });
+}
+
+void copy_append(bench::state &st)
+{
+    const auto v = make<varlens>(words(st.rows()));
+    st.measure(v.size(), [&] {
+        varlens w;
+        w.reserve(v.size());
+        w.append(v.size(), v.data<0>(), v.data<1>());
+        bench::do_not_optimize(w);
+    });
+}
+
+void erase_front(bench::state &st)
+{
+    constexpr std::size_t window = 256;
+    const auto ws                = words(st.rows());
+    st.measure(ws.size(), [&] {
+        varlens v;
+        v.reserve(window);
+        for (std::size_t i = 0; i < ws.size(); ++i) {
+            if (v.size() == window)
+                v.erase(v.begin());
+            v.push_back(static_cast<std::uint32_t>(i), ws[i]);
+        }
+        bench::do_not_optimize(v);
+    });
+}
+
+[[maybe_unused]] const bool registered =
+    (bench::registrar{"varlen/build/std_string", build<strings>},
+     bench::registrar{"varlen/build/varlen", build<varlens>},
+     bench::registrar{"varlen/scan/std_string", scan<strings>},
+     bench::registrar{"varlen/scan/varlen", scan<varlens>},
+     bench::registrar{"varlen/copy/push_back", copy_push_back},
+     bench::registrar{"varlen/copy/append", copy_append},
+     bench::registrar{"varlen/erase_front", erase_front}, true);
+
+} // namespace
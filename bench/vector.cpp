@@ -0,0 +1,320 @@
+//
+// Benchmarks dori::vector against an array-of-structures baseline, i.e.
+// std::vector of a struct with the same fields, across column counts and
+// element sizes.
+//
+
+#include "harness.h"
+
+#include <dori/vector.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <tuple>
+#include <vector>
+
+namespace
+{
+
+using namespace boost::mp11;
+
+template <std::size_t Size>
+struct blob {
+    std::uint64_t v[Size / 8];
+};
+
+template <std::size_t Size>
+using elem_t = std::conditional_t<
+    Size == 4, std::uint32_t,
+    std::conditional_t<Size == 8, std::uint64_t, blob<Size>>>;
+
+template <class T>
+constexpr std::uint64_t key(const T &x) noexcept
+{
+    if constexpr (std::is_integral_v<T>)
+        return x;
+    else
+        return x.v[0];
+}
+
+template <class T>
+constexpr T make(std::uint64_t x) noexcept
+{
+    if constexpr (std::is_integral_v<T>)
+        return static_cast<T>(x);
+    else
+        return T{{x}};
+}
+
+template <class T, std::size_t Cols>
+struct aos_row {
+    T c[Cols];
+};
+
+template <class T, std::size_t Cols>
+using soa_t = mp_rename<mp_repeat_c<mp_list<T>, Cols>, dori::vector>;
+template <class T, std::size_t Cols>
+using aos_t = std::vector<aos_row<T, Cols>>;
+
+std::vector<std::uint64_t> random_keys(std::size_t n)
+{
+    std::vector<std::uint64_t> res(n);
+    std::mt19937_64 rng{42};
+    for (auto &x : res)
+        x = rng();
+    return res;
+}
+
+//
+// Uniform access to both containers so that each benchmark body is written
+// once. The SoA variants work column-wise where that's what the container is
+// meant for; the AoS variants are the idiomatic std::vector code.
+//
+
+template <class T, std::size_t Cols>
+struct soa {
+    using vec                   = soa_t<T, Cols>;
+    static constexpr auto label = "dori::vector";
+
+    static void push(vec &v, std::uint64_t x)
+    {
+        [&]<std::size_t... Is>(std::index_sequence<Is...>)
+        {
+            v.push_back(make<T>(x + Is)...);
+        }
+        (std::make_index_sequence<Cols>{});
+    }
+    static void reserve(vec &v, std::size_t n) { v.reserve(n); }
+    static void grow_push(vec &v, std::uint64_t x)
+    {
+        if (v.size() == v.capacity())
+            v.reserve(std::max<std::size_t>(8, v.capacity() * 2));
+        push(v, x);
+    }
+    static std::uint64_t sum_all(const vec &v)
+    {
+        std::uint64_t acc = 0;
+        for (auto &&row : v)
+            std::apply([&](const auto &...xs) { acc += (key(xs) + ...); },
+                       row);
+        return acc;
+    }
+    static std::uint64_t sum_first(const vec &v)
+    {
+        std::uint64_t acc = 0;
+        const auto p      = v.template data<0>();
+        for (std::size_t i = 0; i < v.size(); ++i)
+            acc += key(p[i]);
+        return acc;
+    }
+    static void erase_front(vec &v, std::size_t n)
+    {
+        v.erase(v.begin(),
+                std::next(v.begin(), static_cast<std::ptrdiff_t>(n)));
+    }
+    static vec sorted(const vec &v)
+    {
+        // Sort a permutation by the key column, then gather column by column
+        std::vector<std::uint32_t> perm(v.size());
+        std::iota(perm.begin(), perm.end(), 0u);
+        const auto k = v.template data<0>();
+        std::sort(perm.begin(), perm.end(), [&](auto a, auto b) {
+            return key(k[a]) < key(k[b]);
+        });
+        vec res;
+        res.reserve(v.size());
+        res.resize(v.size());
+        [&]<std::size_t... Is>(std::index_sequence<Is...>)
+        {
+            (..., [&](auto *d, const auto *s) {
+                for (std::size_t i = 0; i < perm.size(); ++i)
+                    d[i] = s[perm[i]];
+            }(res.template data<Is>(), v.template data<Is>()));
+        }
+        (std::make_index_sequence<Cols>{});
+        return res;
+    }
+};
+
+template <class T, std::size_t Cols>
+struct aos {
+    using vec                   = aos_t<T, Cols>;
+    static constexpr auto label = "std::vector";
+
+    static void push(vec &v, std::uint64_t x)
+    {
+        [&]<std::size_t... Is>(std::index_sequence<Is...>)
+        {
+            v.push_back({make<T>(x + Is)...});
+        }
+        (std::make_index_sequence<Cols>{});
+    }
+    static void reserve(vec &v, std::size_t n) { v.reserve(n); }
+    static void grow_push(vec &v, std::uint64_t x) { push(v, x); }
+    static std::uint64_t sum_all(const vec &v)
+    {
+        std::uint64_t acc = 0;
+        for (auto &row : v)
+            for (auto &x : row.c)
+                acc += key(x);
+        return acc;
+    }
+    static std::uint64_t sum_first(const vec &v)
+    {
+        std::uint64_t acc = 0;
+        for (auto &row : v)
+            acc += key(row.c[0]);
+        return acc;
+    }
+    static void erase_front(vec &v, std::size_t n)
+    {
+        v.erase(v.begin(), v.begin() + static_cast<std::ptrdiff_t>(n));
+    }
+    static vec sorted(const vec &v)
+    {
+        vec res = v;
+        std::sort(res.begin(), res.end(), [](auto &a, auto &b) {
+            return key(a.c[0]) < key(b.c[0]);
+        });
+        return res;
+    }
+};
+
+template <class C>
+typename C::vec filled(std::size_t n)
+{
+    typename C::vec v;
+    C::reserve(v, n);
+    for (const auto x : random_keys(n))
+        C::push(v, x);
+    return v;
+}
+
+template <class C>
+void push_back(bench::state &st)
+{
+    const auto n = st.rows();
+    typename C::vec v;
+    st.measure(
+        n, [&] { v = {}; },
+        [&] {
+            C::reserve(v, n);
+            for (std::size_t i = 0; i < n; ++i)
+                C::push(v, i);
+        });
+    bench::do_not_optimize(v);
+}
+
+template <class C>
+void reserve(bench::state &st)
+{
+    const auto n = st.rows();
+    typename C::vec v;
+    st.measure(
+        n, [&] { v = {}; },
+        [&] {
+            for (std::size_t i = 0; i < n; ++i)
+                C::grow_push(v, i);
+        });
+    bench::do_not_optimize(v);
+}
+
+template <class C>
+void iterate(bench::state &st)
+{
+    const auto v = filled<C>(st.rows());
+    st.measure(v.size(), [&] {
+        auto x = C::sum_all(v);
+        bench::do_not_optimize(x);
+    });
+}
+
+template <class C>
+void scan(bench::state &st)
+{
+    const auto v = filled<C>(st.rows());
+    st.measure(v.size(), [&] {
+        auto x = C::sum_first(v);
+        bench::do_not_optimize(x);
+    });
+}
+
+template <class C>
+void erase(bench::state &st)
+{
+    const auto proto = filled<C>(st.rows());
+    typename C::vec v;
+    st.measure(
+        proto.size(), [&] { v = proto; },
+        [&] { C::erase_front(v, v.size() / 16); });
+}
+
+template <class C>
+void sort(bench::state &st)
+{
+    const auto v = filled<C>(st.rows());
+    st.measure(v.size(), [&] {
+        auto res = C::sorted(v);
+        bench::do_not_optimize(res);
+    });
+}
+
+template <class C>
+void copy(bench::state &st)
+{
+    const auto v = filled<C>(st.rows());
+    st.measure(v.size(), [&] {
+        auto res = v;
+        bench::do_not_optimize(res);
+    });
+}
+
+template <std::size_t Size, std::size_t Cols>
+std::string config()
+{
+    // e.g. "u32x4" for four uint32_t columns, "b32x2" for two 32-byte blobs
+    return (Size > 8 ? "b" + std::to_string(Size)
+                     : "u" + std::to_string(Size * 8)) +
+           "x" + std::to_string(Cols);
+}
+
+template <template <class> class Op>
+void add(const char *name)
+{
+    mp_for_each<mp_list<mp_size_t<4>, mp_size_t<8>, mp_size_t<32>>>(
+        [&](auto size) {
+            mp_for_each<mp_list<mp_size_t<2>, mp_size_t<4>, mp_size_t<8>>>(
+                [&](auto cols) {
+                    using T = elem_t<size>;
+                    mp_for_each<mp_list<soa<T, cols>, aos<T, cols>>>(
+                        [&]<class C>(C) {
+                            bench::registrar{std::string{C::label} + "/" +
+                                                 name + "/" +
+                                                 config<size, cols>(),
+                                             Op<C>{}};
+                        });
+                });
+        });
+}
+
+#define BENCH_op(Name)                                                         \
+    template <class C>                                                         \
+    struct Name##_op {                                                         \
+        void operator()(bench::state &st) const { Name<C>(st); }               \
+    }
+BENCH_op(push_back);
+BENCH_op(reserve);
+BENCH_op(iterate);
+BENCH_op(scan);
+BENCH_op(erase);
+BENCH_op(sort);
+BENCH_op(copy);
+
+[[maybe_unused]] const bool registered =
+    (add<push_back_op>("push_back"), add<reserve_op>("reserve"),
+     add<iterate_op>("iterate"), add<scan_op>("scan"), add<erase_op>("erase"),
+     add<sort_op>("sort"), add<copy_op>("copy"), true);
+
+} // namespace
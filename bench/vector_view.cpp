@@ -0,0 +1,72 @@
+//
+// Benchmarks running a kernel over rows in buffers dori doesn't own, such as
+// those of a network message: copying them into a dori::vector first, against
+// a dori::vector_view of the buffers.
+//
+
+#include "harness.h"
+
+#include <dori/vector.h>
+#include <dori/vector_view.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+
+struct buffers {
+    std::vector<std::int64_t> id;
+    std::vector<double> price;
+    std::vector<float> qty;
+
+    explicit buffers(std::size_t n) : id(n), price(n), qty(n)
+    {
+        for (std::size_t i = 0; i < n; ++i) {
+            id[i]    = static_cast<std::int64_t>(i);
+            price[i] = i * 0.25;
+            qty[i]   = static_cast<float>(i % 7);
+        }
+    }
+};
+
+// Notional of the rows of even id
+template <class V>
+double kernel(const V &v)
+{
+    const auto id = v.template data<0>();
+    const auto p  = v.template data<1>();
+    const auto q  = v.template data<2>();
+    double s      = 0;
+    for (std::size_t i = 0; i < v.size(); ++i)
+        s += id[i] % 2 ? 0 : p[i] * q[i];
+    return s;
+}
+
+void copy(bench::state &st)
+{
+    const buffers b{st.rows()};
+    st.measure(b.id.size(), [&] {
+        dori::vector<std::int64_t, double, float> v;
+        v.reserve(b.id.size());
+        for (std::size_t i = 0; i < b.id.size(); ++i)
+            v.push_back(b.id[i], b.price[i], b.qty[i]);
+        bench::do_not_optimize(kernel(v));
+    });
+}
+
+void view(bench::state &st)
+{
+    const buffers b{st.rows()};
+    st.measure(b.id.size(), [&] {
+        const dori::const_vector_view<std::int64_t, double, float> v{
+            b.id.size(), b.id.data(), b.price.data(), b.qty.data()};
+        bench::do_not_optimize(kernel(v));
+    });
+}
+
+[[maybe_unused]] const bool registered =
+    (bench::registrar{"vector_view/kernel/copy", copy},
+     bench::registrar{"vector_view/kernel/vector_view", view}, true);
+
+} // namespace
@@ -0,0 +1,47 @@
+//
+// Benchmarks growing a vector one row at a time with no size known up front:
+// a dori::vector that doubles its capacity, relocating every column each
+// time, against a dori::vm_vector that commits pages in place.
+//
+
+#include "harness.h"
+
+#include <dori/vector.h>
+#include <dori/vm_vector.h>
+
+#include <algorithm>
+#include <cstdint>
+
+namespace
+{
+
+#define BENCH_columns std::uint64_t, std::uint32_t, double, float
+
+void doubling(bench::state &st)
+{
+    st.measure(st.rows(), [&] {
+        dori::vector<BENCH_columns> v;
+        for (std::size_t i = 0; i < st.rows(); ++i) {
+            if (v.size() == v.capacity())
+                v.reserve(std::max<std::size_t>(8, v.capacity() * 2));
+            v.push_back(i, static_cast<std::uint32_t>(i), 0.5, 0.5f);
+        }
+        bench::do_not_optimize(v.data<0>());
+    });
+}
+
+void vm(bench::state &st)
+{
+    st.measure(st.rows(), [&] {
+        dori::vm_vector<BENCH_columns> v{std::size_t{1} << 32};
+        for (std::size_t i = 0; i < st.rows(); ++i)
+            v.push_back(i, static_cast<std::uint32_t>(i), 0.5, 0.5f);
+        bench::do_not_optimize(v.data<0>());
+    });
+}
+
+[[maybe_unused]] const bool registered =
+    (bench::registrar{"grow/doubling", doubling},
+     bench::registrar{"grow/vm_vector", vm}, true);
+
+} // namespace
@@ -0,0 +1,134 @@
+#pragma once
+
+//
+// Aggregates over the rows of a column, named as types for group_by() and
+// ring::aggregate(). detail::Agg<A, V> says how aggregate A starts from the
+// input of a row of V, adds another, and merges two partial values.
+//
+
+#include "detail/inline.h"
+#include "packed.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+
+namespace dori
+{
+
+//
+// Aggregates of group_by() and ring::aggregate(): the sum, least, or greatest
+// of column I of the rows, or their count. Sums of integers are 64-bit.
+//
+template <std::size_t I>
+struct sum {
+};
+template <std::size_t I>
+struct min {
+};
+template <std::size_t I>
+struct max {
+};
+struct count {
+};
+
+namespace detail
+{
+
+template <class V, std::size_t I>
+using Column_t =
+    std::tuple_element_t<I, typename std::remove_const_t<V>::value_type>;
+
+template <class T>
+using Sum_t = std::conditional_t<
+    std::is_integral_v<T>,
+    std::conditional_t<std::is_signed_v<T>, std::int64_t, std::uint64_t>,
+    decltype(T{} + T{})>;
+
+// Element i of a column, by value if packed
+template <class T>
+DORI_inline const T &Column_at(const T *p, std::size_t i) noexcept
+{
+    return p[i];
+}
+template <class T, std::size_t Bits, bool Const>
+DORI_inline T Column_at(packed_ptr<T, Bits, Const> p, std::size_t i) noexcept
+{
+    return static_cast<T>(p[i]);
+}
+
+// The column of an aggregate with no input
+struct No_input {
+};
+DORI_inline No_input Column_at(No_input, std::size_t) noexcept { return {}; }
+
+//
+// How aggregate A of vector V is started from and added an input, the element
+// of its column in a row, and how two are merged.
+//
+template <class A, class V>
+struct Agg;
+template <std::size_t I, class V>
+struct Agg<sum<I>, V> {
+    using input = Column_t<V, I>;
+    using type  = Sum_t<input>;
+    static DORI_inline auto Column(const V &v) noexcept
+    {
+        return v.template data<I>();
+    }
+    static DORI_inline type First(const input &x)
+    {
+        return static_cast<type>(x);
+    }
+    static DORI_inline void Add(type &acc, const input &x)
+    {
+        acc += static_cast<type>(x);
+    }
+    static DORI_inline void Merge(type &acc, const type &x) { acc += x; }
+};
+template <std::size_t I, class V>
+struct Agg<min<I>, V> {
+    using input = Column_t<V, I>;
+    using type  = input;
+    static DORI_inline auto Column(const V &v) noexcept
+    {
+        return v.template data<I>();
+    }
+    static DORI_inline type First(const input &x) { return x; }
+    static DORI_inline void Add(type &acc, const input &x) { Merge(acc, x); }
+    static DORI_inline void Merge(type &acc, const type &x)
+    {
+        if (x < acc)
+            acc = x;
+    }
+};
+template <std::size_t I, class V>
+struct Agg<max<I>, V> {
+    using input = Column_t<V, I>;
+    using type  = input;
+    static DORI_inline auto Column(const V &v) noexcept
+    {
+        return v.template data<I>();
+    }
+    static DORI_inline type First(const input &x) { return x; }
+    static DORI_inline void Add(type &acc, const input &x) { Merge(acc, x); }
+    static DORI_inline void Merge(type &acc, const type &x)
+    {
+        if (acc < x)
+            acc = x;
+    }
+};
+template <class V>
+struct Agg<count, V> {
+    using input = No_input;
+    using type  = std::size_t;
+    static DORI_inline No_input Column(const V &) noexcept { return {}; }
+    static DORI_inline type First(No_input) noexcept { return 1; }
+    static DORI_inline void Add(type &acc, No_input) noexcept { ++acc; }
+    static DORI_inline void Merge(type &acc, type x) noexcept { acc += x; }
+};
+
+} // namespace detail
+
+} // namespace dori
@@ -1,3 +1,25 @@
 #pragma once
 
-#include "vector.h"
\ No newline at end of file
+#include "aos.h"
+#include "arrow.h"
+#include "channel.h"
+#include "columns.h"
+#include "cow_vector.h"
+#include "flat_hash_map.h"
+#include "group_by.h"
+#include "ingest.h"
+#include "nullable.h"
+#include "packed.h"
+#include "partition.h"
+#include "parallel.h"
+#include "query.h"
+#include "ring.h"
+#include "small_vector.h"
+#include "static_vector.h"
+#include "tracked_vector.h"
+#include "variant_column.h"
+#include "vector.h"
+#include "vector_view.h"
+#if __has_include(<sys/mman.h>)
+#include "vm_vector.h"
+#endif
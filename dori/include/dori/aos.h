@@ -0,0 +1,452 @@
+#pragma once
+
+//
+// Bulk conversion between arrays of structs and the columns of a vector. The
+// members named go to, or come from, the declared columns in order:
+//
+//   struct tick { std::int32_t id; float px; float qty; std::uint32_t ts; };
+//   dori::vector<std::int32_t, float, float, std::uint32_t> v;
+//   dori::append_from_aos(v, std::span{ticks}, &tick::id, &tick::px,
+//                         &tick::qty, &tick::ts);
+//   dori::export_to_aos(v, std::span{out}, &tick::id, &tick::px, &tick::qty,
+//                       &tick::ts);
+//
+// When the members tile the struct as fields of 4 or 8 bytes of the types of
+// the columns, in any order, rows are transposed with SSE2 shuffles. Rows of
+// 4-byte fields go 4 at a time, as 4x4 blocks of fields and then a pair and a
+// single field left over, except that 3 fields are shuffled out of the 3
+// vectors that 4 rows fill. Rows of 8-byte fields go 2 at a time, as 2x2
+// blocks and a single field left over.
+// Otherwise rows are appended in blocks that stay in L1 while each of their
+// members is copied out to its column, and exported a struct at a time. Rows
+// are written in place past the end of the vector unless a column isn't
+// trivially copyable, in which case they are pushed back one by one.
+//
+
+#include "detail/assert.h"
+#include "detail/inline.h"
+#include "packed.h"
+#include "vector.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace dori
+{
+
+namespace detail
+{
+
+// Rows per block of the appending of structs that aren't tiled
+inline constexpr std::size_t Aos_block = 256;
+
+template <class S, class M>
+DORI_inline std::size_t Member_offset(const S &s, M S::*m) noexcept
+{
+    const auto p = reinterpret_cast<const std::byte *>(&s);
+    return static_cast<std::size_t>(
+        reinterpret_cast<const std::byte *>(&(s.*m)) - p);
+}
+
+template <class M>
+struct Member;
+template <class S, class M>
+struct Member<M S::*> {
+    using type = std::remove_cv_t<M>;
+};
+template <class M>
+using Member_t = typename Member<M>::type;
+
+//
+// Whether structs S may be transposed by Aos_transpose to columns of pointer
+// types Ps from members Ms, given that the members tile the struct
+//
+template <class S, class Ps, class Ms>
+inline constexpr bool Aos_tiles = false;
+template <class S, class... Ps, class... Ms>
+inline constexpr bool Aos_tiles<S, mp_list<Ps...>, mp_list<Ms...>> = [] {
+    constexpr auto K = sizeof...(Ms);
+    constexpr auto W = sizeof(S) / K;
+    return (... && std::is_pointer_v<Ps>) &&
+           (... && std::is_same_v<std::remove_cv_t<std::remove_pointer_t<Ps>>,
+                                  Member_t<Ms>>) &&
+           (... && std::is_trivially_copyable_v<Member_t<Ms>>) &&
+           (... && (sizeof(Member_t<Ms>) == W)) && sizeof(S) == W * K &&
+           (W == 4 || W == 8);
+}();
+
+// Orders columns ps by the offsets offs of their members into lanes, if the
+// members tile rows of K fields of W bytes
+template <std::size_t W, std::size_t K, class B>
+DORI_inline bool Aos_lanes(const std::array<std::size_t, K> &offs,
+                           const std::array<B *, K> &ps,
+                           std::array<B *, K> &lanes) noexcept
+{
+    lanes = {};
+    for (std::size_t j = 0; j < K; ++j) {
+        const auto l = offs[j] / W;
+        if (offs[j] % W || l >= K || lanes[l])
+            return false;
+        lanes[l] = ps[j];
+    }
+    return true;
+}
+
+#ifdef __SSE2__
+DORI_inline void Transpose_4x4(__m128i &a, __m128i &b, __m128i &c,
+                               __m128i &d) noexcept
+{
+    const auto ab0 = _mm_unpacklo_epi32(a, b);
+    const auto ab1 = _mm_unpackhi_epi32(a, b);
+    const auto cd0 = _mm_unpacklo_epi32(c, d);
+    const auto cd1 = _mm_unpackhi_epi32(c, d);
+    a              = _mm_unpacklo_epi64(ab0, cd0);
+    b              = _mm_unpackhi_epi64(ab0, cd0);
+    c              = _mm_unpacklo_epi64(ab1, cd1);
+    d              = _mm_unpackhi_epi64(ab1, cd1);
+}
+
+DORI_inline __m128i Load(const std::byte *p) noexcept
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+}
+DORI_inline void Store(std::byte *p, __m128i x) noexcept
+{
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(p), x);
+}
+// The low 8 or 4 bytes of a vector
+DORI_inline __m128i Load_8(const std::byte *p) noexcept
+{
+    return _mm_loadl_epi64(reinterpret_cast<const __m128i *>(p));
+}
+DORI_inline void Store_8(std::byte *p, __m128i x) noexcept
+{
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(p), x);
+}
+DORI_inline __m128i Load_4(const std::byte *p) noexcept
+{
+    std::int32_t x;
+    std::memcpy(&x, p, 4);
+    return _mm_cvtsi32_si128(x);
+}
+DORI_inline void Store_4(std::byte *p, __m128i x) noexcept
+{
+    const auto y = _mm_cvtsi128_si32(x);
+    std::memcpy(p, &y, 4);
+}
+
+// _mm_shuffle_ps of integer vectors: the low lanes from a, the high from b
+template <int Imm>
+DORI_inline __m128i Shuffle(__m128i a, __m128i b) noexcept
+{
+    return _mm_castps_si128(
+        _mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), Imm));
+}
+#endif
+
+//
+// Transposes n rows of K fields of W bytes at rows into the columns of the
+// fields, cols[l] being that of field l
+//
+template <std::size_t W, std::size_t K>
+void Aos_transpose(const std::byte *rows, std::size_t n,
+                   const std::array<std::byte *, K> &cols) noexcept
+{
+    constexpr auto R = W * K; // Bytes per row
+    std::size_t i    = 0;
+#ifdef __SSE2__
+    if constexpr (W == 4 && K == 3)
+        // 4 rows are 3 vectors: x0 y0 z0 x1, y1 z1 x2 y2, z2 x3 y3 z3
+        for (; i + 4 <= n; i += 4) {
+            const auto p = rows + i * R;
+            const auto a = Load(p), b = Load(p + 16), c = Load(p + 32);
+            Store(cols[0] + i * W,
+                  Shuffle<_MM_SHUFFLE(2, 0, 3, 0)>(
+                      a, Shuffle<_MM_SHUFFLE(1, 1, 2, 2)>(b, c)));
+            Store(cols[1] + i * W,
+                  Shuffle<_MM_SHUFFLE(2, 0, 2, 0)>(
+                      Shuffle<_MM_SHUFFLE(0, 0, 1, 1)>(a, b),
+                      Shuffle<_MM_SHUFFLE(2, 2, 3, 3)>(b, c)));
+            Store(cols[2] + i * W,
+                  Shuffle<_MM_SHUFFLE(2, 0, 2, 0)>(
+                      Shuffle<_MM_SHUFFLE(1, 1, 2, 2)>(a, b),
+                      Shuffle<_MM_SHUFFLE(3, 3, 0, 0)>(c, c)));
+        }
+    else if constexpr (W == 4)
+        // Blocks of 4 fields, then a pair and a single field left over
+        for (; i + 4 <= n; i += 4) {
+            constexpr auto G = K / 4 * 4;
+            const auto p     = rows + i * R;
+            for (std::size_t g = 0; g < G; g += 4) {
+                auto a = Load(p + g * W), b = Load(p + R + g * W),
+                     c = Load(p + 2 * R + g * W), d = Load(p + 3 * R + g * W);
+                Transpose_4x4(a, b, c, d);
+                Store(cols[g] + i * W, a);
+                Store(cols[g + 1] + i * W, b);
+                Store(cols[g + 2] + i * W, c);
+                Store(cols[g + 3] + i * W, d);
+            }
+            if constexpr (K % 4 >= 2) {
+                const auto q = p + G * W;
+                const auto a = K == 2 ? Load(q)
+                                      : _mm_unpacklo_epi64(Load_8(q),
+                                                           Load_8(q + R));
+                const auto b = K == 2 ? Load(q + 16)
+                                      : _mm_unpacklo_epi64(Load_8(q + 2 * R),
+                                                           Load_8(q + 3 * R));
+                Store(cols[G] + i * W, Shuffle<_MM_SHUFFLE(2, 0, 2, 0)>(a, b));
+                Store(cols[G + 1] + i * W,
+                      Shuffle<_MM_SHUFFLE(3, 1, 3, 1)>(a, b));
+            }
+            if constexpr (K % 2) {
+                const auto q = p + (K - 1) * W;
+                Store(cols[K - 1] + i * W,
+                      _mm_unpacklo_epi64(
+                          _mm_unpacklo_epi32(Load_4(q), Load_4(q + R)),
+                          _mm_unpacklo_epi32(Load_4(q + 2 * R),
+                                             Load_4(q + 3 * R))));
+            }
+        }
+    else
+        // Blocks of 2 fields, then a single field left over
+        for (; i + 2 <= n; i += 2) {
+            const auto p = rows + i * R;
+            for (std::size_t g = 0; g + 2 <= K; g += 2) {
+                const auto a = Load(p + g * W), b = Load(p + R + g * W);
+                Store(cols[g] + i * W, _mm_unpacklo_epi64(a, b));
+                Store(cols[g + 1] + i * W, _mm_unpackhi_epi64(a, b));
+            }
+            if constexpr (K % 2) {
+                const auto q = p + (K - 1) * W;
+                Store(cols[K - 1] + i * W,
+                      _mm_unpacklo_epi64(Load_8(q), Load_8(q + R)));
+            }
+        }
+#endif
+    for (; i < n; ++i)
+        for (std::size_t l = 0; l < K; ++l)
+            std::memcpy(cols[l] + i * W, rows + i * R + l * W, W);
+}
+
+// The inverse of Aos_transpose
+template <std::size_t W, std::size_t K>
+void Soa_transpose(const std::array<const std::byte *, K> &cols,
+                   std::size_t n, std::byte *rows) noexcept
+{
+    constexpr auto R = W * K;
+    std::size_t i    = 0;
+#ifdef __SSE2__
+    if constexpr (W == 4 && K == 3)
+        for (; i + 4 <= n; i += 4) {
+            const auto x = Load(cols[0] + i * W), y = Load(cols[1] + i * W),
+                       z = Load(cols[2] + i * W);
+            const auto p = rows + i * R;
+            Store(p, Shuffle<_MM_SHUFFLE(2, 0, 2, 0)>(
+                         Shuffle<_MM_SHUFFLE(0, 0, 0, 0)>(x, y),
+                         Shuffle<_MM_SHUFFLE(1, 1, 0, 0)>(z, x)));
+            Store(p + 16, Shuffle<_MM_SHUFFLE(2, 0, 2, 0)>(
+                              Shuffle<_MM_SHUFFLE(1, 1, 1, 1)>(y, z),
+                              Shuffle<_MM_SHUFFLE(2, 2, 2, 2)>(x, y)));
+            Store(p + 32, Shuffle<_MM_SHUFFLE(2, 0, 2, 0)>(
+                              Shuffle<_MM_SHUFFLE(3, 3, 2, 2)>(z, x),
+                              Shuffle<_MM_SHUFFLE(3, 3, 3, 3)>(y, z)));
+        }
+    else if constexpr (W == 4)
+        for (; i + 4 <= n; i += 4) {
+            constexpr auto G = K / 4 * 4;
+            const auto p     = rows + i * R;
+            for (std::size_t g = 0; g < G; g += 4) {
+                auto a = Load(cols[g] + i * W), b = Load(cols[g + 1] + i * W),
+                     c = Load(cols[g + 2] + i * W),
+                     d = Load(cols[g + 3] + i * W);
+                Transpose_4x4(a, b, c, d);
+                Store(p + g * W, a);
+                Store(p + R + g * W, b);
+                Store(p + 2 * R + g * W, c);
+                Store(p + 3 * R + g * W, d);
+            }
+            if constexpr (K % 4 >= 2) {
+                const auto x = Load(cols[G] + i * W),
+                           y = Load(cols[G + 1] + i * W);
+                const auto lo = _mm_unpacklo_epi32(x, y),
+                           hi = _mm_unpackhi_epi32(x, y);
+                const auto q  = p + G * W;
+                if constexpr (K == 2) {
+                    Store(q, lo);
+                    Store(q + 16, hi);
+                } else {
+                    Store_8(q, lo);
+                    Store_8(q + R, _mm_unpackhi_epi64(lo, lo));
+                    Store_8(q + 2 * R, hi);
+                    Store_8(q + 3 * R, _mm_unpackhi_epi64(hi, hi));
+                }
+            }
+            if constexpr (K % 2) {
+                const auto x = Load(cols[K - 1] + i * W);
+                const auto q = p + (K - 1) * W;
+                Store_4(q, x);
+                Store_4(q + R, _mm_srli_si128(x, 4));
+                Store_4(q + 2 * R, _mm_srli_si128(x, 8));
+                Store_4(q + 3 * R, _mm_srli_si128(x, 12));
+            }
+        }
+    else
+        for (; i + 2 <= n; i += 2) {
+            const auto p = rows + i * R;
+            for (std::size_t g = 0; g + 2 <= K; g += 2) {
+                const auto x = Load(cols[g] + i * W),
+                           y = Load(cols[g + 1] + i * W);
+                Store(p + g * W, _mm_unpacklo_epi64(x, y));
+                Store(p + R + g * W, _mm_unpackhi_epi64(x, y));
+            }
+            if constexpr (K % 2) {
+                const auto x = Load(cols[K - 1] + i * W);
+                const auto q = p + (K - 1) * W;
+                Store_8(q, x);
+                Store_8(q + R, _mm_unpackhi_epi64(x, x));
+            }
+        }
+#endif
+    for (; i < n; ++i)
+        for (std::size_t l = 0; l < K; ++l)
+            std::memcpy(rows + i * R + l * W, cols[l] + i * W, W);
+}
+
+struct Bulk_ops {
+    template <class Al, class Ts, class TsSrt, auto Offsets, auto Redir,
+              std::size_t... Is>
+    static constexpr DORI_inline auto &
+    Impl(vector_impl<Al, Ts, TsSrt, Offsets, Redir, Is...> &v) noexcept
+    {
+        return v;
+    }
+
+    //
+    // Appends n rows to v by writing them past its end with f(ps...), ps
+    // being the columns there. Columns are trivially copyable or packed.
+    //
+    template <class V, class F, std::size_t... Is>
+    static void Append(V &v, std::size_t n, F f, std::index_sequence<Is...>)
+    {
+        auto &s = Impl(v);
+        Grow(v, n);
+        f((s.template data<Is>() + s.sz_)...);
+        s.sz_ += n;
+    }
+
+    // Makes room for n more rows in v, at least doubling its capacity
+    template <class V>
+    static DORI_inline void Grow(V &v, std::size_t n)
+    {
+        if (v.size() + n > v.capacity())
+            v.reserve(std::max(v.size() + n, 2 * v.capacity()));
+    }
+};
+
+} // namespace detail
+
+//
+// Appends rows made of members ms of each struct of rows to v, member I going
+// to declared column I, at least doubling the capacity of v if it's short
+//
+template <class V, class S, std::size_t E, class... Ms>
+requires(sizeof...(Ms) == std::tuple_size_v<typename V::value_type> &&
+         (... && std::is_member_object_pointer_v<Ms>)) //
+    void append_from_aos(V &v, std::span<S, E> rows, Ms... ms)
+{
+    if (rows.empty())
+        return;
+    const auto n = rows.size();
+    using Js     = std::index_sequence_for<Ms...>;
+    [&]<std::size_t... Is>(std::index_sequence<Is...>)
+    {
+        using Cols = detail::mp_list<decltype(v.template data<Is>())...>;
+        constexpr bool In_place =
+            (... && std::is_trivially_copyable_v<
+                        std::tuple_element_t<Is, typename V::value_type>>);
+        if constexpr (!In_place) {
+            detail::Bulk_ops::Grow(v, n);
+            for (const auto &r : rows)
+                v.push_back(r.*ms...);
+        } else
+            detail::Bulk_ops::Append(
+                v, n,
+                [&](auto... ps) {
+                    if constexpr (detail::Aos_tiles<
+                                      std::remove_cv_t<S>, Cols,
+                                      detail::mp_list<Ms...>>) {
+                        constexpr auto K = sizeof...(Ms);
+                        constexpr auto W = sizeof(S) / K;
+                        std::array<std::byte *, K> lanes;
+                        if (detail::Aos_lanes<W, K>(
+                                {detail::Member_offset(rows[0], ms)...},
+                                {reinterpret_cast<std::byte *>(ps)...},
+                                lanes))
+                            return detail::Aos_transpose<W, K>(
+                                reinterpret_cast<const std::byte *>(
+                                    rows.data()),
+                                n, lanes);
+                    }
+                    for (std::size_t b = 0; b < n; b += detail::Aos_block) {
+                        const auto e = std::min(n, b + detail::Aos_block);
+                        (..., [&] {
+                            for (auto i = b; i < e; ++i)
+                                ps[i] = rows[i].*ms;
+                        }());
+                    }
+                },
+                Js{});
+    }
+    (Js{});
+}
+
+//
+// Assigns members ms of each of the first v.size() structs of out from the
+// rows of v, a vector or a view, member I coming from declared column I
+//
+template <class V, class S, std::size_t E, class... Ms>
+requires(!std::is_const_v<S> &&
+         sizeof...(Ms) == std::tuple_size_v<typename V::value_type> &&
+         (... && std::is_member_object_pointer_v<Ms>)) //
+    void export_to_aos(const V &v, std::span<S, E> out, Ms... ms)
+{
+    DORI_assert(out.size() >= v.size());
+    if (v.empty())
+        return;
+    const auto n = v.size();
+    [&]<std::size_t... Is>(std::index_sequence<Is...>)
+    {
+        using Cols = detail::mp_list<decltype(v.template data<Is>())...>;
+        if constexpr (detail::Aos_tiles<S, Cols, detail::mp_list<Ms...>>) {
+            constexpr auto K = sizeof...(Ms);
+            constexpr auto W = sizeof(S) / K;
+            std::array<const std::byte *, K> lanes;
+            if (detail::Aos_lanes<W, K>(
+                    {detail::Member_offset(out[0], ms)...},
+                    {reinterpret_cast<const std::byte *>(
+                        v.template data<Is>())...},
+                    lanes))
+                return detail::Soa_transpose<W, K>(
+                    lanes, n, reinterpret_cast<std::byte *>(out.data()));
+        }
+        const auto o = out.data();
+        [&](const auto... ps) {
+            for (std::size_t i = 0; i < n; ++i)
+                (..., (o[i].*ms = ps[i]));
+        }(v.template data<Is>()...);
+    }
+    (std::index_sequence_for<Ms...>{});
+}
+
+} // namespace dori
@@ -0,0 +1,325 @@
+#pragma once
+
+//
+// Export to and import from the Arrow C data interface without copying rows.
+// A vector is exported as a struct array with a child array per column, the
+// data buffer of which is data<I>() of the vector:
+//
+//   ArrowArray a;
+//   ArrowSchema s;
+//   dori::export_arrow(std::move(v), &a, &s, {"id", "price", "flag"});
+//   consume(&a, &s); // calls a.release() and s.release() when done
+//
+// The vector is moved into storage shared by the array and its children, so
+// that a consumer may move a child out and release it on its own.
+//
+// A struct array of compatible columns, exported by Arrow or anyone else, is
+// imported as a const_vector_view of its buffers, valid until it's released:
+//
+//   auto view = dori::import_arrow<std::int64_t, double, dori::bit>(a, s);
+//
+// Columns may be integers, float, double, or dori::bit, which is laid out
+// as the bitmap of an Arrow boolean. Columns with nulls aren't imported.
+// Bitmaps are read a 64-bit word at a time, as dori::bit columns are; Arrow
+// pads its buffers to at least that.
+//
+
+#include "detail/assert.h"
+#include "detail/inline.h"
+#include "packed.h"
+#include "vector.h"
+#include "vector_view.h"
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// The ABI of the Arrow C data interface, as given in its specification
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+    // Array type description
+    const char *format;
+    const char *name;
+    const char *metadata;
+    int64_t flags;
+    int64_t n_children;
+    struct ArrowSchema **children;
+    struct ArrowSchema *dictionary;
+
+    // Release callback
+    void (*release)(struct ArrowSchema *);
+    // Opaque producer-specific data
+    void *private_data;
+};
+
+struct ArrowArray {
+    // Array data description
+    int64_t length;
+    int64_t null_count;
+    int64_t offset;
+    int64_t n_buffers;
+    int64_t n_children;
+    const void **buffers;
+    struct ArrowArray **children;
+    struct ArrowArray *dictionary;
+
+    // Release callback
+    void (*release)(struct ArrowArray *);
+    // Opaque producer-specific data
+    void *private_data;
+};
+
+#endif // ARROW_C_DATA_INTERFACE
+
+namespace dori
+{
+
+namespace detail
+{
+
+static_assert(std::endian::native == std::endian::little,
+              "dori::bit columns are laid out as Arrow bitmaps only on "
+              "little-endian targets");
+
+// Arrow format string of a column
+template <class T>
+inline constexpr const char *Arrow_format = nullptr;
+template <>
+inline constexpr const char *Arrow_format<bit> = "b";
+template <>
+inline constexpr const char *Arrow_format<std::int8_t> = "c";
+template <>
+inline constexpr const char *Arrow_format<std::uint8_t> = "C";
+template <>
+inline constexpr const char *Arrow_format<std::int16_t> = "s";
+template <>
+inline constexpr const char *Arrow_format<std::uint16_t> = "S";
+template <>
+inline constexpr const char *Arrow_format<std::int32_t> = "i";
+template <>
+inline constexpr const char *Arrow_format<std::uint32_t> = "I";
+template <>
+inline constexpr const char *Arrow_format<std::int64_t> = "l";
+template <>
+inline constexpr const char *Arrow_format<std::uint64_t> = "L";
+template <>
+inline constexpr const char *Arrow_format<float> = "f";
+template <>
+inline constexpr const char *Arrow_format<double> = "g";
+
+template <class T>
+inline constexpr bool Arrow_compatible = Arrow_format<T> != nullptr;
+
+// Declared columns of a vector
+template <class Al, class... Ts, class TsSrt, auto Offsets, auto Redir,
+          std::size_t... Is>
+mp_list<Ts...>
+Arrow_columns(const vector_impl<Al, mp_list<Ts...>, TsSrt, Offsets, Redir,
+                                Is...> &);
+
+// Address of the buffer of a column of a vector, and the row it starts at
+template <class T>
+DORI_inline std::pair<const void *, std::int64_t> Arrow_buffer(T *p) noexcept
+{
+    return {p, 0};
+}
+template <class T, std::size_t Bits, bool Const>
+DORI_inline std::pair<const void *, std::int64_t>
+Arrow_buffer(packed_ptr<T, Bits, Const> p) noexcept
+{
+    return {p.words(), p.index()};
+}
+
+//
+// What an exported array keeps alive: the vector, shared between the array
+// and its children, and the buffers and children of the array
+//
+struct Arrow_array_data {
+    std::shared_ptr<const void> rows;
+    std::array<const void *, 2> buffers{};
+    std::vector<ArrowArray> children;
+    std::vector<ArrowArray *> child_ptrs;
+
+    static void Release(ArrowArray *a) noexcept
+    {
+        const auto d = static_cast<Arrow_array_data *>(a->private_data);
+        for (auto &c : d->children)
+            if (c.release)
+                c.release(&c);
+        delete d;
+        a->release = nullptr;
+    }
+};
+
+struct Arrow_schema_data {
+    std::string name;
+    std::vector<ArrowSchema> children;
+    std::vector<ArrowSchema *> child_ptrs;
+
+    static void Release(ArrowSchema *s) noexcept
+    {
+        const auto d = static_cast<Arrow_schema_data *>(s->private_data);
+        for (auto &c : d->children)
+            if (c.release)
+                c.release(&c);
+        delete d;
+        s->release = nullptr;
+    }
+};
+
+inline ArrowArray Arrow_array(std::unique_ptr<Arrow_array_data> d,
+                              std::int64_t length, std::int64_t offset,
+                              std::int64_t n_buffers)
+{
+    ArrowArray a{};
+    a.length       = length;
+    a.offset       = offset;
+    a.n_buffers    = n_buffers;
+    a.n_children   = static_cast<std::int64_t>(d->child_ptrs.size());
+    a.buffers      = d->buffers.data();
+    a.children     = d->child_ptrs.empty() ? nullptr : d->child_ptrs.data();
+    a.release      = &Arrow_array_data::Release;
+    a.private_data = d.release();
+    return a;
+}
+
+inline ArrowSchema Arrow_schema(std::unique_ptr<Arrow_schema_data> d,
+                                const char *format)
+{
+    ArrowSchema s{};
+    s.format       = format;
+    s.name         = d->name.c_str();
+    s.n_children   = static_cast<std::int64_t>(d->child_ptrs.size());
+    s.children     = d->child_ptrs.empty() ? nullptr : d->child_ptrs.data();
+    s.release      = &Arrow_schema_data::Release;
+    s.private_data = d.release();
+    return s;
+}
+
+[[noreturn]] inline void Arrow_mismatch(const char *what)
+{
+    throw std::invalid_argument{std::string{"dori::import_arrow: "} + what};
+}
+
+// Column I of a struct array, checked against T
+template <class T>
+Cptr_t<T> Arrow_column(const ArrowArray &a, const ArrowSchema &s,
+                       std::int64_t offset, std::int64_t length)
+{
+    if (std::string_view{s.format} != Arrow_format<T>)
+        Arrow_mismatch("column of another type");
+    if (a.n_buffers != 2 || a.length < offset + length)
+        Arrow_mismatch("malformed column");
+    if (a.null_count != 0 && a.buffers[0])
+        Arrow_mismatch("column with nulls");
+    const auto i = a.offset + offset;
+    if constexpr (Is_packed<T>) {
+        // The word holding the first byte, and the row there
+        const auto p = reinterpret_cast<std::uintptr_t>(a.buffers[1]);
+        const auto w = p & ~std::uintptr_t{7};
+        return {reinterpret_cast<const std::uint64_t *>(w),
+                static_cast<std::ptrdiff_t>((p - w) * 8) + i};
+    } else
+        return static_cast<const T *>(a.buffers[1]) + i;
+}
+
+} // namespace detail
+
+//
+// Exports the rows of v into array and schema, as a struct array of a child
+// per column named names[I], or I if there are fewer names
+//
+template <class V>
+requires(!std::is_lvalue_reference_v<V>) //
+    void export_arrow(V &&v, ArrowArray *array, ArrowSchema *schema,
+                      std::initializer_list<std::string_view> names = {})
+{
+    using Vec = std::remove_cvref_t<V>;
+    using Cols = decltype(detail::Arrow_columns(std::declval<const Vec &>()));
+    [&]<class... Cs, std::size_t... Is>(detail::mp_list<Cs...> *,
+                                        std::index_sequence<Is...>)
+    {
+        static_assert((... && detail::Arrow_compatible<Cs>),
+                      "columns must be integers, float, double, or dori::bit");
+
+        const auto rows = std::make_shared<const Vec>(std::move(v));
+        const auto n = static_cast<std::int64_t>(rows->size());
+
+        auto sd = std::make_unique<detail::Arrow_schema_data>();
+        auto ad = std::make_unique<detail::Arrow_array_data>();
+        sd->children.reserve(sizeof...(Is));
+        ad->children.reserve(sizeof...(Is));
+        (..., [&] {
+            auto csd = std::make_unique<detail::Arrow_schema_data>();
+            csd->name = Is < names.size()
+                            ? std::string{names.begin()[Is]}
+                            : std::to_string(Is);
+            sd->children.push_back(
+                detail::Arrow_schema(std::move(csd), detail::Arrow_format<Cs>));
+
+            auto cad  = std::make_unique<detail::Arrow_array_data>();
+            cad->rows = rows;
+            const auto [p, off] =
+                n ? detail::Arrow_buffer(rows->template data<Is>())
+                  : std::pair<const void *, std::int64_t>{nullptr, 0};
+            cad->buffers = {nullptr, p};
+            ad->children.push_back(
+                detail::Arrow_array(std::move(cad), n, off, 2));
+        }());
+        for (auto &c : sd->children)
+            sd->child_ptrs.push_back(&c);
+        for (auto &c : ad->children)
+            ad->child_ptrs.push_back(&c);
+        ad->rows = rows;
+
+        *schema = detail::Arrow_schema(std::move(sd), "+s");
+        *array  = detail::Arrow_array(std::move(ad), n, 0, 1);
+    }
+    (static_cast<Cols *>(nullptr),
+     std::make_index_sequence<boost::mp11::mp_size<Cols>::value>{});
+}
+
+//
+// Views the columns of struct array a of schema s as Ts, throwing
+// std::invalid_argument if they don't match
+//
+template <class... Ts>
+const_vector_view<Ts...> import_arrow(const ArrowArray &a,
+                                      const ArrowSchema &s)
+{
+    static_assert((... && detail::Arrow_compatible<Ts>),
+                  "columns must be integers, float, double, or dori::bit");
+    if (!a.release || !s.release)
+        detail::Arrow_mismatch("released array");
+    if (std::string_view{s.format} != "+s")
+        detail::Arrow_mismatch("not a struct array");
+    if (s.n_children != sizeof...(Ts) || a.n_children != sizeof...(Ts))
+        detail::Arrow_mismatch("wrong number of columns");
+    if (a.null_count != 0 && a.n_buffers && a.buffers[0])
+        detail::Arrow_mismatch("struct with nulls");
+    return [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+        return const_vector_view<Ts...>{
+            static_cast<std::size_t>(a.length),
+            detail::Arrow_column<Ts>(*a.children[Is], *s.children[Is],
+                                     a.offset, a.length)...};
+    }(std::index_sequence_for<Ts...>{});
+}
+
+} // namespace dori
@@ -0,0 +1,165 @@
+#pragma once
+
+//
+// A bounded channel of batches of rows between threads. Each slot of the
+// channel holds a vector: send() swaps the batch of the caller with the one
+// in a free slot and receive() swaps the batch in a full slot with that of
+// the caller, so handing off a batch costs a swap of the pointers of the
+// vectors whatever its rows. The batch the consumer passes to receive() is
+// cleared, keeping its capacity, and left in the slot for the next producer
+// to fill, so batches are recycled instead of reallocated once the channel
+// has gone around:
+//
+//   dori::channel<dori::vector<int, float>> ch{8};
+//   // producer                      // consumer
+//   dori::vector<int, float> b;      dori::vector<int, float> b;
+//   fill(b);                         while (ch.receive(b))
+//   ch.send(b); // b is recycled         use(b);
+//   ch.close();
+//
+// The slots are those of a bounded queue in the manner of D. Vyukov: a slot
+// holds a sequence number that tells its lap and whether it's full, so that a
+// producer and the consumer only contend on the slot they both touch. With
+// producers::many, producers claim slots by CAS. There's one consumer.
+//
+
+#include "detail/assert.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace dori
+{
+
+enum class producers { one, many };
+
+template <class V, producers P = producers::one>
+class channel
+{
+    struct alignas(cache_line) Slot {
+        // Full with the batch of lap pos / n_ when pos + 1, free for it when
+        // pos
+        std::atomic<std::size_t> seq;
+        bool last = false;
+        V v;
+    };
+
+  public:
+    using value_type = V;
+    using size_type  = std::size_t;
+
+    // A channel of slots rounded up to a power of two
+    explicit channel(size_type slots)
+        : n_{std::bit_ceil(std::max(slots, size_type{1}))},
+          slots_{std::make_unique<Slot[]>(n_)}
+    {
+        for (size_type i = 0; i < n_; ++i)
+            slots_[i].seq.store(i, std::memory_order_relaxed);
+    }
+    channel(const channel &)            = delete;
+    channel &operator=(const channel &) = delete;
+
+    size_type capacity() const noexcept { return n_; }
+
+    //
+    // Sends batch, waiting for a free slot, and leaves batch with an empty
+    // batch of the consumer's to fill
+    //
+    void send(V &batch) { Send<true>(batch, false); }
+    // Sends batch if there's a free slot
+    bool try_send(V &batch) { return Send<false>(batch, false); }
+
+    //
+    // Sends the end of the batches, after which there are no more sends;
+    // receive() returns false once it's received the batches before it
+    //
+    void close()
+    {
+        V none;
+        Send<true>(none, true);
+    }
+
+    //
+    // Receives a batch into batch, clearing the batch that was there for a
+    // producer to reuse, and waiting for one to be sent. Returns false
+    // instead if the channel's been closed and there are no more batches.
+    // Only one thread may receive.
+    //
+    bool receive(V &batch) { return Receive<true>(batch); }
+    // Receives a batch if one's been sent
+    bool try_receive(V &batch) { return Receive<false>(batch); }
+
+  private:
+    template <bool Wait>
+    bool Send(V &batch, bool last)
+    {
+        auto pos = tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            auto &s        = slots_[pos & (n_ - 1)];
+            const auto seq = s.seq.load(std::memory_order_acquire);
+            const auto d   = static_cast<std::ptrdiff_t>(seq - pos);
+            if (d == 0) {
+                if constexpr (P == producers::many) {
+                    if (!tail_.compare_exchange_weak(
+                            pos, pos + 1, std::memory_order_relaxed))
+                        continue;
+                } else
+                    tail_.store(pos + 1, std::memory_order_relaxed);
+                using std::swap;
+                swap(s.v, batch);
+                s.last = last;
+                s.seq.store(pos + 1, std::memory_order_release);
+                // Producers a lap ahead may wait on the slot along with the
+                // consumer, and waking only one of them could miss it
+                if constexpr (P == producers::many)
+                    s.seq.notify_all();
+                else
+                    s.seq.notify_one();
+                return true;
+            }
+            if (d < 0) {
+                // Full, with the batch of the lap before
+                if constexpr (!Wait)
+                    return false;
+                s.seq.wait(seq, std::memory_order_acquire);
+            }
+            pos = tail_.load(std::memory_order_relaxed);
+        }
+    }
+
+    template <bool Wait>
+    bool Receive(V &batch)
+    {
+        auto &s  = slots_[head_ & (n_ - 1)];
+        auto seq = s.seq.load(std::memory_order_acquire);
+        while (seq != head_ + 1) {
+            if constexpr (!Wait)
+                return false;
+            s.seq.wait(seq, std::memory_order_acquire);
+            seq = s.seq.load(std::memory_order_acquire);
+        }
+        if (s.last)
+            return false;
+        batch.clear();
+        using std::swap;
+        swap(batch, s.v);
+        s.seq.store(head_ + n_, std::memory_order_release);
+        s.seq.notify_all();
+        ++head_;
+        return true;
+    }
+
+    size_type n_;
+    std::unique_ptr<Slot[]> slots_;
+    // Next slot to send to
+    alignas(cache_line) std::atomic<size_type> tail_{0};
+    // Next slot to receive from; the consumer's alone
+    alignas(cache_line) size_type head_ = 0;
+};
+
+} // namespace dori
@@ -0,0 +1,280 @@
+#pragma once
+
+//
+// Conversions that add or drop a column of a vector, consuming it:
+//
+//   auto w = dori::with_column<float>(std::move(v)); // vector<A, B, float>
+//   auto u = dori::without_column<0>(std::move(w));  // vector<B, float>
+//
+// The rows are moved into an allocation of the new layout of the same
+// capacity a column at a time: one memcpy() per column of trivially copyable
+// (or packed) elements, or two per nullable column, and a move per element
+// otherwise. No rows are built as tuples. The result keeps the allocator and
+// layout policy of the vector; a default allocator becomes the default one of
+// the new columns, and a column added under grouped<> gets a group of its own
+// after the others.
+//
+
+#include "vector.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace dori
+{
+
+namespace detail
+{
+
+template <class Layout>
+struct Layout_with {
+    using type = Layout;
+};
+template <std::size_t... Prios>
+struct Layout_with<layout::grouped<Prios...>> {
+    using type =
+        layout::grouped<Prios..., std::max({std::size_t{0}, Prios...}) + 1>;
+};
+
+template <class Layout, std::size_t I>
+struct Layout_without {
+    using type = Layout;
+};
+template <std::size_t... Prios, std::size_t I>
+struct Layout_without<layout::grouped<Prios...>, I> {
+    static constexpr std::array<std::size_t, sizeof...(Prios)> ps{Prios...};
+    template <std::size_t... Js>
+    static layout::grouped<ps[Js < I ? Js : Js + 1]...>
+        Drop(std::index_sequence<Js...>);
+    using type =
+        decltype(Drop(std::make_index_sequence<sizeof...(Prios) - 1>{}));
+};
+
+// Vector of columns Us with the layout and allocator of one of columns Ts
+template <class Layout, class Al, class Ts, class... Us>
+using Columns_result = typename With_layout<
+    Layout, vector_al<std::conditional_t<
+                          std::is_same_v<Al, Default_allocator<Ts>>,
+                          Default_allocator<mp_list<Us...>>, Al>,
+                      Us...>>::type;
+
+struct Column_ops {
+    static constexpr auto New = static_cast<std::size_t>(-1);
+
+    template <class Al, class Ts, class TsSrt, auto Offsets, auto Redir,
+              std::size_t... Is>
+    static constexpr DORI_inline auto &
+    Impl(vector_impl<Al, Ts, TsSrt, Offsets, Redir, Is...> &v) noexcept
+    {
+        return v;
+    }
+
+    //
+    // Builds a Dst whose declared column J is column Map[J] of src, or made of
+    // args if that is New. Column Drop of src, if any, is destroyed, and src
+    // is left empty.
+    //
+    template <class Dst, auto Map, std::size_t Drop, class Src,
+              class... Args>
+    static Dst Rebuild(Src &src, const Args &...args)
+    {
+        auto &s = Impl(src);
+        Dst res = [&] {
+            if constexpr (std::is_same_v<decltype(s.al_),
+                                         typename Dst::allocator_type>)
+                return Dst{s.al_};
+            else
+                return Dst{};
+        }();
+        if (s.cap_) {
+            Fill<Map>(Impl(res), s, args...);
+            if constexpr (Drop != New)
+                Destroy_n(s.al_, s.template data<Drop>(), s.sz_);
+            s.Deallocate(s.p_, s.cap_, s.sz_);
+            s.sz_  = 0;
+            s.cap_ = 0;
+        }
+        return res;
+    }
+
+  private:
+    template <auto Map, class Al, class... Ts, class... TsSrt, auto Offsets,
+              auto Redir, std::size_t... Is, class S, class... Args>
+    static void
+    Fill(vector_impl<Al, mp_list<Ts...>, mp_list<TsSrt...>, Offsets, Redir,
+                     Is...> &d,
+         S &s, const Args &...args)
+    {
+        static_assert(!(Is_varlen<Ts> || ...),
+                      "columns of vectors with varlen columns can't be added "
+                      "or dropped");
+        using D        = std::remove_reference_t<decltype(d)>;
+        const auto cap = D::Round_cap(s.cap_);
+        const auto p   = d.Allocate(cap);
+        // The new column goes first, as the others can't be moved back
+        constexpr auto New_at = [] {
+            std::size_t res = sizeof...(Ts);
+            (..., (res = Map[Unredir_of<D>(Is)] == New ? Is : res));
+            return res;
+        }();
+        if constexpr (New_at != sizeof...(Ts))
+            try {
+                Construct_n(d.al_, D::template Data_at<New_at>(p, cap),
+                            s.sz_, args...);
+            } catch (...) {
+                d.Deallocate(p, cap, 0);
+                throw;
+            }
+        (..., Relocate_column<Map[Unredir_of<D>(Is)]>(
+                  d.al_, s, D::template Data_at<Is>(p, cap)));
+        d.p_   = p;
+        d.sz_  = s.sz_;
+        d.cap_ = cap;
+    }
+
+    template <class D>
+    static constexpr std::size_t Unredir_of(std::size_t i) noexcept
+    {
+        return D::Storage_order[i];
+    }
+
+    template <std::size_t K, class A, class S, class P>
+    static DORI_inline void Relocate_column(A &al, S &s, P d) noexcept
+    {
+        if constexpr (K != New)
+            Relocate(al, s.al_, d, s.template data<K>(), s.sz_);
+    }
+
+    template <class A, class SA, class T>
+    static DORI_inline void Relocate(A &al, SA &s_al, T *d, T *s,
+                                     std::size_t n) noexcept
+    {
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            if (n)
+                std::memcpy(d, s, n * sizeof(T));
+        } else
+            for (const auto l = s + n; s != l; ++s, ++d) {
+                Call_maybe_unsafe(
+                    DORI_f_ref(std::allocator_traits<A>::construct), al, d,
+                    static_cast<Move_t<T>>(*s));
+                Call_maybe_unsafe(
+                    DORI_f_ref(std::allocator_traits<SA>::destroy), s_al, s);
+            }
+    }
+    template <class A, class SA, class T, std::size_t Bits>
+    static DORI_inline void Relocate(A &, SA &, packed_ptr<T, Bits> d,
+                                     packed_ptr<T, Bits> s,
+                                     std::size_t n) noexcept
+    {
+        Packed_copy(d, s, n);
+    }
+    template <class A, class SA, class T>
+    static DORI_inline void Relocate(A &, SA &, nullable_ptr<T> d,
+                                     nullable_ptr<T> s, std::size_t n) noexcept
+    {
+        Nullable_copy(d, s, n);
+    }
+
+    template <class A, class T, class... Args>
+    static void Construct_n(A &al, T *d, std::size_t n, const Args &...args)
+    {
+        const auto f = d;
+        try {
+            for (const auto l = d + n; d != l; ++d)
+                std::allocator_traits<A>::construct(al, d, args...);
+        } catch (...) {
+            Destroy_n(al, f, static_cast<std::size_t>(d - f));
+            throw;
+        }
+    }
+    template <class A, class T, std::size_t Bits, class... Args>
+    static DORI_inline void Construct_n(A &, packed_ptr<T, Bits> d,
+                                        std::size_t n, const Args &...args)
+    {
+        const T x(args...);
+        for (const auto l = d + n; d != l; ++d)
+            *d = x;
+    }
+    template <class A, class T, class... Args>
+    static DORI_inline void Construct_n(A &, nullable_ptr<T> d, std::size_t n,
+                                        const Args &...args)
+    {
+        const std::optional<T> x(args...);
+        for (const auto l = d + n; d != l; ++d)
+            *d = x;
+    }
+
+    template <class A, class T>
+    static DORI_inline void Destroy_n(A &al, T *d, std::size_t n) noexcept
+    {
+        if constexpr (!std::is_trivially_destructible_v<T>)
+            for (const auto l = d + n; d != l; ++d)
+                Call_maybe_unsafe(
+                    DORI_f_ref(std::allocator_traits<A>::destroy), al, d);
+    }
+    template <class A, class T, std::size_t Bits>
+    static DORI_inline void Destroy_n(A &, packed_ptr<T, Bits>,
+                                      std::size_t) noexcept
+    {
+    }
+    template <class A, class T>
+    static DORI_inline void Destroy_n(A &, nullable_ptr<T>,
+                                      std::size_t) noexcept
+    {
+    }
+};
+
+} // namespace detail
+
+//
+// Moves the rows of v into a vector with a column of type C appended, each
+// element of which is constructed from args. v is left empty.
+//
+template <class C, class Layout, class Al, class... Ts, class... Args>
+auto with_column(basic_vector<Layout, Al, Ts...> &&v, const Args &...args)
+{
+    using Res =
+        detail::Columns_result<typename detail::Layout_with<Layout>::type, Al,
+                               boost::mp11::mp_list<Ts...>, Ts..., C>;
+    constexpr auto map = [] {
+        std::array<std::size_t, sizeof...(Ts) + 1> res;
+        for (std::size_t i = 0; i < sizeof...(Ts); ++i)
+            res[i] = i;
+        res.back() = detail::Column_ops::New;
+        return res;
+    }();
+    return detail::Column_ops::Rebuild<Res, map, detail::Column_ops::New>(
+        v, args...);
+}
+
+//
+// Moves the rows of v into a vector without its column I, whose elements are
+// destroyed. v is left empty.
+//
+template <std::size_t I, class Layout, class Al, class... Ts>
+requires(I < sizeof...(Ts) && sizeof...(Ts) > 1) auto without_column(
+    basic_vector<Layout, Al, Ts...> &&v)
+{
+    using L   = boost::mp11::mp_list<Ts...>;
+    using Res = boost::mp11::mp_apply<
+        detail::Columns_result,
+        boost::mp11::mp_append<
+            boost::mp11::mp_list<
+                typename detail::Layout_without<Layout, I>::type, Al, L>,
+            boost::mp11::mp_erase_c<L, I, I + 1>>>;
+    constexpr auto map = [] {
+        std::array<std::size_t, sizeof...(Ts) - 1> res;
+        for (std::size_t i = 0; i < res.size(); ++i)
+            res[i] = i < I ? i : i + 1;
+        return res;
+    }();
+    return detail::Column_ops::Rebuild<Res, map, I>(v);
+}
+
+} // namespace dori
@@ -0,0 +1,431 @@
+#pragma once
+
+//
+// cow_vector<Ts...> is a vector whose columns are reference-counted buffers of
+// their own, shared between copies. Copying one (or taking a snapshot()) costs
+// a reference per column regardless of the rows; a column is copied only when
+// a vector holding it writes to it while it's shared, so a writer handing out
+// snapshots every tick copies just the columns it changes in between:
+//
+//   auto snap = v.snapshot();   // O(columns)
+//   v.mutable_data<2>()[i] = x; // copies column 2 if snap still holds it
+//
+// Rows appended to a shared buffer don't disturb the vectors that share it,
+// as each reads only its own rows. So the vector that made a buffer keeps
+// appending to it in place as long as no other vector has; any other vector,
+// or one that shrank meanwhile, copies the column first.
+//
+// Copies may be read, and written, on other threads while the writer goes
+// on: the writer of a buffer and its size are atomic, and a vector writes in
+// place only to rows no other vector reads. As with std::shared_ptr, each
+// vector object itself is used by one thread at a time, and a copy handed to
+// another thread must be handed over with synchronization, such as through a
+// mutex or a channel. Reads go through data<I>() and are never copying;
+// writes go through mutable_data<I>(), which is.
+//
+
+#include "detail/assert.h"
+#include "detail/inline.h"
+#include "packed.h"
+#include "query.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace dori
+{
+
+namespace detail
+{
+
+// Identifies the vector allowed to append to the buffers it makes in place
+inline std::uint64_t Cow_writer_id() noexcept
+{
+    static std::atomic<std::uint64_t> next{1};
+    return next.fetch_add(1, std::memory_order_relaxed);
+}
+
+//
+// Handle to the buffer of one column. The rows of a buffer past built are
+// unconstructed; built may exceed the size of a vector holding it, the extra
+// rows belonging to the vector that appended them. The writer appends while
+// other vectors on other threads look at writer and built to tell whether
+// they may too, so both are atomic.
+//
+template <class T>
+class Cow_column
+{
+    struct Buffer {
+        std::atomic<std::size_t> refs{1};
+        std::atomic<std::uint64_t> writer{0};
+        std::atomic<std::size_t> built{0};
+        std::size_t cap = 0;
+        T *p            = nullptr;
+    };
+
+  public:
+    Cow_column() noexcept = default;
+    Cow_column(std::size_t cap, std::uint64_t writer)
+    {
+        auto b = std::make_unique<Buffer>();
+        b->writer.store(writer, std::memory_order_relaxed);
+        b->cap = cap;
+        b->p   = std::allocator<T>{}.allocate(cap);
+        b_     = b.release();
+    }
+    Cow_column(const Cow_column &other) noexcept : b_{other.b_}
+    {
+        if (b_)
+            b_->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+    Cow_column(Cow_column &&other) noexcept
+        : b_{std::exchange(other.b_, nullptr)}
+    {
+    }
+    Cow_column &operator=(Cow_column rhs) noexcept
+    {
+        std::swap(b_, rhs.b_);
+        return *this;
+    }
+    ~Cow_column()
+    {
+        if (b_ && b_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::destroy_n(b_->p, b_->built.load(std::memory_order_relaxed));
+            std::allocator<T>{}.deallocate(b_->p, b_->cap);
+            delete b_;
+        }
+    }
+
+    DORI_inline const T *data() const noexcept { return b_ ? b_->p : nullptr; }
+
+    DORI_inline bool shared() const noexcept
+    {
+        return b_ && b_->refs.load(std::memory_order_acquire) != 1;
+    }
+
+    DORI_inline bool same(const Cow_column &other) const noexcept
+    {
+        return b_ == other.b_;
+    }
+
+    // Buffer of cap rows holding the first n of this one; they're moved when
+    // no other vector holds this buffer
+    Cow_column Copy(std::size_t n, std::size_t cap, std::uint64_t writer)
+    {
+        Cow_column res{cap, writer};
+        if (n) {
+            if (!shared() && std::is_nothrow_move_constructible_v<T>)
+                std::uninitialized_move_n(b_->p, n, res.b_->p);
+            else
+                std::uninitialized_copy_n(b_->p, n, res.b_->p);
+        }
+        res.b_->built.store(n, std::memory_order_relaxed);
+        return res;
+    }
+
+    // The rows of a vector of size sz for writing
+    DORI_inline T *Writable(std::size_t sz, std::size_t cap,
+                            std::uint64_t writer)
+    {
+        if (shared())
+            *this = Copy(sz, cap, writer);
+        return b_ ? b_->p : nullptr;
+    }
+
+    // Makes row sz the next one to construct
+    DORI_inline void Prepare_append(std::size_t sz, std::size_t cap,
+                                    std::uint64_t writer)
+    {
+        if (!shared()) {
+            b_->writer.store(writer, std::memory_order_relaxed);
+            Trim(sz);
+        } else if (b_->writer.load(std::memory_order_acquire) != writer ||
+                   b_->built.load(std::memory_order_acquire) != sz)
+            *this = Copy(sz, cap, writer);
+    }
+
+    template <class... Args>
+    DORI_inline void Construct(Args &&...args)
+    {
+        const auto n = b_->built.load(std::memory_order_relaxed);
+        std::construct_at(b_->p + n, static_cast<Args &&>(args)...);
+        b_->built.store(n + 1, std::memory_order_release);
+    }
+
+    // Destroys the rows from n on; only for buffers whose tail is owned
+    DORI_inline void Trim(std::size_t n) noexcept
+    {
+        const auto built = b_->built.load(std::memory_order_relaxed);
+        if (n < built) {
+            std::destroy(b_->p + n, b_->p + built);
+            b_->built.store(n, std::memory_order_relaxed);
+        }
+    }
+
+    // Destroys the rows from n on unless other vectors may read them
+    DORI_inline void Shrink(std::size_t n) noexcept
+    {
+        if (b_ && !shared())
+            Trim(n);
+    }
+
+  private:
+    Buffer *b_ = nullptr;
+};
+
+} // namespace detail
+
+template <class... Ts>
+class cow_vector
+{
+    static_assert((... && !detail::Is_packed<Ts>),
+                  "packed columns can't be stored in a cow_vector");
+    static_assert((... && !detail::Is_nullable<Ts>),
+                  "nullable columns can't be stored in a cow_vector");
+    static_assert((... && !detail::Is_varlen<Ts>),
+                  "varlen columns can't be stored in a cow_vector");
+
+    template <class F>
+    DORI_inline void Each(F &&f)
+    {
+        std::apply([&](auto &...cs) { (..., f(cs)); }, cols_);
+    }
+
+  public:
+    using value_type      = std::tuple<Ts...>;
+    using const_reference = std::tuple<const Ts &...>;
+    using size_type       = std::size_t;
+    using difference_type = std::ptrdiff_t;
+
+    cow_vector() noexcept : id_{detail::Cow_writer_id()} {}
+
+    // Shares the columns of other
+    cow_vector(const cow_vector &other) noexcept
+        : cols_{other.cols_}, sz_{other.sz_}, cap_{other.cap_},
+          id_{detail::Cow_writer_id()}
+    {
+    }
+    cow_vector(cow_vector &&other) noexcept
+        : cols_{std::move(other.cols_)}, sz_{std::exchange(other.sz_, 0)},
+          cap_{std::exchange(other.cap_, 0)},
+          id_{std::exchange(other.id_, detail::Cow_writer_id())}
+    {
+    }
+    cow_vector &operator=(const cow_vector &rhs) noexcept
+    {
+        cols_ = rhs.cols_;
+        sz_   = rhs.sz_;
+        cap_  = rhs.cap_;
+        return *this;
+    }
+    cow_vector &operator=(cow_vector &&rhs) noexcept
+    {
+        swap(rhs);
+        return *this;
+    }
+
+    void swap(cow_vector &other) noexcept
+    {
+        std::swap(cols_, other.cols_);
+        std::swap(sz_, other.sz_);
+        std::swap(cap_, other.cap_);
+        std::swap(id_, other.id_);
+    }
+
+    // A copy sharing every column; the same as copying the vector
+    DORI_inline cow_vector snapshot() const noexcept { return *this; }
+
+    DORI_inline bool empty() const noexcept { return !sz_; }
+    DORI_inline size_type size() const noexcept { return sz_; }
+    DORI_inline size_type capacity() const noexcept { return cap_; }
+
+    template <std::size_t I>
+    requires(I < sizeof...(Ts)) DORI_inline auto data() const noexcept
+    {
+        return std::get<I>(cols_).data();
+    }
+
+    //
+    // The rows of column I for writing. The column is copied first if another
+    // vector shares it, which invalidates pointers to it obtained earlier.
+    //
+    template <std::size_t I>
+    requires(I < sizeof...(Ts)) DORI_inline auto mutable_data()
+    {
+        return std::get<I>(cols_).Writable(sz_, cap_, id_);
+    }
+
+    // Whether column I is shared with another vector
+    template <std::size_t I>
+    requires(I < sizeof...(Ts)) DORI_inline bool shared() const noexcept
+    {
+        return std::get<I>(cols_).shared();
+    }
+
+    // Whether column I of other is the same buffer as that of this
+    template <std::size_t I>
+    requires(I < sizeof...(Ts)) DORI_inline bool
+        shares(const cow_vector &other) const noexcept
+    {
+        return std::get<I>(cols_).same(std::get<I>(other.cols_));
+    }
+
+    DORI_inline const_reference operator[](size_type i) const noexcept
+    {
+        DORI_assert(i < sz_);
+        return std::apply(
+            [&](const auto &...cs) { return const_reference{cs.data()[i]...}; },
+            cols_);
+    }
+    const_reference at(size_type i) const
+    {
+        if (i >= sz_)
+            throw std::out_of_range{"dori::cow_vector::at"};
+        return (*this)[i];
+    }
+    DORI_inline const_reference front() const noexcept { return (*this)[0]; }
+    DORI_inline const_reference back() const noexcept
+    {
+        return (*this)[sz_ - 1];
+    }
+
+    // Moves the columns to buffers of cap rows of this vector's own
+    void reserve(size_type cap)
+    {
+        if (cap <= cap_)
+            return;
+        auto cols = std::apply(
+            [&](auto &...cs) { return std::tuple{cs.Copy(sz_, cap, id_)...}; },
+            cols_);
+        cols_ = std::move(cols);
+        cap_  = cap;
+    }
+
+    void clear() noexcept
+    {
+        Each([&](auto &c) { c.Shrink(0); });
+        sz_ = 0;
+    }
+
+    void resize(size_type sz)
+    {
+        DORI_assert(sz <= cap_);
+        if (sz <= sz_) {
+            Each([&](auto &c) { c.Shrink(sz); });
+            sz_ = sz;
+            return;
+        }
+        Each([&](auto &c) { c.Prepare_append(sz_, cap_, id_); });
+        Append([&](auto &c, auto) {
+            for (auto i = sz_; i < sz; ++i)
+                c.Construct();
+        });
+        sz_ = sz;
+    }
+
+    template <class... Us>
+    requires((std::is_constructible_v<Ts, Us &&> && ...) &&
+             sizeof...(Us) == sizeof...(Ts)) //
+        void emplace_back(Us &&...xs)
+    {
+        DORI_assert(sz_ < cap_);
+        Each([&](auto &c) { c.Prepare_append(sz_, cap_, id_); });
+        std::tuple<Us &&...> fwd{static_cast<Us &&>(xs)...};
+        Append([&](auto &c, auto i) {
+            c.Construct(std::get<i>(std::move(fwd)));
+        });
+        ++sz_;
+    }
+
+    template <class... Us>
+    requires((std::is_constructible_v<Ts, Us &&> && ...) &&
+             sizeof...(Us) == sizeof...(Ts)) //
+        DORI_inline void push_back(Us &&...xs)
+    {
+        emplace_back(static_cast<Us &&>(xs)...);
+    }
+    DORI_inline void push_back(const value_type &value)
+    {
+        std::apply([&](const Ts &...xs) { emplace_back(xs...); }, value);
+    }
+
+    template <class F>
+    requires((std::is_invocable_v<F &&, const Ts *, const Ts *> && ...)) //
+        DORI_inline void for_each(F &&f) const
+    {
+        std::apply(
+            [&](const auto &...cs) {
+                (..., static_cast<F &&>(f)(cs.data(), cs.data() + sz_));
+            },
+            cols_);
+    }
+
+    // Starts a lazy query over the columns; see query.h
+    DORI_inline auto query() const noexcept
+    {
+        return ::dori::query<cow_vector>{*this};
+    }
+
+  private:
+    // Constructs rows past sz_ by f(column, index) in each column, all of
+    // which have been prepared for appending; on failure, the rows constructed
+    // are destroyed again
+    template <class F>
+    void Append(F &&f)
+    {
+        try {
+            [&]<std::size_t... Is>(std::index_sequence<Is...>)
+            {
+                (..., f(std::get<Is>(cols_),
+                        std::integral_constant<std::size_t, Is>{}));
+            }
+            (std::index_sequence_for<Ts...>{});
+        } catch (...) {
+            Each([&](auto &c) { c.Trim(sz_); });
+            throw;
+        }
+    }
+
+    std::tuple<detail::Cow_column<Ts>...> cols_;
+    size_type sz_  = 0;
+    size_type cap_ = 0;
+    std::uint64_t id_;
+};
+
+template <class... Ts>
+DORI_inline bool operator==(const cow_vector<Ts...> &lhs,
+                            const cow_vector<Ts...> &rhs) noexcept
+{
+    if (lhs.size() != rhs.size())
+        return false;
+    return [&]<std::size_t... Is>(std::index_sequence<Is...>)
+    {
+        return (... && std::equal(lhs.template data<Is>(),
+                                  lhs.template data<Is>() + lhs.size(),
+                                  rhs.template data<Is>(),
+                                  rhs.template data<Is>() + rhs.size()));
+    }
+    (std::index_sequence_for<Ts...>{});
+}
+
+template <class... Ts>
+DORI_inline bool operator!=(const cow_vector<Ts...> &lhs,
+                            const cow_vector<Ts...> &rhs) noexcept
+{
+    return !(lhs == rhs);
+}
+
+template <class... Ts>
+DORI_inline void swap(cow_vector<Ts...> &lhs, cow_vector<Ts...> &rhs) noexcept
+{
+    lhs.swap(rhs);
+}
+
+} // namespace dori
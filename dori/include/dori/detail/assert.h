@@ -1,6 +1,7 @@
 #pragma once
 
 #include <stdexcept>
+#include <stdio.h>
 #include <stdlib.h>
 #include <type_traits>
 
@@ -14,20 +15,18 @@
 
 #if DORI_DEBUG
 #define DORI_assert(Expr)                                                      \
-    []() {                                                                     \
-        if constexpr (std::is_constant_evaluated())                            \
-            return [](bool e) {                                                \
-                if (!e)                                                        \
-                    throw std::runtime_error{#Expr " != true"};                \
-            };                                                                 \
-        else                                                                   \
-            return [](bool e) {                                                \
-                if (!e) {                                                      \
-                    fprintf(stderr, "%s\n", #Expr " != true");                 \
-                    abort();                                                   \
-                }                                                              \
-            };                                                                 \
-    }()(Expr)
-#else
+    [](bool e) {                                                               \
+        if (std::is_constant_evaluated()) {                                    \
+            if (!e)                                                            \
+                throw std::runtime_error{#Expr " != true"};                    \
+        } else if (!e) {                                                       \
+            fprintf(stderr, "%s\n", #Expr " != true");                         \
+            abort();                                                           \
+        }                                                                      \
+    }(static_cast<bool>(Expr))
+#elif defined(_MSC_VER) && !defined(__clang__)
 #define DORI_assert(Expr) __assume(Expr)
-#endif
\ No newline at end of file
+#else
+#define DORI_assert(Expr)                                                      \
+    static_cast<void>((Expr) ? void() : __builtin_unreachable())
+#endif
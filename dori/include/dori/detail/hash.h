@@ -0,0 +1,22 @@
+#pragma once
+
+#include "inline.h"
+
+#include <cstdint>
+#include <functional>
+
+namespace dori::detail
+{
+
+template <class K>
+DORI_inline std::uint64_t Hash_key(const K &k)
+{
+    // std::hash is the identity for integers; spread it to the upper bits,
+    // and fold those back down, as the low bits of a product depend only on
+    // the low bits of the key
+    const auto h =
+        static_cast<std::uint64_t>(std::hash<K>{}(k)) * 0x9e3779b97f4a7c15u;
+    return h ^ h >> 32;
+}
+
+} // namespace dori::detail
@@ -2,6 +2,16 @@
 
 #if defined(_MSC_VER) && !defined(__INTEL_COMPILER)
 #define DORI_inline inline __forceinline
+#elif defined(__GNUC__) || defined(__clang__)
+#define DORI_inline inline __attribute__((always_inline))
 #else
 #define DORI_inline inline
-#endif
\ No newline at end of file
+#endif
+
+#if defined(_MSC_VER) && !defined(__INTEL_COMPILER)
+#define DORI_noinline __declspec(noinline)
+#elif defined(__GNUC__) || defined(__clang__)
+#define DORI_noinline __attribute__((noinline))
+#else
+#define DORI_noinline
+#endif
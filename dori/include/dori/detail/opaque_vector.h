@@ -7,6 +7,7 @@
 
 #include <algorithm>
 #include <array>
+#include <cstring>
 #include <memory>
 #include <string_view>
 #include <utility>
@@ -57,4 +58,55 @@ struct Destroy_to_impl {
     }
 };
 
+//
+// Relocating, copying, and erasing rows of trivially copyable elements comes
+// down to moving bytes, so the code for these is shared by all vectors whose
+// sequences have the same sizes (and packed bits) in storage order, whatever
+// their element types, allocator, or wrapper: vector<i32, double> and
+// vector<f64, float> run the same functions. These sit on warm paths, where a
+// call costs less than a copy of the loops in every instantiation.
+//
+
+template <class Sizes, class Bits>
+struct Trivial_ops;
+template <std::size_t... Szs, std::size_t... Bs>
+struct Trivial_ops<std::index_sequence<Szs...>, std::index_sequence<Bs...>> {
+    static constexpr std::size_t Sz_all = (Szs + ...);
+
+    // Copies rows 0..n from s of capacity s_cap to d of capacity d_cap
+    DORI_noinline static void copy(std::byte *d, std::size_t d_cap,
+                                   const std::byte *s, std::size_t s_cap,
+                                   std::size_t n) noexcept
+    {
+        if (!n)
+            return;
+        std::size_t off = 0;
+        (..., (Szs ? (void)std::memcpy(d + off * d_cap, s + off * s_cap,
+                                       n * Szs)
+                   : (void)0,
+               off += Szs));
+        // Packed sequences follow in whole words
+        d += d_cap * Sz_all;
+        s += s_cap * Sz_all;
+        std::size_t bit_off = 0;
+        (..., (Bs ? (void)std::memcpy(d + d_cap / 8 * bit_off,
+                                      s + s_cap / 8 * bit_off,
+                                      (n * Bs + 63) / 64 * 8)
+                  : (void)0,
+               bit_off += Bs));
+    }
+
+    // Moves rows l..n of p of capacity cap to f; no packed sequences
+    DORI_noinline static void erase(std::byte *p, std::size_t cap,
+                                    std::size_t f, std::size_t l,
+                                    std::size_t n) noexcept
+    {
+        static_assert(!(Bs + ...), "packed rows don't start on bytes");
+        std::size_t off = 0;
+        (..., (std::memmove(p + off * cap + f * Szs, p + off * cap + l * Szs,
+                            (n - l) * Szs),
+               off += Szs));
+    }
+};
+
 } // namespace dori::detail
\ No newline at end of file
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "inline.h"
+#include "opaque_vector.h"
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+namespace dori::detail
+{
+
+//
+// An allocator carrying a buffer of its own, from which it serves one
+// allocation of at most Bytes bytes at a time. Anything else is forwarded to
+// the upstream allocator. As the buffer doesn't move along with the allocator,
+// an allocator is equal to another only while neither of their buffers is in
+// use - this makes vector_impl relocate elements rather than take over their
+// storage when it'd be an inline buffer.
+//
+
+template <std::size_t Bytes, std::size_t Align, class Upstream>
+class Sbo_allocator
+{
+    using Up_tr = std::allocator_traits<Upstream>;
+
+  public:
+    using value_type                             = std::byte;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::false_type;
+    using propagate_on_container_swap            = std::false_type;
+    using is_always_equal                        = std::false_type;
+
+    constexpr DORI_inline Sbo_allocator() noexcept(noexcept(Upstream{}))
+        : up_{}
+    {
+    }
+    constexpr DORI_inline explicit Sbo_allocator(const Upstream &up) noexcept
+        : up_{up}
+    {
+    }
+    // Copies share the upstream but never the buffer
+    constexpr DORI_inline Sbo_allocator(const Sbo_allocator &other) noexcept
+        : up_{other.up_}
+    {
+    }
+    constexpr DORI_inline Sbo_allocator &
+    operator=(const Sbo_allocator &other) noexcept
+    {
+        up_ = other.up_;
+        return *this;
+    }
+
+    constexpr DORI_inline const Upstream &upstream() const noexcept
+    {
+        return up_;
+    }
+
+    constexpr DORI_inline std::byte *allocate(std::size_t n)
+    {
+        if (n <= Bytes && !used_) {
+            used_ = true;
+            return buf_;
+        }
+        return Up_tr::allocate(up_, n);
+    }
+
+    constexpr DORI_inline void deallocate(std::byte *p, std::size_t n) noexcept
+    {
+        if (p == buf_)
+            used_ = false;
+        else
+            Up_tr::deallocate(up_, p, n);
+    }
+
+    constexpr DORI_inline bool owns(const std::byte *p) const noexcept
+    {
+        return p == buf_;
+    }
+
+    constexpr DORI_inline bool
+    operator==(const Sbo_allocator &other) const noexcept
+    {
+        return this == &other || (!used_ && !other.used_ && up_ == other.up_);
+    }
+    constexpr DORI_inline bool
+    operator!=(const Sbo_allocator &other) const noexcept
+    {
+        return !(*this == other);
+    }
+
+  private:
+    DORI_no_unique_address Upstream up_;
+    bool used_ = false;
+    alignas(Align) std::byte buf_[Bytes];
+};
+
+} // namespace dori::detail
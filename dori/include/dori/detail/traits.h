@@ -1,7 +1,9 @@
 #pragma once
 
+#include <boost/align/aligned_allocator_forward.hpp>
 #include <boost/mp11/algorithm.hpp>
 #include <iterator>
+#include <string_view>
 #include <type_traits>
 
 namespace dori::detail
@@ -56,17 +58,48 @@ concept Tuple = requires
     typename std::tuple_size<T>;
 };
 
+template <class T>
+using Is_input_iterator =
+    std::bool_constant<std::input_iterator<std::remove_cvref_t<T>>>;
+
+// Whether an allocator customizes the construction or destruction of elements
+template <class Al>
+inline constexpr bool Al_constructs = requires(Al &al, int *p)
+{
+    al.construct(p);
+}
+|| requires(Al &al, int *p)
+{
+    al.destroy(p);
+};
+// Its construct() and destroy() are those of std::allocator
+template <class T, std::size_t A>
+inline constexpr bool
+    Al_constructs<boost::alignment::aligned_allocator<T, A>> = false;
+
 template <class T>
 using Move_t =
     std::conditional_t<std::is_trivially_copy_constructible_v<T>, T &, T &&>;
 
+//
+// The name is used as a deterministic tiebreaker and for diagnostics, so the
+// exact format doesn't matter beyond it being unique per type.
+//
+
 template <class T>
 static constexpr auto Get_type_name()
 {
+#if defined(_MSC_VER) && !defined(__clang__)
     std::string_view sv = __FUNCSIG__;
     auto f_i            = sv.find('<');
     auto l_i            = sv.rfind('>');
     return sv.substr(f_i, l_i - f_i);
+#else
+    std::string_view sv = __PRETTY_FUNCTION__;
+    auto f_i            = sv.find("T = ") + 4;
+    auto l_i            = sv.find_first_of(";]", f_i);
+    return sv.substr(f_i, l_i - f_i);
+#endif
 }
 
 } // namespace dori::detail
\ No newline at end of file
@@ -1,10 +1,17 @@
 #pragma once
 
 #include <boost/align/aligned_allocator.hpp>
+#include <cstddef>
 
 namespace dori
 {
 
+// Assumed size of a cache line
+inline constexpr std::size_t cache_line = 64;
+
+template <class Layout, class Allocator, class... Ts>
+struct basic_vector;
+
 template <class Allocator, class... Ts>
 struct vector_al;
 
@@ -12,6 +19,7 @@ namespace detail
 {
 template <class, class, class, auto, auto, std::size_t...>
 class vector_impl;
+struct Column_ops;
 }
 // template <class... Ts>
 // using vector = vector_al<
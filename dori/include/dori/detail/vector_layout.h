@@ -1,5 +1,7 @@
 #pragma once
 
+#include "../layout.h"
+#include "../packed.h"
 #include "traits.h"
 #include "vector_fwd.h"
 
@@ -13,19 +15,30 @@
 namespace dori::detail
 {
 
-template <class Al, class... Ts, std::size_t... Is>
+template <class Al, class Layout, class... Ts, std::size_t... Is>
 constexpr auto Get_vector(std::index_sequence<Is...>)
 {
     constexpr auto res = [] {
-        std::array xs{std::tuple{static_cast<std::ptrdiff_t>(sizeof(Ts)),
-                                 Get_type_name<Ts>(), Is}...};
-        std::sort(xs.begin(), xs.end(), std::greater<>{});
-
-        std::array idx{std::get<2>(xs[Is])...};
-        std::array<std::size_t, xs.size()> offs{}, redir{};
+        // Packed sequences go after the others, as they take no whole bytes
+        // per row; their offsets are thus all the same
+        constexpr std::array<std::size_t, sizeof...(Ts)> idx = [] {
+            constexpr auto order = Layout::template order<Ts...>();
+            constexpr std::array packed{Is_packed<Ts>...};
+            std::array<std::size_t, sizeof...(Ts)> res{};
+            auto it = res.begin();
+            for (bool p : {false, true})
+                for (auto i : order)
+                    if (packed[i] == p)
+                        *it++ = i;
+            return res;
+        }();
+        constexpr std::array<std::size_t, sizeof...(Ts)> sizes{
+            (Is_packed<Ts> ? 0 : sizeof(Ts))...};
+
+        std::array<std::size_t, idx.size()> offs{}, redir{};
         (..., (redir[idx[Is]] = Is));
-        std::ptrdiff_t off = 0;
-        (..., (offs[Is] = off, off += std::get<0>(xs[Is])));
+        std::size_t off = 0;
+        (..., (offs[Is] = off, off += sizes[idx[Is]]));
 
         return std::array{idx, offs, redir};
     }();
@@ -34,8 +47,8 @@ constexpr auto Get_vector(std::index_sequence<Is...>)
     return vector_impl<Al, Ts_, TsSrt, res[1], res[2], Is...>{};
 }
 
-template <class Al, class... Ts>
+template <class Al, class Layout, class... Ts>
 using Get_vector_t =
-    decltype(Get_vector<Al, Ts...>(std::index_sequence_for<Ts...>{}));
+    decltype(Get_vector<Al, Layout, Ts...>(std::index_sequence_for<Ts...>{}));
 
-} // namespace dori::detail
\ No newline at end of file
+} // namespace dori::detail
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "inline.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <sys/mman.h>
+#include <type_traits>
+#include <unistd.h>
+
+namespace dori::detail
+{
+
+//
+// An allocator handing out address space rather than memory: allocations are
+// mappings with no access, the pages of which are committed and returned with
+// Commit() and Decommit() as they're needed. The mappings start on a page, so
+// they're aligned for any element type.
+//
+
+inline std::size_t Page_size() noexcept
+{
+    static const auto res = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    return res;
+}
+
+class Vm_allocator
+{
+  public:
+    using value_type      = std::byte;
+    using is_always_equal = std::true_type;
+
+    std::byte *allocate(std::size_t n)
+    {
+        const auto p = ::mmap(nullptr, n, PROT_NONE,
+                              MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1,
+                              0);
+        if (p == MAP_FAILED)
+            throw std::bad_alloc{};
+        return static_cast<std::byte *>(p);
+    }
+
+    void deallocate(std::byte *p, std::size_t n) noexcept { ::munmap(p, n); }
+
+    // Makes the pages overlapping f..l readable and writable
+    static void Commit(std::byte *f, std::byte *l)
+    {
+        const auto pg = Page_size();
+        const auto b  = Round_down(f, pg);
+        if (f != l && ::mprotect(b, static_cast<std::size_t>(l - b),
+                                 PROT_READ | PROT_WRITE))
+            throw std::bad_alloc{};
+    }
+
+    // Returns the pages within f..l to the system, leaving them inaccessible
+    static void Decommit(std::byte *f, std::byte *l) noexcept
+    {
+        const auto pg = Page_size();
+        const auto b  = Round_down(f + pg - 1, pg);
+        const auto e  = Round_down(l, pg);
+        if (b < e) {
+            const auto n = static_cast<std::size_t>(e - b);
+            ::madvise(b, n, MADV_DONTNEED);
+            ::mprotect(b, n, PROT_NONE);
+        }
+    }
+
+    friend bool operator==(const Vm_allocator &, const Vm_allocator &) noexcept
+    {
+        return true;
+    }
+
+  private:
+    static DORI_inline std::byte *Round_down(std::byte *p,
+                                             std::size_t pg) noexcept
+    {
+        return p - reinterpret_cast<std::uintptr_t>(p) % pg;
+    }
+};
+
+} // namespace dori::detail
@@ -0,0 +1,638 @@
+#pragma once
+
+//
+// An open-addressed hash map from keys to rows of values in the manner of the
+// Swiss tables of Abseil. Each slot of the map has a control byte telling
+// whether it's empty, a tombstone, or full, and for a full slot, 7 bits of the
+// hash of its key. The control bytes, the keys, and each type of value are
+// columns of one allocation, laid out as those of a vector:
+//
+//   dori::flat_hash_map<std::string, std::uint32_t, float> m;
+//   m.try_emplace("a", 1, 0.5f);
+//   if (auto it = m.find("a"); it != m.end())
+//       std::get<2>(*it) += 1;
+//
+// A lookup matches the control bytes of a group of slots against the hash at
+// once, with SSE2 if available, and compares only the keys of the matches;
+// the value columns are touched only by the iterator of a hit. Groups are
+// aligned to their width and probed in triangular steps, and a lookup ends at
+// the first group with an empty slot. At most 7/8 of the slots are used.
+//
+// Keys and values are moved into a new allocation as the map grows, which
+// invalidates iterators.
+//
+
+#include "detail/assert.h"
+#include "detail/hash.h"
+#include "detail/inline.h"
+#include "vector.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace dori
+{
+
+namespace detail
+{
+
+// Control bytes of slots not full; those of full slots are 0..127
+inline constexpr std::int8_t Ctrl_empty   = -128;
+inline constexpr std::int8_t Ctrl_deleted = -2;
+
+//
+// Matches of a group of control bytes as a mask, bits of which index(m) maps
+// to slots of the group
+//
+#ifdef __SSE2__
+struct Ctrl_group {
+    static constexpr std::size_t width = 16;
+    using mask_type                    = std::uint32_t;
+
+    __m128i c;
+
+    explicit DORI_inline Ctrl_group(const std::int8_t *p) noexcept
+        : c{_mm_loadu_si128(reinterpret_cast<const __m128i *>(p))}
+    {
+    }
+    DORI_inline mask_type match(std::int8_t h) const noexcept
+    {
+        return static_cast<mask_type>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h), c)));
+    }
+    DORI_inline mask_type match_empty() const noexcept
+    {
+        return match(Ctrl_empty);
+    }
+    // Empty slots and tombstones
+    DORI_inline mask_type match_free() const noexcept
+    {
+        return static_cast<mask_type>(_mm_movemask_epi8(c));
+    }
+    static DORI_inline std::size_t index(mask_type m) noexcept
+    {
+        return static_cast<std::size_t>(std::countr_zero(m));
+    }
+};
+#else
+// A word of control bytes, matched a byte at a time by bit tricks
+struct Ctrl_group {
+    static constexpr std::size_t width = 8;
+    using mask_type                    = std::uint64_t;
+
+    static constexpr std::uint64_t Lsbs = 0x0101010101010101u;
+    static constexpr std::uint64_t Msbs = 0x8080808080808080u;
+
+    std::uint64_t c;
+
+    explicit DORI_inline Ctrl_group(const std::int8_t *p) noexcept
+    {
+        std::memcpy(&c, p, sizeof c);
+        if constexpr (std::endian::native == std::endian::big)
+            c = __builtin_bswap64(c);
+    }
+    // The high bit of each byte equal to h, and rarely of a byte after one;
+    // comparing the keys rules those out
+    DORI_inline mask_type match(std::int8_t h) const noexcept
+    {
+        const auto x = c ^ Lsbs * static_cast<std::uint8_t>(h);
+        return (x - Lsbs) & ~x & Msbs;
+    }
+    // Both have the high bit set, and only a tombstone bit 1
+    DORI_inline mask_type match_empty() const noexcept
+    {
+        return c & ~(c << 6) & Msbs;
+    }
+    DORI_inline mask_type match_free() const noexcept { return c & Msbs; }
+    static DORI_inline std::size_t index(mask_type m) noexcept
+    {
+        return static_cast<std::size_t>(std::countr_zero(m)) / 8;
+    }
+};
+#endif
+
+} // namespace detail
+
+template <class Layout, class Al, class K, class... Vs>
+class basic_flat_hash_map
+{
+    static_assert(!detail::Is_packed<K>, "keys can't be packed");
+    static_assert(!(detail::Is_varlen<K> || ... || detail::Is_varlen<Vs>),
+                  "varlen columns are supported by vector only");
+    static_assert(!(detail::Is_nullable<K> || ... || detail::Is_nullable<Vs>),
+                  "nullable columns are supported by vector only");
+    static_assert(
+        (std::is_nothrow_move_constructible_v<K> && ... &&
+         std::is_nothrow_move_constructible_v<detail::Value_t<Vs>>),
+        "keys and values are moved as the map grows");
+
+    // Columns of control bytes, keys, and values
+    using Table = detail::Get_vector_t<Al, Layout, std::int8_t, K, Vs...>;
+    using Al_tr = std::allocator_traits<Al>;
+    using Group = detail::Ctrl_group;
+    using Js    = std::index_sequence_for<Vs...>;
+
+    static constexpr std::size_t W    = Group::width;
+    static constexpr std::size_t Npos = ~std::size_t{};
+
+    template <bool Const>
+    class Iterator
+    {
+        friend basic_flat_hash_map;
+        template <bool>
+        friend class Iterator;
+        using Map = std::conditional_t<Const, const basic_flat_hash_map,
+                                       basic_flat_hash_map>;
+
+        Map *m_        = nullptr;
+        std::size_t i_ = 0;
+
+        DORI_inline Iterator(Map *m, std::size_t i) noexcept : m_{m}, i_{i} {}
+
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using difference_type   = std::ptrdiff_t;
+        using value_type        = std::tuple<K, detail::Value_t<Vs>...>;
+        using reference =
+            std::conditional_t<Const,
+                               std::tuple<const K &, detail::Cref_t<Vs>...>,
+                               std::tuple<const K &, detail::Ref_t<Vs>...>>;
+
+        Iterator() noexcept = default;
+        template <bool C>
+        requires(Const && !C) //
+            DORI_inline Iterator(const Iterator<C> &it) noexcept
+            : m_{it.m_},
+              i_{it.i_}
+        {
+        }
+
+        DORI_inline reference operator*() const noexcept
+        {
+            return m_->template Row<reference>(i_, Js{});
+        }
+        DORI_inline Iterator &operator++() noexcept
+        {
+            i_ = m_->Next_full(i_ + 1);
+            return *this;
+        }
+        DORI_inline Iterator operator++(int) noexcept
+        {
+            auto res = *this;
+            ++*this;
+            return res;
+        }
+        DORI_inline bool operator==(const Iterator &rhs) const noexcept
+        {
+            return i_ == rhs.i_;
+        }
+    };
+
+  public:
+    using key_type       = K;
+    using size_type      = std::size_t;
+    using allocator_type = Al;
+    using iterator       = Iterator<false>;
+    using const_iterator = Iterator<true>;
+    using reference      = typename iterator::reference;
+
+    basic_flat_hash_map() noexcept(noexcept(Al{})) = default;
+
+    // An empty map with room for n keys
+    explicit basic_flat_hash_map(size_type n, const Al &alloc = Al{})
+        : t_{alloc}
+    {
+        reserve(n);
+    }
+
+    basic_flat_hash_map(const basic_flat_hash_map &other)
+        : basic_flat_hash_map{
+              other.size_,
+              Al_tr::select_on_container_copy_construction(other.Alloc())}
+    {
+        for (size_type i = other.Next_full(0); i != other.n_;
+             i = other.Next_full(i + 1))
+            Copy_slot(other, i, Js{});
+    }
+    basic_flat_hash_map(basic_flat_hash_map &&other) noexcept
+        : t_{static_cast<Table &&>(other.t_)},
+          n_{std::exchange(other.n_, 0)},
+          size_{std::exchange(other.size_, 0)},
+          growth_left_{std::exchange(other.growth_left_, 0)},
+          shift_{std::exchange(other.shift_, 0)}
+    {
+    }
+
+    basic_flat_hash_map &operator=(const basic_flat_hash_map &rhs)
+    {
+        if (this != &rhs) {
+            basic_flat_hash_map tmp{rhs};
+            swap(tmp);
+        }
+        return *this;
+    }
+    basic_flat_hash_map &operator=(basic_flat_hash_map &&rhs) noexcept
+    {
+        basic_flat_hash_map tmp{static_cast<basic_flat_hash_map &&>(rhs)};
+        swap(tmp);
+        return *this;
+    }
+
+    ~basic_flat_hash_map() { Destroy_all(); }
+
+    void swap(basic_flat_hash_map &other) noexcept
+    {
+        t_.swap(other.t_);
+        std::swap(n_, other.n_);
+        std::swap(size_, other.size_);
+        std::swap(growth_left_, other.growth_left_);
+        std::swap(shift_, other.shift_);
+    }
+
+    Al get_allocator() const noexcept { return Alloc(); }
+
+    size_type size() const noexcept { return size_; }
+    bool empty() const noexcept { return !size_; }
+    // Slots in the table
+    size_type bucket_count() const noexcept { return n_; }
+
+    iterator begin() noexcept { return {this, Next_full(0)}; }
+    const_iterator begin() const noexcept { return {this, Next_full(0)}; }
+    iterator end() noexcept { return {this, n_}; }
+    const_iterator end() const noexcept { return {this, n_}; }
+
+    // Makes room for n keys without growing
+    void reserve(size_type n)
+    {
+        const auto slots = std::bit_ceil(std::max(W, n + (n + 6) / 7));
+        if (n > size_ + growth_left_ && slots > n_)
+            Rehash(slots);
+    }
+
+    //
+    // Lookup
+    //
+
+    iterator find(const K &k) noexcept
+    {
+        const auto i = Find(k, detail::Hash_key(k));
+        return {this, i == Npos ? n_ : i};
+    }
+    const_iterator find(const K &k) const noexcept
+    {
+        const auto i = Find(k, detail::Hash_key(k));
+        return {this, i == Npos ? n_ : i};
+    }
+    bool contains(const K &k) const noexcept
+    {
+        return Find(k, detail::Hash_key(k)) != Npos;
+    }
+
+    //
+    // Modifiers
+    //
+
+    // Inserts k with values vs unless k is already in the map
+    template <class Kf, class... Us>
+    requires(sizeof...(Us) == sizeof...(Vs)) //
+        std::pair<iterator, bool> try_emplace(Kf &&k, Us &&...vs)
+    {
+        const auto h = detail::Hash_key(static_cast<const K &>(k));
+        if (const auto i = Find(k, h); i != Npos)
+            return {iterator{this, i}, false};
+        const auto i = Insert(h, Js{}, static_cast<Kf &&>(k),
+                              static_cast<Us &&>(vs)...);
+        return {iterator{this, i}, true};
+    }
+
+    // Inserts k with values vs, or assigns vs to the values of k
+    template <class Kf, class... Us>
+    requires(sizeof...(Us) == sizeof...(Vs)) //
+        std::pair<iterator, bool> insert_or_assign(Kf &&k, Us &&...vs)
+    {
+        const auto h = detail::Hash_key(static_cast<const K &>(k));
+        if (const auto i = Find(k, h); i != Npos) {
+            Assign(i, Js{}, static_cast<Us &&>(vs)...);
+            return {iterator{this, i}, false};
+        }
+        const auto i = Insert(h, Js{}, static_cast<Kf &&>(k),
+                              static_cast<Us &&>(vs)...);
+        return {iterator{this, i}, true};
+    }
+
+    // Removes k if it's in the map, returning the number of keys removed
+    size_type erase(const K &k) noexcept
+    {
+        const auto i = Find(k, detail::Hash_key(k));
+        if (i == Npos)
+            return 0;
+        Erase(i);
+        return 1;
+    }
+    iterator erase(const_iterator pos) noexcept
+    {
+        DORI_assert(pos.i_ < n_ && Ctrl()[pos.i_] >= 0);
+        Erase(pos.i_);
+        return {this, Next_full(pos.i_ + 1)};
+    }
+
+    void clear() noexcept
+    {
+        Destroy_all();
+        if (n_)
+            std::memset(Ctrl(), Ctrl_empty_byte, n_);
+        size_        = 0;
+        growth_left_ = Max_load(n_);
+    }
+
+  private:
+    static constexpr int Ctrl_empty_byte = 0x80;
+
+    static constexpr DORI_inline size_type Max_load(size_type n) noexcept
+    {
+        return n - n / 8;
+    }
+
+    DORI_inline Al Alloc() const noexcept { return t_.get_allocator(); }
+
+    // Column I of the table: control bytes, keys, and then values
+    template <std::size_t I>
+    DORI_inline auto Col() noexcept
+    {
+        return n_ ? t_.template data<I>() : decltype(t_.template data<I>()){};
+    }
+    template <std::size_t I>
+    DORI_inline auto Col() const noexcept
+    {
+        return n_ ? t_.template data<I>() : decltype(t_.template data<I>()){};
+    }
+    DORI_inline std::int8_t *Ctrl() noexcept { return Col<0>(); }
+    DORI_inline const std::int8_t *Ctrl() const noexcept { return Col<0>(); }
+    DORI_inline K *Keys() noexcept { return Col<1>(); }
+    DORI_inline const K *Keys() const noexcept { return Col<1>(); }
+
+    static DORI_inline std::int8_t H2(std::uint64_t h) noexcept
+    {
+        return static_cast<std::int8_t>(h >> 57);
+    }
+    // First group to probe for h; the bits above those of H2
+    DORI_inline size_type H1(std::uint64_t h) const noexcept
+    {
+        return static_cast<size_type>(h >> shift_) & (n_ / W - 1);
+    }
+
+    // Slot of k of hash h, or Npos
+    template <class Q>
+    size_type Find(const Q &k, std::uint64_t h) const noexcept
+    {
+        if (!size_)
+            return Npos;
+        const auto ctrl = Ctrl();
+        const auto keys = Keys();
+        const auto h2   = H2(h);
+        const auto gm   = n_ / W - 1;
+        for (size_type g = H1(h), step = 0;; g = (g + ++step) & gm) {
+            const Group grp{ctrl + g * W};
+            for (auto m = grp.match(h2); m; m &= m - 1) {
+                const auto i = g * W + Group::index(m);
+                if (keys[i] == k)
+                    return i;
+            }
+            if (grp.match_empty())
+                return Npos;
+        }
+    }
+
+    // First empty slot or tombstone on the probe sequence of h
+    DORI_inline size_type Find_free(std::uint64_t h) const noexcept
+    {
+        const auto ctrl = Ctrl();
+        const auto gm   = n_ / W - 1;
+        for (size_type g = H1(h), step = 0;; g = (g + ++step) & gm)
+            if (const auto m = Group{ctrl + g * W}.match_free())
+                return g * W + Group::index(m);
+    }
+
+    DORI_inline size_type Next_full(size_type i) const noexcept
+    {
+        const auto ctrl = Ctrl();
+        while (i < n_ && ctrl[i] < 0)
+            ++i;
+        return i;
+    }
+
+    template <class Ref, std::size_t... Is>
+    DORI_inline Ref Row(size_type i, std::index_sequence<Is...>) const noexcept
+    {
+        auto &m = const_cast<basic_flat_hash_map &>(*this);
+        return Ref{Keys()[i], m.template Col<Is + 2>()[i]...};
+    }
+
+    //
+    // Construction and destruction of elements
+    //
+
+    template <class T, class U>
+    DORI_inline void Construct(T *p, U &&x)
+    {
+        auto al = Alloc();
+        Al_tr::construct(al, p, static_cast<U &&>(x));
+    }
+    template <class T, std::size_t Bits, class U>
+    DORI_inline void Construct(packed_ptr<T, Bits> p, U &&x) noexcept
+    {
+        *p = static_cast<T>(x);
+    }
+
+    template <class T>
+    DORI_inline void Destroy(T *p) noexcept
+    {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            auto al = Alloc();
+            Al_tr::destroy(al, p);
+        }
+    }
+    template <class T, std::size_t Bits>
+    DORI_inline void Destroy(packed_ptr<T, Bits>) noexcept
+    {
+    }
+
+    template <std::size_t... Is>
+    DORI_inline void Destroy_slot(size_type i,
+                                  std::index_sequence<Is...>) noexcept
+    {
+        Destroy(Keys() + i);
+        (..., Destroy(Col<Is + 2>() + i));
+    }
+
+    void Destroy_all() noexcept
+    {
+        if constexpr (!std::is_trivially_destructible_v<K> ||
+                      (... ||
+                       !std::is_trivially_destructible_v<detail::Value_t<Vs>>))
+            for (size_type i = Next_full(0); i != n_; i = Next_full(i + 1))
+                Destroy_slot(i, Js{});
+    }
+
+    // Constructs the key and values of slot i, or none if one throws
+    template <std::size_t... Is, class Kf, class... Us>
+    void Construct_slot(size_type i, std::index_sequence<Is...>, Kf &&k,
+                        Us &&...vs)
+    {
+        std::size_t done = 0;
+        try {
+            Construct(Keys() + i, static_cast<Kf &&>(k));
+            ++done;
+            (..., (Construct(Col<Is + 2>() + i,
+                             static_cast<Us &&>(vs)),
+                   ++done));
+        } catch (...) {
+            if (done)
+                Destroy(Keys() + i);
+            (..., (Is + 1 < done ? Destroy(Col<Is + 2>() + i)
+                                 : void()));
+            throw;
+        }
+    }
+
+    template <std::size_t... Is, class Kf, class... Us>
+    size_type Insert(std::uint64_t h, std::index_sequence<Is...> js, Kf &&k,
+                     Us &&...vs)
+    {
+        auto i = n_ ? Find_free(h) : Npos;
+        if (i == Npos || (!growth_left_ && Ctrl()[i] == detail::Ctrl_empty)) {
+            Grow();
+            i = Find_free(h);
+        }
+        Construct_slot(i, js, static_cast<Kf &&>(k), static_cast<Us &&>(vs)...);
+        if (Ctrl()[i] == detail::Ctrl_empty)
+            --growth_left_;
+        Ctrl()[i] = H2(h);
+        ++size_;
+        return i;
+    }
+
+    template <std::size_t... Is, class... Us>
+    DORI_inline void Assign(size_type i, std::index_sequence<Is...>,
+                            Us &&...vs)
+    {
+        (..., (Col<Is + 2>()[i] = static_cast<Us &&>(vs)));
+    }
+
+    template <std::size_t... Is>
+    void Copy_slot(const basic_flat_hash_map &other, size_type i,
+                   std::index_sequence<Is...> js)
+    {
+        const auto &k = other.Keys()[i];
+        Insert(detail::Hash_key(k), js, k,
+               static_cast<detail::Value_t<Vs>>(
+                   other.Col<Is + 2>()[i])...);
+    }
+
+    void Erase(size_type i) noexcept
+    {
+        Destroy_slot(i, Js{});
+        // A lookup ends at a group with an empty slot, so if i's group has
+        // one, no lookup went past it and i may be empty too
+        const auto g = i / W * W;
+        if (Group{Ctrl() + g}.match_empty()) {
+            Ctrl()[i] = detail::Ctrl_empty;
+            ++growth_left_;
+        } else
+            Ctrl()[i] = detail::Ctrl_deleted;
+        --size_;
+    }
+
+    // Rehashes into twice the slots, or as many if half of them are
+    // tombstones
+    void Grow()
+    {
+        Rehash(size_ * 2 < Max_load(n_) ? std::max(n_, W)
+                                        : std::max(n_ * 2, W));
+    }
+
+    void Rehash(size_type n)
+    {
+        Table t{Alloc()};
+        t.reserve(n);
+        std::memset(t.template data<0>(), Ctrl_empty_byte, n);
+        t.swap(t_);
+        const auto old_n = std::exchange(n_, n);
+        shift_           = 57 - static_cast<unsigned>(std::countr_zero(n / W));
+        growth_left_     = Max_load(n) - size_;
+        if (!old_n)
+            return;
+
+        const auto ctrl = t.template data<0>();
+        const auto keys = t.template data<1>();
+        for (size_type i = 0; i != old_n; ++i)
+            if (ctrl[i] >= 0) {
+                const auto h = detail::Hash_key(keys[i]);
+                const auto j = Find_free(h);
+                Move_slot(t, i, j, Js{});
+                Ctrl()[j] = H2(h);
+            }
+    }
+
+    template <std::size_t... Is>
+    DORI_inline void Move_slot(Table &t, size_type i, size_type j,
+                               std::index_sequence<Is...>) noexcept
+    {
+        const auto keys = t.template data<1>();
+        Construct(Keys() + j, std::move(keys[i]));
+        Destroy(keys + i);
+        (..., [&](auto s) {
+            Construct(Col<Is + 2>() + j,
+                      static_cast<detail::Value_t<Vs> &&>(s[i]));
+            Destroy(s + i);
+        }(t.template data<Is + 2>()));
+    }
+
+    Table t_;
+    size_type n_           = 0;
+    size_type size_        = 0;
+    size_type growth_left_ = 0;
+    unsigned shift_        = 0;
+};
+
+template <class Layout, class Al, class K, class... Vs>
+DORI_inline void swap(basic_flat_hash_map<Layout, Al, K, Vs...> &lhs,
+                      basic_flat_hash_map<Layout, Al, K, Vs...> &rhs) noexcept
+{
+    lhs.swap(rhs);
+}
+
+namespace detail
+{
+template <class Vector>
+struct Deduce_map;
+template <class Al, class K, class... Vs>
+struct Deduce_map<vector_al<Al, K, Vs...>> {
+    using type = basic_flat_hash_map<layout::default_policy, Al, K, Vs...>;
+};
+template <class Layout, class Al, class K, class... Vs>
+struct Deduce_map<basic_vector<Layout, Al, K, Vs...>> {
+    using type = basic_flat_hash_map<Layout, Al, K, Vs...>;
+};
+} // namespace detail
+
+//
+// flat_hash_map<K, Vs..., [Allocator], [Layout]> like vector
+//
+template <class K, class... Vs>
+using flat_hash_map = typename detail::Deduce_map<
+    detail::Deduce_vec<boost::mp11::mp_list<K, Vs...>>>::type;
+
+} // namespace dori
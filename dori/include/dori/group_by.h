@@ -0,0 +1,474 @@
+#pragma once
+
+//
+// Aggregation over the rows of a vector grouped by the value of a column:
+//
+//   auto r = dori::group_by<0>(v).aggregate<dori::sum<2>, dori::count>();
+//   // dori::vector<K, S, std::size_t>, a row per distinct key of column 0
+//
+// The groups are built in a vector of keys and accumulators, indexed by an
+// open-addressed table of 8-byte slots that hold the upper half of the hash of
+// the key and the row of its group. Probes compare the hashes before the keys,
+// so a probe reads the key of another group seldom, and the table is kept at
+// most half full. Groups come in the order their keys first appear.
+//
+// Past Hash_groups_max groups, if most rows so far have started a group, the
+// table has outgrown the cache and nearly every probe misses. For keys and
+// inputs that are trivially copyable, the rows are then sorted by bits of the
+// hash of their keys into partitions in one radix pass, and each partition is
+// hashed on its own with a table that stays in cache. The groups then come by
+// partition.
+//
+// parallel_aggregate() aggregates chunks of rows in parallel and merges the
+// partial results in chunk order. unique_by<K>(v) keeps the first row of each
+// key.
+//
+
+#include "aggregate.h"
+#include "detail/assert.h"
+#include "detail/hash.h"
+#include "detail/inline.h"
+#include "parallel.h"
+#include "vector.h"
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace dori
+{
+
+namespace detail
+{
+
+// Groups past which high-cardinality keys are partitioned rather than hashed
+// whole; the table of twice the slots and the groups outgrow L2 by then
+inline constexpr std::size_t Hash_groups_max = std::size_t{1} << 18;
+
+// Rows per partition aimed for, such that a partition's groups and their table
+// stay in L2
+inline constexpr std::size_t Partition_rows = std::size_t{1} << 14;
+
+//
+// Open-addressed index of groups by the hash of their keys. A slot holds the
+// upper half of the hash and one past the index of the group, and is 0 if
+// empty; the slot of a hash is its upper bits, so the table is grown without
+// the keys.
+//
+class Group_table
+{
+  public:
+    Group_table() { Resize(16); }
+
+    // Empties the table, sizing it for up to n groups
+    void Reset(std::size_t n)
+    {
+        n_ = 0;
+        n  = std::max(std::bit_ceil(n * 2), std::size_t{16});
+        if (n == slots_.size())
+            std::fill(slots_.begin(), slots_.end(), 0);
+        else {
+            slots_.clear();
+            Resize(n);
+        }
+    }
+
+    //
+    // Index of the group of a key of hash h for which eq(index) holds, or
+    // make() of a new one.
+    //
+    template <class Eq, class Make>
+    DORI_inline std::uint32_t Find_or_insert(std::uint64_t h, Eq eq,
+                                             Make make)
+    {
+        const auto tag = static_cast<std::uint32_t>(h >> 32);
+        for (auto i = tag >> shift_;; i = (i + 1) & mask_) {
+            const auto s = slots_[i];
+            if (!s) {
+                const std::uint32_t g = make();
+                slots_[i] = std::uint64_t{tag} << 32 | (g + 1);
+                if (++n_ * 2 > slots_.size())
+                    Resize(slots_.size() * 2);
+                return g;
+            }
+            if (static_cast<std::uint32_t>(s >> 32) == tag &&
+                eq(static_cast<std::uint32_t>(s) - 1))
+                return static_cast<std::uint32_t>(s) - 1;
+        }
+    }
+
+    // Starts fetching the slot of hash h
+    DORI_inline void Prefetch([[maybe_unused]] std::uint64_t h) const noexcept
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(&slots_[static_cast<std::uint32_t>(h >> 32) >>
+                                   shift_]);
+#endif
+    }
+
+    std::size_t size() const noexcept { return n_; }
+
+  private:
+    void Resize(std::size_t n)
+    {
+        DORI_assert(n <= (std::uint64_t{1} << 32) && "too many groups");
+        std::vector<std::uint64_t> old(n);
+        old.swap(slots_);
+        mask_  = static_cast<std::uint32_t>(n - 1);
+        shift_ = 32 - std::countr_zero(n);
+        for (const auto s : old)
+            if (s)
+                for (auto i = static_cast<std::uint32_t>(s >> 32) >> shift_;;
+                     i      = (i + 1) & mask_)
+                    if (!slots_[i]) {
+                        slots_[i] = s;
+                        break;
+                    }
+    }
+
+    std::vector<std::uint64_t> slots_;
+    std::size_t n_      = 0;
+    std::uint32_t mask_ = 0;
+    int shift_          = 32;
+};
+
+//
+// Builds the groups of the rows of a V by its column K: a row of result_type
+// holds a key and the accumulators of each aggregate in As.
+//
+template <class V, std::size_t K, class... As>
+class Grouper
+{
+    using Key = Column_t<V, K>;
+    using Js  = std::index_sequence_for<As...>;
+
+    // Rows hashed ahead of their probes, so that the slots are fetched
+    // together
+    static constexpr std::size_t Batch = 16;
+
+    // A row of a partition: its key and the inputs of the aggregates
+    struct Row {
+        Key k;
+        std::tuple<typename As::input...> in;
+    };
+    // Storage for rows, constructed as they're scattered to partitions
+    struct Rows {
+        explicit Rows(std::size_t n)
+            : p{std::allocator<Row>{}.allocate(n)}, n{n}
+        {
+        }
+        Rows(const Rows &) = delete;
+        ~Rows() { std::allocator<Row>{}.deallocate(p, n); }
+        Row *p;
+        std::size_t n;
+    };
+
+  public:
+    using result_type = dori::vector<Key, typename As::type...>;
+
+    // Whether rows can be copied to partitions cheaply
+    static constexpr bool Partitionable =
+        std::is_trivially_copyable_v<Key> &&
+        (... && std::is_trivially_copyable_v<typename As::input>);
+
+    explicit Grouper(std::size_t groups = 64)
+    {
+        res_.reserve(std::max(groups, std::size_t{1}));
+        Refresh(Js{});
+    }
+
+    //
+    // Folds in rows first..last of v. Returns false, having stopped early, if
+    // the groups are better built by Partitioned().
+    //
+    bool Add(const V &v, std::size_t first, std::size_t last)
+    {
+        const auto keys = v.template data<K>();
+        const std::tuple cols{As::Column(v)...};
+        std::uint64_t hs[Batch];
+        for (auto b = first; b < last; b += Batch) {
+            const auto e = std::min(b + Batch, last);
+            for (auto i = b; i != e; ++i) {
+                hs[i - b] = Hash_key(Column_at(keys, i));
+                table_.Prefetch(hs[i - b]);
+            }
+            for (auto i = b; i != e; ++i) {
+                Insert(hs[i - b], Column_at(keys, i), cols, i, Js{});
+                if constexpr (Partitionable)
+                    if (res_.size() > Hash_groups_max &&
+                        res_.size() * 2 > i - first + 1)
+                        return false;
+            }
+        }
+        return true;
+    }
+
+    //
+    // Builds the groups of rows first..last of v partition by partition: the
+    // rows are copied out to partitions by bits of the hash of their keys, so
+    // that no two partitions share a key, and then each is hashed with a table
+    // that stays in cache. The groups come by partition.
+    //
+    static result_type Partitioned(const V &v, std::size_t first,
+                                   std::size_t last)
+    {
+        const auto keys = v.template data<K>();
+        const std::tuple cols{As::Column(v)...};
+        const auto n = last - first;
+        const auto bits =
+            std::clamp<int>(std::bit_width(n / Partition_rows), 1, 10);
+        const auto part = [bits](std::uint64_t h) noexcept {
+            return static_cast<std::size_t>(h >> 16) &
+                   ((std::size_t{1} << bits) - 1);
+        };
+
+        std::vector<std::size_t> off((std::size_t{1} << bits) + 1);
+        for (auto i = first; i != last; ++i)
+            ++off[part(Hash_key(Column_at(keys, i))) + 1];
+        for (std::size_t p = 1; p < off.size(); ++p)
+            off[p] += off[p - 1];
+        const Rows rows{n};
+        {
+            std::vector<std::size_t> pos(off.begin(), off.end() - 1);
+            for (auto i = first; i != last; ++i)
+                Copy_row(rows.p + pos[part(Hash_key(Column_at(keys, i)))]++,
+                         keys, cols, i, Js{});
+        }
+
+        Grouper res;
+        for (std::size_t p = 0; p + 1 < off.size(); ++p) {
+            res.table_.Reset(off[p + 1] - off[p]);
+            for (auto j = off[p]; j != off[p + 1]; ++j)
+                res.Insert(Hash_key(rows.p[j].k), rows.p[j].k, rows.p[j].in,
+                           Js{});
+        }
+        return res.take();
+    }
+
+    // Folds in the groups of a partial result
+    void Merge(result_type &&part)
+    {
+        const auto keys = part.template data<0>();
+        for (std::size_t g = 0; g < part.size(); ++g) {
+            bool added    = false;
+            const auto to = table_.Find_or_insert(
+                Hash_key(keys[g]),
+                [&](std::uint32_t h) { return keys_[h] == keys[g]; },
+                [&] {
+                    added = true;
+                    return Move_from(part, g, Js{});
+                });
+            if (!added)
+                Merge_from(to, part, g, Js{});
+        }
+    }
+
+    result_type take() noexcept { return std::move(res_); }
+
+  private:
+    // Folds row i of cols, of key k of hash h, into its group
+    template <class... Ps, std::size_t... Is>
+    DORI_inline void Insert(std::uint64_t h, const Key &k,
+                            const std::tuple<Ps...> &cols, std::size_t i,
+                            std::index_sequence<Is...>)
+    {
+        bool added   = false;
+        const auto g = table_.Find_or_insert(
+            h, [&](std::uint32_t g) { return keys_[g] == k; },
+            [&] {
+                added = true;
+                return Push(k, As::First(Column_at(std::get<Is>(cols), i))...);
+            });
+        if (!added)
+            (..., As::Add(std::get<Is>(accs_)[g],
+                          Column_at(std::get<Is>(cols), i)));
+    }
+    // Folds inputs in, of key k of hash h, into its group
+    template <std::size_t... Is>
+    DORI_inline void Insert(std::uint64_t h, const Key &k,
+                            const std::tuple<typename As::input...> &in,
+                            std::index_sequence<Is...>)
+    {
+        bool added   = false;
+        const auto g = table_.Find_or_insert(
+            h, [&](std::uint32_t g) { return keys_[g] == k; },
+            [&] {
+                added = true;
+                return Push(k, As::First(std::get<Is>(in))...);
+            });
+        if (!added)
+            (..., As::Add(std::get<Is>(accs_)[g], std::get<Is>(in)));
+    }
+
+    template <class P, class... Ps, std::size_t... Is>
+    static DORI_inline void Copy_row(Row *r, P keys,
+                                     const std::tuple<Ps...> &cols,
+                                     std::size_t i, std::index_sequence<Is...>)
+    {
+        std::construct_at(r, Column_at(keys, i),
+                          std::tuple{Column_at(std::get<Is>(cols), i)...});
+    }
+
+    // Appends a group, returning its index
+    template <class... Us>
+    DORI_inline std::uint32_t Push(Us &&...xs)
+    {
+        if (res_.size() == res_.capacity()) {
+            res_.reserve(res_.capacity() * 2);
+            Refresh(Js{});
+        }
+        res_.push_back(static_cast<Us &&>(xs)...);
+        return static_cast<std::uint32_t>(res_.size() - 1);
+    }
+
+    template <std::size_t... Is>
+    DORI_inline std::uint32_t Move_from(result_type &part, std::size_t g,
+                                        std::index_sequence<Is...>)
+    {
+        return Push(std::move(part.template data<0>()[g]),
+                    std::move(part.template data<1 + Is>()[g])...);
+    }
+
+    template <std::size_t... Is>
+    DORI_inline void Merge_from(std::uint32_t to, const result_type &part,
+                                std::size_t g, std::index_sequence<Is...>)
+    {
+        (..., As::Merge(std::get<Is>(accs_)[to],
+                        part.template data<1 + Is>()[g]));
+    }
+
+    // Points keys_ and accs_ at the storage of res_
+    template <std::size_t... Is>
+    DORI_inline void Refresh(std::index_sequence<Is...>) noexcept
+    {
+        keys_ = res_.template data<0>();
+        accs_ = {res_.template data<1 + Is>()...};
+    }
+
+    result_type res_;
+    Key *keys_;
+    std::tuple<typename As::type *...> accs_;
+    Group_table table_;
+};
+
+template <class V, std::size_t K, class... As>
+typename Grouper<V, K, As...>::result_type
+Aggregate(const V &v, std::size_t first, std::size_t last)
+{
+    using G = Grouper<V, K, As...>;
+    if (first == last)
+        return {};
+    G g;
+    if (!g.Add(v, first, last))
+        return G::Partitioned(v, first, last);
+    return g.take();
+}
+
+} // namespace detail
+
+//
+// Rows of a vector grouped by the value of its column K; see group_by()
+//
+template <class V, std::size_t K>
+class grouping
+{
+  public:
+    constexpr DORI_inline explicit grouping(const V &v) noexcept : v_{&v} {}
+
+    //
+    // A vector of a row per group, holding its key followed by the value of
+    // each aggregate in As over the rows of the group.
+    //
+    template <class... As>
+    auto aggregate() const
+    {
+        return detail::Aggregate<V, K, detail::Agg<As, V>...>(*v_, 0,
+                                                             v_->size());
+    }
+
+    //
+    // Like aggregate(), but chunks of about grain rows are aggregated in
+    // parallel and their groups merged in chunk order.
+    //
+    template <class... As>
+    auto parallel_aggregate(thread_pool &pool, std::size_t grain) const
+    {
+        using G  = detail::Grouper<V, K, detail::Agg<As, V>...>;
+        grain    = detail::Round_grain<V>(grain);
+        const auto sz = v_->size();
+        std::vector<std::optional<typename G::result_type>> parts(
+            (sz + grain - 1) / grain);
+        pool.run(parts.size(), [&](std::size_t i) {
+            const auto first = i * grain;
+            parts[i].emplace(detail::Aggregate<V, K, detail::Agg<As, V>...>(
+                *v_, first, std::min(first + grain, sz)));
+        });
+        G res;
+        for (auto &x : parts)
+            res.Merge(std::move(*x));
+        return res.take();
+    }
+    template <class... As>
+    auto parallel_aggregate(std::size_t grain) const
+    {
+        return parallel_aggregate<As...>(thread_pool::global(), grain);
+    }
+
+  private:
+    const V *v_;
+};
+
+//
+// Groups the rows of v by column K for aggregate():
+//
+//   dori::group_by<0>(v).aggregate<dori::sum<2>, dori::max<3>>()
+//
+template <std::size_t K, class V>
+requires(K < std::tuple_size_v<typename V::value_type>) //
+    constexpr DORI_inline grouping<V, K> group_by(const V &v) noexcept
+{
+    return grouping<V, K>{v};
+}
+
+//
+// A copy of v with only the first row of each value of column K, in the order
+// of v.
+//
+template <std::size_t K, class V>
+requires(K < std::tuple_size_v<typename V::value_type>) //
+    V unique_by(const V &v)
+{
+    V res;
+    if (v.empty())
+        return res;
+    const auto keys = v.template data<K>();
+    detail::Group_table table;
+    for (std::size_t i = 0; i < v.size(); ++i) {
+        const auto &k = detail::Column_at(keys, i);
+        table.Find_or_insert(
+            detail::Hash_key(k),
+            [&](std::uint32_t g) {
+                return detail::Column_at(res.template data<K>(), g) == k;
+            },
+            [&] {
+                std::apply(
+                    [&](const auto &...xs) {
+                        detail::Grow_push_back(res, xs...);
+                    },
+                    v[i]);
+                return static_cast<std::uint32_t>(res.size() - 1);
+            });
+    }
+    return res;
+}
+
+} // namespace dori
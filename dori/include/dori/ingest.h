@@ -0,0 +1,379 @@
+#pragma once
+
+//
+// Parallel loading of text and binary records into the columns of a vector:
+//
+//   dori::ingest::csv(v, text, {.delimiter = ';', .header = true});
+//   dori::ingest::records(v, bytes, sizeof(rec), {offsetof(rec, id), ...});
+//
+// csv() splits the text at line breaks into chunks of about chunk_bytes and
+// parses them on a thread pool. The separators of a chunk are found 64 bytes
+// at a time as a bitmask (with SSE2 if available), and each field is parsed
+// straight into a column segment of the chunk, without building rows. Once
+// all chunks are parsed, the segments are appended to the vector a column at
+// a time, by one memcpy() per segment for trivially copyable columns. If a
+// field doesn't parse, std::invalid_argument is thrown and the vector is left
+// as it was.
+//
+// Fields are parsed with std::from_chars() for numbers, as 0, 1, false, or
+// true for bools, and as the text between separators for strings; there is no
+// quoting, so fields may not hold the delimiter or line breaks. Blank lines
+// are skipped and a \r before a line break is dropped.
+//
+// records() copies fixed-size binary records, each column from its byte offset
+// in the record, in chunks of rows in parallel straight into the vector. The
+// chunks are split as parallel_for_each_chunk() splits them, so in a vector
+// whose columns start on cache lines no two write to the same line; see
+// parallel.h.
+//
+
+#include "aos.h"
+#include "detail/assert.h"
+#include "detail/inline.h"
+#include "packed.h"
+#include "parallel.h"
+#include "vector.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace dori::ingest
+{
+
+struct csv_options {
+    char delimiter = ',';
+    // Whether the first line names the columns, and is to be skipped
+    bool header = false;
+    // Bytes of text per chunk parsed by a thread
+    std::size_t chunk_bytes = std::size_t{1} << 20;
+};
+
+namespace detail
+{
+
+using namespace ::dori::detail;
+
+//
+// Finds the bytes a and b in p..e in order, scanning 64 bytes at a time into
+// a mask of the bytes matched
+//
+class Separators
+{
+  public:
+    Separators(const char *p, const char *e, char a, char b) noexcept
+        : p_{p}, e_{e}, a_{a}, b_{b}
+    {
+        Scan();
+    }
+
+    // The next of a or b, or e
+    DORI_inline const char *next() noexcept
+    {
+        while (!m_) {
+            p_ += 64;
+            if (p_ >= e_)
+                return e_;
+            Scan();
+        }
+        const auto res = p_ + std::countr_zero(m_);
+        m_ &= m_ - 1;
+        return res;
+    }
+
+  private:
+    DORI_inline void Scan() noexcept
+    {
+        if (e_ - p_ >= 64)
+            m_ = Mask(p_);
+        else {
+            // The tail, padded with a byte that is neither a nor b
+            char buf[64];
+            std::memset(buf, a_ == 0 || b_ == 0 ? 1 : 0, sizeof(buf));
+            std::memcpy(buf, p_, static_cast<std::size_t>(e_ - p_));
+            m_ = Mask(buf);
+        }
+    }
+
+    DORI_inline std::uint64_t Mask(const char *p) const noexcept
+    {
+#ifdef __SSE2__
+        const auto va = _mm_set1_epi8(a_), vb = _mm_set1_epi8(b_);
+        std::uint64_t res = 0;
+        for (int i = 0; i < 4; ++i) {
+            const auto x = _mm_loadu_si128(
+                reinterpret_cast<const __m128i *>(p + 16 * i));
+            const auto m = _mm_movemask_epi8(
+                _mm_or_si128(_mm_cmpeq_epi8(x, va), _mm_cmpeq_epi8(x, vb)));
+            res |= std::uint64_t{static_cast<std::uint16_t>(m)} << 16 * i;
+        }
+        return res;
+#else
+        std::uint64_t res = 0;
+        for (int i = 0; i < 64; ++i)
+            res |= std::uint64_t{p[i] == a_ || p[i] == b_} << i;
+        return res;
+#endif
+    }
+
+    const char *p_;
+    const char *e_;
+    char a_, b_;
+    std::uint64_t m_ = 0;
+};
+
+[[noreturn]] inline void Bad_field(const char *what, std::size_t at)
+{
+    throw std::invalid_argument{std::string{"dori::ingest::csv: "} + what +
+                                " at byte " + std::to_string(at)};
+}
+
+// Parses the field f..l into a T; at is its offset for errors
+template <class T>
+T Parse(const char *f, const char *l, std::size_t at)
+{
+    if constexpr (std::is_same_v<T, bool>) {
+        const std::string_view s{f, static_cast<std::size_t>(l - f)};
+        if (s == "1" || s == "true")
+            return true;
+        if (s != "0" && s != "false")
+            Bad_field("bad bool", at);
+        return false;
+    } else if constexpr (std::is_arithmetic_v<T>) {
+        T res{};
+        const auto [p, ec] = std::from_chars(f, l, res);
+        if (ec != std::errc{} || p != l)
+            Bad_field("bad number", at);
+        return res;
+    } else {
+        static_assert(std::is_constructible_v<T, std::string_view>,
+                      "columns must be numbers, bools, or strings");
+        return T(std::string_view{f, static_cast<std::size_t>(l - f)});
+    }
+}
+
+// Element of a segment of a column of values of type T
+template <class T>
+using Seg_value = std::conditional_t<std::is_same_v<T, bool>, char, T>;
+
+// The values of each column Ts parsed from a chunk
+template <class... Ts>
+using Segment = std::tuple<std::vector<Seg_value<Ts>>...>;
+
+// Parses the lines of p..e, offset at bytes into the text, into s
+template <class... Ts>
+void Parse_chunk(const char *p, const char *e, std::size_t at, char delim,
+                 Segment<Ts...> &s)
+{
+    constexpr auto N = sizeof...(Ts);
+    Separators seps{p, e, delim, '\n'};
+    const auto base = p - at;
+    const auto off  = [&](const char *x) {
+        return static_cast<std::size_t>(x - base);
+    };
+    while (p < e) {
+        if (*p == '\n' || (*p == '\r' && e - p > 1 && p[1] == '\n')) {
+            p = seps.next() + 1;
+            continue;
+        }
+        [&]<std::size_t... Is>(std::index_sequence<Is...>)
+        {
+            (..., [&] {
+                const auto x = seps.next();
+                auto l       = x;
+                if constexpr (Is + 1 < N) {
+                    if (x == e || *x != delim)
+                        Bad_field("too few fields", off(x));
+                } else {
+                    if (x != e && *x != '\n')
+                        Bad_field("too many fields", off(x));
+                    if (l != p && l[-1] == '\r')
+                        --l;
+                }
+                std::get<Is>(s).push_back(
+                    Parse<mp_at_c<mp_list<Ts...>, Is>>(p, l, off(p)));
+                p = x + 1;
+            }());
+        }
+        (std::index_sequence_for<Ts...>{});
+    }
+}
+
+// Copies n values of type T of a segment from s to column d
+template <class T, class P>
+DORI_inline void Copy_segment(P d, const Seg_value<T> *s,
+                              std::size_t n) noexcept
+{
+    if constexpr (std::is_same_v<P, T *> && std::is_trivially_copyable_v<T>) {
+        if (n)
+            std::memcpy(d, s, n * sizeof(T));
+    } else
+        for (std::size_t i = 0; i < n; ++i)
+            d[i] = static_cast<T>(s[i]);
+}
+
+} // namespace detail
+
+//
+// Appends the rows of CSV text to v, parsing chunks of it on pool; see above
+//
+template <class V>
+void csv(thread_pool &pool, V &v, std::string_view text, csv_options opt = {})
+{
+    DORI_assert(opt.delimiter != '\n');
+
+    // Chunks end after a line break, or at the end of the text
+    std::vector<const char *> ends;
+    const auto e = text.data() + text.size();
+    auto p       = text.data();
+    if (opt.header) {
+        const auto nl = std::find(p, e, '\n');
+        p             = nl == e ? e : nl + 1;
+    }
+    const auto first = p;
+    while (p != e) {
+        if (static_cast<std::size_t>(e - p) <= opt.chunk_bytes)
+            p = e;
+        else {
+            const auto nl = static_cast<const char *>(
+                std::memchr(p + opt.chunk_bytes, '\n',
+                            static_cast<std::size_t>(e - p) - opt.chunk_bytes));
+            p = nl ? nl + 1 : e;
+        }
+        ends.push_back(p);
+    }
+
+    using Row = typename V::value_type;
+    [&]<std::size_t... Is>(std::index_sequence<Is...>)
+    {
+        using Seg = detail::Segment<std::tuple_element_t<Is, Row>...>;
+        std::vector<Seg> segs(ends.size());
+        pool.run(segs.size(), [&](std::size_t i) {
+            const auto f = i ? ends[i - 1] : first;
+            detail::Parse_chunk<std::tuple_element_t<Is, Row>...>(
+                f, ends[i], static_cast<std::size_t>(f - text.data()),
+                opt.delimiter, segs[i]);
+        });
+
+        std::size_t n = 0;
+        for (const auto &s : segs)
+            n += std::get<0>(s).size();
+        if (!n)
+            return;
+        if constexpr ((... && std::is_trivially_copyable_v<
+                                  std::tuple_element_t<Is, Row>>))
+            detail::Bulk_ops::Append(
+                v, n,
+                [&](auto... ps) {
+                    std::size_t k = 0;
+                    for (const auto &s : segs) {
+                        const auto m = std::get<0>(s).size();
+                        (..., detail::Copy_segment<
+                                  std::tuple_element_t<Is, Row>>(
+                                  ps + k, std::get<Is>(s).data(), m));
+                        k += m;
+                    }
+                },
+                std::index_sequence<Is...>{});
+        else {
+            detail::Bulk_ops::Grow(v, n);
+            for (auto &s : segs)
+                for (std::size_t i = 0; i < std::get<0>(s).size(); ++i)
+                    v.push_back(std::move(std::get<Is>(s)[i])...);
+        }
+    }
+    (std::make_index_sequence<std::tuple_size_v<Row>>{});
+}
+template <class V>
+void csv(V &v, std::string_view text, csv_options opt = {})
+{
+    csv(thread_pool::global(), v, text, opt);
+}
+
+//
+// Appends to v the records of record_size bytes in data, column I of each
+// being the bytes at offsets[I], copied in parallel on pool. Columns are
+// trivially copyable and not packed. Throws std::invalid_argument if data
+// doesn't hold whole records or a column doesn't fit in one.
+//
+template <class V, std::size_t N>
+requires(N == std::tuple_size_v<typename V::value_type>) //
+    void records(thread_pool &pool, V &v, std::span<const std::byte> data,
+                 std::size_t record_size,
+                 const std::array<std::size_t, N> &offsets)
+{
+    if (!record_size || data.size() % record_size)
+        throw std::invalid_argument{
+            "dori::ingest::records: data isn't whole records"};
+    const auto n = data.size() / record_size;
+    if (!n)
+        return;
+    [&]<std::size_t... Is>(std::index_sequence<Is...>)
+    {
+        using Cols = detail::mp_list<decltype(v.template data<Is>())...>;
+        static_assert(
+            (... && (std::is_pointer_v<detail::mp_at_c<Cols, Is>> &&
+                     std::is_trivially_copyable_v<
+                         std::remove_pointer_t<detail::mp_at_c<Cols, Is>>>)),
+            "columns must be trivially copyable and not packed");
+        constexpr std::array<std::size_t, N> sizes{
+            sizeof(*std::declval<detail::mp_at_c<Cols, Is>>())...};
+        for (std::size_t i = 0; i < N; ++i)
+            if (offsets[i] > record_size || sizes[i] > record_size - offsets[i])
+                throw std::invalid_argument{
+                    "dori::ingest::records: column past the record"};
+
+        //
+        // Chunks of about a MiB of records, split at rows of v that are
+        // multiples of a cache line's worth of rows in every column, counting
+        // the rows already there, as parallel_for_each_chunk() splits them;
+        // these rows start on lines if the columns do
+        //
+        const auto grain =
+            (std::max<std::size_t>((std::size_t{1} << 20) / record_size, 1) +
+             cache_line - 1) /
+            cache_line * cache_line;
+        const auto base = v.size(), c0 = base / grain;
+        detail::Bulk_ops::Append(
+            v, n,
+            [&](auto... ps) {
+                pool.run((base + n - 1) / grain + 1 - c0, [&](std::size_t c) {
+                    const auto f = std::max((c0 + c) * grain, base) - base;
+                    const auto l =
+                        std::min((c0 + c + 1) * grain, base + n) - base;
+                    auto s = data.data() + f * record_size;
+                    for (auto i = f; i < l; ++i, s += record_size)
+                        (..., std::memcpy(ps + i, s + offsets[Is],
+                                          sizeof(*ps)));
+                });
+            },
+            std::make_index_sequence<N>{});
+    }
+    (std::make_index_sequence<N>{});
+}
+template <class V, std::size_t N>
+requires(N == std::tuple_size_v<typename V::value_type>) //
+    void records(V &v, std::span<const std::byte> data,
+                 std::size_t record_size,
+                 const std::array<std::size_t, N> &offsets)
+{
+    records(thread_pool::global(), v, data, record_size, offsets);
+}
+
+} // namespace dori::ingest
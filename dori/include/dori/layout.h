@@ -0,0 +1,155 @@
+#pragma once
+
+//
+// Layout policies decide the order in which the element sequences of a vector
+// are stored in its allocation. A policy is a type deriving from policy with a
+// member function template `order<Ts...>()` returning the declared indices of
+// Ts in storage order; from that, the offset and redirection arrays of the
+// vector are computed (see detail/vector_layout.h).
+//
+// Sequence I starts at `Offsets[I] * capacity()` bytes into the allocation. If
+// the order is such that this isn't a multiple of the alignment of every
+// element type for every capacity, the capacity is rounded up to a multiple of
+// `granularity` instead, and the rows thus gained are the padding of the
+// layout. info<Vector> reports these properties at compile time.
+//
+
+#include "detail/traits.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <numeric>
+#include <tuple>
+#include <utility>
+
+namespace dori::layout
+{
+
+struct policy {
+};
+
+//
+// Sort by descending size. Ties are broken by type name, which makes the order
+// of e.g. vector<i32, i64> and vector<i64, i32> match.
+//
+struct by_size : policy {
+    template <class... Ts>
+    static constexpr auto order()
+    {
+        return []<std::size_t... Is>(std::index_sequence<Is...>)
+        {
+            std::array xs{
+                std::tuple{sizeof(Ts), detail::Get_type_name<Ts>(), Is}...};
+            std::sort(xs.begin(), xs.end(), std::greater<>{});
+            return std::array{std::get<2>(xs[Is])...};
+        }
+        (std::index_sequence_for<Ts...>{});
+    }
+};
+
+//
+// Sort by descending alignment, then descending size, and then by type name.
+// With this order no rounding of capacity is ever needed.
+//
+struct by_alignment : policy {
+    template <class... Ts>
+    static constexpr auto order()
+    {
+        return []<std::size_t... Is>(std::index_sequence<Is...>)
+        {
+            std::array xs{std::tuple{alignof(Ts), sizeof(Ts),
+                                     detail::Get_type_name<Ts>(), Is}...};
+            std::sort(xs.begin(), xs.end(), std::greater<>{});
+            return std::array{std::get<3>(xs[Is])...};
+        }
+        (std::index_sequence_for<Ts...>{});
+    }
+};
+
+//
+// Keep the order of declaration.
+//
+struct declared : policy {
+    template <class... Ts>
+    static constexpr auto order()
+    {
+        return []<std::size_t... Is>(std::index_sequence<Is...>)
+        {
+            return std::array{Is...};
+        }
+        (std::index_sequence_for<Ts...>{});
+    }
+};
+
+//
+// Assign a priority to each element type (in declaration order). Sequences of
+// equal priority are kept adjacent, and groups of lower priority value precede
+// those of higher value, e.g. grouped<0, 1, 0> places the first and the third
+// sequences (the hot ones) first. Within a group, by_alignment applies.
+//
+template <std::size_t... Prios>
+struct grouped : policy {
+    template <class... Ts>
+    static constexpr auto order()
+    {
+        static_assert(sizeof...(Prios) == sizeof...(Ts),
+                      "grouped<> needs a priority for each element type");
+        return []<std::size_t... Is>(std::index_sequence<Is...>)
+        {
+            std::array xs{std::tuple{Prios, alignof(Ts), sizeof(Ts),
+                                     detail::Get_type_name<Ts>(), Is}...};
+            std::sort(xs.begin(), xs.end(), [](const auto &a, const auto &b) {
+                // Ascending priority, otherwise like by_alignment
+                if (std::get<0>(a) != std::get<0>(b))
+                    return std::get<0>(a) < std::get<0>(b);
+                return std::tuple{std::get<1>(a), std::get<2>(a),
+                                  std::get<3>(a), std::get<4>(a)} >
+                       std::tuple{std::get<1>(b), std::get<2>(b),
+                                  std::get<3>(b), std::get<4>(b)};
+            });
+            return std::array{std::get<4>(xs[Is])...};
+        }
+        (std::index_sequence_for<Ts...>{});
+    }
+};
+
+using default_policy = by_size;
+
+//
+// Compile-time description of a vector's layout, e.g.
+// static_assert(dori::layout::info<V>::max_padding_bytes == 0).
+//
+template <class Vector>
+struct info {
+    // Declared indices of the element types in storage order
+    static constexpr auto order = Vector::Storage_order;
+    // Byte offset of each sequence (in storage order) per row of capacity
+    static constexpr auto offsets   = Vector::Storage_offsets;
+    // Bytes per row of the ordinary sequences, and bits per row of the packed
+    // ones (see packed.h)
+    static constexpr auto row_size     = Vector::Storage_row_size;
+    static constexpr auto bits_per_row = Vector::Storage_bits_per_row;
+    static constexpr auto alignment    = Vector::Storage_alignment;
+    // Capacity is always a multiple of this
+    static constexpr auto granularity = Vector::Storage_granularity;
+    // Size of the allocation for a given capacity
+    static constexpr std::size_t bytes(std::size_t cap) noexcept
+    {
+        return Vector::Storage_bytes(cap);
+    }
+    // Sequence I (declared) of an allocation p, a pointer to (const) bytes, of
+    // a given capacity
+    template <std::size_t I, class B>
+    static constexpr auto data(B *p, std::size_t cap) noexcept
+    {
+        return Vector::template Storage_data<I>(p, cap);
+    }
+    // Most rows (and bytes) a capacity can be rounded up by
+    static constexpr std::size_t max_padding_rows  = granularity - 1;
+    static constexpr std::size_t max_padding_bytes =
+        (max_padding_rows * (row_size * 8 + bits_per_row) + 7) / 8;
+};
+
+} // namespace dori::layout
@@ -0,0 +1,394 @@
+#pragma once
+
+//
+// Nullable columns. Giving dori::nullable<T> as an element type of a vector
+// stores a column of std::optional<T> as Arrow does: the values form an
+// ordinary sequence of T, and whether each row holds one is a bit of a
+// validity bitmap among the packed sequences (see packed.h). A column of
+// small T thus takes a bit per row over the values where std::optional<T>
+// would take as many bytes again, and scans of the values stay dense.
+//
+// Rows are read as std::optional<T> and written through nullable_ref, which
+// operator[] and iterators give; data<I>() and for_each() give nullable_ptr,
+// whose values() and validity() are the two sequences. Null rows hold T{}.
+// The kernels in dori::valid take the validity of rows into account a word of
+// the bitmap at a time, and take a dense path over the values when a column
+// has no nulls.
+//
+
+#include "aggregate.h"
+#include "detail/assert.h"
+#include "detail/inline.h"
+#include "packed.h"
+
+#include <algorithm>
+#include <bit>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <type_traits>
+
+namespace dori
+{
+
+// Element type for a column of T of which rows may be null
+template <class T>
+struct nullable {
+    static_assert(std::is_trivially_copyable_v<T> &&
+                      std::is_default_constructible_v<T>,
+                  "nullable columns hold trivially copyable values");
+    alignas(T) unsigned char bytes[sizeof(T)];
+};
+
+//
+// Reference to a row of a nullable column.
+//
+template <class T>
+class nullable_ref
+{
+  public:
+    constexpr DORI_inline nullable_ref(T *v, std::uint64_t *w,
+                                       unsigned sh) noexcept
+        : v_{v}, w_{w}, sh_{sh}
+    {
+    }
+
+    constexpr DORI_inline bool has_value() const noexcept
+    {
+        return (*w_ >> sh_) & 1;
+    }
+    constexpr DORI_inline operator std::optional<T>() const noexcept
+    {
+        if (has_value())
+            return *v_;
+        return std::nullopt;
+    }
+
+    constexpr DORI_inline const nullable_ref &
+    operator=(const std::optional<T> &x) const noexcept
+    {
+        *v_ = x ? *x : T{};
+        *w_ = (*w_ & ~(std::uint64_t{1} << sh_)) |
+              (std::uint64_t{x.has_value()} << sh_);
+        return *this;
+    }
+    constexpr DORI_inline const nullable_ref &
+    operator=(const nullable_ref &rhs) const noexcept
+    {
+        return *this = static_cast<std::optional<T>>(rhs);
+    }
+
+    friend constexpr DORI_inline bool
+    operator==(const nullable_ref &a, const std::optional<T> &b) noexcept
+    {
+        return static_cast<std::optional<T>>(a) == b;
+    }
+
+    friend constexpr DORI_inline void swap(const nullable_ref &a,
+                                           const nullable_ref &b) noexcept
+    {
+        const std::optional<T> x = a;
+        a                        = b;
+        b                        = x;
+    }
+
+  private:
+    T *v_;
+    std::uint64_t *w_;
+    unsigned sh_;
+};
+
+//
+// Random-access iterator over a nullable column; stands in for a pointer.
+//
+template <class T, bool Const = false>
+class nullable_ptr
+{
+    using Value = std::conditional_t<Const, const T, T>;
+    using Word  = std::conditional_t<Const, const std::uint64_t, std::uint64_t>;
+
+  public:
+    using value_type        = std::optional<T>;
+    using difference_type   = std::ptrdiff_t;
+    using reference         = std::conditional_t<Const, std::optional<T>,
+                                         nullable_ref<T>>;
+    using pointer           = void;
+    using iterator_category = std::random_access_iterator_tag;
+
+    constexpr DORI_inline nullable_ptr() noexcept = default;
+    constexpr DORI_inline nullable_ptr(Value *values, Word *words,
+                                       difference_type i = 0) noexcept
+        : v_{values}, w_{words}, i_{i}
+    {
+    }
+    constexpr DORI_inline operator nullable_ptr<T, true>() const noexcept
+    {
+        return {v_, w_, i_};
+    }
+
+    // The values and the validity bits of the rows from row 0, and the row
+    // this points to
+    constexpr DORI_inline Value *values() const noexcept { return v_; }
+    constexpr DORI_inline packed_ptr<bool, 1, Const> validity() const noexcept
+    {
+        return {w_, i_};
+    }
+    constexpr DORI_inline difference_type index() const noexcept { return i_; }
+
+    constexpr DORI_inline reference operator[](difference_type n) const noexcept
+    {
+        DORI_assert(i_ + n >= 0);
+        const auto i  = static_cast<std::size_t>(i_ + n);
+        const auto w  = w_ + i / 64;
+        const auto sh = static_cast<unsigned>(i % 64);
+        if constexpr (Const) {
+            if ((*w >> sh) & 1)
+                return v_[i];
+            return std::nullopt;
+        } else
+            return {v_ + i, w, sh};
+    }
+    constexpr DORI_inline reference operator*() const noexcept
+    {
+        return (*this)[0];
+    }
+
+    constexpr DORI_inline nullable_ptr &operator++() noexcept
+    {
+        return ++i_, *this;
+    }
+    constexpr DORI_inline nullable_ptr operator++(int) noexcept
+    {
+        return {v_, w_, i_++};
+    }
+    constexpr DORI_inline nullable_ptr &operator--() noexcept
+    {
+        return --i_, *this;
+    }
+    constexpr DORI_inline nullable_ptr operator--(int) noexcept
+    {
+        return {v_, w_, i_--};
+    }
+    constexpr DORI_inline nullable_ptr &operator+=(difference_type n) noexcept
+    {
+        return i_ += n, *this;
+    }
+    constexpr DORI_inline nullable_ptr &operator-=(difference_type n) noexcept
+    {
+        return i_ -= n, *this;
+    }
+    friend constexpr DORI_inline nullable_ptr
+    operator+(nullable_ptr p, difference_type n) noexcept
+    {
+        return p += n;
+    }
+    friend constexpr DORI_inline nullable_ptr operator+(difference_type n,
+                                                        nullable_ptr p) noexcept
+    {
+        return p += n;
+    }
+    friend constexpr DORI_inline nullable_ptr
+    operator-(nullable_ptr p, difference_type n) noexcept
+    {
+        return p -= n;
+    }
+    friend constexpr DORI_inline difference_type
+    operator-(const nullable_ptr &a, const nullable_ptr &b) noexcept
+    {
+        DORI_assert(a.w_ == b.w_);
+        return a.i_ - b.i_;
+    }
+    friend constexpr DORI_inline bool operator==(const nullable_ptr &a,
+                                                 const nullable_ptr &b) noexcept
+    {
+        return a.w_ == b.w_ && a.i_ == b.i_;
+    }
+    friend constexpr DORI_inline auto
+    operator<=>(const nullable_ptr &a, const nullable_ptr &b) noexcept
+    {
+        DORI_assert(a.w_ == b.w_);
+        return a.i_ <=> b.i_;
+    }
+
+  private:
+    Value *v_          = nullptr;
+    Word *w_           = nullptr;
+    difference_type i_ = 0;
+};
+
+namespace detail
+{
+template <class T>
+struct Is_nullable_ptr_impl : std::false_type {
+};
+template <class T, bool Const>
+struct Is_nullable_ptr_impl<nullable_ptr<T, Const>> : std::true_type {
+};
+template <class T>
+inline constexpr bool Is_nullable_ptr = Is_nullable_ptr_impl<T>::value;
+
+// Copies rows 0..n between sequences of equal capacity granularity
+template <class T, bool Const>
+constexpr DORI_inline void Nullable_copy(nullable_ptr<T> d,
+                                         nullable_ptr<T, Const> s,
+                                         std::size_t n) noexcept
+{
+    DORI_assert(!d.index() && !s.index());
+    std::copy_n(s.values(), n, d.values());
+    Packed_copy(d.validity(), s.validity(), n);
+}
+} // namespace detail
+
+//
+// Kernels over nullable columns of n rows, skipping the null ones. Each word
+// of the validity bitmap selects the values of its 64 rows: all of them if it
+// is all ones, none if zero, and those of its set bits otherwise. A column
+// with no nulls is scanned as a plain array.
+//
+namespace valid
+{
+
+namespace detail
+{
+using namespace ::dori::detail;
+using ::dori::mask::detail::Tail;
+
+// Calls f(i, k) for each run i..i + k of rows all valid, and g(i, k, m) for
+// each other run of rows of a word with any valid, m being their validity
+template <class T, bool Const, class F, class G>
+DORI_inline void Each_word(nullable_ptr<T, Const> p, std::size_t n, F &&f,
+                           G &&g)
+{
+    DORI_assert(p.index() % 64 == 0 && "kernels need a word-aligned start");
+    if (!n)
+        return;
+    if (mask::all(p.validity(), n)) {
+        f(std::size_t{0}, n);
+        return;
+    }
+    const auto w  = p.validity().words() + p.index() / 64;
+    const auto nw = (n + 63) / 64;
+    for (std::size_t k = 0; k < nw; ++k) {
+        const auto m = k + 1 == nw ? w[k] & Tail(n) : w[k];
+        if (m == ~std::uint64_t{0})
+            f(k * 64, std::size_t{64});
+        else if (m)
+            g(k * 64, std::min<std::size_t>(64, n - k * 64), m);
+    }
+}
+} // namespace detail
+
+// Number of rows that aren't null
+template <class T, bool Const>
+std::size_t count(nullable_ptr<T, Const> p, std::size_t n) noexcept
+{
+    DORI_assert(p.index() % 64 == 0 && "kernels need a word-aligned start");
+    return mask::count(p.validity(), n);
+}
+
+// Sum of the rows that aren't null; sums of integers are 64-bit
+template <class T, bool Const>
+detail::Sum_t<T> sum(nullable_ptr<T, Const> p, std::size_t n) noexcept
+{
+    using S      = detail::Sum_t<T>;
+    const auto v = p.values() + p.index();
+    S res{};
+    detail::Each_word(
+        p, n,
+        [&](std::size_t f, std::size_t k) {
+            for (std::size_t i = f; i < f + k; ++i)
+                res += static_cast<S>(v[i]);
+        },
+        [&](std::size_t f, std::size_t k, std::uint64_t m) {
+            // A select over the word rather than a walk of its set bits,
+            // which vectorizes
+            for (std::size_t i = 0; i < k; ++i)
+                res += (m >> i) & 1 ? static_cast<S>(v[f + i]) : S{};
+        });
+    return res;
+}
+
+namespace detail
+{
+template <class Less, class T, bool Const>
+std::optional<T> Extreme(nullable_ptr<T, Const> p, std::size_t n) noexcept
+{
+    const auto v = p.values() + p.index();
+    std::optional<T> res;
+    const auto add = [&](const T &x) {
+        if (!res || Less{}(x, *res))
+            res = x;
+    };
+    Each_word(
+        p, n,
+        [&](std::size_t f, std::size_t k) {
+            T acc = v[f];
+            for (std::size_t i = f + 1; i < f + k; ++i)
+                if (Less{}(v[i], acc))
+                    acc = v[i];
+            add(acc);
+        },
+        [&](std::size_t f, std::size_t, std::uint64_t m) {
+            for (; m; m &= m - 1)
+                add(v[f + static_cast<std::size_t>(std::countr_zero(m))]);
+        });
+    return res;
+}
+struct Greater {
+    template <class T>
+    constexpr DORI_inline bool operator()(const T &a, const T &b) const
+    {
+        return b < a;
+    }
+};
+} // namespace detail
+
+// Least and greatest of the rows that aren't null, if any
+template <class T, bool Const>
+std::optional<T> min(nullable_ptr<T, Const> p, std::size_t n) noexcept
+{
+    return detail::Extreme<std::less<>>(p, n);
+}
+template <class T, bool Const>
+std::optional<T> max(nullable_ptr<T, Const> p, std::size_t n) noexcept
+{
+    return detail::Extreme<detail::Greater>(p, n);
+}
+
+//
+// Sets each row of out to whether the row of p isn't null and satisfies pred,
+// a function of const T &. pred is called for null rows too, on T{}, and the
+// result is masked by the validity bits a word at a time. The bits past n in
+// the last word of out are preserved.
+//
+template <class T, bool Const, class Pred>
+void where(nullable_ptr<T, Const> p, std::size_t n, Pred pred, mask::ptr out)
+{
+    DORI_assert(p.index() % 64 == 0 && out.index() % 64 == 0 &&
+                "kernels need a word-aligned start");
+    if (!n)
+        return;
+    const auto v  = p.values() + p.index();
+    const auto w  = p.validity().words() + p.index() / 64;
+    const auto dw = out.words() + out.index() / 64;
+    const auto nw = (n + 63) / 64;
+    for (std::size_t k = 0; k < nw; ++k) {
+        const auto f = k * 64, l = std::min(f + 64, n);
+        std::uint64_t bits = 0;
+        for (auto i = f; i < l; ++i)
+            bits |= std::uint64_t{static_cast<bool>(pred(v[i]))} << (i - f);
+        if (k + 1 < nw)
+            dw[k] = bits & w[k];
+        else {
+            const auto t = detail::Tail(n);
+            dw[k]        = (dw[k] & ~t) | (bits & w[k] & t);
+        }
+    }
+}
+
+} // namespace valid
+
+} // namespace dori
@@ -0,0 +1,467 @@
+#pragma once
+
+//
+// Packed columns. Giving dori::bit as an element type of a vector stores a
+// bool column as a bitset, and dori::packed<E, Bits> stores an enumeration or
+// integer column in Bits bits per row (1, 2, 4, 8, 16, or 32). The sequences
+// of such columns follow those of the ordinary ones in the allocation, and
+// each is a run of 64-bit words, which the capacity being a multiple of 64
+// ensures.
+//
+// Elements of packed columns are accessed through proxies: operator[] and
+// iterators of the vector give packed_ref in place of T &, and data<I>() and
+// for_each() give packed_ptr in place of T *. The kernels in dori::mask work a
+// word at a time on bit columns.
+//
+
+#include "detail/assert.h"
+#include "detail/inline.h"
+#include "varlen.h"
+
+#include <algorithm>
+#include <bit>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <type_traits>
+
+namespace dori
+{
+
+// Element type for a bool column stored as a bitset
+struct alignas(std::uint64_t) bit {
+};
+
+// Element type for a column of T stored in Bits bits per row
+template <class T, std::size_t Bits>
+struct alignas(std::uint64_t) packed {
+};
+
+// See nullable.h
+template <class T>
+struct nullable;
+template <class T>
+class nullable_ref;
+template <class T, bool Const>
+class nullable_ptr;
+
+// See variant_column.h
+template <class... Ts>
+class variant_column;
+
+namespace detail
+{
+
+template <class T>
+struct Packing {
+    static constexpr std::size_t bits = 0;
+    using value_type                  = T;
+};
+template <>
+struct Packing<bit> {
+    static constexpr std::size_t bits = 1;
+    using value_type                  = bool;
+};
+template <class T, std::size_t Bits>
+struct Packing<packed<T, Bits>> {
+    static_assert(std::is_enum_v<T> || std::is_integral_v<T>,
+                  "only enumerations and integers can be packed");
+    static_assert(Bits && Bits <= 32 && std::has_single_bit(Bits),
+                  "packed columns take 1, 2, 4, 8, 16, or 32 bits per row");
+    static constexpr std::size_t bits = Bits;
+    using value_type                  = T;
+};
+
+template <class T>
+inline constexpr bool Is_packed = Packing<T>::bits != 0;
+
+template <class T>
+struct Nullable_of {
+    using element_type = T;
+    using value_type   = T;
+};
+template <class T>
+struct Nullable_of<nullable<T>> {
+    using element_type = T;
+    using value_type   = std::optional<T>;
+};
+
+template <class T>
+inline constexpr bool Is_nullable = false;
+template <class T>
+inline constexpr bool Is_nullable<nullable<T>> = true;
+
+template <class T>
+inline constexpr bool Is_variant_column = false;
+template <class... Ts>
+inline constexpr bool Is_variant_column<variant_column<Ts...>> = true;
+
+// Bits per row of a column declared as T after the ordinary sequences: its
+// packed elements, or the validity of its nullable ones
+template <class T>
+inline constexpr std::size_t Bits_of = Packing<T>::bits + Is_nullable<T>;
+
+// Alignment of the allocation for a column declared as T: that of its
+// elements, or of the words of the validity bits of nullable ones
+template <class T>
+using Align_of = std::integral_constant<
+    std::size_t, Is_nullable<T> ? std::max(alignof(T), alignof(std::uint64_t))
+                                : alignof(T)>;
+
+// The type of the elements of a column declared as T
+template <class T>
+using Value_t = typename std::conditional_t<
+    Is_varlen<T>, Varlen_of<T>,
+    std::conditional_t<Is_nullable<T>, Nullable_of<T>,
+                       Packing<T>>>::value_type;
+
+template <class T>
+constexpr DORI_inline std::uint64_t To_bits(T x) noexcept
+{
+    if constexpr (std::is_enum_v<T>)
+        return static_cast<std::uint64_t>(
+            static_cast<std::make_unsigned_t<std::underlying_type_t<T>>>(x));
+    else
+        return static_cast<std::uint64_t>(
+            static_cast<std::make_unsigned_t<
+                std::conditional_t<std::is_same_v<T, bool>, unsigned, T>>>(x));
+}
+
+template <class T>
+constexpr DORI_inline T From_bits(std::uint64_t x) noexcept
+{
+    if constexpr (std::is_same_v<T, bool>)
+        return x != 0;
+    else if constexpr (std::is_enum_v<T>)
+        return static_cast<T>(static_cast<std::underlying_type_t<T>>(x));
+    else
+        return static_cast<T>(x);
+}
+
+} // namespace detail
+
+//
+// Reference to an element of a packed column.
+//
+template <class T, std::size_t Bits>
+class packed_ref
+{
+    static constexpr std::uint64_t Mask = (std::uint64_t{1} << Bits) - 1;
+
+  public:
+    constexpr DORI_inline packed_ref(std::uint64_t *w, unsigned sh) noexcept
+        : w_{w}, sh_{sh}
+    {
+    }
+
+    constexpr DORI_inline operator T() const noexcept
+    {
+        return detail::From_bits<T>((*w_ >> sh_) & Mask);
+    }
+
+    constexpr DORI_inline const packed_ref &operator=(T x) const noexcept
+    {
+        DORI_assert(detail::To_bits(x) <= Mask && "value doesn't fit");
+        *w_ = (*w_ & ~(Mask << sh_)) | (detail::To_bits(x) << sh_);
+        return *this;
+    }
+    constexpr DORI_inline const packed_ref &
+    operator=(const packed_ref &rhs) const noexcept
+    {
+        return *this = static_cast<T>(rhs);
+    }
+
+    friend constexpr DORI_inline void swap(const packed_ref &a,
+                                           const packed_ref &b) noexcept
+    {
+        const T x = a;
+        a         = static_cast<T>(b);
+        b         = x;
+    }
+
+  private:
+    std::uint64_t *w_;
+    unsigned sh_;
+};
+
+//
+// Random-access iterator over a packed column; stands in for a pointer.
+//
+template <class T, std::size_t Bits, bool Const = false>
+class packed_ptr
+{
+    using Word = std::conditional_t<Const, const std::uint64_t, std::uint64_t>;
+    static constexpr std::uint64_t Mask = (std::uint64_t{1} << Bits) - 1;
+
+  public:
+    static constexpr std::size_t per_word = 64 / Bits;
+
+    using value_type        = T;
+    using difference_type   = std::ptrdiff_t;
+    using reference         = std::conditional_t<Const, T, packed_ref<T, Bits>>;
+    using pointer           = void;
+    using iterator_category = std::random_access_iterator_tag;
+
+    constexpr DORI_inline packed_ptr() noexcept = default;
+    constexpr DORI_inline packed_ptr(Word *words,
+                                     difference_type i = 0) noexcept
+        : w_{words}, i_{i}
+    {
+    }
+    constexpr DORI_inline operator packed_ptr<T, Bits, true>() const noexcept
+    {
+        return {w_, i_};
+    }
+
+    // The word holding row 0 and the row this points to
+    constexpr DORI_inline Word *words() const noexcept { return w_; }
+    constexpr DORI_inline difference_type index() const noexcept { return i_; }
+
+    constexpr DORI_inline reference operator[](difference_type n) const noexcept
+    {
+        DORI_assert(i_ + n >= 0);
+        const auto i = static_cast<std::size_t>(i_ + n);
+        const auto w = w_ + i / per_word;
+        const auto sh = static_cast<unsigned>(i % per_word * Bits);
+        if constexpr (Const)
+            return detail::From_bits<T>((*w >> sh) & Mask);
+        else
+            return {w, sh};
+    }
+    constexpr DORI_inline reference operator*() const noexcept
+    {
+        return (*this)[0];
+    }
+
+    constexpr DORI_inline packed_ptr &operator++() noexcept
+    {
+        return ++i_, *this;
+    }
+    constexpr DORI_inline packed_ptr operator++(int) noexcept
+    {
+        return {w_, i_++};
+    }
+    constexpr DORI_inline packed_ptr &operator--() noexcept
+    {
+        return --i_, *this;
+    }
+    constexpr DORI_inline packed_ptr operator--(int) noexcept
+    {
+        return {w_, i_--};
+    }
+    constexpr DORI_inline packed_ptr &operator+=(difference_type n) noexcept
+    {
+        return i_ += n, *this;
+    }
+    constexpr DORI_inline packed_ptr &operator-=(difference_type n) noexcept
+    {
+        return i_ -= n, *this;
+    }
+    friend constexpr DORI_inline packed_ptr
+    operator+(packed_ptr p, difference_type n) noexcept
+    {
+        return p += n;
+    }
+    friend constexpr DORI_inline packed_ptr operator+(difference_type n,
+                                                      packed_ptr p) noexcept
+    {
+        return p += n;
+    }
+    friend constexpr DORI_inline packed_ptr
+    operator-(packed_ptr p, difference_type n) noexcept
+    {
+        return p -= n;
+    }
+    friend constexpr DORI_inline difference_type
+    operator-(const packed_ptr &a, const packed_ptr &b) noexcept
+    {
+        DORI_assert(a.w_ == b.w_);
+        return a.i_ - b.i_;
+    }
+    friend constexpr DORI_inline bool operator==(const packed_ptr &a,
+                                                 const packed_ptr &b) noexcept
+    {
+        return a.w_ == b.w_ && a.i_ == b.i_;
+    }
+    friend constexpr DORI_inline auto operator<=>(const packed_ptr &a,
+                                                  const packed_ptr &b) noexcept
+    {
+        DORI_assert(a.w_ == b.w_);
+        return a.i_ <=> b.i_;
+    }
+
+  private:
+    Word *w_           = nullptr;
+    difference_type i_ = 0;
+};
+
+namespace detail
+{
+template <class T>
+struct Is_packed_ptr_impl : std::false_type {
+};
+template <class T, std::size_t Bits, bool Const>
+struct Is_packed_ptr_impl<packed_ptr<T, Bits, Const>> : std::true_type {
+};
+template <class T>
+inline constexpr bool Is_packed_ptr = Is_packed_ptr_impl<T>::value;
+
+template <class T>
+using Nullable_elem = typename Nullable_of<T>::element_type;
+
+// Pointer-likes to the elements of a column declared as T
+template <class T>
+using Ptr_t = std::conditional_t<
+    Is_packed<T>, packed_ptr<Value_t<T>, Packing<T>::bits>,
+    std::conditional_t<
+        Is_varlen<T>, varlen_ptr<typename Varlen_of<T>::element_type>,
+        std::conditional_t<Is_nullable<T>,
+                           nullable_ptr<Nullable_elem<T>, false>,
+                           T *>>>;
+template <class T>
+using Cptr_t = std::conditional_t<
+    Is_packed<T>, packed_ptr<Value_t<T>, Packing<T>::bits, true>,
+    std::conditional_t<
+        Is_varlen<T>, varlen_ptr<typename Varlen_of<T>::element_type, true>,
+        std::conditional_t<Is_nullable<T>,
+                           nullable_ptr<Nullable_elem<T>, true>,
+                           const T *>>>;
+
+// References to the elements of a column declared as T; rows of varlen
+// columns are read-only views
+template <class T>
+using Ref_t = std::conditional_t<
+    Is_packed<T>, packed_ref<Value_t<T>, Packing<T>::bits>,
+    std::conditional_t<
+        Is_varlen<T>, typename Varlen_of<T>::view_type,
+        std::conditional_t<Is_nullable<T>, nullable_ref<Nullable_elem<T>>,
+                           T &>>>;
+template <class T>
+using Cref_t = std::conditional_t<
+    Is_packed<T> || Is_nullable<T>, Value_t<T>,
+    std::conditional_t<Is_varlen<T>, typename Varlen_of<T>::view_type,
+                       const T &>>;
+
+// Copies rows 0..n between sequences of equal capacity granularity
+template <class T, std::size_t Bits, bool Const>
+constexpr DORI_inline void Packed_copy(packed_ptr<T, Bits> d,
+                                       packed_ptr<T, Bits, Const> s,
+                                       std::size_t n) noexcept
+{
+    DORI_assert(!d.index() && !s.index());
+    std::copy_n(s.words(), (n * Bits + 63) / 64, d.words());
+}
+} // namespace detail
+
+//
+// Kernels over bit columns (packed_ptr<bool, 1>) of n rows. These operate on
+// whole words; the bits past n in the last word are ignored, and preserved
+// where written to.
+//
+namespace mask
+{
+
+using ptr  = packed_ptr<bool, 1>;
+using cptr = packed_ptr<bool, 1, true>;
+
+namespace detail
+{
+constexpr DORI_inline std::uint64_t Tail(std::size_t n) noexcept
+{
+    return n % 64 ? (std::uint64_t{1} << n % 64) - 1 : ~std::uint64_t{0};
+}
+} // namespace detail
+
+// Number of set bits
+inline std::size_t count(cptr f, std::size_t n) noexcept
+{
+    DORI_assert(f.index() % 64 == 0 && "kernels need a word-aligned start");
+    if (!n)
+        return 0;
+    const auto w  = f.words() + f.index() / 64;
+    const auto nw = (n + 63) / 64;
+    std::size_t res = 0;
+    for (std::size_t i = 0; i + 1 < nw; ++i)
+        res += static_cast<std::size_t>(std::popcount(w[i]));
+    return res + static_cast<std::size_t>(
+                     std::popcount(w[nw - 1] & detail::Tail(n)));
+}
+
+inline bool any(cptr f, std::size_t n) noexcept
+{
+    DORI_assert(f.index() % 64 == 0 && "kernels need a word-aligned start");
+    if (!n)
+        return false;
+    const auto w  = f.words() + f.index() / 64;
+    const auto nw = (n + 63) / 64;
+    std::uint64_t acc = 0;
+    for (std::size_t i = 0; i + 1 < nw; ++i)
+        acc |= w[i];
+    return acc | (w[nw - 1] & detail::Tail(n));
+}
+
+inline bool none(cptr f, std::size_t n) noexcept { return !any(f, n); }
+
+inline bool all(cptr f, std::size_t n) noexcept { return count(f, n) == n; }
+
+//
+// d[i] = op(a[i], b[i]) for each row, where op is a bitwise function object
+// such as std::bit_and<>, applied to whole words. d may alias a or b.
+//
+template <class Op>
+void combine(ptr d, cptr a, cptr b, std::size_t n, Op op) noexcept
+{
+    DORI_assert(d.index() % 64 == 0 && a.index() % 64 == 0 &&
+                b.index() % 64 == 0 && "kernels need a word-aligned start");
+    if (!n)
+        return;
+    const auto dw = d.words() + d.index() / 64;
+    const auto aw = a.words() + a.index() / 64;
+    const auto bw = b.words() + b.index() / 64;
+    const auto nw = (n + 63) / 64;
+    for (std::size_t i = 0; i + 1 < nw; ++i)
+        dw[i] = static_cast<std::uint64_t>(op(aw[i], bw[i]));
+    const auto t = detail::Tail(n);
+    dw[nw - 1] = (dw[nw - 1] & ~t) |
+                 (static_cast<std::uint64_t>(op(aw[nw - 1], bw[nw - 1])) & t);
+}
+
+// Sets each row of d to x
+inline void fill(ptr d, std::size_t n, bool x) noexcept
+{
+    DORI_assert(d.index() % 64 == 0 && "kernels need a word-aligned start");
+    if (!n)
+        return;
+    const auto dw = d.words() + d.index() / 64;
+    const auto nw = (n + 63) / 64;
+    const auto v  = x ? ~std::uint64_t{0} : 0;
+    for (std::size_t i = 0; i + 1 < nw; ++i)
+        dw[i] = v;
+    const auto t = detail::Tail(n);
+    dw[nw - 1]   = (dw[nw - 1] & ~t) | (v & t);
+}
+
+//
+// Writes the indices of the set rows in ascending order to out, e.g. to turn
+// the result of a predicate into a selection vector. Returns the end of the
+// output.
+//
+template <class OutIt>
+OutIt to_indices(cptr f, std::size_t n, OutIt out)
+{
+    DORI_assert(f.index() % 64 == 0 && "kernels need a word-aligned start");
+    const auto w  = f.words() + f.index() / 64;
+    const auto nw = (n + 63) / 64;
+    for (std::size_t i = 0; i < nw; ++i) {
+        auto x = i + 1 == nw ? w[i] & detail::Tail(n) : w[i];
+        for (; x; x &= x - 1)
+            *out++ = i * 64 + static_cast<std::size_t>(std::countr_zero(x));
+    }
+    return out;
+}
+
+} // namespace mask
+
+} // namespace dori
@@ -0,0 +1,329 @@
+#pragma once
+
+//
+// Parallel execution over the rows of a vector. parallel_for_each_chunk()
+// splits the rows into chunks of about grain rows and calls f(first, last)
+// for each on a thread pool, and parallel_reduce() folds a value computed per
+// chunk. Chunk boundaries are multiples of the rows that fill a cache line in
+// every column, so packed columns are always split at whole words. Where every
+// column starts on a line, the boundaries fall on lines too, and neighbouring
+// chunks share none. Vectors round a capacity of 4096 rows or more so that
+// each column starts a whole number of lines into the allocation, which the
+// default allocator aligns to a line. Otherwise neighbouring chunks may share
+// the line at their boundary in each column, but not the lines in between.
+//
+// thread_pool hands out the chunks of a job to its workers and the calling
+// thread as contiguous ranges of chunk indices. A thread that runs out of its
+// range steals the upper half of the remaining range of another, so uneven
+// chunks balance out without a shared queue.
+//
+
+#include "detail/assert.h"
+#include "detail/vector_fwd.h"
+#include "packed.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace dori
+{
+
+class thread_pool
+{
+    // The range of chunk indices left to a thread; begin in the low half and
+    // end in the high half of the word, so that taking from either end is a
+    // single CAS
+    struct alignas(cache_line) Range {
+        std::atomic<std::uint64_t> r{0};
+    };
+
+    static constexpr std::uint64_t Pack(std::uint64_t b, std::uint64_t e)
+    {
+        return b | e << 32;
+    }
+
+  public:
+    // threads includes the calling thread of run(), so one fewer worker is
+    // started
+    explicit thread_pool(unsigned threads = std::thread::hardware_concurrency())
+        : ranges_{std::make_unique<Range[]>(std::max(threads, 1u))},
+          size_{std::max(threads, 1u)}
+    {
+        workers_.reserve(size_ - 1);
+        for (unsigned i = 1; i < size_; ++i)
+            workers_.emplace_back([this, i] { Worker(i); });
+    }
+    thread_pool(const thread_pool &)            = delete;
+    thread_pool &operator=(const thread_pool &) = delete;
+    ~thread_pool()
+    {
+        {
+            std::lock_guard l{m_};
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (auto &w : workers_)
+            w.join();
+    }
+
+    unsigned size() const noexcept { return size_; }
+
+    // Pool shared by the functions below when none is given
+    static thread_pool &global()
+    {
+        static thread_pool res;
+        return res;
+    }
+
+    //
+    // Calls f(i) for each i in 0..n across the pool and returns once all are
+    // done. The first exception thrown by f is rethrown after the rest have
+    // been skipped. Calls from within f run serially on the calling thread.
+    //
+    template <class F>
+    void run(std::size_t n, F &&f)
+    {
+        DORI_assert(n < (std::uint64_t{1} << 32) && "too many chunks");
+        if (!n)
+            return;
+        if (size_ == 1 || n == 1 || Current() == this) {
+            for (std::size_t i = 0; i < n; ++i)
+                f(i);
+            return;
+        }
+
+        using Fn = std::remove_reference_t<F>;
+        std::lock_guard run_l{run_m_};
+        ctx_   = const_cast<void *>(static_cast<const void *>(&f));
+        fn_    = [](void *ctx, std::size_t i) { (*static_cast<Fn *>(ctx))(i); };
+        error_ = nullptr;
+        failed_.store(false, std::memory_order_relaxed);
+        remaining_.store(n, std::memory_order_relaxed);
+        for (unsigned t = 0; t < size_; ++t)
+            ranges_[t].r.store(Pack(n * t / size_, n * (t + 1) / size_),
+                               std::memory_order_release);
+        {
+            std::lock_guard l{m_};
+            ++gen_;
+        }
+        cv_.notify_all();
+
+        const auto prev = std::exchange(Current(), this);
+        Work(0);
+        Current() = prev;
+        for (auto r = remaining_.load(std::memory_order_acquire); r;
+             r      = remaining_.load(std::memory_order_acquire))
+            remaining_.wait(r, std::memory_order_acquire);
+        if (error_)
+            std::rethrow_exception(error_);
+    }
+
+  private:
+    static thread_pool *&Current() noexcept
+    {
+        static thread_local thread_pool *res = nullptr;
+        return res;
+    }
+
+    static bool Pop(Range &rg, std::uint32_t &i) noexcept
+    {
+        auto r = rg.r.load(std::memory_order_acquire);
+        for (;;) {
+            const auto b = r & 0xffffffff, e = r >> 32;
+            if (b == e)
+                return false;
+            if (rg.r.compare_exchange_weak(r, Pack(b + 1, e),
+                                           std::memory_order_acq_rel)) {
+                i = static_cast<std::uint32_t>(b);
+                return true;
+            }
+        }
+    }
+
+    // Moves the upper half of the range of another thread to self, taking its
+    // first index to i
+    bool Steal(unsigned self, std::uint32_t &i) noexcept
+    {
+        for (unsigned k = 1; k < size_; ++k) {
+            auto &victim = ranges_[(self + k) % size_];
+            auto r       = victim.r.load(std::memory_order_acquire);
+            for (;;) {
+                const auto b = r & 0xffffffff, e = r >> 32;
+                if (b == e)
+                    break;
+                const auto mid = b + (e - b) / 2;
+                if (victim.r.compare_exchange_weak(
+                        r, Pack(b, mid), std::memory_order_acq_rel)) {
+                    ranges_[self].r.store(Pack(mid + 1, e),
+                                          std::memory_order_release);
+                    i = static_cast<std::uint32_t>(mid);
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    void Work(unsigned self) noexcept
+    {
+        std::uint32_t i;
+        while (Pop(ranges_[self], i) || Steal(self, i)) {
+            if (!failed_.load(std::memory_order_relaxed))
+                try {
+                    fn_(ctx_, i);
+                } catch (...) {
+                    if (!failed_.exchange(true))
+                        error_ = std::current_exception();
+                }
+            if (remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                remaining_.notify_all();
+        }
+    }
+
+    void Worker(unsigned self)
+    {
+        Current()         = this;
+        std::uint64_t gen = 0;
+        for (;;) {
+            {
+                std::unique_lock l{m_};
+                cv_.wait(l, [&] { return stop_ || gen_ != gen; });
+                if (stop_)
+                    return;
+                gen = gen_;
+            }
+            Work(self);
+        }
+    }
+
+    std::unique_ptr<Range[]> ranges_;
+    unsigned size_;
+    std::vector<std::thread> workers_;
+
+    // The job being run
+    void (*fn_)(void *, std::size_t) = nullptr;
+    void *ctx_                         = nullptr;
+    std::exception_ptr error_;
+    std::atomic<bool> failed_{false};
+    alignas(cache_line) std::atomic<std::size_t> remaining_{0};
+
+    std::mutex run_m_;
+    std::mutex m_;
+    std::condition_variable cv_;
+    std::uint64_t gen_ = 0;
+    bool stop_         = false;
+};
+
+namespace detail
+{
+
+template <class P>
+struct Rows_per_line;
+template <class T>
+struct Rows_per_line<T *>
+    : std::integral_constant<std::size_t,
+                             cache_line / std::gcd(cache_line, sizeof(T))> {
+};
+template <class T, std::size_t Bits, bool Const>
+struct Rows_per_line<packed_ptr<T, Bits, Const>>
+    : std::integral_constant<std::size_t, cache_line * 8 / Bits> {
+};
+// The values, and a bit of validity per row among the packed sequences
+template <class T, bool Const>
+struct Rows_per_line<nullable_ptr<T, Const>>
+    : std::integral_constant<std::size_t,
+                             std::lcm(Rows_per_line<T *>::value,
+                                      cache_line * 8)> {
+};
+// The end offsets; the values lie in a buffer of their own
+template <class T, bool Const>
+struct Rows_per_line<varlen_ptr<T, Const>> : Rows_per_line<std::size_t *> {
+};
+
+template <class V, std::size_t I>
+using Column_ptr_t = decltype(std::declval<V &>().template data<I>());
+
+// Rows that take a whole number of cache lines' worth of bytes in every column
+// of V
+template <class V, std::size_t... Is>
+constexpr std::size_t Line_rows(std::index_sequence<Is...>) noexcept
+{
+    std::size_t res = 1;
+    (..., (res = std::lcm(res, Rows_per_line<Column_ptr_t<V, Is>>::value)));
+    return res;
+}
+
+template <class V>
+constexpr std::size_t Round_grain(std::size_t grain) noexcept
+{
+    using Row          = typename std::remove_const_t<V>::value_type;
+    constexpr auto line = Line_rows<V>(
+        std::make_index_sequence<std::tuple_size_v<Row>>{});
+    return (std::max(grain, std::size_t{1}) + line - 1) / line * line;
+}
+
+} // namespace detail
+
+//
+// Calls f(first, last) for chunks of rows of v covering all of them, in
+// parallel. grain is rounded up to a multiple of the rows in a cache line of
+// every column.
+//
+template <class V, class F>
+void parallel_for_each_chunk(thread_pool &pool, V &v, std::size_t grain, F &&f)
+{
+    grain         = detail::Round_grain<V>(grain);
+    const auto sz = v.size();
+    pool.run((sz + grain - 1) / grain, [&](std::size_t i) {
+        const auto first = i * grain;
+        f(first, std::min(first + grain, sz));
+    });
+}
+template <class V, class F>
+void parallel_for_each_chunk(V &v, std::size_t grain, F &&f)
+{
+    parallel_for_each_chunk(thread_pool::global(), v, grain,
+                            static_cast<F &&>(f));
+}
+
+//
+// Folds map(first, last) of each chunk of rows of v into init with op. The
+// chunks are mapped in parallel and folded in order, so the result doesn't
+// depend on the scheduling.
+//
+template <class V, class T, class Map, class Op>
+T parallel_reduce(thread_pool &pool, V &v, std::size_t grain, T init, Map map,
+                  Op op)
+{
+    grain         = detail::Round_grain<V>(grain);
+    const auto sz = v.size();
+    std::vector<std::optional<T>> parts((sz + grain - 1) / grain);
+    pool.run(parts.size(), [&](std::size_t i) {
+        const auto first = i * grain;
+        parts[i].emplace(map(first, std::min(first + grain, sz)));
+    });
+    for (auto &x : parts)
+        init = op(std::move(init), std::move(*x));
+    return init;
+}
+template <class V, class T, class Map, class Op>
+T parallel_reduce(V &v, std::size_t grain, T init, Map map, Op op)
+{
+    return parallel_reduce(thread_pool::global(), v, grain, std::move(init),
+                           std::move(map), std::move(op));
+}
+
+} // namespace dori
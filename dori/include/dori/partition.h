@@ -0,0 +1,368 @@
+#pragma once
+
+//
+// Partitioning of the rows of a vector into k buckets by a function of the
+// values of a column, e.g. to shard them across threads or nodes:
+//
+//   const auto fn = [](auto key) { return hash(key) % 8; };
+//   auto shards   = dori::partition_by<0>(v, 8, fn); // shards[0..8]
+//   auto p        = dori::reorder_by<0>(v, 8, fn);   // p.rows, p.offsets
+//
+// partition_by() gives a vector per bucket, and reorder_by() one vector of the
+// rows by bucket along with where each bucket starts. Rows keep their order
+// within a bucket.
+//
+// Either takes two passes over the rows. The first calls fn per row and counts
+// the rows of each bucket, so that each destination is allocated once at its
+// final size. The second scatters the rows through write-combining buffers:
+// the rows bound for a bucket gather in a buffer of whole cache lines per
+// column, which is copied out when full. Stores to the destinations thus go a
+// line at a time however the buckets interleave, rather than an element at a
+// time to k lines per column. This needs columns of trivially copyable
+// elements, not packed; rows of other vectors are copied one by one.
+//
+// parallel_partition_by() and parallel_reorder_by() split the rows into chunks
+// that are counted and then scattered on a thread pool, each chunk into a
+// range of each bucket of its own; fn is called concurrently. These need
+// columns that can be scattered as above.
+//
+
+#include "aos.h"
+#include "detail/assert.h"
+#include "detail/inline.h"
+#include "parallel.h"
+#include "vector.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace dori
+{
+
+// The rows of a vector by bucket; bucket b is rows offsets[b]..offsets[b + 1]
+template <class V>
+struct partitioned {
+    V rows;
+    std::vector<std::size_t> offsets;
+
+    std::size_t buckets() const noexcept { return offsets.size() - 1; }
+};
+
+namespace detail
+{
+
+// Rows per chunk of the parallel variants at least
+inline constexpr std::size_t Partition_chunk_rows = std::size_t{1} << 16;
+
+template <class V, std::size_t... Is>
+constexpr bool Scatterable(std::index_sequence<Is...>) noexcept
+{
+    return (... && (std::is_pointer_v<Column_ptr_t<V, Is>> &&
+                    std::is_trivially_copyable_v<
+                        std::remove_pointer_t<Column_ptr_t<V, Is>>>));
+}
+
+// Whether the rows of V can be scattered as bytes
+template <class V>
+inline constexpr bool Is_scatterable = Scatterable<V>(
+    std::make_index_sequence<std::tuple_size_v<typename V::value_type>>{});
+
+// The columns of V from some row on
+template <class V, class Js>
+struct Columns_of;
+template <class V, std::size_t... Is>
+struct Columns_of<V, std::index_sequence<Is...>> {
+    using type = std::tuple<Column_ptr_t<V, Is>...>;
+};
+
+// Storage for n elements of type T from a cache line on, left unconstructed
+template <class T>
+class Wc_buffer
+{
+  public:
+    explicit Wc_buffer(std::size_t n)
+        : p_{static_cast<T *>(::operator new(n * sizeof(T),
+                                             std::align_val_t{cache_line}))}
+    {
+    }
+    Wc_buffer(const Wc_buffer &) = delete;
+    ~Wc_buffer() { ::operator delete(p_, std::align_val_t{cache_line}); }
+
+    DORI_inline T *data() const noexcept { return p_; }
+
+  private:
+    T *p_;
+};
+
+//
+// Calls fn on column I of rows first..last of v, writing the bucket of each to
+// bs and counting the rows of each bucket in hist
+//
+template <std::size_t I, class V, class Fn>
+void Count_buckets(const V &v, std::size_t first, std::size_t last,
+                   [[maybe_unused]] std::size_t k, Fn &fn, std::uint32_t *bs,
+                   std::size_t *hist)
+{
+    const auto keys = v.template data<I>();
+    for (auto i = first; i != last; ++i) {
+        const auto b = static_cast<std::size_t>(fn(keys[i]));
+        DORI_assert(b < k && "bucket out of range");
+        bs[i] = static_cast<std::uint32_t>(b);
+        ++hist[b];
+    }
+}
+
+//
+// Copies rows first..last of v to the columns dst[b] of their buckets b from
+// row pos[b] on, advancing pos[b], through a buffer of R rows per bucket
+//
+template <std::size_t R, class V, class Dst, std::size_t... Is>
+void Scatter(const V &v, std::size_t first, std::size_t last,
+             const std::uint32_t *bs, const Dst *dst, std::size_t *pos,
+             std::size_t k, std::index_sequence<Is...>)
+{
+    using Ts = mp_list<std::remove_pointer_t<std::tuple_element_t<Is, Dst>>...>;
+    const std::tuple src{v.template data<Is>()...};
+    std::tuple<Wc_buffer<mp_at_c<Ts, Is>>...> bufs{
+        (static_cast<void>(Is), k * R)...};
+    std::vector<std::uint32_t> fill(k);
+    const auto flush = [&](std::size_t b, std::size_t m) {
+        (..., std::memcpy(std::get<Is>(dst[b]) + pos[b],
+                          std::get<Is>(bufs).data() + b * R,
+                          m * sizeof(mp_at_c<Ts, Is>)));
+        pos[b] += m;
+    };
+    for (auto i = first; i != last; ++i) {
+        const auto b = bs[i];
+        const auto c = fill[b]++;
+        (..., std::memcpy(std::get<Is>(bufs).data() + b * R + c,
+                          std::get<Is>(src) + i, sizeof(mp_at_c<Ts, Is>)));
+        if (c + 1 == R) {
+            flush(b, R);
+            fill[b] = 0;
+        }
+    }
+    for (std::size_t b = 0; b < k; ++b)
+        if (fill[b])
+            flush(b, fill[b]);
+}
+
+//
+// Partitions v into k buckets by fn of column I, in chunks on pool if given.
+// make(counts) makes room for the rows of each bucket and returns where the
+// columns of each start.
+//
+template <std::size_t I, class V, class Fn, class Make>
+void Partition(thread_pool *pool, const V &v, std::size_t k, Fn &fn,
+               Make make)
+{
+    using Js = std::make_index_sequence<std::tuple_size_v<
+        typename V::value_type>>;
+    DORI_assert(k && k <= (std::uint64_t{1} << 32) && "bad bucket count");
+    const auto n = v.size();
+    if (!n) {
+        make(std::vector<std::size_t>(k));
+        return;
+    }
+    const auto chunks =
+        pool ? std::clamp<std::size_t>(n / Partition_chunk_rows, 1,
+                                       std::size_t{4} * pool->size())
+             : 1;
+    const auto grain = (n + chunks - 1) / chunks;
+    const auto each  = [&](auto f) {
+        if (pool)
+            pool->run(chunks, f);
+        else
+            f(std::size_t{0});
+    };
+
+    const auto bs = std::make_unique_for_overwrite<std::uint32_t[]>(n);
+    std::vector<std::size_t> pos(chunks * k);
+    each([&](std::size_t c) {
+        Count_buckets<I>(v, c * grain, std::min(c * grain + grain, n), k, fn,
+                         bs.get(), pos.data() + c * k);
+    });
+    // The rows of each bucket, and the first row of each chunk in its bucket
+    std::vector<std::size_t> counts(k);
+    for (std::size_t c = 0; c < chunks; ++c)
+        for (std::size_t b = 0; b < k; ++b)
+            counts[b] += std::exchange(pos[c * k + b], counts[b]);
+
+    const auto dst = make(counts);
+    constexpr auto R = Line_rows<V>(Js{});
+    each([&](std::size_t c) {
+        Scatter<R>(v, c * grain, std::min(c * grain + grain, n), bs.get(),
+                   dst.data(), pos.data() + c * k, k, Js{});
+    });
+}
+
+template <std::size_t I, class V, class Fn>
+std::vector<V> Partition_by(thread_pool *pool, const V &v, std::size_t k,
+                            Fn &fn)
+{
+    using Js = std::make_index_sequence<std::tuple_size_v<
+        typename V::value_type>>;
+    std::vector<V> res;
+    res.reserve(k);
+    for (std::size_t b = 0; b < k; ++b)
+        res.emplace_back(v.get_allocator());
+    Partition<I>(pool, v, k, fn, [&](const std::vector<std::size_t> &counts) {
+        std::vector<typename Columns_of<V, Js>::type> dst(k);
+        for (std::size_t b = 0; b < k; ++b)
+            if (counts[b])
+                Bulk_ops::Append(
+                    res[b], counts[b], [&](auto... ps) { dst[b] = {ps...}; },
+                    Js{});
+        return dst;
+    });
+    return res;
+}
+
+template <std::size_t I, class V, class Fn>
+partitioned<V> Reorder_by(thread_pool *pool, const V &v, std::size_t k, Fn &fn)
+{
+    using Js = std::make_index_sequence<std::tuple_size_v<
+        typename V::value_type>>;
+    partitioned<V> res{V{v.get_allocator()}, std::vector<std::size_t>(k + 1)};
+    Partition<I>(pool, v, k, fn, [&](const std::vector<std::size_t> &counts) {
+        std::vector<typename Columns_of<V, Js>::type> dst(k);
+        for (std::size_t b = 0; b < k; ++b)
+            res.offsets[b + 1] = res.offsets[b] + counts[b];
+        if (v.size())
+            Bulk_ops::Append(
+                res.rows, v.size(),
+                [&](auto... ps) {
+                    for (std::size_t b = 0; b < k; ++b)
+                        dst[b] = {(ps + res.offsets[b])...};
+                },
+                Js{});
+        return dst;
+    });
+    return res;
+}
+
+//
+// The bucket of each row of v and the rows in order of bucket, for vectors
+// that can't be scattered as bytes
+//
+template <std::size_t I, class V, class Fn>
+std::vector<std::uint32_t> Bucket_order(const V &v, std::size_t k, Fn &fn,
+                                        std::vector<std::size_t> &offsets)
+{
+    DORI_assert(k && k <= (std::uint64_t{1} << 32) && "bad bucket count");
+    const auto n = v.size();
+    std::vector<std::uint32_t> bs(n);
+    offsets.assign(k + 1, 0);
+    if (n)
+        Count_buckets<I>(v, 0, n, k, fn, bs.data(), offsets.data() + 1);
+    for (std::size_t b = 0; b < k; ++b)
+        offsets[b + 1] += offsets[b];
+    std::vector<std::size_t> pos(offsets.begin(), offsets.end() - 1);
+    std::vector<std::uint32_t> order(n);
+    for (std::size_t i = 0; i < n; ++i)
+        order[pos[bs[i]]++] = static_cast<std::uint32_t>(i);
+    return order;
+}
+
+template <class V>
+DORI_inline void Push_row(V &d, const V &s, std::size_t i)
+{
+    std::apply([&](const auto &...xs) { d.push_back(xs...); }, s[i]);
+}
+
+} // namespace detail
+
+//
+// Copies the rows of v into k vectors, row i going to vector fn(x) where x is
+// its element of column I; fn returns a bucket in 0..k
+//
+template <std::size_t I, class V, class Fn>
+requires(I < std::tuple_size_v<typename V::value_type>) //
+    std::vector<V> partition_by(const V &v, std::size_t k, Fn fn)
+{
+    if constexpr (detail::Is_scatterable<V>)
+        return detail::Partition_by<I>(nullptr, v, k, fn);
+    else {
+        std::vector<std::size_t> offs;
+        const auto order = detail::Bucket_order<I>(v, k, fn, offs);
+        std::vector<V> res;
+        res.reserve(k);
+        for (std::size_t b = 0; b < k; ++b) {
+            res.emplace_back(v.get_allocator());
+            if (offs[b + 1] == offs[b])
+                continue;
+            res[b].reserve(offs[b + 1] - offs[b]);
+            for (auto j = offs[b]; j != offs[b + 1]; ++j)
+                detail::Push_row(res[b], v, order[j]);
+        }
+        return res;
+    }
+}
+
+//
+// Copies the rows of v into one vector in order of their buckets, as given by
+// partition_by(), along with the first row of each bucket
+//
+template <std::size_t I, class V, class Fn>
+requires(I < std::tuple_size_v<typename V::value_type>) //
+    partitioned<V> reorder_by(const V &v, std::size_t k, Fn fn)
+{
+    if constexpr (detail::Is_scatterable<V>)
+        return detail::Reorder_by<I>(nullptr, v, k, fn);
+    else {
+        partitioned<V> res{V{v.get_allocator()}, {}};
+        const auto order = detail::Bucket_order<I>(v, k, fn, res.offsets);
+        if (!order.empty())
+            res.rows.reserve(order.size());
+        for (const auto i : order)
+            detail::Push_row(res.rows, v, i);
+        return res;
+    }
+}
+
+//
+// partition_by() and reorder_by() with the rows counted and scattered in
+// chunks on pool; fn is called concurrently
+//
+template <std::size_t I, class V, class Fn>
+requires(I < std::tuple_size_v<typename V::value_type>) //
+    std::vector<V> parallel_partition_by(thread_pool &pool, const V &v,
+                                         std::size_t k, Fn fn)
+{
+    static_assert(detail::Is_scatterable<V>,
+                  "columns must be trivially copyable and not packed");
+    return detail::Partition_by<I>(&pool, v, k, fn);
+}
+template <std::size_t I, class V, class Fn>
+requires(I < std::tuple_size_v<typename V::value_type>) //
+    std::vector<V> parallel_partition_by(const V &v, std::size_t k, Fn fn)
+{
+    return parallel_partition_by<I>(thread_pool::global(), v, k,
+                                    std::move(fn));
+}
+
+template <std::size_t I, class V, class Fn>
+requires(I < std::tuple_size_v<typename V::value_type>) //
+    partitioned<V> parallel_reorder_by(thread_pool &pool, const V &v,
+                                       std::size_t k, Fn fn)
+{
+    static_assert(detail::Is_scatterable<V>,
+                  "columns must be trivially copyable and not packed");
+    return detail::Reorder_by<I>(&pool, v, k, fn);
+}
+template <std::size_t I, class V, class Fn>
+requires(I < std::tuple_size_v<typename V::value_type>) //
+    partitioned<V> parallel_reorder_by(const V &v, std::size_t k, Fn fn)
+{
+    return parallel_reorder_by<I>(thread_pool::global(), v, k, std::move(fn));
+}
+
+} // namespace dori
@@ -0,0 +1,293 @@
+#pragma once
+
+//
+// Lazy queries over the columns of a vector. v.query() starts an expression,
+// where() and select() append stages to it, and a terminal such as reduce()
+// evaluates it. Stages name the columns they read by their declared indices:
+//
+//   v.query().where<2>(is_even).select<0, 3>(mul).reduce(std::plus<>{})
+//
+// All stages are fused into one pass over the rows in chunks of Query_chunk
+// rows. Each stage runs over the whole chunk before the next one does, passing
+// on a selection of row offsets and, once there has been a select(), a value
+// per selected row; these stay in L1 in between. Only the named columns are
+// read, and only at the selected rows past the first where().
+//
+// Stages after a select() receive its value ahead of the columns they name;
+// so in v.query().select<0>(f).where(g), g is called with the result of f.
+//
+
+#include "detail/inline.h"
+
+#include <boost/mp11/algorithm.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace dori
+{
+
+template <class Src, class... Stages>
+class query;
+
+namespace detail
+{
+
+// Rows per chunk of evaluation: a selection of this many row offsets and a few
+// columns of values fit in L1 together
+inline constexpr std::size_t Query_chunk = 2048;
+
+// The value of a row before any select()
+struct No_value {
+};
+
+template <class Pred, std::size_t... Is>
+struct Where_stage {
+    Pred pred;
+};
+
+template <class F, std::size_t... Is>
+struct Select_stage {
+    F f;
+};
+
+// Calls f with the value at vs[j], if any, followed by cs
+template <class F, class V, class... Cs>
+constexpr DORI_inline decltype(auto) Invoke_stage(F &f, V *vs, std::size_t j,
+                                                  Cs &&...cs)
+{
+    if constexpr (std::is_same_v<V, No_value>)
+        return f(static_cast<Cs &&>(cs)...);
+    else
+        return f(vs[j], static_cast<Cs &&>(cs)...);
+}
+
+// Moves vs[j] to vs[m] as a where() stage compacts the values
+template <class V>
+constexpr DORI_inline void Compact_value(V *vs, std::size_t m,
+                                         std::size_t j) noexcept
+{
+    if constexpr (std::is_same_v<V, No_value>)
+        return;
+    else if constexpr (std::is_trivially_copyable_v<V>)
+        vs[m] = vs[j];
+    else if (m != j)
+        vs[m] = std::move(vs[j]);
+}
+
+template <class Src, class V, class Stage>
+struct Next_value {
+    using type = V;
+};
+template <class Src, class V, class F, std::size_t... Is>
+struct Next_value<Src, V, Select_stage<F, Is...>> {
+    using type = std::decay_t<decltype(Invoke_stage(
+        std::declval<F &>(), std::declval<V *>(), 0,
+        std::declval<const Src &>().template data<Is>()[0]...))>;
+};
+
+} // namespace detail
+
+template <class Src, class... Stages>
+class query
+{
+    template <class, class...>
+    friend class query;
+
+    template <class V, class Stage>
+    using Next_t = typename detail::Next_value<Src, V, Stage>::type;
+
+    using Chunk_sel = std::array<std::uint32_t, detail::Query_chunk>;
+
+  public:
+    // Type of the value of a row after the stages; detail::No_value if there
+    // has been no select()
+    using value_type = boost::mp11::mp_fold<boost::mp11::mp_list<Stages...>,
+                                            detail::No_value, Next_t>;
+
+    constexpr DORI_inline explicit query(const Src &src,
+                                         std::tuple<Stages...> stages = {})
+        : src_{&src}, stages_{std::move(stages)}
+    {
+    }
+
+    //
+    // Keeps the rows for which pred(columns Is...) holds. Stage functions are
+    // called as const.
+    //
+    template <std::size_t... Is, class Pred>
+    constexpr DORI_inline auto where(Pred pred) const
+    {
+        return Append(detail::Where_stage<Pred, Is...>{std::move(pred)});
+    }
+
+    //
+    // Replaces the value of each row with f(columns Is...).
+    //
+    template <std::size_t... Is, class F>
+    constexpr DORI_inline auto select(F f) const
+    {
+        return Append(detail::Select_stage<F, Is...>{std::move(f)});
+    }
+
+    //
+    // Terminals
+    //
+
+    // Number of rows kept
+    constexpr std::size_t count() const
+    {
+        std::size_t res = 0;
+        Run([&](std::size_t, const std::uint32_t *, std::size_t n,
+                const value_type *) { res += n; });
+        return res;
+    }
+
+    // Writes the indices of the rows kept in ascending order to out, and
+    // returns the end of the output
+    template <class OutIt>
+    constexpr OutIt to_indices(OutIt out) const
+    {
+        Run([&](std::size_t b, const std::uint32_t *sel, std::size_t n,
+                const value_type *) {
+            for (std::size_t j = 0; j < n; ++j)
+                *out++ = b + (sel ? sel[j] : j);
+        });
+        return out;
+    }
+
+    // Calls f with the value of each row kept
+    template <class F>
+    constexpr void for_each(F &&f) const
+    {
+        static_assert(Has_value, "for_each() needs a select() stage");
+        Run([&](std::size_t, const std::uint32_t *, std::size_t n,
+                const value_type *vs) {
+            for (std::size_t j = 0; j < n; ++j)
+                f(vs[j]);
+        });
+    }
+
+    // Left fold of the values of the rows kept
+    template <class T, class Op>
+    constexpr T reduce(T init, Op op) const
+    {
+        static_assert(Has_value, "reduce() needs a select() stage");
+        Run([&](std::size_t, const std::uint32_t *, std::size_t n,
+                const value_type *vs) {
+            // A local accumulator can't alias vs, so it stays in a register
+            T acc = std::move(init);
+            for (std::size_t j = 0; j < n; ++j)
+                acc = op(std::move(acc), vs[j]);
+            init = std::move(acc);
+        });
+        return init;
+    }
+    template <class Op>
+    constexpr DORI_inline value_type reduce(Op op) const
+    {
+        return reduce(value_type{}, std::move(op));
+    }
+
+  private:
+    static constexpr bool Has_value =
+        !std::is_same_v<value_type, detail::No_value>;
+
+    template <class Stage>
+    constexpr DORI_inline auto Append(Stage st) const
+    {
+        return query<Src, Stages..., Stage>{
+            *src_, std::tuple_cat(stages_, std::tuple{std::move(st)})};
+    }
+
+    //
+    // Each chunk starts out dense, its selection being all of its rows, and
+    // becomes sparse at the first where(); until then, rows are indexed
+    // directly rather than through the selection. Sinks get a null selection
+    // for a dense chunk.
+    //
+    template <class Sink>
+    constexpr void Run(Sink &&sink) const
+    {
+        Chunk_sel sel;
+        const std::size_t sz = src_->size();
+        for (std::size_t b = 0; b < sz; b += detail::Query_chunk) {
+            const auto n           = std::min(detail::Query_chunk, sz - b);
+            detail::No_value *none = nullptr;
+            Stage<0, true>(sink, b, sel, n, none);
+        }
+    }
+
+    template <std::size_t K, bool Dense, class Sink, class V>
+    constexpr DORI_inline void Stage(Sink &sink, std::size_t b, Chunk_sel &sel,
+                                     std::size_t n, V *vs) const
+    {
+        if constexpr (K == sizeof...(Stages))
+            sink(b, Dense ? nullptr : sel.data(), n, vs);
+        else if (n)
+            Apply<K, Dense>(std::get<K>(stages_), sink, b, sel, n, vs);
+    }
+
+    template <bool Dense>
+    static constexpr DORI_inline std::uint32_t Row(const Chunk_sel &sel,
+                                                   std::size_t j) noexcept
+    {
+        if constexpr (Dense)
+            return static_cast<std::uint32_t>(j);
+        else
+            return sel[j];
+    }
+
+    template <std::size_t K, bool Dense, class Pred, std::size_t... Is,
+              class Sink, class V>
+    constexpr void Apply(const detail::Where_stage<Pred, Is...> &st,
+                         Sink &sink, std::size_t b, Chunk_sel &sel,
+                         std::size_t n, V *vs) const
+    {
+        const auto &pred = st.pred;
+        std::size_t m    = 0;
+        // Compact the selection (and values) without branching on pred
+        std::apply(
+            [&](const auto... cs) {
+                for (std::size_t j = 0; j < n; ++j) {
+                    const auto i    = Row<Dense>(sel, j);
+                    const bool keep = static_cast<bool>(
+                        detail::Invoke_stage(pred, vs, j, cs[i]...));
+                    sel[m] = i;
+                    detail::Compact_value(vs, m, j);
+                    m += keep;
+                }
+            },
+            std::tuple{(src_->template data<Is>() + b)...});
+        Stage<K + 1, false>(sink, b, sel, m, vs);
+    }
+
+    template <std::size_t K, bool Dense, class F, std::size_t... Is,
+              class Sink, class V>
+    constexpr void Apply(const detail::Select_stage<F, Is...> &st, Sink &sink,
+                         std::size_t b, Chunk_sel &sel, std::size_t n,
+                         V *vs) const
+    {
+        using R = Next_t<V, detail::Select_stage<F, Is...>>;
+        const auto &f = st.f;
+        std::array<R, detail::Query_chunk> out;
+        std::apply(
+            [&](const auto... cs) {
+                for (std::size_t j = 0; j < n; ++j)
+                    out[j] = detail::Invoke_stage(f, vs, j,
+                                                  cs[Row<Dense>(sel, j)]...);
+            },
+            std::tuple{(src_->template data<Is>() + b)...});
+        Stage<K + 1, Dense>(sink, b, sel, n, out.data());
+    }
+
+    const Src *src_;
+    std::tuple<Stages...> stages_;
+};
+
+} // namespace dori
@@ -0,0 +1,458 @@
+#pragma once
+
+//
+// A circular buffer of rows, in a single allocation laid out as that of a
+// vector. The rows run from a head that advances as they're popped, wrapping
+// around at capacity(), so popping from the front moves nothing. Pushing to a
+// full ring drops its first row:
+//
+//   dori::ring<float, std::uint32_t> r{1024}; // the last 1024 samples
+//   r.append(batch);                          // a vector of the same columns
+//   r.pop_front(16);
+//   auto [s, m] = r.aggregate<dori::sum<0>, dori::max<1>>(64);
+//
+// Each column of the rows is the concatenation of at most two contiguous runs,
+// spans<I>(), which kernels may run over as they would over a column of a
+// vector.
+//
+
+#include "aggregate.h"
+#include "detail/assert.h"
+#include "detail/inline.h"
+#include "vector.h"
+#include "vector_view.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace dori
+{
+
+template <class Layout, class Al, class... Ts>
+class basic_ring : detail::Get_vector_t<Al, Layout, Ts...>
+{
+    // The storage; its size stays 0, as the rows are the ring's to construct
+    // and destroy
+    using Base  = detail::Get_vector_t<Al, Layout, Ts...>;
+    using Al_tr = std::allocator_traits<Al>;
+    using Js    = std::index_sequence_for<Ts...>;
+
+    using Base::al_;
+    using Base::cap_;
+
+    // Rows i.. of the storage, as a source of aggregate inputs
+    struct Run {
+        using value_type = std::tuple<detail::Value_t<Ts>...>;
+        const basic_ring *r;
+        std::size_t i;
+        template <std::size_t I>
+        DORI_inline auto data() const noexcept
+        {
+            return r->template Column<I>() + i;
+        }
+    };
+
+    static_assert(!(detail::Is_varlen<Ts> || ...),
+                  "varlen columns are supported by vector only");
+    static_assert(!(detail::Is_nullable<Ts> || ...),
+                  "nullable columns are supported by vector only");
+
+  public:
+    using value_type      = typename Base::value_type;
+    using reference       = typename Base::reference;
+    using const_reference = typename Base::const_reference;
+    using size_type       = std::size_t;
+    using allocator_type  = Al;
+
+    basic_ring() noexcept(noexcept(Al{})) = default;
+
+    // An empty ring of n rows of capacity
+    explicit basic_ring(size_type n, const Al &alloc = Al{}) : Base{alloc}
+    {
+        if (n)
+            Base::reserve(n);
+        n_ = n;
+    }
+
+    basic_ring(const basic_ring &other)
+        : basic_ring{other.n_, Al_tr::select_on_container_copy_construction(
+                                   other.al_)}
+    {
+        const auto [a, b] = other.Runs();
+        Copy_in(a.first, a.second, other, Js{});
+        Copy_in(b.first, b.second, other, Js{});
+    }
+    basic_ring(basic_ring &&other) noexcept
+        : Base{static_cast<Base &&>(other)},
+          head_{std::exchange(other.head_, 0)},
+          size_{std::exchange(other.size_, 0)}, n_{std::exchange(other.n_, 0)}
+    {
+    }
+
+    basic_ring &operator=(const basic_ring &rhs)
+    {
+        if (this != &rhs) {
+            basic_ring tmp{rhs};
+            swap(tmp);
+        }
+        return *this;
+    }
+    basic_ring &operator=(basic_ring &&rhs) noexcept
+    {
+        basic_ring tmp{static_cast<basic_ring &&>(rhs)};
+        swap(tmp);
+        return *this;
+    }
+
+    ~basic_ring() { clear(); }
+
+    void swap(basic_ring &other) noexcept
+    {
+        Base::swap(other);
+        std::swap(head_, other.head_);
+        std::swap(size_, other.size_);
+        std::swap(n_, other.n_);
+    }
+
+    Al get_allocator() const noexcept { return al_; }
+
+    size_type size() const noexcept { return size_; }
+    size_type capacity() const noexcept { return n_; }
+    bool empty() const noexcept { return !size_; }
+    bool full() const noexcept { return size_ == n_; }
+
+    //
+    // Element access; row 0 is the first
+    //
+
+    DORI_inline reference operator[](size_type i) noexcept
+    {
+        DORI_assert(i < size_);
+        return Row_at(Phys(i), Js{});
+    }
+    DORI_inline const_reference operator[](size_type i) const noexcept
+    {
+        DORI_assert(i < size_);
+        return Row_at(Phys(i), Js{});
+    }
+    DORI_inline reference front() noexcept { return (*this)[0]; }
+    DORI_inline const_reference front() const noexcept { return (*this)[0]; }
+    DORI_inline reference back() noexcept { return (*this)[size_ - 1]; }
+    DORI_inline const_reference back() const noexcept
+    {
+        return (*this)[size_ - 1];
+    }
+
+    //
+    // Column I of the rows as two runs, the second of which is empty unless
+    // the rows wrap around
+    //
+    template <std::size_t I>
+    DORI_inline auto spans() noexcept
+    {
+        return Spans_of(Column<I>());
+    }
+    template <std::size_t I>
+    DORI_inline auto spans() const noexcept
+    {
+        return Spans_of(Column<I>());
+    }
+
+    //
+    // Modifiers
+    //
+
+    // Appends a row of xs, dropping the first row if the ring is full
+    template <class... Us>
+    requires(sizeof...(Us) == sizeof...(Ts)) //
+        void push_back(Us &&...xs)
+    {
+        DORI_assert(n_ && "ring has no capacity");
+        if (size_ == n_)
+            pop_front();
+        Construct_row(Phys(size_), Js{}, static_cast<Us &&>(xs)...);
+        ++size_;
+    }
+    void push_back(const value_type &x)
+    {
+        std::apply([&](const auto &...xs) { push_back(xs...); }, x);
+    }
+
+    //
+    // Appends n rows, column I of which is read from first Is (a pointer or
+    // an iterator), dropping as many rows from the front as don't fit. Only
+    // the last capacity() rows of a larger batch are kept.
+    //
+    template <class... Its>
+    requires(sizeof...(Its) == sizeof...(Ts)) //
+        void append(size_type n, Its... firsts)
+    {
+        DORI_assert(n_ || !n);
+        if (n > n_) {
+            ((firsts += static_cast<std::ptrdiff_t>(n - n_)), ...);
+            n = n_;
+        }
+        if (size_ + n > n_)
+            pop_front(size_ + n - n_);
+        const auto i = Phys(size_);
+        const auto k = std::min(n, n_ - i);
+        Append_runs(i, k, n - k, Js{}, firsts...);
+        size_ += n;
+    }
+    // Appends the rows of v, a vector of the same columns
+    template <class V>
+    void append(const V &v)
+    {
+        if (!v.empty())
+            [&]<std::size_t... Is>(std::index_sequence<Is...>)
+            {
+                append(v.size(), v.template data<Is>()...);
+            }
+        (Js{});
+    }
+
+    // Destroys the first n rows
+    void pop_front(size_type n = 1) noexcept
+    {
+        DORI_assert(n <= size_);
+        const auto k = std::min(n, n_ - head_);
+        Destroy_run(head_, k, Js{});
+        Destroy_run(0, n - k, Js{});
+        head_ = Phys(n);
+        size_ -= n;
+        if (!size_)
+            head_ = 0;
+    }
+
+    void clear() noexcept
+    {
+        if (size_)
+            pop_front(size_);
+    }
+
+    //
+    // The value of each aggregate in As over the last w rows, as a tuple; see
+    // aggregate.h
+    //
+    //   auto [lo, hi] = r.aggregate<dori::min<0>, dori::max<0>>(100);
+    //
+    template <class... As>
+    auto aggregate(size_type w) const
+    {
+        DORI_assert(w && w <= size_ && "window out of range");
+        const auto f = Phys(size_ - w);
+        const auto k = std::min(w, n_ - f);
+        return std::tuple{Window<detail::Agg<As, Run>>(f, k, w - k)...};
+    }
+
+  private:
+    // Storage index of row i
+    DORI_inline size_type Phys(size_type i) const noexcept
+    {
+        const auto j = head_ + i;
+        return j >= n_ ? j - n_ : j;
+    }
+
+    // Start and length of the runs of the rows in the storage
+    DORI_inline std::array<std::pair<size_type, size_type>, 2>
+    Runs() const noexcept
+    {
+        const auto k = std::min(size_, n_ - head_);
+        return {{{head_, k}, {0, size_ - k}}};
+    }
+
+    template <std::size_t I>
+    DORI_inline auto Column() noexcept
+    {
+        return cap_ ? Base::template data<I>()
+                    : decltype(Base::template data<I>()){};
+    }
+    template <std::size_t I>
+    DORI_inline auto Column() const noexcept
+    {
+        return cap_ ? Base::template data<I>()
+                    : decltype(Base::template data<I>()){};
+    }
+
+    template <class P>
+    DORI_inline std::array<column_span<P>, 2> Spans_of(P p) const noexcept
+    {
+        const auto [a, b] = Runs();
+        return {{{p + a.first, a.second}, {p + b.first, b.second}}};
+    }
+
+    template <std::size_t... Is>
+    DORI_inline reference Row_at(size_type i,
+                                 std::index_sequence<Is...>) noexcept
+    {
+        return reference{Column<Is>()[i]...};
+    }
+    template <std::size_t... Is>
+    DORI_inline const_reference
+    Row_at(size_type i, std::index_sequence<Is...>) const noexcept
+    {
+        return const_reference{Column<Is>()[i]...};
+    }
+
+    //
+    // Construction and destruction of elements
+    //
+
+    template <class T, class U>
+    DORI_inline void Construct(T *p, U &&x)
+    {
+        Al_tr::construct(al_, p, static_cast<U &&>(x));
+    }
+    template <class T, std::size_t Bits, class U>
+    DORI_inline void Construct(packed_ptr<T, Bits> p, U &&x) noexcept
+    {
+        *p = static_cast<T>(x);
+    }
+
+    template <class T>
+    DORI_inline void Destroy_n(T *p, size_type n) noexcept
+    {
+        if constexpr (!std::is_trivially_destructible_v<T>)
+            for (const auto l = p + n; p != l; ++p)
+                Al_tr::destroy(al_, p);
+    }
+    template <class T, std::size_t Bits>
+    DORI_inline void Destroy_n(packed_ptr<T, Bits>, size_type) noexcept
+    {
+    }
+
+    // Constructs n elements at d from s, or none if one throws
+    template <class P, class It>
+    void Construct_n(P d, It s, size_type n)
+    {
+        using T = std::remove_pointer_t<P>;
+        if constexpr (std::is_pointer_v<P> && std::is_pointer_v<It> &&
+                      std::is_trivially_copyable_v<T> &&
+                      std::is_same_v<std::remove_cv_t<
+                                         std::remove_pointer_t<It>>,
+                                     T>) {
+            if (n)
+                std::memcpy(d, s, n * sizeof(T));
+        } else {
+            size_type i = 0;
+            try {
+                for (; i != n; ++i, ++s)
+                    Construct(d + i, *s);
+            } catch (...) {
+                Destroy_n(d, i);
+                throw;
+            }
+        }
+    }
+
+    template <std::size_t... Is, class... Us>
+    void Construct_row(size_type i, std::index_sequence<Is...>, Us &&...xs)
+    {
+        std::size_t done = 0;
+        try {
+            (..., (Construct(Column<Is>() + i, static_cast<Us &&>(xs)),
+                   ++done));
+        } catch (...) {
+            (..., (Is < done ? Destroy_n(Column<Is>() + i, 1) : void()));
+            throw;
+        }
+    }
+
+    // Constructs each column in two runs: k rows at i, and m rows at 0
+    template <std::size_t... Is, class... Its>
+    void Append_runs(size_type i, size_type k, size_type m,
+                     std::index_sequence<Is...>, Its... firsts)
+    {
+        std::size_t done = 0;
+        try {
+            (..., (Append_column<Is>(i, k, m, firsts), ++done));
+        } catch (...) {
+            (..., (Is < done ? (Destroy_n(Column<Is>() + i, k),
+                                Destroy_n(Column<Is>(), m))
+                             : void()));
+            throw;
+        }
+    }
+    template <std::size_t I, class It>
+    void Append_column(size_type i, size_type k, size_type m, It s)
+    {
+        const auto d = Column<I>();
+        Construct_n(d + i, s, k);
+        try {
+            Construct_n(d, s + static_cast<std::ptrdiff_t>(k), m);
+        } catch (...) {
+            Destroy_n(d + i, k);
+            throw;
+        }
+    }
+
+    // Copies rows i..i + n of the storage of other to the end
+    template <std::size_t... Is>
+    void Copy_in(size_type i, size_type n, const basic_ring &other,
+                 std::index_sequence<Is...>)
+    {
+        if (n)
+            append(n, (other.template Column<Is>() + i)...);
+    }
+
+    template <std::size_t... Is>
+    DORI_inline void Destroy_run(size_type i, size_type n,
+                                 std::index_sequence<Is...>) noexcept
+    {
+        (..., Destroy_n(Column<Is>() + i, n));
+    }
+
+    // Folds aggregate A over k rows at f and m rows at 0
+    template <class A>
+    typename A::type Window(size_type f, size_type k, size_type m) const
+    {
+        const auto a = A::Column(Run{this, f});
+        typename A::type acc = A::First(detail::Column_at(a, 0));
+        for (size_type j = 1; j < k; ++j)
+            A::Add(acc, detail::Column_at(a, j));
+        const auto b = A::Column(Run{this, 0});
+        for (size_type j = 0; j < m; ++j)
+            A::Add(acc, detail::Column_at(b, j));
+        return acc;
+    }
+
+    size_type head_ = 0;
+    size_type size_   = 0;
+    size_type n_    = 0;
+};
+
+template <class Layout, class Al, class... Ts>
+DORI_inline void swap(basic_ring<Layout, Al, Ts...> &lhs,
+                      basic_ring<Layout, Al, Ts...> &rhs) noexcept
+{
+    lhs.swap(rhs);
+}
+
+namespace detail
+{
+template <class Vector>
+struct Deduce_ring;
+template <class Al, class... Ts>
+struct Deduce_ring<vector_al<Al, Ts...>> {
+    using type = basic_ring<layout::default_policy, Al, Ts...>;
+};
+template <class Layout, class Al, class... Ts>
+struct Deduce_ring<basic_vector<Layout, Al, Ts...>> {
+    using type = basic_ring<Layout, Al, Ts...>;
+};
+} // namespace detail
+
+//
+// ring<Ts..., [Allocator], [Layout]> like vector
+//
+template <class... Ts>
+using ring = typename detail::Deduce_ring<
+    detail::Deduce_vec<boost::mp11::mp_list<Ts...>>>::type;
+
+} // namespace dori
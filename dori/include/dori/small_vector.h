@@ -0,0 +1,221 @@
+#pragma once
+
+#include "detail/sbo_allocator.h"
+#include "vector.h"
+
+namespace dori
+{
+
+//
+// A vector that stores up to N rows inline in the object, in the same layout
+// as the allocation of the corresponding vector would have, and moves to the
+// heap only when reserve() asks for more. Initially capacity() == N, so that
+// push_back() etc. may be used right away. Unlike with vector, moving a
+// small_vector whose rows are inline moves the rows one by one.
+//
+
+namespace detail
+{
+// Inline capacity and allocator of a small_vector; N is rounded up so that the
+// buffer holds whole granules of the layout
+template <std::size_t N, class Layout, class Allocator, class... Ts>
+struct Small_vector_traits {
+    using Info = layout::info<basic_vector<Layout, Allocator, Ts...>>;
+    static constexpr std::size_t Inline_cap =
+        (N + Info::granularity - 1) / Info::granularity * Info::granularity;
+    using Al   = Sbo_allocator<Info::bytes(Inline_cap), Info::alignment,
+                             Allocator>;
+    using Base = Get_vector_t<Al, Layout, Ts...>;
+};
+} // namespace detail
+
+template <std::size_t N, class Layout, class Allocator, class... Ts>
+class basic_small_vector
+    : public detail::Small_vector_traits<N, Layout, Allocator, Ts...>::Base
+{
+    using Traits = detail::Small_vector_traits<N, Layout, Allocator, Ts...>;
+    using Base   = typename Traits::Base;
+    static constexpr auto Inline_cap = Traits::Inline_cap;
+
+    using Base::al_;
+    using Base::cap_;
+    using Base::p_;
+    using Base::sz_;
+
+    static_assert(N > 0, "use dori::vector for no inline storage");
+    static_assert(!(detail::Is_varlen<Ts> || ...),
+                  "varlen columns are supported by vector only");
+
+    constexpr DORI_inline bool Is_inline() const noexcept
+    {
+        return al_.owns(p_);
+    }
+
+    // Adopt the heap storage of other, which then reverts to inline storage
+    constexpr DORI_inline void Take_storage(basic_small_vector &other) noexcept
+    {
+        DORI_assert(!other.Is_inline());
+        this->Maybe_delete();
+        p_         = other.p_;
+        sz_        = other.sz_;
+        cap_       = other.cap_;
+        other.sz_  = 0;
+        other.cap_ = 0;
+        other.reserve(Inline_cap);
+    }
+
+  public:
+    using allocator_type = Allocator;
+
+    static constexpr std::size_t inline_capacity = Inline_cap;
+
+    constexpr DORI_inline basic_small_vector() noexcept(noexcept(Allocator{}))
+        : Base{}
+    {
+        this->reserve(Inline_cap);
+    }
+    constexpr DORI_inline explicit basic_small_vector(
+        const Allocator &alloc) noexcept
+        : Base{typename Traits::Al{alloc}}
+    {
+        this->reserve(Inline_cap);
+    }
+
+    constexpr DORI_inline basic_small_vector(const basic_small_vector &other)
+        : basic_small_vector{other.get_allocator()}
+    {
+        if (other.size() > Inline_cap)
+            this->reserve(other.size());
+        Base::operator=(other);
+    }
+
+    constexpr DORI_inline basic_small_vector(basic_small_vector &&other)
+        : basic_small_vector{other.get_allocator()}
+    {
+        if (other.Is_inline()) {
+            Base::operator=(static_cast<Base &&>(other));
+            other.clear();
+        } else
+            Take_storage(other);
+    }
+
+    constexpr DORI_inline basic_small_vector &
+    operator=(const basic_small_vector &rhs)
+    {
+        Base::operator=(rhs);
+        return *this;
+    }
+
+    constexpr DORI_inline basic_small_vector &
+    operator=(basic_small_vector &&rhs)
+    {
+        if (this == &rhs)
+            return *this;
+        if (!rhs.Is_inline() && al_.upstream() == rhs.al_.upstream())
+            Take_storage(rhs);
+        else {
+            Base::operator=(static_cast<Base &&>(rhs));
+            rhs.clear();
+        }
+        return *this;
+    }
+
+    constexpr DORI_inline ~basic_small_vector() = default;
+
+    constexpr DORI_inline Allocator get_allocator() const noexcept
+    {
+        return al_.upstream();
+    }
+
+    constexpr DORI_inline bool is_inline() const noexcept
+    {
+        return Is_inline();
+    }
+
+    constexpr DORI_inline void swap(basic_small_vector &other)
+    {
+        if (!Is_inline() && !other.Is_inline()) {
+            std::swap(p_, other.p_);
+            std::swap(sz_, other.sz_);
+            std::swap(cap_, other.cap_);
+        } else {
+            basic_small_vector tmp{static_cast<basic_small_vector &&>(other)};
+            other = static_cast<basic_small_vector &&>(*this);
+            *this = static_cast<basic_small_vector &&>(tmp);
+        }
+    }
+
+    // Returns to inline storage if the rows fit
+    constexpr DORI_inline void shrink_to_fit()
+    {
+        if (Is_inline())
+            return;
+        if (sz_ > Inline_cap) {
+            Base::shrink_to_fit();
+            return;
+        }
+        basic_small_vector tmp{get_allocator()};
+        tmp.Base::operator=(static_cast<Base &&>(*this));
+        this->Maybe_delete();
+        sz_ = cap_ = 0;
+        this->reserve(Inline_cap);
+        Base::operator=(static_cast<Base &&>(tmp));
+    }
+};
+
+namespace detail
+{
+template <std::size_t N, class Vector>
+struct Deduce_small_vec;
+template <std::size_t N, class Al, class... Ts>
+struct Deduce_small_vec<N, vector_al<Al, Ts...>> {
+    using type = basic_small_vector<N, layout::default_policy, Al, Ts...>;
+};
+template <std::size_t N, class Layout, class Al, class... Ts>
+struct Deduce_small_vec<N, basic_vector<Layout, Al, Ts...>> {
+    using type = basic_small_vector<N, Layout, Al, Ts...>;
+};
+} // namespace detail
+
+template <std::size_t N, class Layout, class Al, class... Ts>
+constexpr DORI_inline bool
+operator==(const basic_small_vector<N, Layout, Al, Ts...> &lhs,
+           const basic_small_vector<N, Layout, Al, Ts...> &rhs) noexcept
+{
+    if (lhs.size() != rhs.size())
+        return false;
+    if (lhs.empty())
+        return true;
+    return [&]<std::size_t... Is>(std::index_sequence<Is...>)
+    {
+        return (... && std::equal(lhs.template data<Is>(),
+                                  lhs.template data<Is>() + lhs.size(),
+                                  rhs.template data<Is>(),
+                                  rhs.template data<Is>() + rhs.size()));
+    }
+    (std::index_sequence_for<Ts...>{});
+}
+
+template <std::size_t N, class Layout, class Al, class... Ts>
+constexpr DORI_inline bool
+operator!=(const basic_small_vector<N, Layout, Al, Ts...> &lhs,
+           const basic_small_vector<N, Layout, Al, Ts...> &rhs) noexcept
+{
+    return !(lhs == rhs);
+}
+
+template <std::size_t N, class Layout, class Al, class... Ts>
+constexpr DORI_inline void swap(basic_small_vector<N, Layout, Al, Ts...> &lhs,
+                                basic_small_vector<N, Layout, Al, Ts...> &rhs)
+{
+    lhs.swap(rhs);
+}
+
+//
+// small_vector<N, Ts..., [Allocator], [Layout]> like vector
+//
+template <std::size_t N, class... Ts>
+using small_vector = typename detail::Deduce_small_vec<
+    N, detail::Deduce_vec<boost::mp11::mp_list<Ts...>>>::type;
+
+} // namespace dori
@@ -0,0 +1,625 @@
+#pragma once
+
+//
+// static_vector<N, Ts...> is a vector of at most N rows, each type of which is
+// stored in an array of its own within the object. There's no allocator and
+// no reinterpretation of storage, so the container is usable in constant
+// evaluation, e.g. for building lookup tables at compile time:
+//
+//   constexpr auto tbl = [] {
+//       dori::static_vector<256, std::uint8_t, float> res;
+//       for (int i = 0; i < 256; ++i)
+//           res.push_back(..., ...);
+//       return res;
+//   }();
+//
+// A static_vector held in a constexpr variable needs to be full unless its
+// element types are trivial, as unused storage isn't initialized otherwise.
+// For trivial element types the container is trivially copyable as well.
+//
+
+#include "detail/assert.h"
+#include "detail/inline.h"
+#include "detail/traits.h"
+#include "detail/unsafe.h"
+#include "packed.h"
+#include "query.h"
+
+#include <algorithm>
+#include <boost/mp11/algorithm.hpp>
+#include <boost/mp11/list.hpp>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace dori
+{
+
+namespace detail
+{
+
+template <class Ts, std::size_t N, std::size_t... Is>
+class static_vector_impl;
+
+template <class T>
+inline constexpr bool Is_static_trivial =
+    std::is_trivially_default_constructible_v<T> &&
+    std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>;
+
+//
+// Storage for one sequence. Elements of trivial types are zero-initialized in
+// constant evaluation only, as constant expressions may not leave any value
+// indeterminate. Other elements live in a union so that they're constructed
+// and destroyed only as rows are added and removed.
+//
+template <std::size_t I, class T, std::size_t N, bool = Is_static_trivial<T>>
+struct Static_column {
+    constexpr DORI_inline Static_column() noexcept
+    {
+        if (std::is_constant_evaluated())
+            for (auto &x : xs)
+                x = T{};
+    }
+    T xs[N];
+};
+
+template <std::size_t I, class T, std::size_t N>
+struct Static_column<I, T, N, false> {
+    constexpr DORI_inline Static_column() noexcept {}
+    constexpr DORI_inline Static_column(const Static_column &) noexcept {}
+    constexpr DORI_inline Static_column &
+    operator=(const Static_column &) noexcept
+    {
+        return *this;
+    }
+    constexpr DORI_inline ~Static_column() {}
+    union {
+        T xs[N];
+    };
+};
+
+template <std::size_t N, class Ts, class Is>
+struct Static_columns;
+template <std::size_t N, class... Ts, std::size_t... Is>
+struct Static_columns<N, mp_list<Ts...>, std::index_sequence<Is...>>
+    : Static_column<Is, Ts, N>... {
+};
+
+template <class... Ts, std::size_t N, std::size_t... Is>
+class static_vector_impl<mp_list<Ts...>, N, Is...>
+{
+    static constexpr inline bool Trivial = (Is_static_trivial<Ts> && ...);
+    static_assert(!(Is_packed<Ts> || ...),
+                  "packed columns are supported by vector only");
+    static_assert(!(Is_varlen<Ts> || ...),
+                  "varlen columns are supported by vector only");
+    static_assert(!(Is_nullable<Ts> || ...),
+                  "nullable columns are supported by vector only");
+
+    template <std::size_t I>
+    using Ith = mp_at_c<mp_list<Ts...>, I>;
+
+  public:
+    using value_type      = std::tuple<Ts...>;
+    using reference       = std::tuple<Ts &...>;
+    using const_reference = std::tuple<const Ts &...>;
+    using difference_type = std::ptrdiff_t;
+    using size_type       = std::size_t;
+
+#define DORI_static_vector_iterator_convop_and_ptrsty_const_iterator          \
+    std::tuple<const Ts *...>
+#define DORI_static_vector_iterator_convop_and_ptrsty_iterator                \
+    constexpr DORI_inline operator const_iterator() const noexcept             \
+    {                                                                          \
+        return {ptrs, i};                                                      \
+    }                                                                          \
+    std::tuple<Ts *...>
+
+#define DORI_static_vector_iterator(It, Ref)                                   \
+    struct It {                                                                \
+        using difference_type   = static_vector_impl::difference_type;         \
+        using value_type        = static_vector_impl::value_type;              \
+        using reference         = static_vector_impl::reference;               \
+        using iterator_category = std::input_iterator_tag;                     \
+        constexpr DORI_inline It &operator++() noexcept { return ++i, *this; } \
+        constexpr DORI_inline It operator++(int) noexcept                      \
+        {                                                                      \
+            return {ptrs, i++};                                                \
+        }                                                                      \
+        constexpr DORI_inline Ref operator*() noexcept                         \
+        {                                                                      \
+            DORI_assert(i < 0 && "out-of-bounds access");                      \
+            return {std::get<Is>(ptrs)[i]...};                                 \
+        }                                                                      \
+        constexpr DORI_inline bool operator==(const It &it) const noexcept     \
+        {                                                                      \
+            return i == it.i;                                                  \
+        }                                                                      \
+        constexpr DORI_inline bool operator!=(const It &it) const noexcept     \
+        {                                                                      \
+            return i != it.i;                                                  \
+        }                                                                      \
+        DORI_static_vector_iterator_convop_and_ptrsty_##It ptrs;              \
+        std::ptrdiff_t i = 0;                                                  \
+    }
+
+    DORI_static_vector_iterator(const_iterator, const_reference);
+    DORI_static_vector_iterator(iterator, reference);
+
+  private:
+    template <std::size_t I>
+    constexpr DORI_inline auto *Get_data() noexcept
+    {
+        return static_cast<Static_column<I, Ith<I>, N> &>(cols_).xs;
+    }
+    template <std::size_t I>
+    constexpr DORI_inline const auto *Get_data() const noexcept
+    {
+        return static_cast<const Static_column<I, Ith<I>, N> &>(cols_).xs;
+    }
+
+    constexpr DORI_inline void Destroy_range(size_type f, size_type l) noexcept
+    {
+        if constexpr (!Trivial)
+            (..., [&]<class T>(T *p) {
+                for (auto i = f; i != l; ++i)
+                    std::destroy_at(p + i);
+            }(Get_data<Is>()));
+    }
+
+    // Destroys rows f..l of sequences before I, and rows f..l_i of sequence I
+    template <std::size_t I>
+    constexpr DORI_inline void Unwind(size_type f, size_type l,
+                                      size_type l_i) noexcept
+    {
+        (..., [&](auto *p, std::size_t j) {
+            if (j <= I)
+                for (auto i = f, e = j == I ? l_i : l; i != e; ++i)
+                    std::destroy_at(p + i);
+        }(Get_data<Is>(), Is));
+    }
+
+    template <bool Move, class Vector>
+    constexpr DORI_inline void Construct_from(Vector &v)
+    {
+        DORI_assert(!sz_);
+        using Nothrow = std::bool_constant<
+            (... && (Move ? std::is_nothrow_move_constructible_v<Ts>
+                          : std::is_nothrow_copy_constructible_v<Ts>))>;
+        (..., [&]<std::size_t I, class T>(auto *f, T *d_f) {
+            using Fwd_t = std::conditional_t<Move, T &&, const T &>;
+            size_type i = 0;
+            Try<Nothrow::value>([&] {
+                for (; i != v.sz_; ++i)
+                    std::construct_at(d_f + i, static_cast<Fwd_t>(f[i]));
+            })([&] {
+                Unwind<I>(0, v.sz_, i);
+                throw;
+            });
+        }.template operator()<Is>(v.template Get_data<Is>(), Get_data<Is>()));
+        sz_ = v.sz_;
+    }
+
+    template <bool Move, class Vector>
+    constexpr DORI_inline void Assign_from(Vector &v)
+    {
+        const auto sz = sz_, v_sz = v.sz_, mid = std::min(sz, v_sz);
+        (..., [&]<class T>(auto *f, T *d_f) {
+            using Fwd_t = std::conditional_t<Move, T &&, const T &>;
+            size_type i = 0;
+            for (; i != mid; ++i)
+                d_f[i] = static_cast<Fwd_t>(f[i]);
+            for (; i < v_sz; ++i)
+                Call_maybe_unsafe(
+                    [](T *x, auto *y) {
+                        std::construct_at(x, static_cast<Fwd_t>(*y));
+                    },
+                    d_f + i, f + i);
+            if constexpr (!Is_static_trivial<T>)
+                for (; i < sz; ++i)
+                    std::destroy_at(d_f + i);
+        }(v.template Get_data<Is>(), Get_data<Is>()));
+        sz_ = v.sz_;
+    }
+
+  public:
+    constexpr DORI_inline static_vector_impl() noexcept = default;
+
+    template <class... Args>
+    requires(sizeof...(Args) == sizeof...(Ts) * 2 &&
+             mp_all_of<mp_list<Args...>, Is_input_iterator>::value) //
+        constexpr DORI_inline static_vector_impl(Args... args)
+    {
+        std::tuple<Args...> its{args...};
+        sz_ = static_cast<size_type>(
+            std::distance(std::get<0>(its), std::get<1>(its)));
+        DORI_assert(sz_ <= N);
+        (..., [&]<std::size_t I, class T>(T *d_f, auto f, const auto l) {
+            size_type i = 0;
+            try {
+                for (; f != l; ++f, ++i)
+                    std::construct_at(d_f + i, *f);
+            } catch (...) {
+                Unwind<I>(0, sz_, i);
+                throw;
+            }
+        }.template operator()<Is>(Get_data<Is>(), std::get<Is * 2>(its),
+                                  std::get<Is * 2 + 1>(its)));
+    }
+
+    constexpr DORI_inline
+    static_vector_impl(const static_vector_impl &) requires Trivial = default;
+    constexpr DORI_inline static_vector_impl(const static_vector_impl &other)
+    {
+        Construct_from<false>(other);
+    }
+
+    constexpr DORI_inline
+    static_vector_impl(static_vector_impl &&) requires Trivial = default;
+    constexpr DORI_inline
+    static_vector_impl(static_vector_impl &&other) noexcept(
+        (std::is_nothrow_move_constructible_v<Ts> && ...))
+    {
+        Construct_from<true>(other);
+    }
+
+    constexpr DORI_inline static_vector_impl &
+    operator=(const static_vector_impl &) requires Trivial = default;
+    constexpr DORI_inline static_vector_impl &
+    operator=(const static_vector_impl &rhs)
+    {
+        if (this != &rhs)
+            Assign_from<false>(rhs);
+        return *this;
+    }
+
+    constexpr DORI_inline static_vector_impl &
+    operator=(static_vector_impl &&) requires Trivial = default;
+    constexpr DORI_inline static_vector_impl &
+    operator=(static_vector_impl &&rhs) noexcept(
+        (std::is_nothrow_move_assignable_v<Ts> && ...) &&
+        (std::is_nothrow_move_constructible_v<Ts> && ...))
+    {
+        if (this != &rhs)
+            Assign_from<true>(rhs);
+        return *this;
+    }
+
+    constexpr DORI_inline ~static_vector_impl() requires Trivial = default;
+    constexpr DORI_inline ~static_vector_impl() { clear(); }
+
+    constexpr DORI_inline void swap(static_vector_impl &other) noexcept(
+        (std::is_nothrow_swappable_v<Ts> && ...) &&
+        (std::is_nothrow_move_constructible_v<Ts> && ...))
+    {
+        // Swap the common rows, then move the rest over to the shorter one
+        auto &lo = sz_ < other.sz_ ? *this : other;
+        auto &hi = sz_ < other.sz_ ? other : *this;
+        (..., [&]<class T>(T *a, T *b) {
+            using std::swap;
+            size_type i = 0;
+            for (; i != lo.sz_; ++i)
+                swap(a[i], b[i]);
+            for (; i != hi.sz_; ++i) {
+                Call_maybe_unsafe(
+                    [](T *x, T *y) {
+                        std::construct_at(x, static_cast<T &&>(*y));
+                    },
+                    a + i, b + i);
+                std::destroy_at(b + i);
+            }
+        }(lo.template Get_data<Is>(), hi.template Get_data<Is>()));
+        std::swap(sz_, other.sz_);
+    }
+
+    constexpr DORI_inline reference operator[](size_type i) noexcept
+    {
+        DORI_assert(i < sz_);
+        return {Get_data<Is>()[i]...};
+    }
+
+    constexpr DORI_inline const_reference operator[](size_type i) const noexcept
+    {
+        DORI_assert(i < sz_);
+        return {Get_data<Is>()[i]...};
+    }
+
+    constexpr DORI_inline reference at(size_type i)
+    {
+        if (i >= sz_)
+            throw std::out_of_range{"dori::static_vector::at"};
+        return operator[](i);
+    }
+
+    constexpr DORI_inline const_reference at(size_type i) const
+    {
+        if (i >= sz_)
+            throw std::out_of_range{"dori::static_vector::at"};
+        return operator[](i);
+    }
+
+    constexpr DORI_inline reference front() noexcept
+    {
+        DORI_assert(sz_ > 0);
+        return operator[](0);
+    }
+    constexpr DORI_inline const_reference front() const noexcept
+    {
+        DORI_assert(sz_ > 0);
+        return operator[](0);
+    }
+
+    constexpr DORI_inline reference back() noexcept
+    {
+        DORI_assert(sz_ > 0);
+        return operator[](sz_ - 1);
+    }
+    constexpr DORI_inline const_reference back() const noexcept
+    {
+        DORI_assert(sz_ > 0);
+        return operator[](sz_ - 1);
+    }
+
+    template <std::size_t I>
+    requires(I < sizeof...(Ts)) constexpr DORI_inline Ith<I> *data() noexcept
+    {
+        return Get_data<I>();
+    }
+
+    template <std::size_t I>
+    requires(I < sizeof...(Ts)) constexpr DORI_inline const Ith<I> *data() const
+        noexcept
+    {
+        return Get_data<I>();
+    }
+
+  private:
+    constexpr DORI_inline auto Iter_at(size_type idx) noexcept
+    {
+        return iterator{{(Get_data<Is>() + sz_)...},
+                        static_cast<std::ptrdiff_t>(idx - sz_)};
+    }
+    constexpr DORI_inline auto Iter_at(size_type idx) const noexcept
+    {
+        return const_iterator{{(Get_data<Is>() + sz_)...},
+                              static_cast<std::ptrdiff_t>(idx - sz_)};
+    }
+
+  public:
+    constexpr DORI_inline auto begin() noexcept { return Iter_at(0); }
+    constexpr DORI_inline auto begin() const noexcept { return Iter_at(0); }
+    constexpr DORI_inline auto cbegin() const noexcept { return Iter_at(0); }
+
+    constexpr DORI_inline iterator end() noexcept { return {}; }
+    constexpr DORI_inline const_iterator end() const noexcept { return {}; }
+    constexpr DORI_inline const_iterator cend() const noexcept { return {}; }
+
+    constexpr DORI_inline bool empty() const noexcept { return !sz_; }
+    constexpr DORI_inline bool full() const noexcept { return sz_ == N; }
+    constexpr DORI_inline size_type size() const noexcept { return sz_; }
+    static constexpr DORI_inline size_type capacity() noexcept { return N; }
+    static constexpr DORI_inline size_type max_size() noexcept { return N; }
+
+    constexpr DORI_inline void clear() noexcept
+    {
+        Destroy_range(0, sz_);
+        sz_ = 0;
+    }
+
+    constexpr DORI_inline iterator
+    erase(const_iterator first, const_iterator last) noexcept(
+        (noexcept(std::declval<Ts &>() = std::declval<Ts &&>()) && ...))
+    {
+        const auto f_i = sz_ + first.i;
+        const auto n   = static_cast<size_type>(last.i - first.i);
+        (..., [&]<class T>(T *p) {
+            for (auto i = f_i; i + n < sz_; ++i)
+                p[i] = static_cast<T &&>(p[i + n]);
+        }(Get_data<Is>()));
+        Destroy_range(sz_ - n, sz_);
+        sz_ -= n;
+        return Iter_at(f_i);
+    }
+
+    constexpr DORI_inline iterator
+    erase(const_iterator pos) noexcept(noexcept(erase(pos, std::next(pos))))
+    {
+        return erase(pos, std::next(pos));
+    }
+
+  private:
+    template <class... Us>
+    static constexpr inline auto Nothrow_emplace =
+        (... && mp_rename<mp_push_front<std::decay_t<Us>, Ts>,
+                          std::is_nothrow_constructible>::value);
+
+  public:
+    template <Tuple... Us>
+    requires(sizeof...(Ts) == sizeof...(Us)) //
+        constexpr DORI_inline iterator
+        emplace_back(std::piecewise_construct_t,
+                     Us &&...xs) noexcept(Nothrow_emplace<Us...>)
+    {
+        DORI_assert(sz_ < N);
+        using Fwd = std::tuple<Us &&...>;
+        Fwd fwd{static_cast<Us &&>(xs)...};
+        (..., [&]<std::size_t I, class U>(U &&t) {
+            Try<Nothrow_emplace<Us...>>([&] {
+                std::apply(
+                    [&](auto &&...args) {
+                        std::construct_at(Get_data<I>() + sz_,
+                                          static_cast<decltype(args)>(args)...);
+                    },
+                    static_cast<U &&>(t));
+            })([&] {
+                Unwind<I>(sz_, sz_ + 1, sz_);
+                throw;
+            });
+        }.template operator()<Is>(std::get<Is>(static_cast<Fwd &&>(fwd))));
+        return Iter_at(sz_++);
+    }
+
+    constexpr DORI_inline auto emplace_back() noexcept(
+        noexcept(emplace_back(std::piecewise_construct,
+                              (static_cast<void>(Is), std::tuple<>{})...))) //
+        requires(... &&std::is_default_constructible_v<Ts>)
+    {
+        return emplace_back(std::piecewise_construct,
+                            (static_cast<void>(Is), std::tuple<>{})...);
+    }
+
+    template <class... Us>
+    requires((std::is_constructible_v<Ts, Us &&> && ...) &&
+             sizeof...(Us) == sizeof...(Ts)) //
+        constexpr DORI_inline iterator
+        emplace_back(Us &&...xs) noexcept(noexcept(
+            emplace_back(std::piecewise_construct,
+                         std::tuple<Us &&>{static_cast<Us &&>(xs)}...)))
+    {
+        return emplace_back(std::piecewise_construct,
+                            std::tuple<Us &&>{static_cast<Us &&>(xs)}...);
+    }
+
+    template <class... Us>
+    requires((std::is_constructible_v<Ts, Us &&> && ...) &&
+             sizeof...(Us) == sizeof...(Ts)) //
+        constexpr DORI_inline void push_back(Us &&...xs) noexcept(noexcept(
+            emplace_back(std::piecewise_construct,
+                         std::tuple<Us &&>{static_cast<Us &&>(xs)}...)))
+    {
+        emplace_back(std::piecewise_construct,
+                     std::tuple<Us &&>{static_cast<Us &&>(xs)}...);
+    }
+
+    constexpr DORI_inline void push_back(const value_type &value) noexcept(
+        noexcept(push_back(std::get<Is>(value)...)))
+    {
+        push_back(std::get<Is>(value)...);
+    }
+
+    constexpr DORI_inline void push_back(value_type &&value) noexcept(
+        noexcept(push_back(std::get<Is>(static_cast<value_type &&>(value))...)))
+    {
+        push_back(std::get<Is>(static_cast<value_type &&>(value))...);
+    }
+
+    constexpr DORI_inline void pop_back() noexcept
+    {
+        DORI_assert(sz_ > 0);
+        Destroy_range(sz_ - 1, sz_);
+        --sz_;
+    }
+
+    constexpr DORI_inline void resize(size_type sz)
+    {
+        DORI_assert(sz <= N);
+        if (sz > sz_) { // proposed exceeds current => extend
+            (..., [&]<std::size_t I, class T>(T *p) {
+                auto i = sz_;
+                try {
+                    for (; i != sz; ++i)
+                        std::construct_at(p + i);
+                } catch (...) {
+                    Unwind<I>(sz_, sz, i);
+                    throw;
+                }
+            }.template operator()<Is>(Get_data<Is>()));
+        } else // current exceeds proposed => shrink
+            Destroy_range(sz, sz_);
+        sz_ = sz;
+    }
+
+    // The sequences never move, so for_each() and for_each_stable() are alike
+    template <class F>
+    requires((std::is_invocable_v<F &&, Ts *, Ts *> && ...)) //
+        constexpr DORI_inline void for_each(F &&f) noexcept(
+            noexcept((..., static_cast<F &&>(f)(data<Is>(), data<Is>()))))
+    {
+        (..., static_cast<F &&>(f)(Get_data<Is>(), Get_data<Is>() + sz_));
+    }
+    template <class F>
+    requires((std::is_invocable_v<F &&, const Ts *, const Ts *> && ...)) //
+        constexpr DORI_inline void for_each(F &&f) const
+        noexcept(noexcept((..., static_cast<F &&>(f)(data<Is>(), data<Is>()))))
+    {
+        (..., static_cast<F &&>(f)(Get_data<Is>(), Get_data<Is>() + sz_));
+    }
+    template <class F>
+    constexpr DORI_inline void for_each_stable(F &&f) noexcept(
+        noexcept(for_each(static_cast<F &&>(f))))
+    {
+        for_each(static_cast<F &&>(f));
+    }
+    template <class F>
+    constexpr DORI_inline void for_each_stable(F &&f) const
+        noexcept(noexcept(for_each(static_cast<F &&>(f))))
+    {
+        for_each(static_cast<F &&>(f));
+    }
+
+    // Starts a lazy query over the columns, evaluated in one fused pass; see
+    // query.h
+    constexpr DORI_inline auto query() const noexcept
+    {
+        return ::dori::query<static_vector_impl>{*this};
+    }
+
+  private:
+    template <class, std::size_t, std::size_t...>
+    friend class static_vector_impl;
+
+    size_type sz_ = 0;
+    Static_columns<N, mp_list<Ts...>, std::index_sequence<Is...>> cols_;
+};
+
+template <std::size_t N, class... Ts, std::size_t... Is>
+static_vector_impl<mp_list<Ts...>, N, Is...>
+    Get_static_vector(std::index_sequence<Is...>);
+
+template <std::size_t N, class... Ts>
+using Get_static_vector_t = decltype(Get_static_vector<N, Ts...>(
+    std::index_sequence_for<Ts...>{}));
+
+} // namespace detail
+
+template <std::size_t N, class... Ts>
+struct static_vector : detail::Get_static_vector_t<N, Ts...> {
+    using detail::Get_static_vector_t<N, Ts...>::static_vector_impl;
+};
+
+template <std::size_t N, class... Ts>
+constexpr DORI_inline bool
+operator==(const static_vector<N, Ts...> &lhs,
+           const static_vector<N, Ts...> &rhs) noexcept
+{
+    if (lhs.size() != rhs.size())
+        return false;
+    return [&]<std::size_t... Is>(std::index_sequence<Is...>)
+    {
+        return (... && std::equal(lhs.template data<Is>(),
+                                  lhs.template data<Is>() + lhs.size(),
+                                  rhs.template data<Is>(),
+                                  rhs.template data<Is>() + rhs.size()));
+    }
+    (std::index_sequence_for<Ts...>{});
+}
+
+template <std::size_t N, class... Ts>
+constexpr DORI_inline bool
+operator!=(const static_vector<N, Ts...> &lhs,
+           const static_vector<N, Ts...> &rhs) noexcept
+{
+    return !(lhs == rhs);
+}
+
+template <std::size_t N, class... Ts>
+constexpr DORI_inline void
+swap(static_vector<N, Ts...> &lhs,
+     static_vector<N, Ts...> &rhs) noexcept(noexcept(lhs.swap(rhs)))
+{
+    lhs.swap(rhs);
+}
+
+} // namespace dori
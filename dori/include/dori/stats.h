@@ -0,0 +1,243 @@
+#pragma once
+
+//
+// Instrumentation of dori containers. Define DORI_STATS=1 (for the whole
+// program) to have every vector instantiation count its allocations,
+// relocations, copies, assignments, and erase shifts along with the rows and
+// bytes these touch, the time spent in them, its peak capacity, and the
+// capacity it released unused. With DORI_STATS=0 (the default) none of this
+// is compiled in.
+//
+// Counters are kept per instantiation in entries of a global registry, which
+// can be iterated with for_each_entry() or printed with dump(). A hook set with
+// set_hook() is invoked at the beginning and end of each operation, e.g. for
+// forwarding into a tracing system.
+//
+
+#include "detail/inline.h"
+#include "detail/traits.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <stdio.h>
+#include <string_view>
+#include <type_traits>
+
+#ifndef DORI_STATS
+#define DORI_STATS 0
+#endif
+
+namespace dori::stats
+{
+
+enum class op { allocate, deallocate, relocate, copy, assign, erase, count };
+
+constexpr std::string_view op_names[]{"allocate", "deallocate", "relocate",
+                                      "copy",     "assign",     "erase"};
+
+enum class phase { begin, end };
+
+struct counters {
+    static constexpr auto N = static_cast<std::size_t>(op::count);
+    std::array<std::atomic<std::uint64_t>, N> calls{};
+    std::array<std::atomic<std::uint64_t>, N> rows{};
+    std::array<std::atomic<std::uint64_t>, N> bytes{};
+    std::array<std::atomic<std::uint64_t>, N> ns{};
+    std::atomic<std::uint64_t> peak_capacity{};
+    std::atomic<std::uint64_t> wasted_capacity{}; // rows released unused
+};
+
+struct entry {
+    std::string_view name;
+    std::size_t columns;
+    std::size_t row_size; // bytes per row, i.e. sum of column element sizes
+    counters c;
+    entry *next = nullptr;
+};
+
+struct event {
+    op kind;
+    phase ph;
+    const entry &e;
+    std::size_t rows;
+    std::size_t bytes;
+};
+
+using hook_t = void (*)(const event &) noexcept;
+
+namespace detail
+{
+inline std::atomic<entry *> head{nullptr};
+inline std::atomic<hook_t> hook{nullptr};
+
+inline entry &Register(entry &e) noexcept
+{
+    e.next = head.load(std::memory_order_relaxed);
+    while (!head.compare_exchange_weak(e.next, &e, std::memory_order_release,
+                                       std::memory_order_relaxed))
+        ;
+    return e;
+}
+
+template <class Vector, std::size_t Columns, std::size_t Row_size>
+entry &Entry_for() noexcept
+{
+    static entry e{::dori::detail::Get_type_name<Vector>(), Columns, Row_size,
+                   {}};
+    [[maybe_unused]] static const bool registered = (Register(e), true);
+    return e;
+}
+
+inline void Add(std::atomic<std::uint64_t> &c, std::uint64_t n) noexcept
+{
+    c.fetch_add(n, std::memory_order_relaxed);
+}
+
+inline void Max(std::atomic<std::uint64_t> &c, std::uint64_t n) noexcept
+{
+    auto cur = c.load(std::memory_order_relaxed);
+    while (cur < n &&
+           !c.compare_exchange_weak(cur, n, std::memory_order_relaxed))
+        ;
+}
+
+inline void Record_capacity(entry &e, std::size_t cap) noexcept
+{
+    Max(e.c.peak_capacity, cap);
+}
+
+inline void Record_release(entry &e, std::size_t cap,
+                           std::size_t used) noexcept
+{
+    Add(e.c.wasted_capacity, cap - used);
+}
+
+//
+// Records an operation on construction and its duration on destruction.
+//
+class Scope
+{
+  public:
+    constexpr DORI_inline Scope(entry &e, op kind, std::size_t rows) noexcept
+        : e_{e}, kind_{kind}, rows_{rows}
+    {
+        if (!std::is_constant_evaluated())
+            Begin();
+    }
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+    constexpr DORI_inline ~Scope()
+    {
+        if (!std::is_constant_evaluated())
+            End();
+    }
+
+  private:
+    void Begin() noexcept
+    {
+        const auto i = static_cast<std::size_t>(kind_);
+        Add(e_.c.calls[i], 1);
+        Add(e_.c.rows[i], rows_);
+        Add(e_.c.bytes[i], rows_ * e_.row_size);
+        if (auto h = hook.load(std::memory_order_acquire))
+            h({kind_, phase::begin, e_, rows_, rows_ * e_.row_size});
+        t0_ = std::chrono::steady_clock::now();
+    }
+    void End() noexcept
+    {
+        const auto dt = std::chrono::steady_clock::now() - t0_;
+        Add(e_.c.ns[static_cast<std::size_t>(kind_)],
+            static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(dt)
+                    .count()));
+        if (auto h = hook.load(std::memory_order_acquire))
+            h({kind_, phase::end, e_, rows_, rows_ * e_.row_size});
+    }
+
+    entry &e_;
+    op kind_;
+    std::size_t rows_;
+    std::chrono::steady_clock::time_point t0_{};
+};
+} // namespace detail
+
+inline void set_hook(hook_t h) noexcept
+{
+    detail::hook.store(h, std::memory_order_release);
+}
+
+template <class F>
+void for_each_entry(F &&f)
+{
+    for (auto e = detail::head.load(std::memory_order_acquire); e; e = e->next)
+        f(static_cast<const entry &>(*e));
+}
+
+inline void reset() noexcept
+{
+    for (auto e = detail::head.load(std::memory_order_acquire); e;
+         e = e->next) {
+        for (auto *a : {&e->c.calls, &e->c.rows, &e->c.bytes, &e->c.ns})
+            for (auto &x : *a)
+                x.store(0, std::memory_order_relaxed);
+        e->c.peak_capacity.store(0, std::memory_order_relaxed);
+        e->c.wasted_capacity.store(0, std::memory_order_relaxed);
+    }
+}
+
+inline void dump(FILE *f = stderr)
+{
+    for_each_entry([&](const entry &e) {
+        fprintf(f, "%.*s (%zu columns, %zu B/row)\n",
+                static_cast<int>(e.name.size()), e.name.data(), e.columns,
+                e.row_size);
+        for (std::size_t i = 0; i < counters::N; ++i) {
+            const auto calls = e.c.calls[i].load(std::memory_order_relaxed);
+            if (!calls)
+                continue;
+            fprintf(f,
+                    "  %-10.*s %12llu calls %14llu rows %14llu elements "
+                    "%16llu bytes %12.3f ms\n",
+                    static_cast<int>(op_names[i].size()), op_names[i].data(),
+                    static_cast<unsigned long long>(calls),
+                    static_cast<unsigned long long>(
+                        e.c.rows[i].load(std::memory_order_relaxed)),
+                    static_cast<unsigned long long>(
+                        e.c.rows[i].load(std::memory_order_relaxed) *
+                        e.columns),
+                    static_cast<unsigned long long>(
+                        e.c.bytes[i].load(std::memory_order_relaxed)),
+                    static_cast<double>(
+                        e.c.ns[i].load(std::memory_order_relaxed)) /
+                        1e6);
+        }
+        fprintf(f, "  peak capacity %llu rows, released unused %llu rows\n",
+                static_cast<unsigned long long>(
+                    e.c.peak_capacity.load(std::memory_order_relaxed)),
+                static_cast<unsigned long long>(
+                    e.c.wasted_capacity.load(std::memory_order_relaxed)));
+    });
+}
+
+} // namespace dori::stats
+
+//
+// Used by the containers to record operations. These expand to nothing when
+// DORI_STATS=0, so instrumentation is free unless asked for.
+//
+#if DORI_STATS
+#define DORI_stats_scope(Op, Rows)                                             \
+    ::dori::stats::detail::Scope DORI_cat(Dori_stats_scope_, __LINE__)         \
+    {                                                                          \
+        Stats_entry(), ::dori::stats::op::Op, Rows                             \
+    }
+#define DORI_stats(...)                                                        \
+    if (!std::is_constant_evaluated()) {                                       \
+        __VA_ARGS__;                                                           \
+    }
+#else
+#define DORI_stats_scope(Op, Rows) static_cast<void>(0)
+#define DORI_stats(...) static_cast<void>(0)
+#endif
@@ -0,0 +1,423 @@
+#pragma once
+
+//
+// tracked_vector<Ts...> is a vector that records which rows of which columns
+// have changed, so that a replica may be brought up to date by sending just
+// those. As with cow_vector, reads go through data<I>() and writes through
+// accessors that say what they write to:
+//
+//   v.set<1>(i, x);                          // row i of column 1
+//   auto p = v.mutable_data<2>(first, last); // rows first..last of column 2
+//   auto d = v.collect_deltas();             // what changed since last time
+//   dori::apply_deltas(replica, d);          // on the receiving side
+//
+// Changes are kept as a bitmap per column of blocks of tracked_block_rows
+// rows, so marking a range costs a bit per block, and a delta holds whole
+// blocks. Appended rows are changed in every column; rows dropped by resize()
+// or clear() show in the size of the next delta. Columns can't be varlen, as
+// a delta overwrites rows in place.
+//
+
+#include "detail/assert.h"
+#include "detail/inline.h"
+#include "packed.h"
+#include "query.h"
+#include "vector.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace dori
+{
+
+// Rows per block of a tracked_vector
+inline constexpr std::size_t tracked_block_rows = 64;
+
+// Rows first..last
+struct row_range {
+    std::size_t first;
+    std::size_t last;
+
+    friend bool operator==(const row_range &, const row_range &) = default;
+};
+
+//
+// The changed rows of a column: disjoint ranges in ascending order, and the
+// values of their rows one after another
+//
+template <class T>
+struct column_delta {
+    std::vector<row_range> ranges;
+    vector<T> rows;
+
+    bool empty() const noexcept { return ranges.empty(); }
+};
+
+//
+// The changes to a tracked_vector of columns Ts: the size it has, and the
+// changed rows of each column
+//
+template <class... Ts>
+struct deltas {
+    std::size_t size = 0;
+    std::tuple<column_delta<Ts>...> columns;
+
+    // Whether no rows changed; the size may have
+    bool empty() const noexcept
+    {
+        return std::apply([](const auto &...cs) { return (... && cs.empty()); },
+                          columns);
+    }
+};
+
+namespace detail
+{
+
+// Copies n rows of a column from s to d
+template <class P, class Q>
+DORI_inline void Copy_rows(P d, Q s, std::size_t n) noexcept(
+    std::is_nothrow_assignable_v<decltype(d[0]), decltype(s[0])>)
+{
+    using T = std::remove_pointer_t<P>;
+    if constexpr (std::is_pointer_v<P> && std::is_trivially_copyable_v<T>) {
+        if (n)
+            std::memcpy(d, s, n * sizeof(T));
+    } else
+        for (std::size_t i = 0; i < n; ++i)
+            d[i] = s[i];
+}
+
+} // namespace detail
+
+template <class Layout, class Al, class... Ts>
+class basic_tracked_vector
+{
+    using Vec = basic_vector<Layout, Al, Ts...>;
+    using Js  = std::index_sequence_for<Ts...>;
+
+    static constexpr std::size_t B = tracked_block_rows;
+
+    static_assert(!(detail::Is_varlen<Ts> || ...),
+                  "varlen columns are supported by vector only");
+
+  public:
+    using value_type      = typename Vec::value_type;
+    using const_reference = typename Vec::const_reference;
+    using const_iterator  = typename Vec::const_iterator;
+    using size_type       = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using allocator_type  = Al;
+    using delta_type      = deltas<Ts...>;
+
+    basic_tracked_vector() noexcept(noexcept(Al{})) = default;
+    explicit basic_tracked_vector(const Al &alloc) noexcept : v_{alloc} {}
+
+    void swap(basic_tracked_vector &other) noexcept
+    {
+        v_.swap(other.v_);
+        dirty_.swap(other.dirty_);
+        std::swap(synced_, other.synced_);
+    }
+
+    Al get_allocator() const noexcept { return v_.get_allocator(); }
+
+    size_type size() const noexcept { return v_.size(); }
+    size_type capacity() const noexcept { return v_.capacity(); }
+    bool empty() const noexcept { return v_.empty(); }
+
+    //
+    // Reading
+    //
+
+    template <std::size_t I>
+    requires(I < sizeof...(Ts)) DORI_inline auto data() const noexcept
+    {
+        return v_.capacity() ? v_.template data<I>()
+                             : decltype(v_.template data<I>()){};
+    }
+    DORI_inline const_reference operator[](size_type i) const noexcept
+    {
+        return v_[i];
+    }
+    DORI_inline const_reference front() const noexcept { return v_.front(); }
+    DORI_inline const_reference back() const noexcept { return v_.back(); }
+    DORI_inline const_iterator begin() const noexcept { return v_.begin(); }
+    DORI_inline const_iterator end() const noexcept { return v_.end(); }
+
+    template <class F>
+    DORI_inline void for_each(F &&f) const
+    {
+        if (v_.capacity())
+            v_.for_each(static_cast<F &&>(f));
+    }
+
+    // Starts a lazy query over the columns; see query.h
+    DORI_inline auto query() const noexcept
+    {
+        return ::dori::query<basic_tracked_vector>{*this};
+    }
+
+    // The vector the rows are in
+    DORI_inline const Vec &untracked() const noexcept { return v_; }
+
+    //
+    // Writing; each marks what it writes to as changed
+    //
+
+    void reserve(size_type cap)
+    {
+        if (cap <= v_.capacity())
+            return;
+        v_.reserve(cap);
+        const auto words = (v_.capacity() + B * 64 - 1) / (B * 64);
+        for (auto &d : dirty_)
+            d.resize(words);
+    }
+
+    template <class... Us>
+    requires(sizeof...(Us) == sizeof...(Ts)) //
+        void push_back(Us &&...xs)
+    {
+        v_.push_back(static_cast<Us &&>(xs)...);
+        Mark_all(v_.size() - 1, v_.size());
+    }
+    void push_back(const value_type &value)
+    {
+        v_.push_back(value);
+        Mark_all(v_.size() - 1, v_.size());
+    }
+
+    // Sets row i of column I to x
+    template <std::size_t I, class U>
+    requires(I < sizeof...(Ts)) DORI_inline void set(size_type i, U &&x)
+    {
+        DORI_assert(i < v_.size());
+        v_.template data<I>()[i] = static_cast<U &&>(x);
+        Mark<I>(i, i + 1);
+    }
+    // Sets row i to value
+    DORI_inline void set(size_type i, const value_type &value)
+    {
+        DORI_assert(i < v_.size());
+        v_[i] = value;
+        Mark_all(i, i + 1);
+    }
+
+    //
+    // Column I for writing rows first..last, which are marked as changed; the
+    // pointer is valid until the capacity changes
+    //
+    template <std::size_t I>
+    requires(I < sizeof...(Ts)) DORI_inline auto mutable_data(size_type first,
+                                                              size_type last)
+    {
+        DORI_assert(first <= last && last <= v_.size());
+        Mark<I>(first, last);
+        return v_.capacity() ? v_.template data<I>()
+                             : decltype(v_.template data<I>()){};
+    }
+    template <std::size_t I>
+    requires(I < sizeof...(Ts)) DORI_inline auto mutable_data()
+    {
+        return mutable_data<I>(0, v_.size());
+    }
+
+    // Resizes to sz rows, the ones added being value-initialized
+    void resize(size_type sz)
+    {
+        const auto n = v_.size();
+        if (sz == n)
+            return;
+        reserve(sz);
+        v_.resize(sz);
+        if (sz > n)
+            Mark_all(n, sz);
+    }
+    void clear() noexcept { v_.clear(); }
+
+    //
+    // Replication
+    //
+
+    // Whether anything changed since the last collect_deltas()
+    bool changed() const noexcept
+    {
+        if (synced_ != v_.size())
+            return true;
+        for (const auto &d : dirty_)
+            for (const auto w : d)
+                if (w)
+                    return true;
+        return false;
+    }
+
+    // The changes since the last call, or since construction
+    delta_type collect_deltas()
+    {
+        delta_type res;
+        res.size = v_.size();
+        [&]<std::size_t... Is>(std::index_sequence<Is...>)
+        {
+            (..., Collect<Is>(std::get<Is>(res.columns)));
+        }
+        (Js{});
+        synced_ = v_.size();
+        return res;
+    }
+
+    // Applies d, collected from another vector, marking the rows it changes
+    void apply_deltas(const delta_type &d)
+    {
+        resize(d.size);
+        [&]<std::size_t... Is>(std::index_sequence<Is...>)
+        {
+            (..., Apply<Is>(std::get<Is>(d.columns)));
+        }
+        (Js{});
+    }
+
+  private:
+    template <std::size_t I>
+    DORI_inline void Mark(size_type first, size_type last) noexcept
+    {
+        if (first == last)
+            return;
+        auto &d = dirty_[I];
+        for (auto b = first / B, e = (last - 1) / B; b <= e; ++b)
+            d[b / 64] |= std::uint64_t{1} << b % 64;
+    }
+    DORI_inline void Mark_all(size_type first, size_type last) noexcept
+    {
+        [&]<std::size_t... Is>(std::index_sequence<Is...>)
+        {
+            (..., Mark<Is>(first, last));
+        }
+        (Js{});
+    }
+
+    // Moves the marks of column I into c, with the rows they mark
+    template <std::size_t I, class T>
+    void Collect(column_delta<T> &c)
+    {
+        auto &d        = dirty_[I];
+        const auto n   = v_.size();
+        size_type rows = 0;
+        for (size_type w = 0; w < d.size(); ++w)
+            for (auto bits = std::exchange(d[w], 0); bits; bits &= bits - 1) {
+                const auto f = (w * 64 + std::countr_zero(bits)) * B;
+                if (f >= n)
+                    continue;
+                const auto l = std::min(f + B, n);
+                if (!c.ranges.empty() && c.ranges.back().last == f)
+                    c.ranges.back().last = l;
+                else
+                    c.ranges.push_back({f, l});
+                rows += l - f;
+            }
+        if (!rows)
+            return;
+        c.rows.reserve(rows);
+        c.rows.resize(rows);
+        const auto p = v_.template data<I>();
+        const auto q = c.rows.template data<0>();
+        size_type k  = 0;
+        for (const auto [f, l] : c.ranges) {
+            detail::Copy_rows(q + k, p + f, l - f);
+            k += l - f;
+        }
+    }
+
+    template <std::size_t I, class T>
+    void Apply(const column_delta<T> &c)
+    {
+        if (c.empty())
+            return;
+        const auto p = v_.template data<I>();
+        const auto s = c.rows.template data<0>();
+        size_type k  = 0;
+        for (const auto [f, l] : c.ranges) {
+            DORI_assert(l <= v_.size());
+            detail::Copy_rows(p + f, s + k, l - f);
+            k += l - f;
+            Mark<I>(f, l);
+        }
+    }
+
+    Vec v_;
+    std::array<std::vector<std::uint64_t>, sizeof...(Ts)> dirty_;
+    size_type synced_ = 0;
+};
+
+template <class Layout, class Al, class... Ts>
+DORI_inline void swap(basic_tracked_vector<Layout, Al, Ts...> &lhs,
+                      basic_tracked_vector<Layout, Al, Ts...> &rhs) noexcept
+{
+    lhs.swap(rhs);
+}
+
+//
+// Brings v, a vector holding the rows a tracked_vector had when d was last
+// collected from it, up to date with d
+//
+template <class V, class... Ts>
+void apply_deltas(V &v, const deltas<Ts...> &d)
+{
+    if (d.size > v.capacity())
+        v.reserve(d.size);
+    if (d.size != v.size())
+        v.resize(d.size);
+    [&]<std::size_t... Is>(std::index_sequence<Is...>)
+    {
+        (..., [&](const auto &c) {
+            if (c.empty())
+                return;
+            const auto p = v.template data<Is>();
+            const auto s = c.rows.template data<0>();
+            std::size_t k = 0;
+            for (const auto [f, l] : c.ranges) {
+                DORI_assert(l <= v.size());
+                detail::Copy_rows(p + f, s + k, l - f);
+                k += l - f;
+            }
+        }(std::get<Is>(d.columns)));
+    }
+    (std::index_sequence_for<Ts...>{});
+}
+
+template <class Layout, class Al, class... Ts>
+void apply_deltas(basic_tracked_vector<Layout, Al, Ts...> &v,
+                  const deltas<Ts...> &d)
+{
+    v.apply_deltas(d);
+}
+
+namespace detail
+{
+template <class Vector>
+struct Deduce_tracked;
+template <class Al, class... Ts>
+struct Deduce_tracked<vector_al<Al, Ts...>> {
+    using type = basic_tracked_vector<layout::default_policy, Al, Ts...>;
+};
+template <class Layout, class Al, class... Ts>
+struct Deduce_tracked<basic_vector<Layout, Al, Ts...>> {
+    using type = basic_tracked_vector<Layout, Al, Ts...>;
+};
+} // namespace detail
+
+//
+// tracked_vector<Ts..., [Allocator], [Layout]> like vector
+//
+template <class... Ts>
+using tracked_vector = typename detail::Deduce_tracked<
+    detail::Deduce_vec<boost::mp11::mp_list<Ts...>>>::type;
+
+} // namespace dori
@@ -0,0 +1,337 @@
+#pragma once
+
+//
+// variant_column<Ts...> is a column of rows each holding one of the
+// alternatives Ts, split by type rather than stored as std::variant<Ts...>,
+// which pads every row to the largest alternative. A vector of a tag and a
+// slot per row says which alternative a row holds and where, and the values
+// of each alternative lie densely in a vector of their own, along with the
+// row of each:
+//
+//   dori::variant_column<circle, rect> shapes;
+//   shapes.push_back(circle{1.f});
+//   shapes.visit_by_type([&](std::span<const circle> cs, auto rows) {...});
+//
+// visit_by_type() calls a function once per alternative with all of its
+// values, so the work over a column runs as loops over values of one type
+// instead of a dispatch per row. The rows of the values given tell where to
+// put the results of a row. Reads and writes of a single row go through its
+// tag, as std::visit() would. Assigning a row a value of another alternative
+// moves the last value of its old alternative into its slot; values of an
+// alternative are thus in no particular order.
+//
+// It's a container of its own rather than a kind of column of a vector: the
+// values of each alternative grow apart from the rows, which doesn't fit the
+// one allocation of capacity() rows that a vector's columns share. Kept next
+// to a vector, its rows line up with those of the vector by index, and a
+// vector refuses it as an element type.
+//
+
+#include "detail/assert.h"
+#include "detail/inline.h"
+#include "detail/traits.h"
+#include "packed.h"
+#include "vector.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace dori
+{
+
+namespace detail
+{
+// Column I of v of size() rows as a span, which is empty if v has no storage
+template <std::size_t I, class V>
+DORI_inline auto Column_span(V &v) noexcept
+{
+    using P = decltype(v.template data<I>());
+    using T = std::remove_pointer_t<P>;
+    return v.capacity() ? std::span<T>{v.template data<I>(), v.size()}
+                        : std::span<T>{};
+}
+} // namespace detail
+
+template <class... Ts>
+class variant_column
+{
+    static_assert(sizeof...(Ts) && sizeof...(Ts) <= 256,
+                  "variant columns take 1 to 256 alternatives");
+    static_assert(detail::mp_is_set<detail::mp_list<Ts...>>::value,
+                  "alternatives of a variant column are distinct");
+    static_assert((... && (!detail::Is_packed<Ts> && !detail::Is_varlen<Ts> &&
+                           !detail::Is_nullable<Ts>)),
+                  "alternatives of a variant column are ordinary types");
+
+  public:
+    using value_type = std::variant<Ts...>;
+    using size_type  = std::size_t;
+    using tag_type   = std::uint8_t;
+    using slot_type  = std::uint32_t;
+
+  private:
+    using Js = std::index_sequence_for<Ts...>;
+
+    template <class T>
+    static constexpr std::size_t Index_of =
+        detail::mp_find<detail::mp_list<Ts...>, T>::value;
+    template <class T>
+    static constexpr bool Is_alt = Index_of<T> < sizeof...(Ts);
+
+  public:
+    variant_column() = default;
+
+    DORI_inline bool empty() const noexcept { return !rows_.size(); }
+    DORI_inline size_type size() const noexcept { return rows_.size(); }
+    static constexpr size_type max_size() noexcept
+    {
+        return std::numeric_limits<slot_type>::max();
+    }
+
+    // Makes room for n rows; the values of each alternative grow as needed
+    void reserve(size_type n)
+    {
+        if (n > rows_.capacity())
+            rows_.reserve(n);
+    }
+
+    void clear() noexcept
+    {
+        if (rows_.capacity())
+            rows_.clear();
+        std::apply(
+            [](auto &...as) { (..., (as.capacity() ? as.clear() : void())); },
+            alts_);
+    }
+
+    void swap(variant_column &other) noexcept
+    {
+        rows_.swap(other.rows_);
+        alts_.swap(other.alts_);
+    }
+
+    //
+    // Appending
+    //
+
+    template <class T, class... Args>
+    requires(Is_alt<T>) void emplace_back(Args &&...args)
+    {
+        if (rows_.size() == max_size())
+            throw std::length_error{"dori::variant_column"};
+        // Room for the row first, so that a throw leaves no value without one
+        if (rows_.size() == rows_.capacity())
+            rows_.reserve(std::max(rows_.capacity() * 2, std::size_t{64}));
+        auto &a = std::get<Index_of<T>>(alts_);
+        detail::Grow_push_back(a, T(static_cast<Args &&>(args)...),
+                               static_cast<slot_type>(rows_.size()));
+        rows_.push_back(static_cast<tag_type>(Index_of<T>),
+                        static_cast<slot_type>(a.size() - 1));
+    }
+    template <class U>
+    requires(Is_alt<std::remove_cvref_t<U>>) void push_back(U &&x)
+    {
+        emplace_back<std::remove_cvref_t<U>>(static_cast<U &&>(x));
+    }
+    void push_back(const value_type &x)
+    {
+        std::visit([&](const auto &y) { push_back(y); }, x);
+    }
+
+    //
+    // Reading and writing rows
+    //
+
+    // The alternative row i holds, as std::variant::index()
+    DORI_inline size_type index(size_type i) const noexcept
+    {
+        DORI_assert(i < size());
+        return rows_.template data<0>()[i];
+    }
+    template <class T>
+    requires(Is_alt<T>) DORI_inline bool holds(size_type i) const noexcept
+    {
+        return index(i) == Index_of<T>;
+    }
+
+    // The value of row i if it holds a T, or nullptr
+    template <class T>
+    requires(Is_alt<T>) DORI_inline T *get_if(size_type i) noexcept
+    {
+        if (!holds<T>(i))
+            return nullptr;
+        return std::get<Index_of<T>>(alts_).template data<0>() + Slot(i);
+    }
+    template <class T>
+    requires(Is_alt<T>) DORI_inline const T *get_if(size_type i) const noexcept
+    {
+        return const_cast<variant_column *>(this)->template get_if<T>(i);
+    }
+
+    // Calls f with the value of row i, as std::visit() would
+    template <class F>
+    DORI_inline decltype(auto) visit(size_type i, F &&f)
+    {
+        return Visit_row<0>(*this, i, f);
+    }
+    template <class F>
+    DORI_inline decltype(auto) visit(size_type i, F &&f) const
+    {
+        return Visit_row<0>(*this, i, f);
+    }
+
+    // Row i as a variant
+    value_type operator[](size_type i) const
+    {
+        return visit(i, [](const auto &x) { return value_type{x}; });
+    }
+
+    //
+    // Sets row i to x. If row i held another alternative, the last value of
+    // that one is moved into the slot of its old value.
+    //
+    template <class U>
+    requires(Is_alt<std::remove_cvref_t<U>>) void set(size_type i, U &&x)
+    {
+        using T          = std::remove_cvref_t<U>;
+        constexpr auto J = Index_of<T>;
+        if (index(i) == J) {
+            std::get<J>(alts_).template data<0>()[Slot(i)] =
+                static_cast<U &&>(x);
+            return;
+        }
+        // x may be a value of this column, which growing would move
+        T y(static_cast<U &&>(x));
+        auto &a = std::get<J>(alts_);
+        detail::Grow_push_back(a, std::move(y), static_cast<slot_type>(i));
+        Drop_slot<0>(index(i), Slot(i));
+        rows_.template data<0>()[i] = static_cast<tag_type>(J);
+        rows_.template data<1>()[i] = static_cast<slot_type>(a.size() - 1);
+    }
+    void set(size_type i, const value_type &x)
+    {
+        std::visit([&](const auto &y) { set(i, y); }, x);
+    }
+
+    //
+    // Batches by type
+    //
+
+    //
+    // Calls f for each alternative T that some row holds with the values of
+    // all such rows as a std::span<T>, and the rows they belong to as a
+    // std::span<const slot_type> if f takes a second argument
+    //
+    template <class F>
+    void visit_by_type(F &&f)
+    {
+        Visit_by_type(*this, f, Js{});
+    }
+    template <class F>
+    void visit_by_type(F &&f) const
+    {
+        Visit_by_type(*this, f, Js{});
+    }
+
+    // The values of the rows holding a T, and the row of each
+    template <class T>
+    requires(Is_alt<T>) DORI_inline std::span<T> values() noexcept
+    {
+        return detail::Column_span<0>(std::get<Index_of<T>>(alts_));
+    }
+    template <class T>
+    requires(Is_alt<T>) DORI_inline std::span<const T> values() const noexcept
+    {
+        return detail::Column_span<0>(std::get<Index_of<T>>(alts_));
+    }
+    template <class T>
+    requires(Is_alt<T>) DORI_inline std::span<const slot_type> rows()
+        const noexcept
+    {
+        return detail::Column_span<1>(std::get<Index_of<T>>(alts_));
+    }
+
+    // The alternative held by each row, and its slot among the values of that
+    DORI_inline std::span<const tag_type> tags() const noexcept
+    {
+        return detail::Column_span<0>(rows_);
+    }
+    DORI_inline std::span<const slot_type> slots() const noexcept
+    {
+        return detail::Column_span<1>(rows_);
+    }
+
+  private:
+    DORI_inline slot_type Slot(size_type i) const noexcept
+    {
+        return rows_.template data<1>()[i];
+    }
+
+    template <std::size_t J, class Self, class F>
+    static DORI_inline decltype(auto) Visit_row(Self &self, size_type i, F &f)
+    {
+        if constexpr (J + 1 < sizeof...(Ts))
+            if (self.index(i) != J)
+                return Visit_row<J + 1>(self, i, f);
+        return f(std::get<J>(self.alts_).template data<0>()[self.Slot(i)]);
+    }
+
+    template <class Self, class F, std::size_t... Is>
+    static DORI_inline void Visit_by_type(Self &self, F &f,
+                                          std::index_sequence<Is...>)
+    {
+        (..., [&] {
+            auto &a = std::get<Is>(self.alts_);
+            if (!a.size())
+                return;
+            const auto vs = detail::Column_span<0>(a);
+            if constexpr (std::is_invocable_v<F &, decltype(vs),
+                                              std::span<const slot_type>>)
+                f(vs, std::span<const slot_type>{detail::Column_span<1>(a)});
+            else
+                f(vs);
+        }());
+    }
+
+    // Drops slot s of alternative j, moving its last value there
+    template <std::size_t J>
+    void Drop_slot(size_type j, slot_type s) noexcept
+    {
+        if constexpr (J < sizeof...(Ts)) {
+            if (j != J)
+                return Drop_slot<J + 1>(j, s);
+            auto &a         = std::get<J>(alts_);
+            const auto last = static_cast<slot_type>(a.size() - 1);
+            if (s != last) {
+                const auto vs = a.template data<0>();
+                const auto rs = a.template data<1>();
+                vs[s]         = std::move(vs[last]);
+                rs[s]         = rs[last];
+                rows_.template data<1>()[rs[s]] = s;
+            }
+            a.resize(last);
+        }
+    }
+
+    // The tag and slot of each row
+    vector<tag_type, slot_type> rows_;
+    // The values of each alternative, and the row of each
+    std::tuple<vector<Ts, slot_type>...> alts_;
+};
+
+template <class... Ts>
+DORI_inline void swap(variant_column<Ts...> &a,
+                      variant_column<Ts...> &b) noexcept
+{
+    a.swap(b);
+}
+
+} // namespace dori
@@ -0,0 +1,203 @@
+#pragma once
+
+//
+// Variable-length columns. Giving dori::varlen<T> as an element type of a
+// vector stores a column of strings (T being a character type) or of lists of
+// T, as Arrow does: the allocation holds the end offset of each row, and the
+// values of all rows lie one after another in a buffer of the column owned by
+// the vector. Scans thus read two contiguous sequences, where a column of
+// std::string or std::vector would hold a pointer per row.
+//
+// Rows are read as std::basic_string_view<T> or std::span<const T>, through
+// operator[], iterators, and the varlen_ptr of data<I>() and for_each(); the
+// latter also gives the end offsets and the values as arrays. Rows are written
+// by push_back() and the like, which append the values of a row to the buffer
+// by one copy, and are otherwise immutable. append() adds many rows at once;
+// given a varlen_ptr, such as of another vector or of any end offsets and
+// values, it copies the values by one insert and rebases the offsets in one
+// pass. Appending may move the values, and so invalidates varlen_ptrs.
+//
+// A row's values start where those of the row before end, as Arrow lays them
+// out, so erasing rows leaves no hole to fill later: erase() moves the fewer
+// of the values before and after the erased rows over them, along with the
+// offsets after. The values before are moved up, leaving dead values at the
+// front of the buffer that are dropped once they outnumber the live ones. So
+// erasing from the front moves each value once on average, as with a deque,
+// while erasing from the middle costs the values on the shorter side.
+//
+
+#include "detail/assert.h"
+#include "detail/inline.h"
+
+#include <compare>
+#include <cstddef>
+#include <iterator>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace dori
+{
+
+// Element type for a column of strings of T, or of lists of T
+template <class T>
+struct alignas(std::size_t) varlen {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "varlen columns hold trivially copyable values");
+};
+
+namespace detail
+{
+
+template <class T>
+inline constexpr bool Is_char =
+    std::is_same_v<T, char> || std::is_same_v<T, wchar_t> ||
+    std::is_same_v<T, char8_t> || std::is_same_v<T, char16_t> ||
+    std::is_same_v<T, char32_t>;
+
+template <class T>
+struct Varlen_of {
+    using element_type = T;
+    using value_type   = T;
+    using view_type    = T;
+};
+template <class T>
+struct Varlen_of<varlen<T>> {
+    using element_type = T;
+    using value_type   = std::conditional_t<Is_char<T>, std::basic_string<T>,
+                                          std::vector<T>>;
+    using view_type    = std::conditional_t<Is_char<T>,
+                                         std::basic_string_view<T>,
+                                         std::span<const T>>;
+};
+
+template <class T>
+inline constexpr bool Is_varlen = false;
+template <class T>
+inline constexpr bool Is_varlen<varlen<T>> = true;
+
+} // namespace detail
+
+//
+// Random-access iterator over a varlen column; stands in for a pointer. Row i
+// holds values()[ends()[i - 1]..ends()[i]], row 0 starting at 0.
+//
+template <class T, bool Const = false>
+class varlen_ptr
+{
+    using End = std::conditional_t<Const, const std::size_t, std::size_t>;
+
+  public:
+    using value_type        = typename detail::Varlen_of<varlen<T>>::value_type;
+    using difference_type   = std::ptrdiff_t;
+    using reference         = typename detail::Varlen_of<varlen<T>>::view_type;
+    using pointer           = void;
+    using iterator_category = std::random_access_iterator_tag;
+
+    constexpr DORI_inline varlen_ptr() noexcept = default;
+    constexpr DORI_inline varlen_ptr(End *ends, const T *values,
+                                     difference_type i = 0) noexcept
+        : e_{ends}, v_{values}, i_{i}
+    {
+    }
+    constexpr DORI_inline operator varlen_ptr<T, true>() const noexcept
+    {
+        return {e_, v_, i_};
+    }
+
+    // The end offsets and values of the rows from row 0, and the row this
+    // points to
+    constexpr DORI_inline End *ends() const noexcept { return e_; }
+    constexpr DORI_inline const T *values() const noexcept { return v_; }
+    constexpr DORI_inline difference_type index() const noexcept { return i_; }
+
+    constexpr DORI_inline reference operator[](difference_type n) const noexcept
+    {
+        DORI_assert(i_ + n >= 0);
+        const auto i = static_cast<std::size_t>(i_ + n);
+        const auto f = i ? e_[i - 1] : 0;
+        return reference{v_ + f, e_[i] - f};
+    }
+    constexpr DORI_inline reference operator*() const noexcept
+    {
+        return (*this)[0];
+    }
+
+    constexpr DORI_inline varlen_ptr &operator++() noexcept
+    {
+        return ++i_, *this;
+    }
+    constexpr DORI_inline varlen_ptr operator++(int) noexcept
+    {
+        return {e_, v_, i_++};
+    }
+    constexpr DORI_inline varlen_ptr &operator--() noexcept
+    {
+        return --i_, *this;
+    }
+    constexpr DORI_inline varlen_ptr operator--(int) noexcept
+    {
+        return {e_, v_, i_--};
+    }
+    constexpr DORI_inline varlen_ptr &operator+=(difference_type n) noexcept
+    {
+        return i_ += n, *this;
+    }
+    constexpr DORI_inline varlen_ptr &operator-=(difference_type n) noexcept
+    {
+        return i_ -= n, *this;
+    }
+    friend constexpr DORI_inline varlen_ptr
+    operator+(varlen_ptr p, difference_type n) noexcept
+    {
+        return p += n;
+    }
+    friend constexpr DORI_inline varlen_ptr operator+(difference_type n,
+                                                      varlen_ptr p) noexcept
+    {
+        return p += n;
+    }
+    friend constexpr DORI_inline varlen_ptr
+    operator-(varlen_ptr p, difference_type n) noexcept
+    {
+        return p -= n;
+    }
+    friend constexpr DORI_inline difference_type
+    operator-(const varlen_ptr &a, const varlen_ptr &b) noexcept
+    {
+        DORI_assert(a.e_ == b.e_);
+        return a.i_ - b.i_;
+    }
+    friend constexpr DORI_inline bool operator==(const varlen_ptr &a,
+                                                 const varlen_ptr &b) noexcept
+    {
+        return a.e_ == b.e_ && a.i_ == b.i_;
+    }
+    friend constexpr DORI_inline auto operator<=>(const varlen_ptr &a,
+                                                  const varlen_ptr &b) noexcept
+    {
+        DORI_assert(a.e_ == b.e_);
+        return a.i_ <=> b.i_;
+    }
+
+  private:
+    End *e_            = nullptr;
+    const T *v_        = nullptr;
+    difference_type i_ = 0;
+};
+
+namespace detail
+{
+template <class T>
+struct Is_varlen_ptr_impl : std::false_type {
+};
+template <class T, bool Const>
+struct Is_varlen_ptr_impl<varlen_ptr<T, Const>> : std::true_type {
+};
+template <class T>
+inline constexpr bool Is_varlen_ptr = Is_varlen_ptr_impl<T>::value;
+} // namespace detail
+
+} // namespace dori
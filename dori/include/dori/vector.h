@@ -6,12 +6,18 @@
 #include "detail/unsafe.h"
 #include "detail/vector_caster.h"
 #include "detail/vector_layout.h"
+#include "nullable.h"
+#include "packed.h"
+#include "query.h"
+#include "stats.h"
 
 #include <boost/mp11/algorithm.hpp>
 #include <boost/mp11/bind.hpp>
 #include <boost/mp11/list.hpp>
 #include <boost/preprocessor/repetition/repeat.hpp>
+#include <algorithm>
 #include <tuple>
+#include <vector>
 
 namespace dori
 {
@@ -22,29 +28,197 @@ namespace detail
 template <class Al, class... Ts, class... TsSrt, auto Offsets, auto Redir,
           std::size_t... Is>
 class vector_impl<Al, mp_list<Ts...>, mp_list<TsSrt...>, Offsets, Redir, Is...>
-    : opaque_vector<Al>
+    : protected opaque_vector<Al>
 {
+  protected:
+    // Accessible to containers built on top, such as small_vector
     using opaque_vector<Al>::al_;
     using opaque_vector<Al>::p_;
     using opaque_vector<Al>::sz_;
     using opaque_vector<Al>::cap_;
+
+    // Adds and drops columns by moving the others; see columns.h
+    friend struct Column_ops;
+    // Appends rows written in place; see aos.h and ingest.h
+    friend struct Bulk_ops;
+
+    static_assert(!(Is_variant_column<Ts> || ...),
+                  "variant_column is a container of its own, not a column");
+
+  private:
     using Al_tr = std::allocator_traits<Al>;
 
-    static constexpr inline auto Sz_all = (sizeof(Ts) + ...);
-    static constexpr inline auto Align  = std::max({alignof(Ts)...});
+    // The values of each varlen column, in storage order; see varlen.h
+    template <class T>
+    using Blob_t = std::vector<
+        typename Varlen_of<T>::element_type,
+        typename Al_tr::template rebind_alloc<
+            typename Varlen_of<T>::element_type>>;
+    template <class T>
+    using Is_varlen_t = std::bool_constant<Is_varlen<T>>;
+    using Blobs       = mp_rename<
+        mp_transform<Blob_t, mp_copy_if<mp_list<TsSrt...>, Is_varlen_t>>,
+        std::tuple>;
+    static constexpr inline bool Varlens = (Is_varlen<Ts> || ...);
+    // Index into Blobs of each varlen sequence
+    static constexpr inline auto Blob_index = [] {
+        std::array<std::size_t, sizeof...(Ts)> res{};
+        std::size_t k = 0;
+        (..., (res[Is] = k, k += Is_varlen<TsSrt>));
+        return res;
+    }();
+
+    //
+    // Where the values of row 0 start in each value buffer. Erasing rows near
+    // the front moves the values before them up rather than those after down,
+    // leaving dead values at the front of the buffer; these are dropped once
+    // they outnumber the live ones.
+    //
+    using Heads = mp_fill<Blobs, std::size_t>;
+
+    DORI_no_unique_address Blobs blobs_;
+    DORI_no_unique_address Heads heads_{};
+
+    template <std::size_t I>
+    constexpr DORI_inline auto &Blob() noexcept
+    {
+        return std::get<Blob_index[I]>(blobs_);
+    }
+    template <std::size_t I>
+    constexpr DORI_inline const auto &Blob() const noexcept
+    {
+        return std::get<Blob_index[I]>(blobs_);
+    }
+    template <std::size_t I>
+    constexpr DORI_inline auto &Head() noexcept
+    {
+        return std::get<Blob_index[I]>(heads_);
+    }
+    template <std::size_t I>
+    constexpr DORI_inline auto Head() const noexcept
+    {
+        return std::get<Blob_index[I]>(heads_);
+    }
+
+    // Value buffers allocating through copies of al
+    static constexpr DORI_inline Blobs Make_blobs(const Al &al) noexcept
+    {
+        return [&]<class... Bs>(std::type_identity<std::tuple<Bs...>>) {
+            return Blobs{typename Bs::allocator_type(al)...};
+        }(std::type_identity<Blobs>{});
+    }
+    // The value buffers of bs moved to ones allocating through copies of al,
+    // which moves the values themselves if the allocators differ
+    static constexpr DORI_inline Blobs Move_blobs(Blobs &bs, const Al &al)
+    {
+        return std::apply(
+            [&]<class... Bs>(Bs &...b) {
+                return Blobs{Bs(static_cast<Bs &&>(b),
+                                typename Bs::allocator_type(al))...};
+            },
+            bs);
+    }
+    // Copies the live values of v, keeping the allocators of this vector
+    constexpr DORI_inline void Assign_blobs(const vector_impl &v)
+    {
+        if (&v == this)
+            return;
+        [&]<std::size_t... Ks>(std::index_sequence<Ks...>)
+        {
+            (..., std::get<Ks>(blobs_).assign(
+                      std::get<Ks>(v.blobs_).begin() +
+                          static_cast<std::ptrdiff_t>(std::get<Ks>(v.heads_)),
+                      std::get<Ks>(v.blobs_).end()));
+        }
+        (std::make_index_sequence<std::tuple_size_v<Blobs>>{});
+        heads_ = Heads{};
+    }
+    // Drops the dead values at the front of each value buffer
+    constexpr DORI_inline void Compact_blobs() noexcept
+    {
+        [&]<std::size_t... Ks>(std::index_sequence<Ks...>)
+        {
+            (..., std::get<Ks>(blobs_).erase(
+                      std::get<Ks>(blobs_).begin(),
+                      std::get<Ks>(blobs_).begin() +
+                          static_cast<std::ptrdiff_t>(
+                              std::exchange(std::get<Ks>(heads_), 0))));
+        }
+        (std::make_index_sequence<std::tuple_size_v<Blobs>>{});
+    }
+
+    // Bytes per row of the ordinary sequences, and bits per row of the packed
+    // (including the validity of nullable sequences)
+    static constexpr inline std::size_t Sz_all =
+        ((Is_packed<Ts> ? 0 : sizeof(Ts)) + ...);
+    static constexpr inline auto Bits_all = (Bits_of<Ts> + ...);
+    static constexpr inline auto Align    = std::max({Align_of<Ts>::value...});
+    // Bit offset of each packed sequence (in storage order) per row of capacity
+    // into the area following the ordinary sequences
+    static constexpr inline auto Bit_offsets = [] {
+        std::array<std::size_t, sizeof...(Ts)> res{};
+        std::size_t off = 0;
+        (..., (res[Is] = off, off += Bits_of<TsSrt>));
+        return res;
+    }();
+    // Inverse of Redir: maps a sorted index back to the declared one
+    static constexpr inline auto Unredir = [] {
+        std::array<std::size_t, sizeof...(Ts)> res{};
+        (..., (res[Redir[Is]] = Is));
+        return res;
+    }();
+    // Smallest multiple of capacity at which every sequence is aligned; packed
+    // sequences are whole words
+    static constexpr inline std::size_t Granularity = [] {
+        std::size_t g = 1;
+        (..., (g = std::lcm(g, Bits_of<TsSrt>
+                                   ? 64
+                                   : alignof(TsSrt) /
+                                         std::gcd(Offsets[Is],
+                                                  alignof(TsSrt)))));
+        return g;
+    }();
+    //
+    // Capacities of Line_cap_min rows or more are rounded up to a multiple of
+    // Line_granularity rows, at which every sequence starts a whole number of
+    // cache lines into the allocation. Given an allocation aligned to a line,
+    // a row that's a multiple of a line's worth in every sequence then starts
+    // on a line in each; see parallel.h.
+    //
+    static constexpr inline std::size_t Line_cap_min = 4096;
+    static constexpr inline std::size_t Line_granularity = [] {
+        std::size_t g = Granularity;
+        (..., (g = std::lcm(g, cache_line / std::gcd(cache_line,
+                                                     Offsets[Is]))));
+        (..., (g = std::lcm(g, cache_line * 8 / std::gcd(cache_line * 8,
+                                                         Bit_offsets[Is]))));
+        return g;
+    }();
+    static constexpr DORI_inline std::size_t Bytes_for(std::size_t cap) noexcept
+    {
+        return cap * Sz_all + cap / 8 * Bits_all;
+    }
+    // Whether rows are copied and relocated as bytes, by code shared with
+    // vectors of the same sizes of sequences; see Trivial_ops
+    static constexpr inline bool Trivial =
+        !Al_constructs<Al> &&
+        (... && (Is_packed<TsSrt> || std::is_trivially_copyable_v<TsSrt>));
+    using Trivial_ops_t = Trivial_ops<
+        std::index_sequence<(Is_packed<TsSrt> ? 0 : sizeof(TsSrt))...>,
+        std::index_sequence<Bits_of<TsSrt>...>>;
 #define DORI_vector_natvis_hint(z, n, _)                                       \
     static constexpr auto Natvis_hint_##n =                                    \
         Offsets[Redir[n < sizeof...(Ts) ? n : 0]];
     BOOST_PP_REPEAT(10, DORI_vector_natvis_hint, ~)
 
 #define DORI_vector_iterator_convop_refconv_and_ptrsty_const_iterator          \
-    std::tuple<const TsSrt *...>
+    std::tuple<Cptr_t<TsSrt>...>
 #define DORI_vector_iterator_convop_refconv_and_ptrsty_iterator                \
     constexpr DORI_inline operator const_iterator() const noexcept             \
     {                                                                          \
         return {ptrs, i};                                                      \
     }                                                                          \
-    std::tuple<TsSrt *...>
+    std::tuple<Ptr_t<TsSrt>...>
 
 #define DORI_vector_iterator(It, Ref)                                          \
     struct It {                                                                \
@@ -78,9 +252,28 @@ class vector_impl<Al, mp_list<Ts...>, mp_list<TsSrt...>, Offsets, Redir, Is...>
     template <std::size_t I>
     using Ith_sorted = mp_at_c<mp_list<TsSrt...>, I>;
 
-    using value_type      = std::tuple<Ts...>;
-    using reference       = std::tuple<Ts &...>;
-    using const_reference = std::tuple<const Ts &...>;
+    // See layout::info
+    static constexpr inline auto Storage_order       = Unredir;
+    static constexpr inline auto Storage_offsets     = Offsets;
+    static constexpr inline auto Storage_row_size    = Sz_all;
+    static constexpr inline auto Storage_bits_per_row = Bits_all;
+    static constexpr inline auto Storage_alignment   = Align;
+    static constexpr inline auto Storage_granularity = Granularity;
+    static constexpr DORI_inline std::size_t
+    Storage_bytes(std::size_t cap) noexcept
+    {
+        return Bytes_for(cap);
+    }
+    template <std::size_t I, class B>
+    static constexpr DORI_inline auto Storage_data(B *p,
+                                                   std::size_t cap) noexcept
+    {
+        return Data_at<Redir[I]>(p, cap);
+    }
+
+    using value_type      = std::tuple<Value_t<Ts>...>;
+    using reference       = std::tuple<Ref_t<Ts>...>;
+    using const_reference = std::tuple<Cref_t<Ts>...>;
     using difference_type = std::ptrdiff_t;
     using size_type       = std::size_t;
     using allocator_type  = Al;
@@ -90,65 +283,117 @@ class vector_impl<Al, mp_list<Ts...>, mp_list<TsSrt...>, Offsets, Redir, Is...>
 
   public:
     constexpr DORI_inline vector_impl() noexcept(noexcept(Al{}))
-        : opaque_vector<Al>{}
+        : opaque_vector<Al>{}, blobs_{Make_blobs(al_)}
     {
     }
     template <class... Args>
     requires(sizeof...(Args) - 1 == sizeof...(Ts) * 2 &&
-             mp_all_of<mp_pop_back<mp_list<Args...>>, std::input_iterator> &&
+             mp_all_of<mp_pop_back<mp_list<Args...>>,
+                       Is_input_iterator>::value &&
              std::is_convertible_v<mp_back<mp_list<Args...>>, const Al &>) //
         constexpr DORI_inline vector_impl(Args &&...args)
-        : vector_impl((static_cast<Args &&>(args), ...))
+        : vector_impl(std::get<sizeof...(Args) - 1>(
+              std::forward_as_tuple(static_cast<Args &&>(args)...)))
     {
         using Fwd = std::tuple<Args &&...>;
         Fwd fwd{static_cast<Args &&>(args)...};
-        cap_ = sz_ = static_cast<size_type>(
+        sz_ = static_cast<size_type>(
             std::distance(std::get<0>(static_cast<Fwd &&>(fwd)),
                           std::get<1>(static_cast<Fwd &&>(fwd))));
-        p_ = Allocate(sz_);
+        cap_ = Round_cap(sz_);
+        p_   = Allocate(cap_);
         (...,
-         []<class T>(T *d_f, auto f, const auto l) {
-             try {
+         [&](Ptr_t<TsSrt> d_f, auto f, const auto l) {
+             if constexpr (Is_packed<TsSrt> || Is_nullable<TsSrt>) {
                  for (; f != l; ++f, ++d_f)
-                     Al_tr::construct(al_, d_f, *f);
-             } catch (...) {
-                 Destroy_to(d_f);
-                 throw;
-             }
-         }(Get_data<Is>(), std::get<Redir[Is * 2]>(static_cast<Fwd &&>(fwd)),
-           std::get<Redir[Is * 2 + 1]>(static_cast<Fwd &&>(fwd))));
+                     *d_f = static_cast<Value_t<TsSrt>>(*f);
+             } else if constexpr (Is_varlen<TsSrt>) {
+                 void *p = d_f.ends();
+                 try {
+                     for (size_type i = 0; f != l; ++f, ++i)
+                         Varlen_push<Is>(p, i, *f);
+                 } catch (...) {
+                     Destroy_to(p);
+                     throw;
+                 }
+             } else
+                 try {
+                     for (; f != l; ++f, ++d_f)
+                         Al_tr::construct(al_, d_f, *f);
+                 } catch (...) {
+                     Destroy_to(d_f);
+                     throw;
+                 }
+         }(Get_data<Is>(),
+           std::get<Unredir[Is] * 2>(static_cast<Fwd &&>(fwd)),
+           std::get<Unredir[Is] * 2 + 1>(static_cast<Fwd &&>(fwd))));
     }
     constexpr DORI_inline vector_impl(const Al &alloc) noexcept
-        : opaque_vector<Al>{alloc}
+        : opaque_vector<Al>{alloc}, blobs_{Make_blobs(al_)}
     {
     }
     constexpr DORI_inline vector_impl(vector_impl &&other) noexcept
         : opaque_vector<Al>{static_cast<Al &&>(other.al_), other.p_, other.sz_,
-                            other.cap_}
+                            other.cap_},
+          blobs_{static_cast<Blobs &&>(other.blobs_)},
+          heads_{std::exchange(other.heads_, Heads{})}
     {
         other.sz_  = 0;
         other.cap_ = 0;
     }
 
   private:
+    static constexpr DORI_inline size_type Round_cap(size_type n) noexcept
+    {
+        const auto g = n < Line_cap_min ? Granularity : Line_granularity;
+        if constexpr (Line_granularity == 1)
+            return n;
+        else
+            return (n + g - 1) / g * g;
+    }
+
+#if DORI_STATS
+    static stats::entry &Stats_entry() noexcept
+    {
+        return stats::detail::Entry_for<vector_al<Al, Ts...>, sizeof...(Ts),
+                                        Sz_all>();
+    }
+#endif
+
+    // Allocates storage for cap rows
     constexpr DORI_inline auto
-    Allocate(size_type n) noexcept(noexcept(Al_tr::allocate(al_, n)))
+    Allocate(size_type cap) noexcept(noexcept(Al_tr::allocate(al_, cap)))
     {
-        DORI_assert(n % Sz_all == 0);
+        DORI_assert(cap % Granularity == 0);
+        DORI_stats_scope(allocate, cap);
+        DORI_stats(stats::detail::Record_capacity(Stats_entry(), cap));
         // Use of lambda here avoids unreachable code warning
         return [](auto p) {
             DORI_assert(reinterpret_cast<uintptr_t>(p) % Align == 0);
             return p;
-        }(Al_tr::allocate(al_, n));
+        }(Al_tr::allocate(al_, Bytes_for(cap)));
+    }
+
+    constexpr DORI_inline void
+    Deallocate(std::byte *p, size_type cap,
+               [[maybe_unused]] size_type used) noexcept(noexcept(
+        Al_tr::deallocate(al_, p, Bytes_for(cap))))
+    {
+        DORI_stats_scope(deallocate, cap);
+        DORI_stats(stats::detail::Record_release(Stats_entry(), cap, used));
+        Al_tr::deallocate(al_, p, Bytes_for(cap));
     }
 
   public:
     constexpr DORI_inline vector_impl(vector_impl &&other, const Al &alloc)
-        : opaque_vector<Al>{alloc, other.p_, other.sz_, other.cap_}
+        : opaque_vector<Al>{alloc, other.p_, other.sz_, other.cap_},
+          blobs_{Move_blobs(other.blobs_, alloc)},
+          heads_{std::exchange(other.heads_, Heads{})}
     {
-        if (!Al_tr::is_always_equal::value && alloc != other.al_) {
-            auto p = Allocate(cap_ * Sz_all);
+        if (!Al_tr::is_always_equal::value && alloc != other.al_ && cap_) {
+            auto p = Allocate(cap_);
             Move_to_alloc(cap_, p);
+            other.Deallocate(other.p_, other.cap_, sz_);
             p_ = p;
         }
         other.sz_  = 0;
@@ -168,33 +413,56 @@ class vector_impl<Al, mp_list<Ts...>, mp_list<TsSrt...>, Offsets, Redir, Is...>
         // If an exception is thrown, p_ points to garbage. Due to this, use
         // !cap_ to check for no allocation.
         //
-        sz_ = cap_ = v.sz_;
-        if (v.cap_) {
-            p_ = Allocate(cap_ * Sz_all);
-            (..., [&]<size_type I, class T>(const T *f, T *d_f) {
-                try {
-                    for (const auto l = f + v.sz_; f != l; ++f, ++d_f)
-                        Al_tr::construct(al_, d_f, *f);
-                } catch (...) {
-                    Destroy_to(d_f);
-                    cap_ = 0;
-                    Al_tr::deallocate(al_, p_, v.cap_ * Sz_all);
-                    throw;
-                }
-            }.template operator()<Is>(v.data<Is>(), data<Is>()));
+        sz_  = v.sz_;
+        cap_ = Round_cap(v.sz_);
+        if (v.sz_) {
+            DORI_stats_scope(copy, v.sz_);
+            Assign_blobs(v);
+            p_ = Allocate(cap_);
+            if constexpr (Trivial)
+                Trivial_ops_t::copy(p_, cap_, v.p_, v.cap_, v.sz_);
+            else
+                (..., [&](Cptr_t<TsSrt> f, Ptr_t<TsSrt> d_f) {
+                    if constexpr (Is_packed<TsSrt>)
+                        Packed_copy(d_f, f, v.sz_);
+                    else if constexpr (Is_nullable<TsSrt>)
+                        Nullable_copy(d_f, f, v.sz_);
+                    else if constexpr (Is_varlen<TsSrt>)
+                        std::copy_n(f.ends(), v.sz_, d_f.ends());
+                    else
+                        try {
+                            for (const auto l = f + v.sz_; f != l; ++f, ++d_f)
+                                Al_tr::construct(al_, d_f, *f);
+                        } catch (...) {
+                            Destroy_to(d_f);
+                            Deallocate(p_, cap_, 0);
+                            cap_ = 0;
+                            throw;
+                        }
+                }(v.template Get_data<Is>(), Get_data<Is>()));
         } else
             p_ = nullptr;
     }
 
+    static constexpr DORI_inline decltype(auto)
+    Select_on_copy(const Al &al) noexcept
+    {
+        // Copying from the lvalue directly spares a move of the temporary into
+        // the [[no_unique_address]] member, where elision isn't guaranteed
+        if constexpr (requires { al.select_on_container_copy_construction(); })
+            return Al_tr::select_on_container_copy_construction(al);
+        else
+            return al;
+    }
+
   public:
     constexpr DORI_inline vector_impl(const vector_impl &other)
-        : opaque_vector<Al>{
-              Al_tr::select_on_container_copy_construction(other.al_)}
+        : opaque_vector<Al>{Select_on_copy(other.al_)}, blobs_{Make_blobs(al_)}
     {
         Copy_from(other);
     }
     constexpr DORI_inline vector_impl(const vector_impl &other, const Al &alloc)
-        : opaque_vector<Al>{alloc}
+        : opaque_vector<Al>{alloc}, blobs_{Make_blobs(al_)}
     {
         Copy_from(other);
     }
@@ -208,30 +476,52 @@ class vector_impl<Al, mp_list<Ts...>, mp_list<TsSrt...>, Offsets, Redir, Is...>
     template <bool Move, class Vector>
     constexpr DORI_inline void Assign_from(Vector &v) noexcept(Move)
     {
-        const auto mid = std::min(sz_, v.sz_);
-        (..., [&]<class T>(auto f, T *d_f) {
-            using Fwd_t = std::conditional_t<Move, T &&, const T &>;
-            const T *a = d_f + mid, *b = d_f + v.sz_, *c = d_f + sz_;
-            // Move into 0..mid
-            for (; d_f != a; ++f, ++d_f)
-                Call_maybe_unsafe(
-                    [](T *x, auto y) { *x = static_cast<Fwd_t>(*y); }, d_f, f);
-            // Umove into mid..rhs.sz_
-            for (; d_f != b; ++f, ++d_f)
-                Call_maybe_unsafe(DORI_f_ref(Al_tr::construct), al_, d_f,
-                                  static_cast<Fwd_t>(*f));
-            // Destroy rhs.sz_..sz_
-            for (; std::less<>{}(d_f, c); ++f)
-                Call_maybe_unsafe(DORI_f_ref(Al_tr::destroy), al_, d_f);
-        }(v.Get_data<Is>(v.cap_), Get_data<Is>(cap_)));
+        DORI_stats_scope(assign, v.sz_);
+        if constexpr (Trivial) {
+            if (static_cast<const void *>(&v) != this)
+                Trivial_ops_t::copy(p_, cap_, v.p_, v.cap_, v.sz_);
+        } else {
+            const auto mid = std::min(sz_, v.sz_);
+            (..., [&](auto f, Ptr_t<TsSrt> d_f) {
+                if constexpr (Is_packed<TsSrt>) {
+                    Packed_copy(d_f, f, v.sz_);
+                } else if constexpr (Is_nullable<TsSrt>) {
+                    Nullable_copy(d_f, f, v.sz_);
+                } else if constexpr (Is_varlen<TsSrt>) {
+                    std::copy_n(f.ends(), v.sz_, d_f.ends());
+                } else {
+                    using T     = TsSrt;
+                    using Fwd_t = std::conditional_t<Move, T &&, const T &>;
+                    const T *a = d_f + mid, *b = d_f + v.sz_, *c = d_f + sz_;
+                    // Move into 0..mid
+                    for (; d_f != a; ++f, ++d_f)
+                        Call_maybe_unsafe(
+                            [](T *x, auto y) { *x = static_cast<Fwd_t>(*y); },
+                            d_f, f);
+                    // Umove into mid..rhs.sz_
+                    for (; d_f != b; ++f, ++d_f)
+                        Call_maybe_unsafe(DORI_f_ref(Al_tr::construct), al_,
+                                          d_f, static_cast<Fwd_t>(*f));
+                    // Destroy rhs.sz_..sz_
+                    for (; std::less<>{}(d_f, c); ++d_f)
+                        Call_maybe_unsafe(DORI_f_ref(Al_tr::destroy), al_, d_f);
+                }
+            }(v.template Get_data<Is>(v.cap_), Get_data<Is>(cap_)));
+        }
+        // Copied even when moving, as v keeps its rows
+        if constexpr (Varlens)
+            Assign_blobs(v);
+        sz_ = v.sz_;
     }
 
+  protected:
     constexpr DORI_inline void Maybe_delete() noexcept(
-        noexcept(clear(), Al_tr::deallocate(al_, p_, cap_ *Sz_all)))
+        noexcept(clear(), Al_tr::deallocate(al_, p_, Bytes_for(cap_))))
     {
         if (cap_) {
+            [[maybe_unused]] const auto used = sz_;
             clear();
-            Al_tr::deallocate(al_, p_, cap_ * Sz_all);
+            Deallocate(p_, cap_, used);
             // Note no resetting vars
         }
     }
@@ -246,11 +536,16 @@ class vector_impl<Al, mp_list<Ts...>, mp_list<TsSrt...>, Offsets, Redir, Is...>
             sz_ = cap_ = 0;
             if (!keep_al) {
                 al_ = rhs.al_;
-                if (!sz_)
+                if constexpr (Varlens) {
+                    std::destroy_at(&blobs_);
+                    std::construct_at(&blobs_, Make_blobs(al_));
+                    heads_ = Heads{};
+                }
+                if (!rhs.sz_)
                     return *this;
             }
-            p_   = Allocate(rhs.sz_ * Sz_all);
-            cap_ = rhs.sz_;
+            p_   = Allocate(Round_cap(rhs.sz_));
+            cap_ = Round_cap(rhs.sz_);
         }
         Assign_from<false>(rhs);
         return *this;
@@ -259,23 +554,31 @@ class vector_impl<Al, mp_list<Ts...>, mp_list<TsSrt...>, Offsets, Redir, Is...>
     constexpr DORI_inline vector_impl &
     operator=(vector_impl &&rhs) noexcept(Al_pocma::value || Al_iae::value)
     { // Note: The standard doesn't mandate strong exception guarantee.
-        Maybe_delete();
-        if constexpr (Al_iae::value) {
-        } else if constexpr (Al_pocma::value) {
-            al_ = static_cast<Al &&>(rhs.al_);
-        } else if (al_ != rhs.al_) {
-            if (cap_ < rhs.sz_) {
-                cap_ = sz_ = 0;
-                p_         = Allocate(rhs.sz_ * Sz_all);
-                cap_       = rhs.sz_;
+        if constexpr (!Al_iae::value && !Al_pocma::value) {
+            if (al_ != rhs.al_) {
+                // The storage of rhs can't be taken over; move elementwise
+                if (cap_ < rhs.sz_) {
+                    Maybe_delete();
+                    cap_ = sz_ = 0;
+                    p_         = Allocate(Round_cap(rhs.sz_));
+                    cap_       = Round_cap(rhs.sz_);
+                }
+                Assign_from<true>(rhs);
+                return *this;
             }
-            Assign_from<true>(rhs);
-            return *this;
         }
+        Maybe_delete();
+        if constexpr (!Al_iae::value && Al_pocma::value)
+            al_ = static_cast<Al &&>(rhs.al_);
         p_      = rhs.p_;
         sz_     = rhs.sz_;
         cap_    = rhs.cap_;
         rhs.sz_ = rhs.cap_ = 0;
+        if constexpr (Varlens) {
+            blobs_ = static_cast<Blobs &&>(rhs.blobs_);
+            heads_ = std::exchange(rhs.heads_, Heads{});
+            std::apply([](auto &...bs) { (..., bs.clear()); }, rhs.blobs_);
+        }
         return *this;
     }
 
@@ -291,6 +594,10 @@ class vector_impl<Al, mp_list<Ts...>, mp_list<TsSrt...>, Offsets, Redir, Is...>
         std::swap(p_, other.p_);
         std::swap(sz_, other.sz_);
         std::swap(cap_, other.cap_);
+        if constexpr (Varlens) {
+            blobs_.swap(other.blobs_);
+            heads_.swap(other.heads_);
+        }
     }
 
     constexpr DORI_inline ~vector_impl() { Maybe_delete(); }
@@ -337,32 +644,68 @@ class vector_impl<Al, mp_list<Ts...>, mp_list<TsSrt...>, Offsets, Redir, Is...>
     constexpr DORI_inline reference back() noexcept
     {
         DORI_assert(sz_ > 0);
-        return *operator[](sz_ - 1);
+        return operator[](sz_ - 1);
     }
     constexpr DORI_inline const_reference back() const noexcept
     {
         DORI_assert(sz_ > 0);
-        return *operator[](sz_ - 1);
+        return operator[](sz_ - 1);
     }
 
   private:
     static constexpr auto npos = static_cast<size_type>(-1);
+
+    // Sequence I of an allocation p of capacity cap
+    template <std::size_t I, class B>
+    static constexpr DORI_inline auto Data_at(B *p, size_type cap) noexcept
+    {
+        using T = mp_at_c<mp_list<TsSrt...>, I>;
+        constexpr bool C = std::is_const_v<B>;
+        if constexpr (Is_packed<T>) {
+            using W = std::conditional_t<C, const std::uint64_t, std::uint64_t>;
+            using RTy = std::conditional_t<C, Cptr_t<T>, Ptr_t<T>>;
+            return RTy{reinterpret_cast<W *>(p + cap * Sz_all +
+                                             cap / 8 * Bit_offsets[I])};
+        } else if constexpr (Is_nullable<T>) {
+            using E = typename Nullable_of<T>::element_type;
+            using W = std::conditional_t<C, const std::uint64_t, std::uint64_t>;
+            using V = std::conditional_t<C, const E, E>;
+            using RTy = std::conditional_t<C, Cptr_t<T>, Ptr_t<T>>;
+            return RTy{reinterpret_cast<V *>(p + Offsets[I] * cap),
+                       reinterpret_cast<W *>(p + cap * Sz_all +
+                                             cap / 8 * Bit_offsets[I])};
+        } else if constexpr (Is_varlen<T>) {
+            // The end offsets; the values are in Blob<I>()
+            using RTy =
+                std::conditional_t<C, const std::size_t *, std::size_t *>;
+            return reinterpret_cast<RTy>(p + Offsets[I] * cap);
+        } else {
+            using RTy = std::conditional_t<C, const T *, T *>;
+            return reinterpret_cast<RTy>(p + Offsets[I] * cap);
+        }
+    }
+
     template <std::size_t I>
     requires(I < sizeof...(Ts)) constexpr DORI_inline
         auto Get_data(size_type cap = npos) noexcept
     {
-        const auto n = (cap == npos) ? cap_ : cap;
-        using RTy    = mp_at_c<mp_list<TsSrt...>, I> *;
-        return reinterpret_cast<RTy>(p_ + Offsets[I] * n);
+        const auto p = Data_at<I>(p_, (cap == npos) ? cap_ : cap);
+        if constexpr (Is_varlen<Ith_sorted<I>>)
+            return Ptr_t<Ith_sorted<I>>{p, Blob<I>().data() + Head<I>()};
+        else
+            return p;
     }
 
     template <std::size_t I>
     requires(I < sizeof...(Ts)) constexpr DORI_inline
         auto Get_data(size_type cap = npos) const noexcept
     {
-        const auto n = (cap == npos) ? cap_ : cap;
-        using RTy    = const mp_at_c<mp_list<TsSrt...>, I> *;
-        return reinterpret_cast<RTy>(p_ + Offsets[I] * n);
+        const auto p = Data_at<I>(static_cast<const std::byte *>(p_),
+                                  (cap == npos) ? cap_ : cap);
+        if constexpr (Is_varlen<Ith_sorted<I>>)
+            return Cptr_t<Ith_sorted<I>>{p, Blob<I>().data() + Head<I>()};
+        else
+            return p;
     }
 
   public:
@@ -409,13 +752,25 @@ class vector_impl<Al, mp_list<Ts...>, mp_list<TsSrt...>, Offsets, Redir, Is...>
     constexpr DORI_inline void Move_to_alloc(size_type cap, auto p) noexcept
     {
         DORI_assert(cap >= sz_);
-        (..., [&]<class T>(T *f, T *d_f) {
-            for (const auto l = f + sz_; f != l; ++f, ++d_f) {
-                Call_maybe_unsafe(DORI_f_ref(Al_tr::construct), al_, d_f,
-                                  static_cast<Move_t<T>>(*f));
-                Call_maybe_unsafe(DORI_f_ref(Al_tr::destroy), al_, f);
-            }
-        }(data<Is>(), reinterpret_cast<Ts *>(p + Offsets[Is] * cap)));
+        DORI_stats_scope(relocate, sz_);
+        if constexpr (Trivial)
+            Trivial_ops_t::copy(p, cap, p_, cap_, sz_);
+        else
+            (..., [&](Ptr_t<TsSrt> f, decltype(Data_at<Is>(p, cap)) d_f) {
+                if constexpr (Is_packed<TsSrt>)
+                    Packed_copy(d_f, f, sz_);
+                else if constexpr (Is_nullable<TsSrt>)
+                    Nullable_copy(d_f, f, sz_);
+                else if constexpr (Is_varlen<TsSrt>)
+                    std::copy_n(f.ends(), sz_, d_f);
+                else
+                    for (const auto l = f + sz_; f != l; ++f, ++d_f) {
+                        using T = TsSrt;
+                        Call_maybe_unsafe(DORI_f_ref(Al_tr::construct), al_,
+                                          d_f, static_cast<Move_t<T>>(*f));
+                        Call_maybe_unsafe(DORI_f_ref(Al_tr::destroy), al_, f);
+                    }
+            }(Get_data<Is>(), Data_at<Is>(p, cap)));
     }
 
   public:
@@ -423,10 +778,11 @@ class vector_impl<Al, mp_list<Ts...>, mp_list<TsSrt...>, Offsets, Redir, Is...>
     reserve(size_type cap) noexcept(noexcept(Move_to_alloc(cap, Allocate({}))))
     {
         DORI_assert(cap > cap_);
-        auto p = Allocate(cap * Sz_all);
+        cap    = Round_cap(cap);
+        auto p = Allocate(cap);
         if (cap_) {
             Move_to_alloc(cap, p);
-            Al_tr::deallocate(al_, p_, cap_ * Sz_all);
+            Deallocate(p_, cap_, sz_);
         }
         p_   = p;
         cap_ = cap;
@@ -436,37 +792,60 @@ class vector_impl<Al, mp_list<Ts...>, mp_list<TsSrt...>, Offsets, Redir, Is...>
     shrink_to_fit() noexcept(noexcept(Move_to_alloc(sz_, Allocate({}))))
     {
         DORI_assert(sz_); // use '= {}' to empty
-        auto p = Allocate(sz_ * Sz_all);
-        Move_to_alloc(sz_, p);
-        Al_tr::deallocate(al_, p_, cap_ * Sz_all);
+        const auto cap = Round_cap(sz_);
+        auto p         = Allocate(cap);
+        Move_to_alloc(cap, p);
+        Deallocate(p_, cap_, sz_);
         p_   = p;
-        cap_ = sz_;
+        cap_ = cap;
+        if constexpr (Varlens) {
+            Compact_blobs();
+            std::apply([](auto &...bs) { (..., bs.shrink_to_fit()); }, blobs_);
+        }
     }
 
     constexpr DORI_inline void clear() noexcept
     {
-        (..., [&]<class T>(T *f, T *l) {
-            while (f != l)
-                Call_maybe_unsafe(DORI_f_ref(Al_tr::destroy), al_, f++);
+        (..., [&](Ptr_t<TsSrt> f, Ptr_t<TsSrt> l) {
+            if constexpr (Is_varlen<TsSrt>) {
+                Blob<Is>().clear();
+                Head<Is>() = 0;
+            } else if constexpr (!Is_packed<TsSrt> && !Is_nullable<TsSrt>)
+                while (f != l)
+                    Call_maybe_unsafe(DORI_f_ref(Al_tr::destroy), al_, f++);
         }(Get_data<Is>(), Get_data<Is>() + sz_));
         sz_ = 0;
     }
 
     constexpr DORI_inline iterator
     erase(const_iterator first, const_iterator last) noexcept(
-        (noexcept(std::declval<Ts &>() = std::declval<Ts &&>()) && ...))
+        (noexcept(std::declval<Value_t<Ts> &>() =
+                      std::declval<Value_t<Ts> &&>()) &&
+         ...))
     {
         const auto f_i = sz_ + first.i;
         const auto n   = last.i - first.i;
-        const std::tuple ptrs{(&data<Is>()[sz_] + f_i)...};
-        (..., [&]<class T>(T *d_f) {
-            const auto e = d_f - first.i;
-            for (auto f = d_f + n; f != e; ++f, ++d_f)
-                *d_f = static_cast<T &&>(*f);
-            while (d_f != e)
-                Al_tr::destroy(al_, d_f++);
-        }(std::get<Is>(ptrs)));
-        return {{std::get<Is>(ptrs)...}, -static_cast<std::intptr_t>(sz_ -= n)};
+        DORI_stats_scope(erase, static_cast<size_type>(-last.i));
+        if constexpr (Trivial && !Bits_all && !Varlens)
+            Trivial_ops_t::erase(p_, cap_, f_i, f_i + n, sz_);
+        else
+            (..., [&](Ptr_t<TsSrt> d_f) {
+                const auto e = d_f - first.i;
+                if constexpr (Is_varlen<TsSrt>) {
+                    Varlen_erase<Is>(f_i, static_cast<size_type>(n));
+                } else if constexpr (Is_packed<TsSrt> || Is_nullable<TsSrt>) {
+                    for (auto f = d_f + n; f != e; ++f, ++d_f)
+                        *d_f = static_cast<Value_t<TsSrt>>(*f);
+                } else {
+                    using T = TsSrt;
+                    for (auto f = d_f + n; f != e; ++f, ++d_f)
+                        *d_f = static_cast<T &&>(*f);
+                    while (d_f != e)
+                        Al_tr::destroy(al_, d_f++);
+                }
+            }(Get_data<Is>() + f_i));
+        sz_ -= n;
+        return Iter_at(f_i);
     }
 
     constexpr DORI_inline iterator
@@ -476,24 +855,158 @@ class vector_impl<Al, mp_list<Ts...>, mp_list<TsSrt...>, Offsets, Redir, Is...>
     }
 
   private:
+    // Records in p the element about to be constructed for the unhappy path
     template <class T, class U, std::size_t... Js>
     constexpr DORI_inline void
-    Emplace(T *p, U &&t, std::index_sequence<Js...>) noexcept(
+    Emplace(void *&p, T *d, U &&t, std::index_sequence<Js...>) noexcept(
         std::is_nothrow_constructible<T,
                                       mp_at_c<std::decay_t<U>, Js>...>::value)
     {
         static_assert(
             std::is_constructible_v<T, mp_at_c<std::decay_t<U>, Js>...>,
             "elements not constructible with parameters to emplace()");
+        p = d;
         Call_maybe_unsafe(
             std::is_nothrow_constructible<T, mp_at_c<std::decay_t<U>, Js>...>{},
-            DORI_f_ref(Al_tr::construct), al_, p,
+            DORI_f_ref(Al_tr::construct), al_, d,
             std::get<Js>(static_cast<U &&>(t))...);
     }
+    template <class T, std::size_t Bits, class U, std::size_t... Js>
+    constexpr DORI_inline void
+    Emplace(void *&, packed_ptr<T, Bits> d, U &&t,
+            std::index_sequence<Js...>) noexcept
+    {
+        *d = T(std::get<Js>(static_cast<U &&>(t))...);
+    }
+    template <class T, class U, std::size_t... Js>
+    constexpr DORI_inline void
+    Emplace(void *&, nullable_ptr<T> d, U &&t,
+            std::index_sequence<Js...>) noexcept
+    {
+        *d = std::optional<T>(std::get<Js>(static_cast<U &&>(t))...);
+    }
+
+    //
+    // Appends x to the values of varlen sequence I as row i, which follows
+    // the others; records in p the end offset written for the unhappy path
+    //
+    template <std::size_t I>
+    constexpr void
+    Varlen_push(void *&p, size_type i,
+                typename Varlen_of<Ith_sorted<I>>::view_type x)
+    {
+        const auto e = Data_at<I>(p_, cap_);
+        auto &b      = Blob<I>();
+        p            = e + i;
+        const auto h = Head<I>();
+        // Drops the values of a row whose emplacement failed, if any
+        b.resize(h + (i ? e[i - 1] : 0));
+        b.insert(b.end(), x.begin(), x.end());
+        e[i] = b.size() - h;
+    }
+
+    //
+    // Appends the n rows from f to the values of varlen sequence I as rows
+    // i..i + n, which follow the others. From a varlen_ptr, the values are
+    // copied by one insert and the end offsets rebased in one pass; from an
+    // iterator of rows, the values are sized first if it can be read twice.
+    //
+    template <std::size_t I, class It>
+    constexpr void Varlen_append(size_type i, size_type n, It f)
+    {
+        using View   = typename Varlen_of<Ith_sorted<I>>::view_type;
+        const auto e = Data_at<I>(p_, cap_);
+        auto &b      = Blob<I>();
+        const auto h = Head<I>();
+        b.resize(h + (i ? e[i - 1] : 0));
+        const auto base = b.size() - h;
+        if constexpr (Is_varlen_ptr<It>) {
+            const auto s  = f.ends() + f.index();
+            const auto vf = f.index() ? s[-1] : 0;
+            b.insert(b.end(), f.values() + vf, f.values() + s[n - 1]);
+            for (size_type j = 0; j < n; ++j)
+                e[i + j] = base + (s[j] - vf);
+        } else {
+            if constexpr (std::forward_iterator<It>) {
+                auto vl = b.size();
+                auto g  = f;
+                for (size_type j = 0; j < n; ++j, ++g)
+                    vl += View(*g).size();
+                b.reserve(vl);
+            }
+            for (size_type j = 0; j < n; ++j, ++f) {
+                const View x(*f);
+                b.insert(b.end(), x.begin(), x.end());
+                e[i + j] = b.size() - h;
+            }
+        }
+    }
+
+    //
+    // Erases rows f..f + n of varlen sequence I. The values of a row start
+    // where those of the row before end, so the erased ones can't be left as
+    // a hole: the fewer of the values before and after them are moved over
+    // them, the ones before being moved up past the head of the buffer. The
+    // dead values at the head are dropped once they outnumber the live ones,
+    // so erasing from the front moves each value once on average.
+    //
+    template <std::size_t I>
+    constexpr void Varlen_erase(size_type f, size_type n) noexcept
+    {
+        if (!n)
+            return;
+        const auto e  = Data_at<I>(p_, cap_);
+        auto &b       = Blob<I>();
+        auto &h       = Head<I>();
+        const auto vf = f ? e[f - 1] : 0, vl = e[f + n - 1];
+        const auto ve = e[sz_ - 1];
+        for (auto i = f; i + n < sz_; ++i)
+            e[i] = e[i + n] - (vl - vf);
+        const auto at = [&](size_type k) {
+            return b.begin() + static_cast<std::ptrdiff_t>(h + k);
+        };
+        if (vf < ve - vl) {
+            std::copy_backward(at(0), at(vf), at(vl));
+            h += vl - vf;
+        } else
+            b.erase(at(vf), at(vl));
+        if (h > b.size() - h) {
+            b.erase(b.begin(), at(0));
+            h = 0;
+        }
+    }
+
+    template <std::size_t I, class U, std::size_t... Js>
+    constexpr DORI_inline void Emplace_at(void *&p, size_type i, U &&t,
+                                          std::index_sequence<Js...> js)
+    {
+        using T = Ith_sorted<I>;
+        if constexpr (Is_varlen<T>) {
+            static_assert(std::is_constructible_v<
+                              typename Varlen_of<T>::view_type,
+                              mp_at_c<std::decay_t<U>, Js>...>,
+                          "varlen rows not constructible with parameters to "
+                          "emplace()");
+            Varlen_push<I>(
+                p, i,
+                typename Varlen_of<T>::view_type(
+                    std::get<Js>(static_cast<U &&>(t))...));
+        } else
+            Emplace(p, Get_data<I>() + i, static_cast<U &&>(t), js);
+    }
+
+    // Whether a row of a column declared as T can be made of Us
+    template <class T, class... Us>
+    static constexpr inline bool Constructible =
+        Is_varlen<T>
+            ? std::is_constructible_v<typename Varlen_of<T>::view_type, Us...>
+            : std::is_constructible_v<Value_t<T>, Us...>;
 
+    // Appending to varlen columns allocates
     template <class... Us>
     static constexpr inline auto Nothrow_emplace =
-        (... && mp_rename<mp_push_front<std::decay_t<Us>, Ts>,
+        !Varlens &&
+        (... && mp_rename<mp_push_front<std::decay_t<Us>, Value_t<Ts>>,
                           std::is_nothrow_constructible>::value);
 
   public:
@@ -509,11 +1022,10 @@ class vector_impl<Al, mp_list<Ts...>, mp_list<TsSrt...>, Offsets, Redir, Is...>
         Try<Nothrow_emplace<Us...>>([&] {
             using Fwd = std::tuple<Us &&...>;
             Fwd fwd{static_cast<Us &&>(xs)...};
-            (...,
-             Emplace((p = Get_data<Is>() + off, reinterpret_cast<TsSrt *>(p)),
-                     std::get<Redir[Is]>(static_cast<Fwd &&>(fwd)),
-                     mp_rename<std::decay_t<mp_at_c<Fwd, Redir[Is]>>,
-                               std::index_sequence_for>{}));
+            (..., Emplace_at<Is>(
+                      p, off, std::get<Unredir[Is]>(static_cast<Fwd &&>(fwd)),
+                      mp_rename<std::decay_t<mp_at_c<Fwd, Unredir[Is]>>,
+                                std::index_sequence_for>{}));
         })([&] {
             Destroy_to(p, off);
             throw;
@@ -521,15 +1033,17 @@ class vector_impl<Al, mp_list<Ts...>, mp_list<TsSrt...>, Offsets, Redir, Is...>
         return Iter_at(off);
     }
 
-    constexpr DORI_inline auto emplace_back() noexcept(noexcept(
-        emplace_back(std::piecewise_construct, (Is, std::tuple<>{})...))) //
-        requires(... &&std::is_default_constructible_v<Ts>)
+    constexpr DORI_inline auto emplace_back() noexcept(
+        noexcept(emplace_back(std::piecewise_construct,
+                              (static_cast<void>(Is), std::tuple<>{})...))) //
+        requires(... &&std::is_default_constructible_v<Value_t<Ts>>)
     {
-        return emplace_back(std::piecewise_construct, (Is, std::tuple<>{})...);
+        return emplace_back(std::piecewise_construct,
+                            (static_cast<void>(Is), std::tuple<>{})...);
     }
 
     template <class... Us>
-    requires((std::is_constructible_v<Ts, Us &&> && ...) &&
+    requires((Constructible<Ts, Us &&> && ...) &&
              sizeof...(Us) == sizeof...(Ts)) //
         constexpr DORI_inline iterator
         emplace_back(Us &&...xs) noexcept(noexcept(
@@ -541,7 +1055,7 @@ class vector_impl<Al, mp_list<Ts...>, mp_list<TsSrt...>, Offsets, Redir, Is...>
     }
 
     template <class... Us>
-    requires((std::is_constructible_v<Ts, Us &&> && ...) &&
+    requires((Constructible<Ts, Us &&> && ...) &&
              sizeof...(Us) == sizeof...(Ts)) //
         constexpr DORI_inline void push_back(Us &&...xs) noexcept(noexcept(
             emplace_back(std::piecewise_construct,
@@ -563,103 +1077,235 @@ class vector_impl<Al, mp_list<Ts...>, mp_list<TsSrt...>, Offsets, Redir, Is...>
         push_back(std::get<Is>(static_cast<value_type &&>(value))...);
     }
 
+    //
+    // Appends n rows, row j of declared column I being xs_I[j], where xs are
+    // iterators such as the data<I>() of another vector. A varlen column takes
+    // a varlen_ptr, whose values are appended by one copy, or an iterator of
+    // rows; see varlen.h. The rows must fit in the capacity.
+    //
+    template <class... Its>
+    requires(sizeof...(Its) == sizeof...(Ts)) //
+        constexpr void append(size_type n, Its... xs)
+    {
+        DORI_assert(sz_ + n <= cap_);
+        if (!n)
+            return;
+        const auto off = sz_;
+        sz_ += n;
+        const std::tuple fs{xs...};
+        void *p;
+        try {
+            (..., [&](Ptr_t<TsSrt> d_f, auto f) {
+                if constexpr (Is_varlen<TsSrt>) {
+                    p = d_f.ends() + off;
+                    Varlen_append<Is>(off, n, f);
+                } else if constexpr (Is_packed<TsSrt> || Is_nullable<TsSrt>) {
+                    for (const auto l = d_f + n; d_f != l; ++f, ++d_f)
+                        *d_f = static_cast<Value_t<TsSrt>>(*f);
+                } else
+                    for (const auto l = d_f + n; d_f != l; ++f, ++d_f) {
+                        p = d_f;
+                        Al_tr::construct(al_, d_f, *f);
+                    }
+            }(Get_data<Is>() + off, std::get<Unredir[Is]>(fs)));
+        } catch (...) {
+            Destroy_to(p, off);
+            throw;
+        }
+    }
+
     constexpr DORI_inline void resize(size_type sz)
     {
         DORI_assert(cap_);
         if (sz > sz_) { // proposed exceeds current => extend
             const auto off = sz_;
             sz_            = sz;
-            (..., [&]<class T>(T *f, T *l) {
-                try {
+            (..., [&](Ptr_t<TsSrt> f, Ptr_t<TsSrt> l) {
+                if constexpr (Is_packed<TsSrt> || Is_nullable<TsSrt>) {
                     for (; f != l; ++f)
-                        Al_tr::construct(al_, f);
-                } catch (...) {
-                    Destroy_to(f, off);
-                    throw;
-                }
-            }(data<Is>() + off, data<Is>() + sz));
+                        *f = Value_t<TsSrt>{};
+                } else if constexpr (Is_varlen<TsSrt>) {
+                    const auto e = f.ends();
+                    std::fill(e + off, e + sz, off ? e[off - 1] : 0);
+                } else
+                    try {
+                        for (; f != l; ++f)
+                            Al_tr::construct(al_, f);
+                    } catch (...) {
+                        Destroy_to(f, off);
+                        throw;
+                    }
+            }(Get_data<Is>() + off, Get_data<Is>() + sz));
         } else { // current exceeds proposed => shrink
-            (..., [&]<class T>(T *f, T *l) {
-                while (f != l)
-                    Call_maybe_unsafe(DORI_f_ref(Al_tr::destroy), al_, f++);
-            }(data<Is>() + sz, data<Is>() + sz_));
+            (..., [&](Ptr_t<TsSrt> f, Ptr_t<TsSrt> l) {
+                if constexpr (Is_varlen<TsSrt>)
+                    Blob<Is>().resize(Head<Is>() + (sz ? f.ends()[sz - 1] : 0));
+                else if constexpr (!Is_packed<TsSrt> && !Is_nullable<TsSrt>)
+                    while (f != l)
+                        Call_maybe_unsafe(DORI_f_ref(Al_tr::destroy), al_,
+                                          f++);
+            }(Get_data<Is>() + sz, Get_data<Is>() + sz_));
             sz_ = sz;
         }
     }
 
     template <class F>
-    requires((std::is_invocable_v<F &&, Ts *, Ts *> && ...)) //
+    requires((std::is_invocable_v<F &&, Ptr_t<Ts>, Ptr_t<Ts>> && ...)) //
         constexpr DORI_inline void for_each(F &&f) noexcept(
             noexcept((..., static_cast<F &&>(f)(data<Is>(), data<Is>()))))
     {
-        (...,
-         static_cast<F &&>(f)(data<Redir[Is]>() + data<Redir[Is]>() + sz_));
+        (..., static_cast<F &&>(f)(Get_data<Is>(), Get_data<Is>() + sz_));
     }
     template <class F>
-    requires((std::is_invocable_v<F &&, Ts *, Ts *> && ...)) //
+    requires((std::is_invocable_v<F &&, Cptr_t<Ts>, Cptr_t<Ts>> && ...)) //
         constexpr DORI_inline void for_each(F &&f) const
         noexcept(noexcept((..., static_cast<F &&>(f)(data<Is>(), data<Is>()))))
     {
-        (...,
-         static_cast<F &&>(f)(data<Redir[Is]>() + data<Redir[Is]>() + sz_));
+        (..., static_cast<F &&>(f)(Get_data<Is>(), Get_data<Is>() + sz_));
     }
     template <class F>
-    requires((std::is_invocable_v<F &&, Ts *, Ts *> && ...)) //
+    requires((std::is_invocable_v<F &&, Ptr_t<Ts>, Ptr_t<Ts>> && ...)) //
         constexpr DORI_inline void for_each_stable(F &&f) noexcept(
             noexcept((..., static_cast<F &&>(f)(data<Is>(), data<Is>()))))
     {
-        (..., static_cast<F &&>(f)(data<Is>() + data<Is>() + sz_));
+        (..., static_cast<F &&>(f)(data<Is>(), data<Is>() + sz_));
     }
     template <class F>
-    requires((std::is_invocable_v<F &&, Ts *, Ts *> && ...)) //
+    requires((std::is_invocable_v<F &&, Cptr_t<Ts>, Cptr_t<Ts>> && ...)) //
         constexpr DORI_inline void for_each_stable(F &&f) const
         noexcept(noexcept((..., static_cast<F &&>(f)(data<Is>(), data<Is>()))))
     {
-        (..., static_cast<F &&>(f)(data<Is>() + data<Is>() + sz_));
+        (..., static_cast<F &&>(f)(data<Is>(), data<Is>() + sz_));
+    }
+
+    // Makes room for n values in varlen column I, so that appending up to as
+    // many doesn't move them; see varlen.h
+    template <std::size_t I>
+    requires(I < sizeof...(Ts) && Is_varlen<mp_at_c<mp_list<Ts...>, I>>) //
+        void reserve_values(size_type n)
+    {
+        auto &b = Blob<Redir[I]>();
+        b.erase(b.begin(), b.begin() + static_cast<std::ptrdiff_t>(
+                                           std::exchange(Head<Redir[I]>(), 0)));
+        b.reserve(n);
+    }
+
+    // Starts a lazy query over the columns, evaluated in one fused pass; see
+    // query.h
+    constexpr DORI_inline auto query() const noexcept
+    {
+        return ::dori::query<vector_impl>{*this};
     }
 };
 
+// Aligned to a cache line at least, so that the sequences of vectors of
+// Line_cap_min rows or more start on lines
 template <class L>
 using Default_allocator = boost::alignment::aligned_allocator<
     std::byte,
-    mp_max_element<mp_transform<std::alignment_of, L>, mp_less>::value>;
+    std::max(cache_line,
+             mp_max_element<mp_transform<Align_of, L>, mp_less>::value)>;
+
+template <class T>
+concept Layout_policy = std::is_base_of_v<layout::policy, T>;
 
+//
+// The allocator and the layout policy are optional trailing arguments, in that
+// order: vector<Ts..., [Allocator], [Layout]>.
+//
 template <class L>
-using Deduce_vec =
+using Deduce_vec_al =
     mp_rename<std::conditional_t<Allocator<std::byte, mp_back<L>>,
                                  mp_rotate_right_c<L, 1>,
                                  mp_push_front<L, Default_allocator<L>>>,
               vector_al>;
 
+template <class Layout, class Vector>
+struct With_layout;
+template <class Layout, class Al, class... Ts>
+struct With_layout<Layout, vector_al<Al, Ts...>> {
+    using type = std::conditional_t<
+        std::is_same_v<Layout, layout::default_policy>, vector_al<Al, Ts...>,
+        basic_vector<Layout, Al, Ts...>>;
+};
+
+template <class L>
+struct Deduce_vec_impl {
+    using type = Deduce_vec_al<L>;
+};
+template <class L>
+requires Layout_policy<mp_back<L>> struct Deduce_vec_impl<L> {
+    using type =
+        typename With_layout<mp_back<L>, Deduce_vec_al<mp_pop_back<L>>>::type;
+};
+
+template <class L>
+using Deduce_vec = typename Deduce_vec_impl<L>::type;
+
+// Appends a row to v, doubling its capacity if it's full
+template <class V, class... Us>
+DORI_inline void Grow_push_back(V &v, Us &&...xs)
+{
+    if (v.size() == v.capacity())
+        v.reserve(std::max(v.capacity() * 2, std::size_t{64}));
+    v.push_back(static_cast<Us &&>(xs)...);
+}
+
 } // namespace detail
 
 template <class... Ts>
 constexpr inline detail::vector_caster<Ts...> vector_cast{};
 
+template <class Layout, class Allocator, class... Ts>
+struct basic_vector : detail::Get_vector_t<Allocator, Layout, Ts...> {
+    using detail::Get_vector_t<Allocator, Layout, Ts...>::vector_impl;
+};
+
 template <class Allocator, class... Ts>
-struct vector_al : detail::Get_vector_t<Allocator, Ts...> {
-    using detail::Get_vector_t<Allocator, Ts...>::vector_impl;
+struct vector_al : basic_vector<layout::default_policy, Allocator, Ts...> {
+    using basic_vector<layout::default_policy, Allocator, Ts...>::basic_vector;
 };
 
-template <class Al, class... Ts>
-constexpr DORI_inline bool operator==(const vector_al<Al, Ts...> &lhs,
-                                      const vector_al<Al, Ts...> &rhs) noexcept
+template <class Layout, class Al, class... Ts>
+constexpr DORI_inline bool
+operator==(const basic_vector<Layout, Al, Ts...> &lhs,
+           const basic_vector<Layout, Al, Ts...> &rhs) noexcept
 {
+    if (lhs.size() != rhs.size())
+        return false;
+    if (lhs.empty())
+        return true;
     return [&]<std::size_t... Is>(std::index_sequence<Is...>)
     {
-        return (... && std::equal(lhs.data<Is>(), lhs.data<Is>() + lhs.size(),
-                                  rhs.data<Is>(), rhs.data<Is>() + rhs.size()));
+        return (... && [n = lhs.size()](auto a, auto b) {
+            // Varlen columns compare as their offsets and values
+            if constexpr (detail::Is_varlen_ptr<decltype(a)>)
+                return std::equal(a.ends(), a.ends() + n, b.ends()) &&
+                       std::equal(a.values(), a.values() + a.ends()[n - 1],
+                                  b.values());
+            else
+                return std::equal(a, a + n, b, b + n);
+        }(lhs.template data<Is>(), rhs.template data<Is>()));
     }
     (std::index_sequence_for<Ts...>{});
 }
 
-template <class Al, class... Ts>
-constexpr DORI_inline bool operator!=(const vector_al<Al, Ts...> &lhs,
-                                      const vector_al<Al, Ts...> &rhs) noexcept
+template <class Layout, class Al, class... Ts>
+constexpr DORI_inline bool
+operator!=(const basic_vector<Layout, Al, Ts...> &lhs,
+           const basic_vector<Layout, Al, Ts...> &rhs) noexcept
 {
     return !(lhs == rhs);
 }
 
+template <class Layout, class Al, class... Ts>
+constexpr DORI_inline void swap(basic_vector<Layout, Al, Ts...> &lhs,
+                                basic_vector<Layout, Al, Ts...> &rhs) noexcept
+{
+    lhs.swap(rhs);
+}
+
+// Exact match for vector_al, which std::swap would otherwise be
 template <class Al, class... Ts>
 constexpr DORI_inline void swap(vector_al<Al, Ts...> &lhs,
                                 vector_al<Al, Ts...> &rhs) noexcept
@@ -0,0 +1,259 @@
+#pragma once
+
+//
+// Non-owning views of rows in columns that live elsewhere, such as network
+// buffers or mapped files. A view is made of either an allocation laid out as
+// that of a vector of the same columns, or a pointer to each column:
+//
+//   using info = dori::layout::info<dori::vector<int, float>>;
+//   auto p     = mmap(..., info::bytes(cap), ...);
+//   dori::vector_view<int, float> v{p, n, cap}; // n rows of capacity cap
+//   dori::const_vector_view<int, float> w{n, ints, floats};
+//
+// Views are cheap to copy and, like std::span, don't make the rows const
+// unless they're a const_vector_view. They have the iterators, element
+// access, for_each(), and query() of a vector, so kernels written against
+// data<I>() and size() take them as they would a vector, and they never
+// allocate.
+//
+
+#include "detail/assert.h"
+#include "detail/inline.h"
+#include "layout.h"
+#include "packed.h"
+#include "query.h"
+#include "vector.h"
+
+#include <cstddef>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace dori
+{
+
+//
+// A contiguous run of size rows of a column starting at data
+//
+template <class P>
+struct column_span {
+    P data;
+    std::size_t size;
+
+    constexpr DORI_inline P begin() const noexcept { return data; }
+    constexpr DORI_inline P end() const noexcept { return data + size; }
+};
+
+template <bool Const, class Layout, class... Ts>
+class basic_vector_view
+{
+    template <class T>
+    using Ptr = std::conditional_t<Const, detail::Cptr_t<T>, detail::Ptr_t<T>>;
+    using Byte = std::conditional_t<Const, const std::byte, std::byte>;
+    using Js   = std::index_sequence_for<Ts...>;
+    template <std::size_t I>
+    using Nth = boost::mp11::mp_at_c<boost::mp11::mp_list<Ts...>, I>;
+    // A vector of the columns, for their layout
+    using Vec = detail::Get_vector_t<
+        detail::Default_allocator<boost::mp11::mp_list<Ts...>>, Layout, Ts...>;
+
+  public:
+    using value_type = std::tuple<detail::Value_t<Ts>...>;
+    using reference =
+        std::conditional_t<Const, std::tuple<detail::Cref_t<Ts>...>,
+                           std::tuple<detail::Ref_t<Ts>...>>;
+    using const_reference = std::tuple<detail::Cref_t<Ts>...>;
+    using difference_type = std::ptrdiff_t;
+    using size_type       = std::size_t;
+
+    //
+    // Iterates from the pointers to the end of each column, with the index
+    // relative to it, as that of a vector does; end() is thus index 0
+    //
+    struct iterator {
+        using difference_type   = std::ptrdiff_t;
+        using value_type        = basic_vector_view::value_type;
+        using reference         = basic_vector_view::reference;
+        using iterator_category = std::input_iterator_tag;
+
+        constexpr DORI_inline iterator &operator++() noexcept
+        {
+            return ++i, *this;
+        }
+        constexpr DORI_inline iterator operator++(int) noexcept
+        {
+            return {ptrs, i++};
+        }
+        constexpr DORI_inline reference operator*() const noexcept
+        {
+            DORI_assert(i < 0 && "out-of-bounds access");
+            return std::apply(
+                [this](const auto &...ps) { return reference{ps[i]...}; },
+                ptrs);
+        }
+        constexpr DORI_inline bool operator==(const iterator &it) const noexcept
+        {
+            return i == it.i;
+        }
+
+        std::tuple<Ptr<Ts>...> ptrs;
+        std::ptrdiff_t i = 0;
+    };
+    using const_iterator = iterator;
+
+    constexpr basic_vector_view() noexcept = default;
+
+    // Rows 0..size of an allocation p of capacity cap laid out as that of a
+    // vector<Ts..., Layout>; cap is a multiple of layout::info<>::granularity
+    constexpr basic_vector_view(std::conditional_t<Const, const void, void> *p,
+                                size_type size, size_type cap) noexcept
+        : basic_vector_view{static_cast<Byte *>(p), size, cap, Js{}}
+    {
+        DORI_assert(size <= cap && cap % layout::info<Vec>::granularity == 0);
+    }
+
+    // size rows of the columns starting at each of ps
+    constexpr basic_vector_view(size_type size, Ptr<Ts>... ps) noexcept
+        : ps_{ps...}, sz_{size}
+    {
+    }
+
+    // The rows of v, a vector (or view) of the same columns
+    template <class V>
+    requires(!std::is_same_v<std::remove_cvref_t<V>, basic_vector_view> &&
+             requires(V &v) {
+                 v.size();
+                 v.template data<0>();
+             }) //
+        constexpr basic_vector_view(V &v) noexcept
+        : basic_vector_view{v, Js{}}
+    {
+    }
+
+    // A const view of the same rows
+    constexpr DORI_inline operator basic_vector_view<true, Layout, Ts...>()
+        const noexcept requires(!Const)
+    {
+        return std::apply(
+            [this](const auto &...ps) {
+                return basic_vector_view<true, Layout, Ts...>{sz_, ps...};
+            },
+            ps_);
+    }
+
+    constexpr DORI_inline size_type size() const noexcept { return sz_; }
+    constexpr DORI_inline bool empty() const noexcept { return !sz_; }
+
+    //
+    // Element access
+    //
+
+    template <std::size_t I>
+    requires(I < sizeof...(Ts)) constexpr DORI_inline Ptr<Nth<I>>
+        data() const noexcept
+    {
+        return std::get<I>(ps_);
+    }
+    // Column I as a span
+    template <std::size_t I>
+    requires(I < sizeof...(Ts)) constexpr DORI_inline auto column() const
+        noexcept
+    {
+        return column_span<Ptr<Nth<I>>>{std::get<I>(ps_), sz_};
+    }
+
+    constexpr DORI_inline reference operator[](size_type i) const noexcept
+    {
+        DORI_assert(i < sz_ && "out-of-bounds access");
+        return std::apply(
+            [i](const auto &...ps) { return reference{ps[i]...}; }, ps_);
+    }
+    constexpr DORI_inline reference front() const noexcept
+    {
+        return (*this)[0];
+    }
+    constexpr DORI_inline reference back() const noexcept
+    {
+        return (*this)[sz_ - 1];
+    }
+
+    constexpr DORI_inline iterator begin() const noexcept
+    {
+        return std::apply(
+            [this](const auto &...ps) {
+                return iterator{{(ps + sz_)...},
+                                -static_cast<std::ptrdiff_t>(sz_)};
+            },
+            ps_);
+    }
+    constexpr DORI_inline iterator cbegin() const noexcept { return begin(); }
+    constexpr DORI_inline iterator end() const noexcept { return {}; }
+    constexpr DORI_inline iterator cend() const noexcept { return {}; }
+
+    // Calls f(first, last) for each column
+    template <class F>
+    constexpr DORI_inline void for_each(F &&f) const
+    {
+        std::apply(
+            [&](const auto &...ps) { (..., f(ps, ps + sz_)); }, ps_);
+    }
+    // Columns never move
+    template <class F>
+    constexpr DORI_inline void for_each_stable(F &&f) const
+    {
+        for_each(static_cast<F &&>(f));
+    }
+
+    // Starts a lazy query over the columns; see query.h
+    constexpr DORI_inline auto query() const noexcept
+    {
+        return ::dori::query<basic_vector_view>{*this};
+    }
+
+  private:
+    template <std::size_t... Is>
+    constexpr DORI_inline basic_vector_view(Byte *p, size_type size,
+                                            size_type cap,
+                                            std::index_sequence<Is...>) noexcept
+        : ps_{layout::info<Vec>::template data<Is>(p, cap)...}, sz_{size}
+    {
+    }
+    template <class V, std::size_t... Is>
+    constexpr DORI_inline basic_vector_view(V &v,
+                                            std::index_sequence<Is...>) noexcept
+        : ps_{(v.size() ? Ptr<Ts>{v.template data<Is>()} : Ptr<Ts>{})...},
+          sz_{v.size()}
+    {
+    }
+
+    std::tuple<Ptr<Ts>...> ps_;
+    size_type sz_ = 0;
+};
+
+namespace detail
+{
+template <bool Const, class Vector>
+struct Deduce_view;
+template <bool Const, class Al, class... Ts>
+struct Deduce_view<Const, vector_al<Al, Ts...>> {
+    using type = basic_vector_view<Const, layout::default_policy, Ts...>;
+};
+template <bool Const, class Layout, class Al, class... Ts>
+struct Deduce_view<Const, basic_vector<Layout, Al, Ts...>> {
+    using type = basic_vector_view<Const, Layout, Ts...>;
+};
+} // namespace detail
+
+//
+// vector_view<Ts..., [Layout]> and const_vector_view<Ts..., [Layout]>, the
+// layout being that of the allocation a view is made of, if any
+//
+template <class... Ts>
+using vector_view = typename detail::Deduce_view<
+    false, detail::Deduce_vec<boost::mp11::mp_list<Ts...>>>::type;
+template <class... Ts>
+using const_vector_view = typename detail::Deduce_view<
+    true, detail::Deduce_vec<boost::mp11::mp_list<Ts...>>>::type;
+
+} // namespace dori
@@ -0,0 +1,226 @@
+#pragma once
+
+//
+// A vector whose capacity is fixed at construction as a reservation of
+// address space, the pages of which are committed as the vector grows. Since
+// the storage never moves, push_back() never relocates and pointers from
+// data<I>() stay valid for the lifetime of the vector. shrink_to_fit() returns
+// the pages past the last row of each sequence to the system instead of
+// moving the rows. Needs mmap() (Linux and other POSIX systems).
+//
+//   dori::vm_vector<Pos, Vel> v{1 << 28}; // reserves, commits nothing
+//   v.push_back(...);                     // commits pages as needed
+//
+
+#include "detail/vm_allocator.h"
+#include "vector.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
+namespace dori
+{
+
+template <class Layout, class... Ts>
+class basic_vm_vector
+    : public detail::Get_vector_t<detail::Vm_allocator, Layout, Ts...>
+{
+    using Base = detail::Get_vector_t<detail::Vm_allocator, Layout, Ts...>;
+    using Al   = detail::Vm_allocator;
+
+    using Base::cap_;
+    using Base::sz_;
+
+    static_assert(!(detail::Is_varlen<Ts> || ...),
+                  "varlen columns are supported by vector only");
+
+    // Rows committed at least, the first time any are
+    static constexpr std::size_t Min_commit = 1024;
+
+    template <class T>
+    static DORI_inline std::byte *Addr(T *p) noexcept
+    {
+        return reinterpret_cast<std::byte *>(p);
+    }
+    // End of the word holding the row before p
+    template <class T, std::size_t Bits>
+    static DORI_inline std::byte *Addr(packed_ptr<T, Bits> p) noexcept
+    {
+        constexpr auto n = packed_ptr<T, Bits>::per_word;
+        return reinterpret_cast<std::byte *>(p.words() +
+                                             (p.index() + n - 1) / n);
+    }
+
+    // Commits the pages for at least n rows of each sequence
+    void Commit(std::size_t n)
+    {
+        DORI_assert(n <= cap_ && "vm_vector capacity exceeded");
+        if (n <= committed_)
+            return;
+        n = std::min(cap_, std::max({n, committed_ * 2, Min_commit}));
+        [&]<std::size_t... Is>(std::index_sequence<Is...>)
+        {
+            (..., Al::Commit(Addr(this->template data<Is>() + committed_),
+                             Addr(this->template data<Is>() + n)));
+        }
+        (std::index_sequence_for<Ts...>{});
+        committed_ = n;
+    }
+
+  public:
+    using size_type = typename Base::size_type;
+
+    basic_vm_vector() noexcept = default;
+
+    // Reserves the address space for max_rows rows
+    explicit basic_vm_vector(size_type max_rows)
+    {
+        if (max_rows)
+            Base::reserve(max_rows);
+    }
+
+    basic_vm_vector(const basic_vm_vector &other)
+        : basic_vm_vector{other.capacity()}
+    {
+        *this = other;
+    }
+    basic_vm_vector(basic_vm_vector &&other) noexcept
+        : Base{static_cast<Base &&>(other)},
+          committed_{std::exchange(other.committed_, 0)}
+    {
+    }
+
+    // Throws std::length_error if the rows of rhs don't fit in the capacity
+    basic_vm_vector &operator=(const basic_vm_vector &rhs)
+    {
+        if (rhs.size() > cap_)
+            throw std::length_error{"dori::vm_vector::operator="};
+        Commit(rhs.size());
+        Base::operator=(rhs);
+        return *this;
+    }
+    basic_vm_vector &operator=(basic_vm_vector &&rhs) noexcept
+    {
+        Base::operator=(static_cast<Base &&>(rhs));
+        committed_ = std::exchange(rhs.committed_, 0);
+        return *this;
+    }
+
+    void swap(basic_vm_vector &other) noexcept
+    {
+        Base::swap(other);
+        std::swap(committed_, other.committed_);
+    }
+
+    // The capacity is set at construction
+    void reserve(size_type) = delete;
+
+    // Rows whose pages are committed
+    size_type committed() const noexcept { return committed_; }
+
+    template <class... Us>
+    DORI_inline auto emplace_back(Us &&...xs)
+    {
+        Commit(sz_ + 1);
+        return Base::emplace_back(static_cast<Us &&>(xs)...);
+    }
+
+    template <class... Us>
+    DORI_inline void push_back(Us &&...xs)
+    {
+        Commit(sz_ + 1);
+        Base::push_back(static_cast<Us &&>(xs)...);
+    }
+
+    template <class... Its>
+    void append(size_type n, Its... xs)
+    {
+        Commit(sz_ + n);
+        Base::append(n, xs...);
+    }
+
+    void resize(size_type sz)
+    {
+        Commit(sz);
+        Base::resize(sz);
+    }
+
+    // Returns the pages past the rows to the system; the storage stays put
+    void shrink_to_fit() noexcept
+    {
+        if (committed_ <= sz_)
+            return;
+        [&]<std::size_t... Is>(std::index_sequence<Is...>)
+        {
+            (..., Al::Decommit(Addr(this->template data<Is>() + sz_),
+                               Addr(this->template data<Is>() + committed_)));
+        }
+        (std::index_sequence_for<Ts...>{});
+        committed_ = sz_;
+    }
+
+  private:
+    size_type committed_ = 0;
+};
+
+namespace detail
+{
+template <class Vector>
+struct Deduce_vm_vec;
+template <class Al, class... Ts>
+struct Deduce_vm_vec<vector_al<Al, Ts...>> {
+    static_assert(std::is_same_v<Al, Default_allocator<mp_list<Ts...>>>,
+                  "vm_vector takes no allocator");
+    using type = basic_vm_vector<layout::default_policy, Ts...>;
+};
+template <class Layout, class Al, class... Ts>
+struct Deduce_vm_vec<basic_vector<Layout, Al, Ts...>> {
+    static_assert(std::is_same_v<Al, Default_allocator<mp_list<Ts...>>>,
+                  "vm_vector takes no allocator");
+    using type = basic_vm_vector<Layout, Ts...>;
+};
+} // namespace detail
+
+template <class Layout, class... Ts>
+DORI_inline bool operator==(const basic_vm_vector<Layout, Ts...> &lhs,
+                            const basic_vm_vector<Layout, Ts...> &rhs) noexcept
+{
+    if (lhs.size() != rhs.size())
+        return false;
+    if (lhs.empty())
+        return true;
+    return [&]<std::size_t... Is>(std::index_sequence<Is...>)
+    {
+        return (... && std::equal(lhs.template data<Is>(),
+                                  lhs.template data<Is>() + lhs.size(),
+                                  rhs.template data<Is>(),
+                                  rhs.template data<Is>() + rhs.size()));
+    }
+    (std::index_sequence_for<Ts...>{});
+}
+
+template <class Layout, class... Ts>
+DORI_inline bool operator!=(const basic_vm_vector<Layout, Ts...> &lhs,
+                            const basic_vm_vector<Layout, Ts...> &rhs) noexcept
+{
+    return !(lhs == rhs);
+}
+
+template <class Layout, class... Ts>
+DORI_inline void swap(basic_vm_vector<Layout, Ts...> &lhs,
+                      basic_vm_vector<Layout, Ts...> &rhs) noexcept
+{
+    lhs.swap(rhs);
+}
+
+//
+// vm_vector<Ts..., [Layout]> like vector
+//
+template <class... Ts>
+using vm_vector = typename detail::Deduce_vm_vec<
+    detail::Deduce_vec<boost::mp11::mp_list<Ts...>>>::type;
+
+} // namespace dori
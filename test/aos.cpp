@@ -0,0 +1,223 @@
+#include <dori/all.h>
+#include <span>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+using namespace std;
+
+struct P2 {
+    float x;
+    int32_t y;
+};
+struct P4 {
+    int32_t a;
+    float b;
+    uint32_t c;
+    float d;
+};
+struct P8 {
+    float a, b, c, d;
+    int32_t e, f, g, h;
+};
+struct P3 {
+    float x, y, z;
+};
+struct P5 {
+    int32_t a;
+    float b, c, d;
+    uint32_t e;
+};
+struct P6 {
+    float a, b, c, d, e, f;
+};
+struct P7 {
+    int32_t a, b, c, d, e, f, g;
+};
+struct Q2 {
+    double x;
+    int64_t y;
+};
+struct Q4 {
+    double a, b;
+    uint64_t c, d;
+};
+struct Q3 {
+    double a;
+    int64_t b;
+    double c;
+};
+struct Q5 {
+    int64_t a, b, c, d, e;
+};
+struct Odd {
+    int8_t a;
+    double b;
+    bool c;
+};
+struct Named {
+    string s;
+    int i;
+};
+
+template <class S>
+static vector<S> rows(size_t n, auto f)
+{
+    vector<S> res(n);
+    for (size_t i = 0; i < n; ++i)
+        res[i] = f(i);
+    return res;
+}
+
+// Appends rs twice through ms, checks the rows against rs by row, and exports
+// them back
+template <class V, class S, class... Ms>
+static void round_trip(const vector<S> &rs, Ms... ms)
+{
+    V v;
+    dori::append_from_aos(v, span{rs}, ms...);
+    dori::append_from_aos(v, span{rs}.subspan(1), ms...);
+    REQUIRE_EQ(v.size(), 2 * rs.size() - 1);
+    for (size_t i = 0; i < v.size(); ++i) {
+        const auto &r = rs[i < rs.size() ? i : i - rs.size() + 1];
+        REQUIRE((v[i] == typename V::value_type{r.*ms...}));
+    }
+
+    vector<S> out(v.size());
+    dori::export_to_aos(v, span{out}, ms...);
+    for (size_t i = 0; i < v.size(); ++i) {
+        const auto &r = rs[i < rs.size() ? i : i - rs.size() + 1];
+        REQUIRE((tuple{out[i].*ms...} == tuple{r.*ms...}));
+    }
+}
+
+TEST_SUITE("dori::aos")
+{
+    TEST_CASE("structs of 4-byte fields")
+    {
+        const auto p2 = rows<P2>(103, [](size_t i) {
+            return P2{i * 0.5f, static_cast<int32_t>(i)};
+        });
+        round_trip<dori::vector<float, int32_t>>(p2, &P2::x, &P2::y);
+        round_trip<dori::vector<int32_t, float>>(p2, &P2::y, &P2::x);
+
+        const auto p4 = rows<P4>(103, [](size_t i) {
+            return P4{static_cast<int32_t>(i), i * 0.5f,
+                      static_cast<uint32_t>(i * 7), -1.0f * i};
+        });
+        round_trip<dori::vector<int32_t, float, uint32_t, float>>(
+            p4, &P4::a, &P4::b, &P4::c, &P4::d);
+        // Members in another order, or missing, and columns of other types
+        round_trip<dori::vector<float, uint32_t, float, int32_t>>(
+            p4, &P4::d, &P4::c, &P4::b, &P4::a);
+        round_trip<dori::vector<float, int32_t>>(p4, &P4::d, &P4::a);
+        round_trip<dori::vector<int64_t, double, uint32_t, float>>(
+            p4, &P4::a, &P4::b, &P4::c, &P4::d);
+
+        const auto p8 = rows<P8>(37, [](size_t i) {
+            const auto f = i * 0.25f;
+            const auto n = static_cast<int32_t>(i * 4);
+            return P8{f, f + 1, f + 2, f + 3, n, n + 1, n + 2, n + 3};
+        });
+        round_trip<dori::vector<int32_t, float, float, float, float, int32_t,
+                                int32_t, int32_t>>(p8, &P8::h, &P8::a, &P8::b,
+                                                   &P8::c, &P8::d, &P8::e,
+                                                   &P8::f, &P8::g);
+    }
+
+    TEST_CASE("structs of 3, 5, 6 and 7 4-byte fields")
+    {
+        const auto p3 = rows<P3>(103, [](size_t i) {
+            return P3{i * 0.5f, i * 1.5f, -2.0f * i};
+        });
+        round_trip<dori::vector<float, float, float>>(p3, &P3::x, &P3::y,
+                                                      &P3::z);
+        round_trip<dori::vector<float, float, float>>(p3, &P3::z, &P3::x,
+                                                      &P3::y);
+
+        const auto p5 = rows<P5>(103, [](size_t i) {
+            return P5{static_cast<int32_t>(i), i * 0.5f, i * 1.5f, i * 2.5f,
+                      static_cast<uint32_t>(~i)};
+        });
+        round_trip<dori::vector<uint32_t, float, int32_t, float, float>>(
+            p5, &P5::e, &P5::c, &P5::a, &P5::b, &P5::d);
+
+        const auto p6 = rows<P6>(103, [](size_t i) {
+            const auto f = i * 0.125f;
+            return P6{f, f + 1, f + 2, f + 3, f + 4, f + 5};
+        });
+        round_trip<dori::vector<float, float, float, float, float, float>>(
+            p6, &P6::a, &P6::b, &P6::c, &P6::d, &P6::e, &P6::f);
+        round_trip<dori::vector<float, float, float, float, float, float>>(
+            p6, &P6::f, &P6::e, &P6::d, &P6::c, &P6::b, &P6::a);
+
+        const auto p7 = rows<P7>(103, [](size_t i) {
+            const auto n = static_cast<int32_t>(i * 7);
+            return P7{n, n + 1, n + 2, n + 3, n + 4, n + 5, n + 6};
+        });
+        round_trip<dori::vector<int32_t, int32_t, int32_t, int32_t, int32_t,
+                                int32_t, int32_t>>(p7, &P7::g, &P7::a, &P7::f,
+                                                   &P7::b, &P7::e, &P7::c,
+                                                   &P7::d);
+    }
+
+    TEST_CASE("structs of 8-byte fields")
+    {
+        const auto q2 = rows<Q2>(51, [](size_t i) {
+            return Q2{i * 0.5, -static_cast<int64_t>(i)};
+        });
+        round_trip<dori::vector<double, int64_t>>(q2, &Q2::x, &Q2::y);
+        round_trip<dori::vector<int64_t, double>>(q2, &Q2::y, &Q2::x);
+
+        const auto q4 = rows<Q4>(51, [](size_t i) {
+            return Q4{i * 0.5, i * 1.5, i, ~uint64_t{i}};
+        });
+        round_trip<dori::vector<uint64_t, double, double, uint64_t>>(
+            q4, &Q4::d, &Q4::a, &Q4::b, &Q4::c);
+
+        // Odd counts, the last field of each pair of rows on its own
+        const auto q3 = rows<Q3>(51, [](size_t i) {
+            return Q3{i * 0.5, static_cast<int64_t>(i) - 25, i * 1.5};
+        });
+        round_trip<dori::vector<double, int64_t, double>>(q3, &Q3::a, &Q3::b,
+                                                          &Q3::c);
+        round_trip<dori::vector<double, double, int64_t>>(q3, &Q3::c, &Q3::a,
+                                                          &Q3::b);
+
+        const auto q5 = rows<Q5>(51, [](size_t i) {
+            const auto n = static_cast<int64_t>(i * 5);
+            return Q5{n, n + 1, n + 2, n + 3, n + 4};
+        });
+        round_trip<dori::vector<int64_t, int64_t, int64_t, int64_t, int64_t>>(
+            q5, &Q5::e, &Q5::d, &Q5::a, &Q5::c, &Q5::b);
+    }
+
+    TEST_CASE("other structs")
+    {
+        const auto o = rows<Odd>(1000, [](size_t i) {
+            return Odd{static_cast<int8_t>(i), i * 0.5, i % 3 == 0};
+        });
+        round_trip<dori::vector<int8_t, double, dori::bit>>(o, &Odd::a,
+                                                             &Odd::b, &Odd::c);
+        round_trip<dori::vector<dori::bit, int16_t>>(o, &Odd::c, &Odd::a);
+
+        const auto n = rows<Named>(300, [](size_t i) {
+            return Named{to_string(i), static_cast<int>(i)};
+        });
+        round_trip<dori::vector<string, int>>(n, &Named::s, &Named::i);
+
+        // Into a view
+        vector<double> b(o.size());
+        vector<int8_t> a(o.size());
+        dori::vector_view<double, int8_t> w{o.size(), b.data(), a.data()};
+        for (size_t i = 0; i < w.size(); ++i)
+            w[i] = tuple{o[i].b, o[i].a};
+        vector<Odd> out(o.size());
+        dori::export_to_aos(w, span{out}, &Odd::b, &Odd::a);
+        REQUIRE_EQ(out[999].b, 499.5);
+        REQUIRE_EQ(out[999].a, o[999].a);
+    }
+}
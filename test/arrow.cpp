@@ -0,0 +1,108 @@
+#include <dori/all.h>
+#include <stdint.h>
+#include <stdexcept>
+#include <string_view>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+using namespace std;
+
+using V = dori::vector<int64_t, dori::bit, float, uint8_t>;
+
+static V make(int n)
+{
+    V v;
+    v.reserve(n);
+    for (int i = 0; i < n; ++i)
+        v.push_back(i * 3, i % 3 == 0, i * 0.5f, static_cast<uint8_t>(i));
+    return v;
+}
+
+TEST_SUITE("dori::arrow")
+{
+    TEST_CASE("export points the children at the columns")
+    {
+        auto v          = make(1000);
+        const auto p    = v.data<0>();
+        const auto flag = v.data<1>().words();
+        ArrowArray a;
+        ArrowSchema s;
+        dori::export_arrow(std::move(v), &a, &s, {"id", "flag"});
+
+        REQUIRE_EQ(string_view{s.format}, "+s");
+        REQUIRE_EQ(s.n_children, 4);
+        REQUIRE_EQ(string_view{s.children[0]->name}, "id");
+        REQUIRE_EQ(string_view{s.children[1]->format}, "b");
+        REQUIRE_EQ(string_view{s.children[2]->name}, "2");
+        REQUIRE_EQ(string_view{s.children[3]->format}, "C");
+        REQUIRE_EQ(a.length, 1000);
+        REQUIRE_EQ(a.n_children, 4);
+        REQUIRE_EQ(a.children[0]->buffers[1], p);
+        REQUIRE_EQ(a.children[1]->buffers[1], flag);
+        REQUIRE_EQ(a.children[1]->buffers[0], nullptr);
+
+        // Arrow's boolean bitmap is LSB first in bytes
+        const auto bytes = reinterpret_cast<const uint8_t *>(flag);
+        for (int i = 0; i < 1000; ++i)
+            REQUIRE_EQ((bytes[i / 8] >> (i % 8) & 1) != 0, i % 3 == 0);
+
+        // A child moved out outlives its parent
+        ArrowArray c = *a.children[2];
+        a.children[2]->release = nullptr;
+        a.release(&a);
+        REQUIRE(!a.release);
+        REQUIRE_EQ(static_cast<const float *>(c.buffers[1])[999], 499.5f);
+        c.release(&c);
+        s.release(&s);
+        REQUIRE(!s.release);
+    }
+
+    TEST_CASE("round trip through a view")
+    {
+        ArrowArray a;
+        ArrowSchema s;
+        dori::export_arrow(make(300), &a, &s);
+        const auto w = dori::import_arrow<int64_t, dori::bit, float, uint8_t>(
+            a, s);
+        REQUIRE_EQ(w.size(), 300);
+        const auto v = make(300);
+        for (size_t i = 0; i < v.size(); ++i)
+            REQUIRE((w[i] == v[i]));
+
+        // A slice starting mid-byte
+        a.offset = 13;
+        a.length = 200;
+        const auto x = dori::import_arrow<int64_t, dori::bit, float, uint8_t>(
+            a, s);
+        for (size_t i = 0; i < x.size(); ++i)
+            REQUIRE((x[i] == v[i + 13]));
+
+        REQUIRE_THROWS_AS(
+            (dori::import_arrow<int64_t, dori::bit, double, uint8_t>(a, s)),
+            invalid_argument);
+        REQUIRE_THROWS_AS((dori::import_arrow<int64_t, dori::bit>(a, s)),
+                          invalid_argument);
+        a.children[3]->null_count = 1;
+        a.children[3]->buffers[0] = a.children[3]->buffers[1];
+        REQUIRE_THROWS_AS(
+            (dori::import_arrow<int64_t, dori::bit, float, uint8_t>(a, s)),
+            invalid_argument);
+        a.children[3]->buffers[0] = nullptr;
+        a.release(&a);
+        s.release(&s);
+    }
+
+    TEST_CASE("empty vectors")
+    {
+        ArrowArray a;
+        ArrowSchema s;
+        dori::export_arrow(V{}, &a, &s);
+        REQUIRE_EQ(a.length, 0);
+        const auto w = dori::import_arrow<int64_t, dori::bit, float, uint8_t>(
+            a, s);
+        REQUIRE(w.empty());
+        a.release(&a);
+        s.release(&s);
+    }
+}
@@ -0,0 +1,145 @@
+#include <dori/all.h>
+#include <chrono>
+#include <set>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+using namespace std;
+
+using V = dori::vector<int, string>;
+
+// Batch i of producer p, of i % 7 rows
+static void fill(V &b, int p, int i)
+{
+    REQUIRE(b.empty());
+    const auto n = i % 7;
+    if (static_cast<int>(b.capacity()) < n)
+        b.reserve(n);
+    for (int j = 0; j < n; ++j)
+        b.push_back(p, to_string(i));
+}
+
+TEST_SUITE("dori::channel")
+{
+    TEST_CASE("batches are received in order and their buffers recycled")
+    {
+        dori::channel<V> ch{3};
+        REQUIRE_EQ(ch.capacity(), 4);
+        set<const int *> received;
+        vector<const int *> recycled;
+        thread t{[&] {
+            V b;
+            for (int i = 0; i < 2000; ++i) {
+                fill(b, 0, i);
+                ch.send(b);
+                if (b.capacity())
+                    recycled.push_back(b.data<0>());
+            }
+            ch.close();
+        }};
+        V b;
+        int i = 0;
+        for (; ch.receive(b); ++i) {
+            REQUIRE_EQ(b.size(), i % 7);
+            for (size_t j = 0; j < b.size(); ++j)
+                REQUIRE_EQ(get<1>(b[j]), to_string(i));
+            if (b.capacity())
+                received.insert(b.data<0>());
+        }
+        t.join();
+        REQUIRE_EQ(i, 2000);
+        REQUIRE(!ch.receive(b));
+        REQUIRE(!recycled.empty());
+        for (const auto p : recycled)
+            REQUIRE(received.count(p));
+    }
+
+    TEST_CASE("many producers")
+    {
+        dori::channel<V, dori::producers::many> ch{8};
+        vector<thread> ts;
+        for (int p = 0; p < 4; ++p)
+            ts.emplace_back([&, p] {
+                V b;
+                for (int i = 0; i < 1000; ++i) {
+                    fill(b, p, i);
+                    ch.send(b);
+                }
+            });
+        thread closer{[&] {
+            for (auto &t : ts)
+                t.join();
+            ch.close();
+        }};
+        V b;
+        int next[4]{};
+        int n = 0;
+        while (ch.receive(b)) {
+            ++n;
+            if (b.empty())
+                continue;
+            const auto p = get<0>(b[0]);
+            const auto i = stoi(get<1>(b[0]));
+            REQUIRE(i >= next[p]);
+            next[p] = i + 1;
+        }
+        closer.join();
+        REQUIRE_EQ(n, 4000);
+    }
+
+    TEST_CASE("many producers laps ahead of a slow consumer")
+    {
+        // Producers wait on the slots the consumer waits on
+        dori::channel<V, dori::producers::many> ch{2};
+        vector<thread> ts;
+        for (int p = 0; p < 8; ++p)
+            ts.emplace_back([&, p] {
+                V b;
+                for (int i = 0; i < 300; ++i) {
+                    fill(b, p, i);
+                    ch.send(b);
+                }
+            });
+        thread closer{[&] {
+            for (auto &t : ts)
+                t.join();
+            ch.close();
+        }};
+        V b;
+        int n = 0;
+        while (ch.receive(b))
+            if (++n % 64 == 0)
+                this_thread::sleep_for(chrono::microseconds{200});
+        closer.join();
+        REQUIRE_EQ(n, 2400);
+    }
+
+    TEST_CASE("try_send and try_receive don't wait")
+    {
+        dori::channel<V> ch{2};
+        V b;
+        REQUIRE(!ch.try_receive(b));
+        for (int i = 1; i <= 2; ++i) {
+            fill(b, 0, i);
+            REQUIRE(ch.try_send(b));
+        }
+        fill(b, 0, 3);
+        REQUIRE(!ch.try_send(b));
+        REQUIRE_EQ(b.size(), 3);
+        V c;
+        REQUIRE(ch.try_receive(c));
+        REQUIRE_EQ(c.size(), 1);
+        REQUIRE(ch.try_send(b));
+        REQUIRE(b.empty());
+        REQUIRE(ch.try_receive(c));
+        REQUIRE_EQ(c.size(), 2);
+        REQUIRE(ch.try_receive(c));
+        REQUIRE_EQ(c.size(), 3);
+        REQUIRE(!ch.try_receive(c));
+    }
+}
@@ -0,0 +1,79 @@
+#include <dori/all.h>
+#include <dori/columns.h>
+#include <memory>
+#include <stdint.h>
+#include <string>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+using namespace std;
+
+enum class color : uint8_t { red, green, blue };
+
+TEST_SUITE("dori::with_column / dori::without_column")
+{
+    TEST_CASE("columns are added and dropped with the rows kept")
+    {
+        dori::vector<int, string, double> v;
+        v.reserve(100);
+        for (int i = 0; i < 100; ++i)
+            v.push_back(i, to_string(i), i / 4.0);
+
+        auto w = dori::with_column<int64_t>(std::move(v), int64_t{-1});
+        static_assert(
+            is_same_v<decltype(w), dori::vector<int, string, double, int64_t>>);
+        REQUIRE(v.empty());
+        REQUIRE_EQ(w.size(), 100);
+        REQUIRE_EQ(w.capacity(), 100);
+        for (int i = 0; i < 100; ++i)
+            REQUIRE((w[i] == tuple{i, to_string(i), i / 4.0, int64_t{-1}}));
+
+        auto u = dori::without_column<1>(std::move(w));
+        static_assert(
+            is_same_v<decltype(u), dori::vector<int, double, int64_t>>);
+        REQUIRE_EQ(u.size(), 100);
+        for (int i = 0; i < 100; ++i)
+            REQUIRE((u[i] == tuple{i, i / 4.0, int64_t{-1}}));
+
+        // Empty vectors convert to empty vectors
+        auto e = dori::without_column<0>(dori::vector<int, float>{});
+        REQUIRE(e.empty());
+        REQUIRE_EQ(e.capacity(), 0);
+    }
+
+    TEST_CASE("move-only, packed, and grouped columns")
+    {
+        using V = dori::vector<unique_ptr<int>, dori::bit, uint16_t,
+                               dori::layout::grouped<1, 0, 0>>;
+        V v;
+        v.reserve(70);
+        for (int i = 0; i < 70; ++i)
+            v.push_back(make_unique<int>(i), i % 3 == 0,
+                        static_cast<uint16_t>(i));
+
+        auto w = dori::with_column<dori::packed<color, 2>>(std::move(v),
+                                                           color::blue);
+        static_assert(
+            is_same_v<decltype(w),
+                      dori::basic_vector<dori::layout::grouped<1, 0, 0, 2>,
+                                         V::allocator_type, unique_ptr<int>,
+                                         dori::bit, uint16_t,
+                                         dori::packed<color, 2>>>);
+        for (int i = 0; i < 70; ++i) {
+            REQUIRE_EQ(*get<0>(w[i]), i);
+            REQUIRE_EQ(static_cast<bool>(get<1>(w[i])), i % 3 == 0);
+            REQUIRE(get<3>(w[i]) == color::blue);
+        }
+
+        auto u = dori::without_column<0>(std::move(w));
+        static_assert(
+            is_same_v<decltype(u),
+                      dori::basic_vector<dori::layout::grouped<0, 0, 2>,
+                                         V::allocator_type, dori::bit,
+                                         uint16_t, dori::packed<color, 2>>>);
+        REQUIRE_EQ(u.size(), 70);
+        REQUIRE_EQ(dori::mask::count(u.data<0>(), u.size()), 24);
+        REQUIRE_EQ(u.data<1>()[69], 69);
+    }
+}
@@ -0,0 +1,171 @@
+#include <dori/all.h>
+#include <atomic>
+#include <functional>
+#include <stdexcept>
+#include <stdint.h>
+#include <string>
+#include <thread>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+using namespace std;
+
+using V = dori::cow_vector<int, string, double>;
+
+static V make(int n, int cap)
+{
+    V v;
+    v.reserve(cap);
+    for (int i = 0; i < n; ++i)
+        v.push_back(i, to_string(i), i / 2.0);
+    return v;
+}
+
+struct throws_at {
+    static inline int countdown = -1;
+    int x;
+    throws_at(int x) : x{x}
+    {
+        if (!countdown--)
+            throw runtime_error{"throws_at"};
+    }
+    throws_at(const throws_at &o) : throws_at{o.x} {}
+};
+
+TEST_SUITE("dori::cow_vector")
+{
+    TEST_CASE("writes copy only the columns written to")
+    {
+        auto v          = make(100, 128);
+        const auto snap = v.snapshot();
+        REQUIRE((v.shares<0>(snap) && v.shares<1>(snap) && v.shares<2>(snap)));
+        REQUIRE(v.shared<1>());
+
+        v.mutable_data<1>()[7] = "seven";
+        REQUIRE((v.shares<0>(snap) && !v.shares<1>(snap) &&
+                 v.shares<2>(snap)));
+        REQUIRE(!v.shared<1>());
+        REQUIRE_EQ(get<1>(snap[7]), "7");
+        REQUIRE_EQ(get<1>(v[7]), "seven");
+
+        // Once the column is the writer's own, writing to it copies nothing
+        const auto p           = v.data<1>();
+        v.mutable_data<1>()[8] = "eight";
+        REQUIRE_EQ(v.data<1>(), p);
+        REQUIRE(v != snap);
+        v.mutable_data<1>()[7] = "7";
+        v.mutable_data<1>()[8] = "8";
+        REQUIRE(v == snap);
+    }
+
+    TEST_CASE("the writer appends to shared columns in place")
+    {
+        auto v    = make(10, 64);
+        auto snap = v.snapshot();
+        v.push_back(10, "10", 5.0);
+        v.resize(15);
+        REQUIRE((v.shares<0>(snap) && v.shares<1>(snap) && v.shares<2>(snap)));
+        REQUIRE_EQ(snap.size(), 10);
+        REQUIRE_EQ(v.size(), 15);
+        REQUIRE_EQ(get<1>(v[10]), "10");
+
+        // The snapshot doesn't own the rows past its own, so it copies
+        snap.push_back(-1, "-1", 0.0);
+        REQUIRE(!v.shares<0>(snap));
+        REQUIRE_EQ(get<0>(snap.back()), -1);
+        REQUIRE_EQ(get<0>(v[10]), 10);
+
+        // Neither does the writer once it has shrunk under a snapshot
+        const auto snap2 = v.snapshot();
+        v.resize(5);
+        REQUIRE_EQ(get<1>(snap2[12]), "");
+        v.push_back(5, "5", 2.5);
+        REQUIRE(!v.shares<1>(snap2));
+        REQUIRE_EQ(get<1>(snap2[5]), "5");
+        REQUIRE_EQ(v.size(), 6);
+    }
+
+    TEST_CASE("reserve, clear, query, and failed appends")
+    {
+        auto v    = make(50, 50);
+        auto snap = v.snapshot();
+        v.reserve(200);
+        REQUIRE_EQ(v.capacity(), 200);
+        REQUIRE(!v.shares<0>(snap));
+        REQUIRE(v == snap);
+        REQUIRE_EQ(v.query()
+                       .where<0>([](int x) { return x % 10 == 0; })
+                       .select<2>([](double d) { return d; })
+                       .reduce(plus<>{}),
+                   (0 + 10 + 20 + 30 + 40) / 2.0);
+        v.clear();
+        REQUIRE(v.empty());
+        REQUIRE_EQ(snap.size(), 50);
+        REQUIRE_EQ(V{}.query().count(), 0);
+
+        dori::cow_vector<string, throws_at> w;
+        w.reserve(4);
+        w.push_back("a", 1);
+        const auto w_snap   = w.snapshot();
+        throws_at::countdown = 0;
+        REQUIRE_THROWS_AS(w.push_back("b", 2), runtime_error);
+        throws_at::countdown = -1;
+        REQUIRE_EQ(w.size(), 1);
+        w.push_back("c", 3);
+        REQUIRE_EQ(get<0>(w.back()), "c");
+        REQUIRE_EQ(get<0>(w_snap.back()), "a");
+    }
+
+    TEST_CASE("snapshots are read on other threads as the writer goes on")
+    {
+        dori::cow_vector<int, int> v;
+        v.reserve(10'000);
+        for (int i = 0; i < 1000; ++i)
+            v.push_back(i, -i);
+        atomic<bool> ok = true;
+        for (int tick = 0; tick < 20; ++tick) {
+            thread reader{[snap = v.snapshot(), &ok] {
+                for (size_t i = 0; i < snap.size(); ++i)
+                    if (get<0>(snap[i]) + get<1>(snap[i]) != 0)
+                        ok = false;
+            }};
+            for (int i = 0; i < 100; ++i) {
+                const auto n = static_cast<int>(v.size());
+                v.push_back(n, -n);
+            }
+            auto a = v.mutable_data<0>();
+            auto b = v.mutable_data<1>();
+            for (size_t i = 0; i < v.size(); ++i)
+                ++a[i], --b[i];
+            reader.join();
+        }
+        REQUIRE(ok);
+        REQUIRE_EQ(v.size(), 3000);
+    }
+
+    TEST_CASE("snapshots append on other threads as the writer does")
+    {
+        dori::cow_vector<int> v;
+        v.reserve(10'000);
+        for (int i = 0; i < 1000; ++i)
+            v.push_back(i);
+        for (int tick = 0; tick < 20; ++tick) {
+            auto snap = v.snapshot();
+            thread other{[&snap] {
+                // Copies the buffer the writer appends to meanwhile
+                for (int i = 0; i < 50; ++i)
+                    snap.push_back(-i);
+            }};
+            for (int i = 0; i < 100; ++i)
+                v.push_back(static_cast<int>(v.size()));
+            other.join();
+            REQUIRE_EQ(get<0>(snap.back()), -49);
+            REQUIRE_EQ(get<0>(snap[snap.size() - 51]),
+                       static_cast<int>(snap.size()) - 51);
+        }
+        REQUIRE_EQ(v.size(), 3000);
+        for (size_t i = 0; i < v.size(); ++i)
+            REQUIRE_EQ(get<0>(v[i]), static_cast<int>(i));
+    }
+}
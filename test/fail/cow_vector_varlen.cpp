@@ -0,0 +1,8 @@
+// Must not compile: cow_vector doesn't store varlen columns
+#include <dori/cow_vector.h>
+
+int main()
+{
+    dori::cow_vector<int, dori::varlen<char>> v;
+    return static_cast<int>(v.size());
+}
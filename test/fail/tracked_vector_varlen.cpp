@@ -0,0 +1,8 @@
+// Must not compile: tracked_vector doesn't track varlen columns
+#include <dori/tracked_vector.h>
+
+int main()
+{
+    dori::tracked_vector<int, dori::varlen<char>> v;
+    return static_cast<int>(v.size());
+}
@@ -0,0 +1,101 @@
+#include <dori/all.h>
+#include <random>
+#include <stdint.h>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+using namespace std;
+
+// Keys and values of m against those of u
+template <class M, class U>
+static void check(const M &m, const U &u)
+{
+    REQUIRE_EQ(m.size(), u.size());
+    size_t n = 0;
+    for (const auto &[k, s, b] : m) {
+        const auto it = u.find(k);
+        REQUIRE(it != u.end());
+        REQUIRE((it->second == pair{s, b}));
+        ++n;
+    }
+    REQUIRE_EQ(n, u.size());
+    for (const auto &[k, x] : u) {
+        const auto it = m.find(k);
+        REQUIRE(it != m.end());
+        REQUIRE_EQ(get<1>(*it), x.first);
+    }
+}
+
+TEST_SUITE("dori::flat_hash_map")
+{
+    TEST_CASE("inserts, lookups, and erasures against std::unordered_map")
+    {
+        dori::flat_hash_map<uint64_t, string, dori::bit> m;
+        unordered_map<uint64_t, pair<string, bool>> u;
+        mt19937_64 rng{42};
+        for (int i = 0; i < 50'000; ++i) {
+            // Keys spaced by 2^20 share their low bits
+            const auto k = (rng() % 5000) << 20;
+            switch (rng() % 4) {
+            case 0: {
+                const auto n = m.erase(k), un = u.erase(k);
+                REQUIRE_EQ(n, un);
+                break;
+            }
+            case 1: {
+                const auto [it, ins] = m.insert_or_assign(k, to_string(i),
+                                                          i % 2 == 0);
+                REQUIRE_EQ(ins, !u.count(k));
+                u.insert_or_assign(k, pair{to_string(i), i % 2 == 0});
+                REQUIRE_EQ(get<0>(*it), k);
+                break;
+            }
+            default: {
+                const auto [it, ins] = m.try_emplace(k, to_string(i), false);
+                const auto uins = u.try_emplace(k, to_string(i), false).second;
+                REQUIRE_EQ(ins, uins);
+                REQUIRE_EQ(get<1>(*it), u[k].first);
+            }
+            }
+            REQUIRE_EQ(m.contains(k), u.count(k) == 1);
+        }
+        check(m, u);
+        REQUIRE(m.bucket_count() * 7 / 8 >= m.size());
+
+        auto c = m;
+        check(c, u);
+        for (auto it = c.begin(); it != c.end();)
+            it = get<2>(*it) ? c.erase(it) : std::next(it);
+        erase_if(u, [](const auto &x) { return x.second.second; });
+        check(c, u);
+
+        auto d = std::move(c);
+        REQUIRE(c.empty());
+        check(d, u);
+        d.clear();
+        REQUIRE((d.empty() && d.begin() == d.end()));
+        REQUIRE(!d.contains(0));
+    }
+
+    TEST_CASE("tombstones are reclaimed without growing")
+    {
+        dori::flat_hash_map<int, int> m{100};
+        const auto n = m.bucket_count();
+        for (int i = 0; i < 100'000; ++i) {
+            m.try_emplace(i, i);
+            if (i >= 50) {
+                const auto e = m.erase(i - 50);
+                REQUIRE_EQ(e, 1);
+            }
+        }
+        REQUIRE_EQ(m.size(), 50);
+        REQUIRE_EQ(m.bucket_count(), n);
+        for (int i = 99'950; i < 100'000; ++i)
+            REQUIRE_EQ(get<1>(*m.find(i)), i);
+        REQUIRE(m.find(0) == m.end());
+    }
+}
@@ -0,0 +1,138 @@
+#include <dori/all.h>
+#include <map>
+#include <set>
+#include <stdint.h>
+#include <string>
+#include <tuple>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+using namespace std;
+
+using V = dori::vector<int, string, int32_t, double>;
+
+static V make(int rows, int keys)
+{
+    V v;
+    v.reserve(rows);
+    for (int i = 0; i < rows; ++i)
+        v.push_back(static_cast<int>(int64_t{i} * 7919 % keys), to_string(i),
+                    i % 100, i / 8.0);
+    return v;
+}
+
+// Key, sum, count, and max by std::map
+template <class R>
+static void check(const V &v, const R &r)
+{
+    map<int, tuple<int64_t, size_t, double>> m;
+    for (size_t i = 0; i < v.size(); ++i) {
+        auto &[s, c, x] =
+            m.try_emplace(get<0>(v[i]), 0, 0, get<3>(v[i])).first->second;
+        s += get<2>(v[i]);
+        ++c;
+        x = std::max(x, get<3>(v[i]));
+    }
+    REQUIRE_EQ(r.size(), m.size());
+    for (size_t g = 0; g < r.size(); ++g) {
+        const auto &[k, s, c, x] = r[g];
+        const auto it            = m.find(k);
+        REQUIRE(it != m.end());
+        REQUIRE((it->second == tuple{s, c, x}));
+    }
+}
+
+TEST_SUITE("dori::group_by")
+{
+    TEST_CASE("groups by hashing in the order keys first appear")
+    {
+        const auto v = make(10'000, 37);
+        const auto r = dori::group_by<0>(v)
+                           .aggregate<dori::sum<2>, dori::count,
+                                      dori::max<3>>();
+        static_assert(
+            is_same_v<decltype(r),
+                      const dori::vector<int, int64_t, size_t, double>>);
+        check(v, r);
+        for (int g = 0; g < 37; ++g)
+            REQUIRE_EQ(get<0>(r[g]), get<0>(v[g]));
+
+        const auto mn = dori::group_by<0>(v).aggregate<dori::min<1>>();
+        REQUIRE_EQ(get<1>(mn[0]), "0");
+    }
+
+    TEST_CASE("high-cardinality keys are partitioned")
+    {
+        const auto v = make(600'000, 500'009);
+        const auto r = dori::group_by<0>(v)
+                           .aggregate<dori::sum<2>, dori::count,
+                                      dori::max<3>>();
+        check(v, r);
+
+        // Keys differing only in high bits spread over the partitions too
+        set<uint64_t> parts;
+        for (int64_t k = 0; k < 1024; ++k)
+            parts.insert(dori::detail::Hash_key(k << 26) >> 16 & 1023);
+        REQUIRE_GT(parts.size(), 512u);
+        // More keys than Hash_groups_max, each starting a group, so that the
+        // rows are partitioned by those hashes
+        static_assert(300'000 > dori::detail::Hash_groups_max);
+        dori::vector<int64_t, int32_t> w;
+        w.reserve(600'000);
+        for (int32_t i = 0; i < 600'000; ++i)
+            w.push_back(int64_t{i % 300'000} << 26, i);
+        const auto c = dori::group_by<0>(w).aggregate<dori::count>();
+        REQUIRE_EQ(c.size(), 300'000u);
+        vector<bool> seen(300'000);
+        bool by_appearance = true;
+        for (size_t g = 0; g < c.size(); ++g) {
+            const auto k = get<0>(c[g]);
+            REQUIRE_EQ(k % (int64_t{1} << 26), 0);
+            REQUIRE_FALSE(seen[static_cast<size_t>(k >> 26)]);
+            seen[static_cast<size_t>(k >> 26)] = true;
+            REQUIRE_EQ(get<1>(c[g]), 2u);
+            by_appearance &= k == static_cast<int64_t>(g) << 26;
+        }
+        // Groups come by partition rather than in the order keys appear
+        REQUIRE_FALSE(by_appearance);
+    }
+
+    TEST_CASE("parallel partial aggregation")
+    {
+        dori::thread_pool pool{4};
+        for (const int keys : {5, 1000, 50'000}) {
+            const auto v = make(200'000, keys);
+            const auto r = dori::group_by<0>(v)
+                               .parallel_aggregate<dori::sum<2>, dori::count,
+                                                   dori::max<3>>(pool, 4096);
+            check(v, r);
+        }
+        const V e;
+        REQUIRE(dori::group_by<0>(e)
+                    .parallel_aggregate<dori::count>(pool, 64)
+                    .empty());
+        REQUIRE(dori::group_by<0>(e).aggregate<dori::count>().empty());
+        REQUIRE(dori::unique_by<0>(e).empty());
+    }
+
+    TEST_CASE("unique_by keeps the first row of each key")
+    {
+        dori::vector<string, dori::bit, int> v;
+        v.reserve(100);
+        for (int i = 0; i < 100; ++i)
+            v.push_back(to_string(i % 10), i % 3 == 0, i);
+        const auto u = dori::unique_by<0>(v);
+        REQUIRE_EQ(u.size(), 10);
+        for (int i = 0; i < 10; ++i)
+            REQUIRE((u[i] == tuple{to_string(i), i % 3 == 0, i}));
+
+        const auto b = dori::unique_by<1>(v);
+        REQUIRE_EQ(b.size(), 2);
+        REQUIRE_EQ(get<2>(b[0]), 0);
+        REQUIRE_EQ(get<2>(b[1]), 1);
+        const auto c = dori::group_by<1>(v).aggregate<dori::count>();
+        REQUIRE_EQ(get<1>(c[0]), 34);
+        REQUIRE_EQ(get<1>(c[1]), 66);
+    }
+}
@@ -0,0 +1,129 @@
+#include <dori/all.h>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+using namespace std;
+
+static string lines(int n, int from = 0)
+{
+    string res;
+    for (int i = from; i < from + n; ++i)
+        res += to_string(i) + ',' + to_string(i * 0.25) + ',' +
+               (i % 3 ? "0" : "true") + ',' + to_string(-i) + '\n';
+    return res;
+}
+
+TEST_SUITE("dori::ingest")
+{
+    TEST_CASE("csv across chunks")
+    {
+        dori::thread_pool pool{4};
+        const auto text = "id,px,flag,n\r\n" + lines(5000);
+        dori::vector<int64_t, double, dori::bit, int16_t> v;
+        dori::ingest::csv(pool, v, text, {.header = true, .chunk_bytes = 999});
+        REQUIRE_EQ(v.size(), 5000);
+        for (int i = 0; i < 5000; ++i)
+            REQUIRE((v[i] == tuple{i, i * 0.25, i % 3 == 0, -i}));
+
+        // Appends, without a trailing line break, and with blank lines
+        auto more = lines(10, 5000) + "\n\r\n" + lines(1, 5010);
+        more.pop_back();
+        dori::ingest::csv(pool, v, more, {.chunk_bytes = 16});
+        REQUIRE_EQ(v.size(), 5011);
+        REQUIRE((v[5010] == tuple{5010, 5010 * 0.25, true, -5010}));
+    }
+
+    TEST_CASE("csv of strings and other delimiters")
+    {
+        dori::vector<string, float, bool> v;
+        dori::ingest::csv(v, "a b;1.5;false\r\n;-2;1\nc;3e2;0\r\n",
+                          {.delimiter = ';'});
+        REQUIRE_EQ(v.size(), 3);
+        REQUIRE((v[0] == tuple{"a b", 1.5f, false}));
+        REQUIRE((v[1] == tuple{"", -2.0f, true}));
+        REQUIRE((v[2] == tuple{"c", 300.0f, false}));
+
+        dori::vector<int, int> w;
+        dori::ingest::csv(w, "");
+        dori::ingest::csv(w, "x,y\n", {.header = true});
+        REQUIRE(w.empty());
+    }
+
+    TEST_CASE("csv errors leave the vector")
+    {
+        dori::thread_pool pool{3};
+        dori::vector<int, double> v;
+        dori::ingest::csv(pool, v, "1,2\n");
+        REQUIRE_THROWS_AS(
+            dori::ingest::csv(pool, v, "1,2\n3\n4,5\n", {.chunk_bytes = 1}),
+            invalid_argument);
+        REQUIRE_THROWS_AS(dori::ingest::csv(pool, v, "1,2,3\n"),
+                          invalid_argument);
+        REQUIRE_THROWS_AS(dori::ingest::csv(pool, v, "1,x\n"),
+                          invalid_argument);
+        REQUIRE_THROWS_AS(dori::ingest::csv(pool, v, "1.5,2\n"),
+                          invalid_argument);
+        REQUIRE_EQ(v.size(), 1);
+        try {
+            dori::ingest::csv(pool, v, "1,2\n3,4\n5,z\n");
+        } catch (const invalid_argument &e) {
+            REQUIRE_EQ(string{e.what()}, "dori::ingest::csv: bad number at "
+                                         "byte 10");
+        }
+    }
+
+    TEST_CASE("binary records")
+    {
+        struct rec {
+            int32_t id;
+            char pad[3];
+            double px;
+            uint16_t n;
+        };
+        vector<rec> rs(100000);
+        for (size_t i = 0; i < rs.size(); ++i)
+            rs[i] = {static_cast<int32_t>(i), {}, i * 0.5,
+                     static_cast<uint16_t>(i * 3)};
+        const auto bytes = as_bytes(span{rs});
+
+        dori::thread_pool pool{4};
+        dori::vector<double, int32_t, uint16_t> v;
+        dori::ingest::records(pool, v, bytes, sizeof(rec),
+                              array{offsetof(rec, px), offsetof(rec, id),
+                                    offsetof(rec, n)});
+        REQUIRE_EQ(v.size(), rs.size());
+        for (size_t i = 0; i < rs.size(); ++i)
+            REQUIRE((v[i] == tuple{rs[i].px, rs[i].id, rs[i].n}));
+
+        REQUIRE_THROWS_AS(dori::ingest::records(v, bytes.first(7), sizeof(rec),
+                                                array<size_t, 3>{}),
+                          invalid_argument);
+        REQUIRE_THROWS_AS(
+            dori::ingest::records(v, bytes, sizeof(rec),
+                                  array<size_t, 3>{0, sizeof(rec) - 1, 0}),
+            invalid_argument);
+        REQUIRE_EQ(v.size(), rs.size());
+
+        // Appending to rows already there, chunks split at rows of v
+        dori::vector<double, int32_t, uint16_t> w;
+        const array offs{offsetof(rec, px), offsetof(rec, id),
+                         offsetof(rec, n)};
+        dori::ingest::records(pool, w, bytes.first(77 * sizeof(rec)),
+                              sizeof(rec), offs);
+        dori::ingest::records(pool, w, bytes.subspan(77 * sizeof(rec)),
+                              sizeof(rec), offs);
+        REQUIRE((w == v));
+        // The columns of w start on cache lines, and so do the chunks, being
+        // split at multiples of a line's worth of rows in every column
+        w.for_each([](auto f, auto) {
+            REQUIRE_EQ(reinterpret_cast<uintptr_t>(f) % dori::cache_line, 0);
+        });
+    }
+}
@@ -0,0 +1,92 @@
+#include <dori/all.h>
+#include <stdint.h>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+using namespace std;
+namespace layout = dori::layout;
+
+template <class V>
+using Info = layout::info<V>;
+
+//
+// The policy is an optional trailing argument (after the allocator, if any)
+//
+
+static_assert(is_same_v<dori::vector<int, layout::by_size>, dori::vector<int>>);
+static_assert(
+    is_base_of_v<dori::basic_vector<layout::declared,
+                                    dori::detail::Default_allocator<
+                                        boost::mp11::mp_list<int, char>>,
+                                    int, char>,
+                 dori::vector<int, char, layout::declared>>);
+
+//
+// Orders
+//
+
+using Mixed = dori::vector<int8_t, int64_t, int16_t, int32_t>;
+static_assert(Info<Mixed>::order == array<size_t, 4>{1, 3, 2, 0});
+static_assert(Info<Mixed>::granularity == 1);
+
+using Declared = dori::vector<int8_t, int64_t, int16_t, layout::declared>;
+static_assert(Info<Declared>::order == array<size_t, 3>{0, 1, 2});
+static_assert(Info<Declared>::offsets == array<size_t, 3>{0, 1, 9});
+static_assert(Info<Declared>::granularity == 8);
+static_assert(Info<Declared>::max_padding_bytes == 7 * (1 + 8 + 2));
+
+struct Vec3 {
+    float x, y, z;
+};
+// by_size puts the 12-byte Vec3 before the double and needs padding...
+using BySize = dori::vector<double, Vec3>;
+static_assert(Info<BySize>::order == array<size_t, 2>{1, 0});
+static_assert(Info<BySize>::granularity == 2);
+// ...whereas by_alignment never does
+using ByAlign = dori::vector<double, Vec3, layout::by_alignment>;
+static_assert(Info<ByAlign>::order == array<size_t, 2>{0, 1});
+static_assert(Info<ByAlign>::max_padding_bytes == 0);
+
+using Grouped = dori::vector<int8_t, int64_t, int16_t, int32_t,
+                             layout::grouped<0, 1, 0, 1>>;
+static_assert(Info<Grouped>::order == array<size_t, 4>{2, 0, 1, 3});
+static_assert(Info<Grouped>::granularity == 8);
+
+TEST_SUITE("dori::layout")
+{
+    TEST_CASE("sequences are stored in the order of the policy")
+    {
+        Grouped v;
+        v.reserve(1);
+        v.resize(1);
+        auto [i8, i64, i16, i32] = v[0];
+        REQUIRE_LT((uintptr_t)&i16, (uintptr_t)&i8);
+        REQUIRE_LT((uintptr_t)&i8, (uintptr_t)&i64);
+        REQUIRE_LT((uintptr_t)&i64, (uintptr_t)&i32);
+    }
+
+    TEST_CASE("capacity is rounded up so that sequences stay aligned")
+    {
+        Declared v;
+        v.reserve(3);
+        REQUIRE_EQ(v.capacity(), 8);
+        for (int i = 0; i < 8; ++i)
+            v.push_back(static_cast<int8_t>(i), i * 2, static_cast<int16_t>(i));
+        REQUIRE_EQ((uintptr_t)v.data<1>() % alignof(int64_t), 0);
+        REQUIRE_EQ((uintptr_t)v.data<2>() % alignof(int16_t), 0);
+        v.reserve(9);
+        REQUIRE_EQ(v.capacity(), 16);
+        REQUIRE_EQ((uintptr_t)v.data<1>() % alignof(int64_t), 0);
+        for (int i = 0; i < 8; ++i) {
+            auto [a, b, c] = v[i];
+            REQUIRE_EQ(a, i);
+            REQUIRE_EQ(b, i * 2);
+            REQUIRE_EQ(c, i);
+        }
+
+        auto v2 = v;
+        REQUIRE_EQ(v2.capacity(), 8);
+        REQUIRE(v2 == v);
+    }
+}
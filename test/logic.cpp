@@ -30,12 +30,8 @@ static_assert(unsigned_integral<C::size_type>);
 //
 // Check member functions
 //
-// __VA_OPT__
-#define LOGIC_check_memfn(r, f, v, ...)                                        \
-    static_assert(is_invocable_r_v<r, decltype(DORI_f_ref(declval<v>().f)),    \
-                                   ##__VA_ARGS__>)
-#define LOGIC_check_nonmemfn(r, f, ...)                                        \
-    static_assert(is_invocable_r_v<r, decltype(DORI_f_ref(f)), ##__VA_ARGS__>)
+#define LOGIC_check_memfn(r, f, v)                                             \
+    static_assert(is_convertible_v<decltype(declval<v>().f()), r>)
 LOGIC_check_memfn(C::allocator_type, get_allocator, const C &);
 LOGIC_check_memfn(C::iterator, begin, C &);
 LOGIC_check_memfn(C::iterator, end, C &);
@@ -228,8 +224,8 @@ TEST_SUITE("dori::vector")
         REQUIRE(equal<It>(v2.begin(), v2.end(), odds_doubled, eq));
 
         const int sum =
-            reduce<It>(++v2.begin(), v2.end(), get<0>(v2[0]),
-                       [](int acc, auto cur) { return acc + get<0>(cur); });
+            accumulate<It>(++v2.begin(), v2.end(), get<0>(v2[0]),
+                           [](int acc, auto cur) { return acc + get<0>(cur); });
         REQUIRE_EQ(sum, 2 + 6 + 10 + 14);
     }
 
@@ -264,6 +260,62 @@ TEST_SUITE("dori::vector")
         REQUIRE_EQ(B_dtors, 16);
     }
 
+    TEST_CASE("dori::vector can be copy-assigned")
+    {
+        dori::vector<int, char> v, v2;
+        v.reserve(4);
+        v2.reserve(8);
+        for (int i = 0; i < 4; ++i)
+            v.push_back(i, static_cast<char>('a' + i));
+        for (int i = 0; i < 6; ++i)
+            v2.push_back(-i, 'z');
+
+        v2 = v;
+        REQUIRE_EQ(v2.size(), 4);
+        REQUIRE(v2 == v);
+
+        v.resize(1);
+        v2 = v;
+        REQUIRE_EQ(v2.size(), 1);
+        REQUIRE(v2 == v);
+    }
+
+    TEST_CASE("trivially copyable rows are copied and erased as bytes")
+    {
+        // Same sizes in another order; both share the byte-level paths
+        using V = dori::vector<int32_t, double, dori::bit, uint16_t>;
+        using W = dori::vector<uint16_t, int64_t, dori::bit, float>;
+        V v;
+        W w;
+        v.reserve(70);
+        w.reserve(130);
+        for (int i = 0; i < 70; ++i) {
+            v.push_back(i, i * 0.5, i % 3 == 0, static_cast<uint16_t>(i));
+            w.push_back(static_cast<uint16_t>(i), i, i % 3 == 0,
+                        static_cast<float>(i));
+        }
+        V v2 = v;
+        REQUIRE(v2 == v);
+        v2.reserve(300);
+        REQUIRE(v2 == v);
+        W w2;
+        w2.reserve(100);
+        w2.resize(100);
+        w2 = w;
+        REQUIRE(w2 == w);
+
+        dori::vector<int32_t, double, uint16_t> u;
+        u.reserve(10);
+        for (int i = 0; i < 10; ++i)
+            u.push_back(i, i * 0.5, static_cast<uint16_t>(i));
+        u.erase(next(u.begin(), 2), next(u.begin(), 5));
+        REQUIRE_EQ(u.size(), 7);
+        for (int i = 0; i < 7; ++i) {
+            const int j = i < 2 ? i : i + 3;
+            REQUIRE((u[i] == tuple{j, j * 0.5, static_cast<uint16_t>(j)}));
+        }
+    }
+
     TEST_CASE("dori::vector::emplace_back works")
     {
         SUBCASE("dori::vector::emplace_back initializes expectedly")
@@ -363,9 +415,14 @@ TEST_SUITE("dori::vector")
         }
     }
 
+#ifdef _MSC_VER
 #define DORI_VECTOR_TEST_EXPLICIT_NEW_AND_DELETE_BEGIN                         \
     __pragma(warning(push)) __pragma(warning(disable : 26409))
 #define DORI_VECTOR_TEST_EXPLICIT_NEW_AND_DELETE_END __pragma(warning(pop))
+#else
+#define DORI_VECTOR_TEST_EXPLICIT_NEW_AND_DELETE_BEGIN
+#define DORI_VECTOR_TEST_EXPLICIT_NEW_AND_DELETE_END
+#endif
 
     TEST_CASE("dori::vector supports custom allocators")
     {
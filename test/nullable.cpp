@@ -0,0 +1,256 @@
+#include <dori/all.h>
+#include <functional>
+#include <optional>
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+using namespace std;
+
+using V = dori::vector<dori::nullable<int>, dori::nullable<double>, string>;
+
+// The values take their own bytes per row, and the validity a bit
+static_assert(dori::layout::info<V>::row_size ==
+              sizeof(int) + sizeof(double) + sizeof(string));
+static_assert(dori::layout::info<V>::bits_per_row == 2);
+static_assert(dori::layout::info<V>::granularity == 64);
+static_assert(
+    is_same_v<V::value_type, tuple<optional<int>, optional<double>, string>>);
+static_assert(
+    is_same_v<V::const_reference,
+              tuple<optional<int>, optional<double>, const string &>>);
+static_assert(is_same_v<decltype(declval<V &>().data<0>()),
+                        dori::nullable_ptr<int>>);
+
+// Row i is null in column 0 if divisible by 3, and in column 1 by 5
+static optional<int> a_of(int i)
+{
+    return i % 3 ? optional<int>{i} : nullopt;
+}
+static optional<double> b_of(int i)
+{
+    return i % 5 ? optional<double>{i * .5} : nullopt;
+}
+
+static void fill(V &v, int n, int from = 0)
+{
+    if (v.capacity() < v.size() + static_cast<size_t>(n))
+        v.reserve(v.size() + static_cast<size_t>(n));
+    for (int i = from; i < from + n; ++i)
+        v.push_back(a_of(i), b_of(i), to_string(i));
+}
+
+static void check(const V &v, const vector<int> &is)
+{
+    REQUIRE_EQ(v.size(), is.size());
+    for (size_t k = 0; k < is.size(); ++k) {
+        const auto [a, b, c] = v[k];
+        REQUIRE((a == a_of(is[k])));
+        REQUIRE((b == b_of(is[k])));
+        REQUIRE_EQ(c, to_string(is[k]));
+    }
+}
+
+static vector<int> iota(int n, int from = 0)
+{
+    vector<int> res(static_cast<size_t>(n));
+    for (int i = 0; i < n; ++i)
+        res[static_cast<size_t>(i)] = from + i;
+    return res;
+}
+
+TEST_SUITE("nullable columns")
+{
+    TEST_CASE("rows round-trip as optionals")
+    {
+        V v;
+        fill(v, 130);
+        check(v, iota(130));
+
+        auto [a, b, c] = v[4];
+        a              = nullopt;
+        b              = 7.;
+        REQUIRE_FALSE(get<0>(v[4]).has_value());
+        REQUIRE((get<1>(v[4]) == 7.));
+        REQUIRE((a == nullopt));
+        get<0>(v[3]) = 33;
+        REQUIRE((get<0>(v[3]) == 33));
+        swap(get<0>(v[3]), get<0>(v[4]));
+        REQUIRE((get<0>(v[4]) == 33));
+        REQUIRE_FALSE(get<0>(v[3]).has_value());
+
+        // Null rows hold T{} among the values
+        const auto p = v.data<0>();
+        REQUIRE_EQ(p.values()[3], 0);
+        REQUIRE_EQ(p.values()[4], 33);
+        REQUIRE_FALSE(p.validity()[3]);
+        REQUIRE(p.validity()[4]);
+
+        v.emplace_back();
+        REQUIRE_FALSE(get<0>(v.back()).has_value());
+        REQUIRE_FALSE(get<1>(v.back()).has_value());
+        v.push_back(1, nullopt, "x");
+        REQUIRE((get<0>(v.back()) == 1));
+
+        int n = 0;
+        v.for_each([&](auto f, auto l) {
+            if constexpr (is_same_v<decltype(f), dori::nullable_ptr<int>>)
+                for (; f != l; ++f)
+                    n += (*f).has_value();
+        });
+        REQUIRE_EQ(n, 130 - 44 + 1);
+    }
+
+    TEST_CASE("kernels skip the null rows")
+    {
+        dori::vector<dori::nullable<int>> v;
+        v.reserve(200);
+        for (int i = 0; i < 200; ++i)
+            v.push_back(a_of(i));
+        const auto p = v.data<0>();
+
+        for (size_t n : {0u, 1u, 2u, 63u, 64u, 65u, 130u, 200u}) {
+            int64_t sum = 0;
+            size_t cnt  = 0;
+            optional<int> lo, hi;
+            for (int i = 0; i < static_cast<int>(n); ++i)
+                if (const auto x = a_of(i)) {
+                    sum += *x;
+                    ++cnt;
+                    lo = lo ? std::min(*lo, *x) : *x;
+                    hi = hi ? std::max(*hi, *x) : *x;
+                }
+            REQUIRE_EQ(dori::valid::count(p, n), cnt);
+            REQUIRE_EQ(dori::valid::sum(p, n), sum);
+            REQUIRE((dori::valid::min(p, n) == lo));
+            REQUIRE((dori::valid::max(p, n) == hi));
+        }
+
+        // Predicates are masked by validity; bits past n are preserved
+        dori::vector<dori::bit> m;
+        m.reserve(256);
+        m.resize(256);
+        dori::mask::fill(m.data<0>(), 256, true);
+        dori::valid::where(
+            p, 130, [](int x) { return x % 2 == 0; }, m.data<0>());
+        for (int i = 0; i < 130; ++i)
+            REQUIRE_EQ(get<0>(m[static_cast<size_t>(i)]),
+                       i % 3 != 0 && i % 2 == 0);
+        REQUIRE(get<0>(m[130]));
+        REQUIRE(get<0>(m[191]));
+    }
+
+    TEST_CASE("columns without nulls take the dense path")
+    {
+        dori::vector<dori::nullable<uint8_t>> v;
+        v.reserve(1000);
+        for (int i = 0; i < 1000; ++i)
+            v.push_back(static_cast<uint8_t>(i));
+        const auto p = v.data<0>();
+        uint64_t sum = 0;
+        for (int i = 0; i < 1000; ++i)
+            sum += static_cast<uint8_t>(i);
+        REQUIRE(dori::mask::all(p.validity(), 1000));
+        REQUIRE_EQ(dori::valid::count(p, 1000), 1000u);
+        REQUIRE_EQ(dori::valid::sum(p, 1000), sum);
+        REQUIRE((dori::valid::min(p, 1000) == uint8_t{0}));
+        REQUIRE((dori::valid::max(p, 1000) == uint8_t{255}));
+
+        get<0>(v[999]) = nullopt;
+        REQUIRE_EQ(dori::valid::sum(p, 1000), sum - 999 % 256);
+
+        // All rows null
+        dori::vector<dori::nullable<float>> w;
+        w.reserve(128);
+        w.resize(70);
+        const auto q = w.data<0>();
+        REQUIRE_EQ(dori::valid::count(q, 70), 0u);
+        REQUIRE_EQ(dori::valid::sum(q, 70), 0.f);
+        REQUIRE_FALSE(dori::valid::min(q, 70).has_value());
+    }
+
+    TEST_CASE("erase, resize, and copies keep the validity")
+    {
+        V v;
+        fill(v, 150);
+        auto is = iota(150);
+
+        v.erase(next(v.begin(), 10), next(v.begin(), 80));
+        is.erase(is.begin() + 10, is.begin() + 80);
+        check(v, is);
+        v.erase(v.begin());
+        is.erase(is.begin());
+        check(v, is);
+
+        v.resize(50);
+        is.resize(50);
+        check(v, is);
+        v.resize(60);
+        for (size_t i = 50; i < 60; ++i) {
+            REQUIRE_FALSE(get<0>(v[i]).has_value());
+            REQUIRE_FALSE(get<1>(v[i]).has_value());
+        }
+        v.resize(50);
+        fill(v, 100, 1000);
+        const auto more = iota(100, 1000);
+        is.insert(is.end(), more.begin(), more.end());
+        check(v, is);
+
+        V w = v;
+        check(w, is);
+        REQUIRE((w == v));
+        get<0>(w[1]) = nullopt;
+        REQUIRE((w != v));
+
+        V u{std::move(w)};
+        w = v;
+        REQUIRE((w == v));
+        v.shrink_to_fit();
+        check(v, is);
+        swap(u, v);
+        check(u, is);
+
+        // Copied and relocated as bytes when trivially copyable
+        dori::vector<dori::nullable<int>, dori::nullable<double>> x;
+        x.reserve(10);
+        for (int i = 0; i < 100; ++i) {
+            if (x.size() == x.capacity())
+                x.reserve(2 * x.size());
+            x.push_back(a_of(i), b_of(i));
+        }
+        auto y = x;
+        REQUIRE((y == x));
+        for (int i = 0; i < 100; ++i) {
+            REQUIRE((get<0>(y[static_cast<size_t>(i)]) == a_of(i)));
+            REQUIRE((get<1>(y[static_cast<size_t>(i)]) == b_of(i)));
+        }
+
+        const vector<optional<int>> ns{1, nullopt, 3};
+        const dori::vector<dori::nullable<int>> z{
+            ns.begin(), ns.end(),
+            dori::vector<dori::nullable<int>>::allocator_type{}};
+        REQUIRE((z[1] == tuple{optional<int>{}}));
+        REQUIRE((z[2] == tuple{optional<int>{3}}));
+    }
+
+    TEST_CASE("columns are added and dropped around nullable ones")
+    {
+        V v;
+        fill(v, 100);
+        auto w = dori::with_column<dori::nullable<int>>(std::move(v), 5);
+        REQUIRE_EQ(w.size(), 100u);
+        for (int i = 0; i < 100; ++i) {
+            const auto [a, b, c, d] = w[static_cast<size_t>(i)];
+            REQUIRE((a == a_of(i)));
+            REQUIRE((b == b_of(i)));
+            REQUIRE((d == 5));
+        }
+        auto u = dori::without_column<0>(std::move(w));
+        for (int i = 0; i < 100; ++i)
+            REQUIRE((get<0>(u[static_cast<size_t>(i)]) == b_of(i)));
+    }
+}
@@ -0,0 +1,139 @@
+#include <dori/all.h>
+#include <functional>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+using namespace std;
+
+enum class color : uint8_t { red, green, blue };
+
+using V = dori::vector<int, dori::bit, dori::packed<color, 2>, string>;
+
+// Packed sequences take no whole bytes per row and come last
+static_assert(dori::layout::info<V>::row_size == sizeof(int) + sizeof(string));
+static_assert(dori::layout::info<V>::bits_per_row == 3);
+static_assert(dori::layout::info<V>::granularity == 64);
+static_assert(dori::layout::info<V>::bytes(64) ==
+              64 * (sizeof(int) + sizeof(string)) + 8 * 3);
+static_assert(is_same_v<V::value_type, tuple<int, bool, color, string>>);
+
+static void fill(V &v, int n)
+{
+    if (v.capacity() < v.size() + static_cast<size_t>(n))
+        v.reserve(v.size() + static_cast<size_t>(n));
+    for (int i = 0; i < n; ++i)
+        v.push_back(i, i % 3 == 0, static_cast<color>(i % 3), to_string(i));
+}
+
+static void check(const V &v, int n, int from = 0)
+{
+    REQUIRE_EQ(v.size(), static_cast<size_t>(n));
+    for (int i = 0; i < n; ++i) {
+        const auto [a, b, c, d] = v[static_cast<size_t>(i)];
+        const auto x            = from + i;
+        REQUIRE_EQ(a, x);
+        REQUIRE_EQ(b, x % 3 == 0);
+        REQUIRE(c == static_cast<color>(x % 3));
+        REQUIRE_EQ(d, to_string(x));
+    }
+}
+
+TEST_SUITE("packed columns")
+{
+    TEST_CASE("rows round-trip through proxies")
+    {
+        V v;
+        fill(v, 130);
+        check(v, 130);
+
+        auto [a, b, c, d] = v[5];
+        b                 = true;
+        c                 = color::blue;
+        REQUIRE(get<1>(v[5]));
+        REQUIRE(get<2>(v[5]) == color::blue);
+        REQUIRE_EQ(get<1>(v[4]), false);
+        REQUIRE(get<2>(v[4]) == color::green);
+
+        auto bs = v.data<1>();
+        swap(bs[0], bs[1]);
+        REQUIRE(!bs[0]);
+        REQUIRE(bs[1]);
+        static_cast<void>(a), static_cast<void>(d);
+    }
+
+    TEST_CASE("erase, resize, copy, and move")
+    {
+        V v;
+        fill(v, 100);
+        v.erase(v.begin(), next(v.begin(), 70));
+        check(v, 30, 70);
+
+        V w = v;
+        check(w, 30, 70);
+        REQUIRE(v == w);
+        w.reserve(300);
+        check(w, 30, 70);
+        fill(w, 1);
+        REQUIRE(v != w);
+        w = v;
+        check(w, 30, 70);
+
+        V x = static_cast<V &&>(w);
+        check(x, 30, 70);
+        x.resize(40);
+        REQUIRE_EQ(get<1>(x[39]), false);
+        REQUIRE(get<2>(x[39]) == color::red);
+        x.resize(30);
+        REQUIRE(v == x);
+        x.shrink_to_fit();
+        check(x, 30, 70);
+    }
+
+    TEST_CASE("mask kernels")
+    {
+        dori::vector<dori::bit, dori::bit, int> v;
+        v.reserve(200);
+        for (int i = 0; i < 200; ++i)
+            v.push_back(i % 2 == 0, i % 3 == 0, i);
+        const auto n = v.size();
+        REQUIRE_EQ(dori::mask::count(v.data<0>(), n), 100);
+        REQUIRE_EQ(dori::mask::count(v.data<1>(), n), 67);
+        REQUIRE(dori::mask::any(v.data<1>(), n));
+        REQUIRE(!dori::mask::all(v.data<1>(), n));
+
+        dori::mask::combine(v.data<0>(), v.data<0>(), v.data<1>(), n,
+                            bit_and<>{});
+        vector<size_t> idx;
+        dori::mask::to_indices(v.data<0>(), n, back_inserter(idx));
+        REQUIRE_EQ(idx.size(), 34);
+        for (size_t i = 0; i < idx.size(); ++i)
+            REQUIRE_EQ(idx[i], i * 6);
+
+        dori::mask::fill(v.data<1>(), n, true);
+        REQUIRE(dori::mask::all(v.data<1>(), n));
+        v.erase(next(v.begin(), 10), v.end());
+        REQUIRE_EQ(dori::mask::count(v.data<1>(), v.size()), 10);
+    }
+
+    TEST_CASE("for_each visits packed sequences through packed_ptr")
+    {
+        dori::vector<dori::bit, uint16_t> v;
+        v.reserve(10);
+        for (uint16_t i = 0; i < 10; ++i)
+            v.push_back(i < 4, i);
+        size_t set = 0, sum = 0;
+        as_const(v).for_each([&](auto f, auto l) {
+            for (; f != l; ++f)
+                if constexpr (is_same_v<decltype(f), const uint16_t *>)
+                    sum += *f;
+                else
+                    set += *f;
+        });
+        REQUIRE_EQ(set, 4);
+        REQUIRE_EQ(sum, 45);
+    }
+}
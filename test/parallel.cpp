@@ -0,0 +1,158 @@
+#include <dori/all.h>
+#include <atomic>
+#include <optional>
+#include <stdexcept>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+using namespace std;
+
+TEST_SUITE("dori::parallel")
+{
+    TEST_CASE("chunks cover the rows once, in whole lines' worth of rows")
+    {
+        dori::vector<uint8_t, uint32_t, double> v;
+        v.reserve(100'000);
+        for (uint32_t i = 0; i < 100'000; ++i)
+            v.push_back(0, i, 0);
+        dori::thread_pool pool{4};
+        atomic<size_t> chunks = 0;
+        dori::parallel_for_each_chunk(pool, v, 1000, [&](size_t f, size_t l) {
+            // Multiples of the rows per line of every column: 64 for uint8_t,
+            // 16 for uint32_t, 8 for double; the columns of a vector this big
+            // start on lines, so the chunks start on lines in each
+            REQUIRE_EQ(f % 64, 0);
+            REQUIRE((l % 64 == 0 || l == v.size()));
+            REQUIRE_EQ(reinterpret_cast<uintptr_t>(v.data<0>() + f) % 64, 0);
+            REQUIRE_EQ(reinterpret_cast<uintptr_t>(v.data<1>() + f) % 64, 0);
+            REQUIRE_EQ(reinterpret_cast<uintptr_t>(v.data<2>() + f) % 64, 0);
+            for (auto i = f; i < l; ++i)
+                ++get<0>(v[i]);
+            ++chunks;
+        });
+        REQUIRE_EQ(chunks.load(), (100'000 + 1023) / 1024);
+        v.for_each([](auto f, auto l) {
+            if constexpr (is_same_v<decltype(f), uint8_t *>)
+                REQUIRE(all_of(f, l, [](uint8_t x) { return x == 1; }));
+        });
+    }
+
+    TEST_CASE("columns of big vectors start on cache lines")
+    {
+        const auto on_line = [](const auto *p) {
+            return reinterpret_cast<uintptr_t>(p) % dori::cache_line == 0;
+        };
+        const auto check = [&]<class V>(V &v, size_t cap) {
+            v.reserve(cap);
+            REQUIRE(v.capacity() >= cap);
+            v.for_each([&](auto f, auto) {
+                using P = decltype(f);
+                if constexpr (is_pointer_v<P>)
+                    REQUIRE(on_line(f));
+                else if constexpr (requires { f.ends(); })
+                    REQUIRE(on_line(f.ends()));
+                else if constexpr (requires { f.validity(); }) {
+                    REQUIRE(on_line(f.values()));
+                    REQUIRE(on_line(f.validity().words()));
+                } else
+                    REQUIRE(on_line(f.words()));
+            });
+        };
+        for (size_t cap : {4096u, 5000u, 100'001u}) {
+            dori::vector<uint8_t, uint32_t, double> a;
+            check(a, cap);
+            dori::vector<dori::bit, char, dori::packed<uint8_t, 2>, uint16_t> b;
+            check(b, cap);
+            dori::vector<dori::nullable<int>, dori::varlen<char>, char> c;
+            check(c, cap);
+        }
+
+        // Smaller vectors keep the capacity asked for
+        dori::vector<uint8_t, uint32_t, double> v;
+        v.reserve(4095);
+        REQUIRE_EQ(v.capacity(), 4095);
+    }
+
+    TEST_CASE("reduction is folded in chunk order")
+    {
+        dori::vector<dori::bit, uint64_t> v;
+        v.reserve(10'000);
+        for (uint64_t i = 0; i < 10'000; ++i)
+            v.push_back(i % 3 == 0, i);
+        dori::thread_pool pool{3};
+        const auto sum = dori::parallel_reduce(
+            pool, v, 512, uint64_t{0},
+            [&](size_t f, size_t l) {
+                uint64_t acc = 0;
+                for (auto i = f; i < l; ++i)
+                    acc += v.data<0>()[i] ? v.data<1>()[i] : 0;
+                return acc;
+            },
+            plus<>{});
+        uint64_t expected = 0;
+        for (uint64_t i = 0; i < 10'000; i += 3)
+            expected += i;
+        REQUIRE_EQ(sum, expected);
+
+        vector<size_t> firsts = dori::parallel_reduce(
+            v, 1, vector<size_t>{},
+            [](size_t f, size_t) { return vector<size_t>{f}; },
+            [](vector<size_t> a, const vector<size_t> &b) {
+                a.insert(a.end(), b.begin(), b.end());
+                return a;
+            });
+        REQUIRE_EQ(firsts.size(), 10'000 / 512 + 1);
+        REQUIRE(is_sorted(firsts.begin(), firsts.end()));
+    }
+
+    TEST_CASE("chunks of nullable and varlen columns")
+    {
+        dori::vector<dori::nullable<int>, dori::varlen<char>, int> v;
+        v.reserve(10'000);
+        for (int i = 0; i < 10'000; ++i)
+            v.push_back(i % 3 ? optional<int>{i} : nullopt,
+                        string(static_cast<size_t>(i % 5), 'x'), i % 7);
+        dori::thread_pool pool{3};
+        const auto n = dori::parallel_reduce(
+            pool, v, 100, size_t{0},
+            [&](size_t f, size_t l) {
+                // Whole words of validity bits per chunk
+                REQUIRE_EQ(f % 512, 0);
+                size_t acc = 0;
+                for (auto i = f; i < l; ++i)
+                    acc += get<0>(v[i]).has_value() + get<1>(v[i]).size();
+                return acc;
+            },
+            plus<>{});
+        size_t expected = 0;
+        for (int i = 0; i < 10'000; ++i)
+            expected += (i % 3 != 0) + static_cast<size_t>(i % 5);
+        REQUIRE_EQ(n, expected);
+
+        atomic<size_t> rows = 0;
+        dori::parallel_for_each_chunk(
+            pool, v, 1, [&](size_t f, size_t l) { rows += l - f; });
+        REQUIRE_EQ(rows.load(), v.size());
+        const auto g =
+            dori::group_by<2>(v).parallel_aggregate<dori::count>(pool, 1000);
+        REQUIRE_EQ(g.size(), 7u);
+    }
+
+    TEST_CASE("exceptions propagate and nested runs are serial")
+    {
+        dori::thread_pool pool{4};
+        REQUIRE_THROWS_AS(pool.run(100,
+                                   [](size_t i) {
+                                       if (i == 42)
+                                           throw runtime_error{"42"};
+                                   }),
+                          runtime_error);
+        atomic<size_t> n = 0;
+        pool.run(8, [&](size_t) { pool.run(8, [&](size_t) { ++n; }); });
+        REQUIRE_EQ(n.load(), 64);
+    }
+}
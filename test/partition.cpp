@@ -0,0 +1,135 @@
+#include <dori/all.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+using namespace std;
+
+using V = dori::vector<int64_t, double, uint8_t>;
+
+static V make(size_t rows)
+{
+    V v;
+    if (rows)
+        v.reserve(rows);
+    for (size_t i = 0; i < rows; ++i)
+        v.push_back(static_cast<int64_t>(i * 7919 % 1000003), i * .5,
+                    static_cast<uint8_t>(i));
+    return v;
+}
+
+// The rows of v in bucket b by column 0, in order
+template <class Vec, class Fn>
+static Vec bucket(const Vec &v, size_t b, Fn fn)
+{
+    Vec res;
+    for (size_t i = 0; i < v.size(); ++i)
+        if (static_cast<size_t>(fn(get<0>(v[i]))) == b) {
+            if (res.size() == res.capacity())
+                res.reserve(res.size() ? 2 * res.size() : 16);
+            apply([&](const auto &...xs) { res.push_back(xs...); }, v[i]);
+        }
+    return res;
+}
+
+template <class Vec, class Fn>
+static void check(const Vec &v, size_t k, Fn fn, const vector<Vec> &parts,
+                  const dori::partitioned<Vec> &p)
+{
+    REQUIRE_EQ(parts.size(), k);
+    REQUIRE_EQ(p.buckets(), k);
+    REQUIRE_EQ(p.offsets.front(), 0u);
+    REQUIRE_EQ(p.offsets.back(), v.size());
+    REQUIRE_EQ(p.rows.size(), v.size());
+    for (size_t b = 0; b < k; ++b) {
+        const auto want = bucket(v, b, fn);
+        REQUIRE((parts[b] == want));
+        REQUIRE_EQ(p.offsets[b + 1] - p.offsets[b], want.size());
+        for (size_t i = 0; i < want.size(); ++i)
+            REQUIRE((p.rows[p.offsets[b] + i] == want[i]));
+    }
+}
+
+TEST_SUITE("partitioning")
+{
+    TEST_CASE("rows go to their buckets in order")
+    {
+        for (size_t n : {1u, 15u, 16u, 17u, 1000u, 5000u})
+            for (size_t k : {1u, 2u, 7u, 64u}) {
+                const auto v  = make(n);
+                const auto fn = [k](int64_t x) { return x % k; };
+                check(v, k, fn, dori::partition_by<0>(v, k, fn),
+                      dori::reorder_by<0>(v, k, fn));
+            }
+
+        // Buckets may be left empty, and keyed by any column
+        const auto v  = make(100);
+        const auto fn = [](uint8_t x) { return x < 10 ? 3 : 0; };
+        const auto ps = dori::partition_by<2>(v, 5, fn);
+        REQUIRE_EQ(ps[0].size(), 90u);
+        REQUIRE(ps[1].empty());
+        REQUIRE_EQ(ps[3].size(), 10u);
+        REQUIRE((ps[3][9] == v[9]));
+        REQUIRE((ps[0][0] == v[10]));
+        const auto p = dori::reorder_by<2>(v, 5, fn);
+        REQUIRE((p.offsets == vector<size_t>{0, 90, 90, 90, 100, 100}));
+        REQUIRE((p.rows[90] == v[0]));
+    }
+
+    TEST_CASE("empty vectors give empty buckets")
+    {
+        const V v;
+        const auto fn = [](int64_t) { return 0; };
+        const auto ps = dori::partition_by<0>(v, 3, fn);
+        REQUIRE_EQ(ps.size(), 3u);
+        for (const auto &x : ps)
+            REQUIRE(x.empty());
+        const auto p = dori::reorder_by<0>(v, 3, fn);
+        REQUIRE(p.rows.empty());
+        REQUIRE((p.offsets == vector<size_t>{0, 0, 0, 0}));
+        REQUIRE(dori::parallel_partition_by<0>(v, 3, fn)[2].empty());
+        REQUIRE(dori::parallel_reorder_by<0>(v, 3, fn).rows.empty());
+    }
+
+    TEST_CASE("parallel variants match the serial ones")
+    {
+        dori::thread_pool pool{4};
+        const auto v = make(300000);
+        for (size_t k : {1u, 3u, 256u}) {
+            const auto fn = [k](int64_t x) { return (x >> 3) % k; };
+            const auto ps = dori::parallel_partition_by<0>(pool, v, k, fn);
+            const auto p  = dori::parallel_reorder_by<0>(pool, v, k, fn);
+            const auto p1 = dori::reorder_by<0>(v, k, fn);
+            REQUIRE((p.offsets == p1.offsets));
+            REQUIRE((p.rows == p1.rows));
+            for (size_t b = 0; b < k; ++b) {
+                REQUIRE_EQ(ps[b].size(), p.offsets[b + 1] - p.offsets[b]);
+                for (size_t i = 0; i < ps[b].size(); i += 97)
+                    REQUIRE((ps[b][i] == p.rows[p.offsets[b] + i]));
+            }
+        }
+        const auto fn = [](int64_t x) { return x & 1; };
+        const auto ps = dori::parallel_partition_by<0>(v, 2, fn);
+        REQUIRE_EQ(ps[0].size() + ps[1].size(), v.size());
+        REQUIRE((ps[1] == bucket(v, 1, fn)));
+    }
+
+    TEST_CASE("other columns are copied a row at a time")
+    {
+        using W = dori::vector<int, string, dori::bit>;
+        W v;
+        v.reserve(300);
+        for (int i = 0; i < 300; ++i)
+            v.push_back(i, to_string(i), i % 3 == 0);
+        const auto fn = [](int x) { return x % 4; };
+        check(v, 4, fn, dori::partition_by<0>(v, 4, fn),
+              dori::reorder_by<0>(v, 4, fn));
+        const auto ps = dori::partition_by<2>(
+            v, 2, [](bool x) { return static_cast<int>(x); });
+        REQUIRE_EQ(ps[1].size(), 100u);
+        REQUIRE((ps[1][5] == tuple{15, string{"15"}, true}));
+    }
+}
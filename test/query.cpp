@@ -0,0 +1,93 @@
+#include <dori/all.h>
+#include <functional>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+using namespace std;
+
+using V = dori::vector<int, string, int64_t, double>;
+
+// Spans several chunks, the last partial
+static constexpr int rows = 5000;
+
+static V make()
+{
+    V v;
+    v.reserve(rows);
+    for (int i = 0; i < rows; ++i)
+        v.push_back(i, to_string(i), int64_t{i} * 3, i / 2.0);
+    return v;
+}
+
+TEST_SUITE("dori::query")
+{
+    TEST_CASE("where, select, and reduce are fused")
+    {
+        const auto v   = make();
+        const auto res = v.query()
+                             .where<0>([](int x) { return x % 2 == 0; })
+                             .select<0, 2>([](int a, int64_t b) {
+                                 return a + b;
+                             })
+                             .reduce(plus<>{});
+        int64_t expected = 0;
+        for (int i = 0; i < rows; i += 2)
+            expected += i + int64_t{i} * 3;
+        REQUIRE_EQ(res, expected);
+        static_assert(is_same_v<decltype(res), const int64_t>);
+    }
+
+    TEST_CASE("stages after select receive its value")
+    {
+        const auto v = make();
+        vector<size_t> lens;
+        v.query()
+            .select<1>([](const string &s) { return s.size(); })
+            .where<0>([](size_t n, int i) { return n == 4 && i % 1000 == 0; })
+            .select<3>([](size_t n, double d) { return n + d; })
+            .for_each([&](double x) {
+                lens.push_back(static_cast<size_t>(x));
+            });
+        const vector<size_t> expected{4 + 500, 4 + 1000, 4 + 1500, 4 + 2000};
+        REQUIRE(lens == expected);
+    }
+
+    TEST_CASE("count and to_indices")
+    {
+        const auto v = make();
+        const auto q = v.query()
+                           .where<2>([](int64_t x) { return x % 7 == 0; })
+                           .where<0>([](int x) { return x > 4000; });
+        vector<size_t> idx;
+        q.to_indices(back_inserter(idx));
+        REQUIRE_EQ(q.count(), idx.size());
+        REQUIRE_EQ(idx.front(), 4004);
+        for (auto i : idx)
+            REQUIRE_EQ(i % 7, 0);
+        REQUIRE_EQ(V{}.query().count(), 0);
+    }
+
+    TEST_CASE("packed and static columns")
+    {
+        dori::vector<dori::bit, int> v;
+        v.reserve(100);
+        for (int i = 0; i < 100; ++i)
+            v.push_back(i % 5 == 0, i);
+        REQUIRE_EQ(v.query()
+                       .where<0>([](bool b) { return b; })
+                       .select<1>([](int x) { return x; })
+                       .reduce(0, plus<>{}),
+                   950);
+
+        dori::static_vector<8, int, float> s;
+        s.push_back(1, 0.5f);
+        s.push_back(2, 1.5f);
+        REQUIRE_EQ(
+            s.query().select<1>([](float x) { return x; }).reduce(plus<>{}),
+            2.0f);
+    }
+}
@@ -0,0 +1,120 @@
+#include <dori/all.h>
+#include <deque>
+#include <stdint.h>
+#include <string>
+#include <tuple>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+using namespace std;
+
+// Rows of r, read through spans<I>(), against those of d
+template <class R, class D>
+static void check(const R &r, const D &d)
+{
+    REQUIRE_EQ(r.size(), d.size());
+    const auto [a, b] = r.template spans<0>();
+    REQUIRE_EQ(a.size + b.size, d.size());
+    size_t i = 0;
+    for (const auto x : a) {
+        REQUIRE_EQ(x, get<0>(d[i]));
+        ++i;
+    }
+    for (const auto x : b) {
+        REQUIRE_EQ(x, get<0>(d[i]));
+        ++i;
+    }
+    for (i = 0; i < d.size(); ++i)
+        REQUIRE((r[i] == d[i]));
+}
+
+TEST_SUITE("dori::ring")
+{
+    TEST_CASE("pushes drop the first rows and pops wrap around")
+    {
+        dori::ring<int, string, dori::bit> r{5};
+        deque<tuple<int, string, bool>> d;
+        REQUIRE((r.empty() && r.capacity() == 5));
+        for (int i = 0; i < 23; ++i) {
+            r.push_back(i, to_string(i), i % 3 == 0);
+            d.emplace_back(i, to_string(i), i % 3 == 0);
+            if (d.size() > 5)
+                d.pop_front();
+            if (i % 4 == 3) {
+                r.pop_front(2);
+                d.erase(d.begin(), d.begin() + 2);
+            }
+            check(r, d);
+        }
+        REQUIRE_EQ(get<1>(r.front()), get<1>(d.front()));
+        REQUIRE_EQ(get<1>(r.back()), "22");
+        get<1>(r.back()) = "x";
+        REQUIRE_EQ(get<1>(r[r.size() - 1]), "x");
+
+        auto s = r;
+        REQUIRE_EQ(s.spans<1>()[1].size, 0);
+        REQUIRE_EQ(get<1>(s.back()), "x");
+        auto m = std::move(s);
+        REQUIRE((s.empty() && s.capacity() == 0));
+        REQUIRE_EQ(m.size(), r.size());
+        r.clear();
+        REQUIRE(r.empty());
+        r.push_back(1, "1", true);
+        REQUIRE_EQ(get<1>(r.front()), "1");
+    }
+
+    TEST_CASE("bulk appends keep the last rows in two runs")
+    {
+        dori::ring<uint32_t, double> r{100};
+        deque<tuple<uint32_t, double>> d;
+        dori::vector<uint32_t, double> batch;
+        batch.reserve(250);
+        for (uint32_t i = 0; i < 250; ++i)
+            batch.push_back(i, i * 0.5);
+
+        uint32_t next = 0;
+        const auto append = [&](size_t n) {
+            r.append(n, batch.data<0>() + next, batch.data<1>() + next);
+            for (size_t j = 0; j < n; ++j, ++next)
+                d.emplace_back(batch[next]);
+            while (d.size() > 100)
+                d.pop_front();
+            check(r, d);
+        };
+        append(70);
+        append(0);
+        append(45);
+        REQUIRE(r.full());
+        REQUIRE_EQ(r.spans<1>()[1].size, 15);
+        r.pop_front(60);
+        d.erase(d.begin(), d.begin() + 60);
+        append(134);
+        REQUIRE_EQ(get<0>(r.front()), 149);
+
+        r.append(batch);
+        REQUIRE_EQ(get<0>(r.front()), 150);
+        REQUIRE_EQ(get<0>(r.back()), 249);
+    }
+
+    TEST_CASE("aggregates over a sliding window")
+    {
+        dori::ring<int, double> r{8};
+        for (int i = 0; i < 13; ++i)
+            r.push_back(i % 5, i * 1.5);
+        // Rows 5..12 with 0..4 wrapped around
+        REQUIRE_EQ(r.spans<0>()[1].size, 5);
+        const auto [s, lo, hi, c] =
+            r.aggregate<dori::sum<0>, dori::min<1>, dori::max<0>,
+                        dori::count>(6);
+        int64_t want = 0;
+        for (int i = 7; i < 13; ++i)
+            want += i % 5;
+        REQUIRE_EQ(s, want);
+        REQUIRE_EQ(lo, 7 * 1.5);
+        REQUIRE_EQ(hi, 4);
+        REQUIRE_EQ(c, 6);
+        REQUIRE_EQ(get<0>(r.aggregate<dori::max<1>>(1)), 12 * 1.5);
+        REQUIRE_EQ(get<0>(r.aggregate<dori::count>(8)), 8);
+    }
+}
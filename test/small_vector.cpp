@@ -0,0 +1,98 @@
+#include <dori/all.h>
+#include <stdint.h>
+#include <string>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+using namespace std;
+
+using Sv = dori::small_vector<4, int, string, char>;
+
+static_assert(Sv::inline_capacity == 4);
+// Rounded up to the granularity of the layout
+static_assert(dori::small_vector<3, int8_t, int64_t, dori::layout::declared>::
+                  inline_capacity == 8);
+
+static void fill(Sv &v, int n)
+{
+    if (v.capacity() < static_cast<size_t>(n))
+        v.reserve(static_cast<size_t>(n));
+    for (int i = 0; i < n; ++i)
+        v.emplace_back(i, to_string(i), static_cast<char>('a' + i));
+}
+
+static void check(const Sv &v, int n)
+{
+    REQUIRE_EQ(v.size(), static_cast<size_t>(n));
+    for (int i = 0; i < n; ++i) {
+        const auto [a, b, c] = v[static_cast<size_t>(i)];
+        REQUIRE_EQ(a, i);
+        REQUIRE_EQ(b, to_string(i));
+        REQUIRE_EQ(c, static_cast<char>('a' + i));
+    }
+}
+
+TEST_SUITE("dori::small_vector")
+{
+    TEST_CASE("rows stay inline until reserve asks for more")
+    {
+        Sv v;
+        REQUIRE(v.is_inline());
+        REQUIRE_EQ(v.capacity(), 4);
+        fill(v, 4);
+        REQUIRE(v.is_inline());
+        check(v, 4);
+        v.reserve(9);
+        REQUIRE(!v.is_inline());
+        check(v, 4);
+        v.emplace_back(4, "4", 'e');
+        check(v, 5);
+        v.erase(next(v.begin()), v.end());
+        v.shrink_to_fit();
+        REQUIRE(v.is_inline());
+        REQUIRE_EQ(v.capacity(), 4);
+        check(v, 1);
+    }
+
+    TEST_CASE("copy and move")
+    {
+        for (int n : {0, 3, 10}) {
+            Sv a;
+            fill(a, n);
+            Sv b{a};
+            check(b, n);
+            REQUIRE(a == b);
+            REQUIRE_EQ(b.is_inline(), n <= 4);
+
+            Sv c{static_cast<Sv &&>(b)};
+            check(c, n);
+            REQUIRE(b.empty());
+            REQUIRE(b.is_inline());
+
+            Sv d;
+            fill(d, 2);
+            d = c;
+            check(d, n);
+            d = static_cast<Sv &&>(c);
+            check(d, n);
+            REQUIRE(c.empty());
+            c = d;
+            check(c, n);
+        }
+    }
+
+    TEST_CASE("swap")
+    {
+        for (auto [n, m] : {pair{2, 3}, pair{2, 9}, pair{7, 9}}) {
+            Sv a, b;
+            fill(a, n);
+            fill(b, m);
+            swap(a, b);
+            check(a, m);
+            check(b, n);
+            REQUIRE_EQ(a.is_inline(), m <= 4);
+            REQUIRE_EQ(b.is_inline(), n <= 4);
+        }
+    }
+}
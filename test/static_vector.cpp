@@ -0,0 +1,103 @@
+#include <dori/all.h>
+#include <stdint.h>
+#include <string>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+using namespace std;
+
+//
+// Lookup tables built at compile time
+//
+
+constexpr auto squares = [] {
+    dori::static_vector<16, uint8_t, uint32_t, float> res;
+    for (uint32_t i = 0; i < 10; ++i)
+        res.push_back(static_cast<uint8_t>(i), i * i,
+                      static_cast<float>(i) / 2);
+    res.erase(res.begin());
+    return res;
+}();
+static_assert(squares.size() == 9);
+static_assert(squares.capacity() == 16);
+static_assert(squares.data<1>()[2] == 9);
+static_assert(get<0>(squares.back()) == 9);
+static_assert(get<2>(squares[0]) == 0.5f);
+static_assert(is_trivially_copyable_v<decltype(squares)>);
+
+constexpr bool strings_work()
+{
+    dori::static_vector<4, string, int> a;
+    a.emplace_back("one", 1);
+    a.emplace_back("two", 2);
+    a.emplace_back("three", 3);
+    auto b = a;
+    b.erase(b.begin());
+    b.pop_back();
+    a.swap(b);
+    a.resize(3);
+    return b.size() == 3 && get<0>(b[2]) == "three" && a.size() == 3 &&
+           get<0>(a[0]) == "two" && get<0>(a[2]).empty() && a != b;
+}
+static_assert(strings_work());
+static_assert(!is_trivially_copyable_v<dori::static_vector<4, string, int>>);
+
+struct Counted {
+    static inline int alive = 0;
+    int v;
+    Counted(int x) : v{x} { ++alive; }
+    Counted(const Counted &o) : v{o.v} { ++alive; }
+    Counted &operator=(const Counted &) = default;
+    ~Counted() { --alive; }
+};
+
+TEST_SUITE("dori::static_vector")
+{
+    TEST_CASE("elements are constructed and destroyed by row")
+    {
+        {
+            dori::static_vector<8, Counted, int> v;
+            REQUIRE_EQ(Counted::alive, 0);
+            for (int i = 0; i < 5; ++i)
+                v.emplace_back(i, i);
+            REQUIRE_EQ(Counted::alive, 5);
+            v.erase(next(v.begin()), next(v.begin(), 3));
+            REQUIRE_EQ(Counted::alive, 3);
+            REQUIRE_EQ(get<0>(v[1]).v, 3);
+            auto w = v;
+            REQUIRE_EQ(Counted::alive, 6);
+            w = dori::static_vector<8, Counted, int>{};
+            REQUIRE_EQ(Counted::alive, 3);
+            int sum = 0;
+            for (auto [c, i] : v)
+                sum += c.v + i;
+            REQUIRE_EQ(sum, 2 * (0 + 3 + 4));
+        }
+        REQUIRE_EQ(Counted::alive, 0);
+    }
+
+    TEST_CASE("swap of unequal sizes")
+    {
+        dori::static_vector<8, string, int> a, b;
+        a.push_back("a", 1);
+        for (int i = 0; i < 4; ++i)
+            b.push_back(to_string(i), i);
+        swap(a, b);
+        REQUIRE_EQ(a.size(), 4);
+        REQUIRE_EQ(b.size(), 1);
+        REQUIRE_EQ(get<0>(a[3]), "3");
+        REQUIRE_EQ(get<0>(b[0]), "a");
+    }
+
+    TEST_CASE("constant tables can be read at run time")
+    {
+        uint32_t sum = 0;
+        squares.for_each([&](const auto *f, const auto *l) {
+            for (; f != l; ++f)
+                sum += static_cast<uint32_t>(*f);
+        });
+        // Columns: 1..9, their squares, and halves of them truncated
+        REQUIRE_EQ(sum, 45 + 285 + 20);
+    }
+}
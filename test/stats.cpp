@@ -0,0 +1,76 @@
+#define DORI_STATS 1
+#include <dori/all.h>
+#include <stdint.h>
+#include <string_view>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+using namespace std;
+
+namespace
+{
+const dori::stats::entry *find_entry(string_view name)
+{
+    const dori::stats::entry *res = nullptr;
+    dori::stats::for_each_entry([&](const dori::stats::entry &e) {
+        if (e.name.find(name) != string_view::npos)
+            res = &e;
+    });
+    return res;
+}
+
+uint64_t at(const array<atomic<uint64_t>, dori::stats::counters::N> &xs,
+            dori::stats::op o)
+{
+    return xs[static_cast<size_t>(o)].load();
+}
+
+int begins = 0;
+int ends   = 0;
+} // namespace
+
+TEST_SUITE("dori::stats")
+{
+    TEST_CASE("vector operations are counted per instantiation")
+    {
+        using dori::stats::op;
+        {
+            dori::vector<int32_t, int64_t> v;
+            v.reserve(4);
+            for (int i = 0; i < 4; ++i)
+                v.push_back(i, i);
+            v.reserve(16);
+            auto v2 = v;
+            v2.erase(v2.begin(), next(v2.begin()));
+        }
+        const auto e = find_entry("int, long");
+        REQUIRE(e);
+        REQUIRE_EQ(e->columns, 2);
+        REQUIRE_EQ(e->row_size, sizeof(int32_t) + sizeof(int64_t));
+        REQUIRE_EQ(at(e->c.calls, op::allocate), 3);
+        REQUIRE_EQ(at(e->c.calls, op::deallocate), 3);
+        REQUIRE_EQ(at(e->c.calls, op::relocate), 1);
+        REQUIRE_EQ(at(e->c.rows, op::relocate), 4);
+        REQUIRE_EQ(at(e->c.bytes, op::relocate), 4 * e->row_size);
+        REQUIRE_EQ(at(e->c.rows, op::copy), 4);
+        REQUIRE_EQ(at(e->c.rows, op::erase), 3);
+        REQUIRE_EQ(e->c.peak_capacity.load(), 16);
+        // 12 unused rows of the reserve(16) buffer, 1 of the erased copy
+        REQUIRE_EQ(e->c.wasted_capacity.load(), 13);
+    }
+
+    TEST_CASE("hook sees beginnings and ends of operations")
+    {
+        dori::stats::set_hook([](const dori::stats::event &ev) noexcept {
+            ++(ev.ph == dori::stats::phase::begin ? begins : ends);
+        });
+        {
+            dori::vector<char> v;
+            v.reserve(8);
+        }
+        dori::stats::set_hook(nullptr);
+        REQUIRE_EQ(begins, 2);
+        REQUIRE_EQ(ends, 2);
+    }
+}
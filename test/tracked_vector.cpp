@@ -0,0 +1,123 @@
+#include <dori/all.h>
+#include <stdint.h>
+#include <string>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+using namespace std;
+
+using T = dori::tracked_vector<int64_t, float, dori::bit, string>;
+using V = dori::vector<int64_t, float, dori::bit, string>;
+
+static T make(int n)
+{
+    T v;
+    v.reserve(n);
+    for (int i = 0; i < n; ++i)
+        v.push_back(i, i * 0.5f, i % 3 == 0, to_string(i));
+    return v;
+}
+
+TEST_SUITE("dori::tracked_vector")
+{
+    TEST_CASE("deltas hold the blocks written to")
+    {
+        auto v = make(1000);
+        REQUIRE(v.changed());
+        const auto d0 = v.collect_deltas();
+        REQUIRE_EQ(d0.size, 1000);
+        REQUIRE_EQ(get<0>(d0.columns).ranges.size(), 1);
+        REQUIRE((get<3>(d0.columns).ranges[0] == dori::row_range{0, 1000}));
+        REQUIRE_EQ(get<2>(d0.columns).rows.size(), 1000);
+        REQUIRE(!v.changed());
+        REQUIRE(v.collect_deltas().empty());
+
+        V r;
+        dori::apply_deltas(r, d0);
+        REQUIRE((r == v.untracked()));
+
+        v.set<1>(5, -1.0f);
+        v.set<1>(70, -2.0f);
+        const auto p = v.mutable_data<2>(130, 200);
+        for (int i = 130; i < 200; ++i)
+            p[i] = !p[i];
+        v.set(999, {-3, -3.0f, true, "x"});
+        const auto d1 = v.collect_deltas();
+        REQUIRE(get<0>(d1.columns).ranges ==
+                (vector<dori::row_range>{{960, 1000}}));
+        REQUIRE(get<1>(d1.columns).ranges ==
+                (vector<dori::row_range>{{0, 128}, {960, 1000}}));
+        REQUIRE(get<2>(d1.columns).ranges ==
+                (vector<dori::row_range>{{128, 256}, {960, 1000}}));
+        REQUIRE_EQ(get<2>(d1.columns).rows.size(), 128 + 40);
+        REQUIRE_EQ(get<0>(get<3>(d1.columns).rows[39]), "x");
+
+        REQUIRE((r != v.untracked()));
+        dori::apply_deltas(r, d1);
+        REQUIRE((r == v.untracked()));
+    }
+
+    TEST_CASE("size changes")
+    {
+        auto v = make(100);
+        V r;
+        dori::apply_deltas(r, v.collect_deltas());
+
+        v.resize(10);
+        auto d = v.collect_deltas();
+        REQUIRE((d.empty() && d.size == 10));
+        dori::apply_deltas(r, d);
+        REQUIRE((r == v.untracked()));
+
+        v.reserve(300);
+        v.push_back(-1, 1.0f, true, "y");
+        v.resize(200);
+        v.set<3>(150, "z");
+        d = v.collect_deltas();
+        REQUIRE(get<0>(d.columns).ranges ==
+                (vector<dori::row_range>{{0, 200}}));
+        dori::apply_deltas(r, d);
+        REQUIRE((r == v.untracked()));
+        REQUIRE_EQ(get<3>(r[150]), "z");
+
+        v.clear();
+        REQUIRE(v.changed());
+        dori::apply_deltas(r, v.collect_deltas());
+        REQUIRE(r.empty());
+    }
+
+    TEST_CASE("replicas of replicas")
+    {
+        auto v = make(500);
+        T r;
+        dori::apply_deltas(r, v.collect_deltas());
+        REQUIRE((r.untracked() == v.untracked()));
+
+        // Applying marks the rows, so r passes them on
+        V s;
+        dori::apply_deltas(s, r.collect_deltas());
+        v.set<0>(300, 42);
+        dori::apply_deltas(r, v.collect_deltas());
+        const auto d = r.collect_deltas();
+        REQUIRE(get<0>(d.columns).ranges ==
+                (vector<dori::row_range>{{256, 320}}));
+        REQUIRE(get<1>(d.columns).empty());
+        dori::apply_deltas(s, d);
+        REQUIRE((s == v.untracked()));
+
+        size_t n = 0;
+        for (const auto &[a, b, c, e] : r)
+            n += c;
+        REQUIRE_EQ(n, 167);
+        const auto q = r.query()
+                           .where<2>([](bool c) { return c; })
+                           .select<0>([](int64_t a) { return a; })
+                           .reduce(plus<>{});
+        REQUIRE_EQ(q, 3 * 166 * 167 / 2 - 300 + 42);
+
+        T e;
+        REQUIRE(!e.changed());
+        REQUIRE(e.collect_deltas().empty());
+    }
+}
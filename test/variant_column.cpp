@@ -0,0 +1,193 @@
+#include <dori/all.h>
+#include <span>
+#include <stdexcept>
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+using namespace std;
+
+using C = dori::variant_column<int, double, string>;
+
+static_assert(is_same_v<C::value_type, variant<int, double, string>>);
+
+// Row i holds i, i / 2., or to_string(i) by i % 3
+static C::value_type value_of(int i)
+{
+    switch (i % 3) {
+    case 0: return i;
+    case 1: return i / 2.;
+    default: return to_string(i);
+    }
+}
+
+static void check(const C &c, const vector<C::value_type> &xs)
+{
+    REQUIRE_EQ(c.size(), xs.size());
+    for (size_t i = 0; i < xs.size(); ++i) {
+        REQUIRE_EQ(c.index(i), xs[i].index());
+        REQUIRE((c[i] == xs[i]));
+        // Each value knows its row
+        c.visit(i, [&]<class T>(const T &x) {
+            const auto vs = c.values<T>();
+            const auto k  = static_cast<size_t>(&x - vs.data());
+            REQUIRE_EQ(c.rows<T>()[k], i);
+        });
+    }
+}
+
+// Refuses negative values
+struct picky {
+    int x;
+    explicit picky(int y) : x{y}
+    {
+        if (y < 0)
+            throw invalid_argument{"picky"};
+    }
+};
+
+TEST_SUITE("variant columns")
+{
+    TEST_CASE("rows round-trip through tags and slots")
+    {
+        C c;
+        REQUIRE(c.empty());
+        vector<C::value_type> xs;
+        for (int i = 0; i < 200; ++i) {
+            xs.push_back(value_of(i));
+            c.push_back(xs.back());
+        }
+        check(c, xs);
+
+        // The values of each alternative are dense
+        REQUIRE_EQ(c.values<int>().size(), 67u);
+        REQUIRE_EQ(c.values<double>().size(), 67u);
+        REQUIRE_EQ(c.values<string>().size(), 66u);
+        REQUIRE_EQ(c.values<int>()[1], 3);
+        REQUIRE_EQ(c.tags()[2], 2u);
+        REQUIRE_EQ(c.slots()[5], 1u);
+
+        REQUIRE(c.holds<double>(4));
+        REQUIRE_EQ(*c.get_if<double>(4), 2.);
+        REQUIRE_FALSE(c.get_if<int>(4));
+        *c.get_if<string>(5) = "five";
+        REQUIRE_EQ(*c.get_if<string>(5), "five");
+
+        c.emplace_back<string>(3u, 'x');
+        REQUIRE_EQ(*c.get_if<string>(200), "xxx");
+        c.push_back(1.5);
+        REQUIRE_EQ(c.visit(201, [](const auto &x) -> size_t {
+            return sizeof(x);
+        }),
+                   sizeof(double));
+    }
+
+    TEST_CASE("set moves rows between alternatives")
+    {
+        C c;
+        vector<C::value_type> xs;
+        for (int i = 0; i < 90; ++i) {
+            xs.push_back(value_of(i));
+            c.push_back(xs.back());
+        }
+        // Same alternative in place, then others, including the last slots
+        for (size_t i : {0u, 3u, 87u, 1u, 88u, 89u, 45u, 46u, 47u}) {
+            const C::value_type x =
+                i % 2 ? C::value_type{string(i, 'a')} : C::value_type{int(i)};
+            c.set(i, x);
+            xs[i] = x;
+            check(c, xs);
+        }
+        c.set(10, 7.);
+        xs[10] = 7.;
+        check(c, xs);
+        REQUIRE_EQ(c.values<int>().size() + c.values<double>().size() +
+                       c.values<string>().size(),
+                   90u);
+
+        C d = c;
+        check(d, xs);
+        c.clear();
+        REQUIRE(c.empty());
+        REQUIRE(c.values<string>().empty());
+        c.push_back(1);
+        check(c, {1});
+        swap(c, d);
+        check(c, xs);
+
+        // From a value of the column itself while its alternative grows
+        C e;
+        for (int i = 0; i < 64; ++i)
+            e.push_back(string(40, static_cast<char>('a' + i % 26)));
+        e.push_back(1);
+        REQUIRE_EQ(e.values<string>().size(), 64u);
+        e.set(64, *e.get_if<string>(3));
+        REQUIRE((e[64] == C::value_type{string(40, 'd')}));
+        REQUIRE((e[3] == e[64]));
+    }
+
+    TEST_CASE("visit_by_type runs a batch per alternative")
+    {
+        dori::variant_column<int, double, string> c;
+        for (int i = 0; i < 100; ++i)
+            c.push_back(value_of(i));
+
+        // Results go back to their rows
+        vector<double> out(c.size());
+        vector<size_t> batches;
+        as_const(c).visit_by_type([&]<class T>(span<const T> xs,
+                                               span<const uint32_t> rows) {
+            batches.push_back(xs.size());
+            for (size_t k = 0; k < xs.size(); ++k) {
+                if constexpr (is_same_v<T, string>)
+                    out[rows[k]] = static_cast<double>(xs[k].size());
+                else
+                    out[rows[k]] = static_cast<double>(xs[k]);
+            }
+        });
+        REQUIRE((batches == vector<size_t>{34, 33, 33}));
+        for (int i = 0; i < 100; ++i) {
+            const auto x = value_of(i);
+            const auto e = i % 3 == 0   ? double(get<int>(x))
+                           : i % 3 == 1 ? get<double>(x)
+                                        : double(get<string>(x).size());
+            REQUIRE_EQ(out[static_cast<size_t>(i)], e);
+        }
+
+        // Values may be written in bulk; alternatives no row holds are skipped
+        dori::variant_column<int, float> d;
+        for (int i = 0; i < 10; ++i)
+            d.push_back(i);
+        int calls = 0;
+        d.visit_by_type([&](auto xs) {
+            ++calls;
+            for (auto &x : xs)
+                x *= 2;
+        });
+        REQUIRE_EQ(calls, 1);
+        REQUIRE_EQ(*d.get_if<int>(9), 18);
+    }
+
+    TEST_CASE("a value that throws leaves no row and no value behind")
+    {
+        dori::variant_column<int, picky> c;
+        for (int i = 0; i < 64; ++i)
+            i % 2 ? c.emplace_back<picky>(i) : c.push_back(i);
+        // The rows are full, so they grow before the value is made
+        REQUIRE_THROWS_AS(c.emplace_back<picky>(-1), invalid_argument);
+        REQUIRE_EQ(c.size(), 64);
+        REQUIRE_EQ(c.values<picky>().size(), 32);
+        REQUIRE_EQ(c.rows<picky>().back(), 63);
+
+        c.emplace_back<picky>(64);
+        REQUIRE_EQ(c.get_if<picky>(64)->x, 64);
+        REQUIRE_EQ(c.rows<picky>().back(), 64);
+        for (size_t i = 0; i < c.size(); ++i)
+            REQUIRE_EQ(c.holds<picky>(i), i % 2 == 1 || i == 64);
+    }
+}
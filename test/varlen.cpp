@@ -0,0 +1,402 @@
+#include <dori/all.h>
+#include <span>
+#include <stdexcept>
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+using namespace std;
+
+using V = dori::vector<int, dori::varlen<char>, dori::varlen<uint16_t>>;
+
+// The allocation holds an end offset per row of each varlen column
+static_assert(dori::layout::info<V>::row_size ==
+              sizeof(int) + 2 * sizeof(size_t));
+static_assert(
+    is_same_v<V::value_type, tuple<int, string, vector<uint16_t>>>);
+static_assert(
+    is_same_v<V::reference, tuple<int &, string_view, span<const uint16_t>>>);
+static_assert(is_same_v<decltype(declval<V &>().data<1>()),
+                        dori::varlen_ptr<char>>);
+
+static string str(int i)
+{
+    return string(static_cast<size_t>(i % 7), static_cast<char>('a' + i % 26));
+}
+static vector<uint16_t> list(int i)
+{
+    vector<uint16_t> res(static_cast<size_t>(i % 5));
+    for (size_t j = 0; j < res.size(); ++j)
+        res[j] = static_cast<uint16_t>(i + static_cast<int>(j));
+    return res;
+}
+
+static void fill(V &v, int n, int from = 0)
+{
+    for (int i = from; i < from + n; ++i) {
+        if (v.size() == v.capacity())
+            v.reserve(v.size() ? 2 * v.size() : 8);
+        v.push_back(i, str(i), list(i));
+    }
+}
+
+// Checks that v holds the rows made of is, in order
+static void check(const V &v, const vector<int> &is)
+{
+    REQUIRE_EQ(v.size(), is.size());
+    size_t k = 0;
+    for (const auto [a, b, c] : v) {
+        const auto x = is[k++];
+        REQUIRE_EQ(a, x);
+        REQUIRE_EQ(b, str(x));
+        const auto l = list(x);
+        REQUIRE((vector<uint16_t>{c.begin(), c.end()} == l));
+    }
+}
+
+static vector<int> iota(int n)
+{
+    vector<int> res(static_cast<size_t>(n));
+    for (int i = 0; i < n; ++i)
+        res[static_cast<size_t>(i)] = i;
+    return res;
+}
+
+struct boom {
+    boom(int x)
+    {
+        if (x < 0)
+            throw runtime_error{"boom"};
+    }
+};
+
+// Counts the bytes allocated through it in *n; default-constructed ones count
+// them in stray
+static size_t stray = 0;
+template <class T>
+struct arena {
+    using value_type                             = T;
+    using propagate_on_container_copy_assignment = true_type;
+    using propagate_on_container_move_assignment = true_type;
+    using propagate_on_container_swap            = true_type;
+
+    size_t *n = nullptr;
+
+    arena() = default;
+    explicit arena(size_t *n) noexcept : n{n} {}
+    template <class U>
+    arena(const arena<U> &other) noexcept : n{other.n}
+    {
+    }
+
+    T *allocate(size_t k)
+    {
+        (n ? *n : stray) += k * sizeof(T);
+        return allocator<T>{}.allocate(k);
+    }
+    void deallocate(T *p, size_t k) noexcept
+    {
+        allocator<T>{}.deallocate(p, k);
+    }
+
+    template <class U>
+    bool operator==(const arena<U> &other) const noexcept
+    {
+        return n == other.n;
+    }
+};
+
+TEST_SUITE("varlen columns")
+{
+    TEST_CASE("rows round-trip as views")
+    {
+        V v;
+        fill(v, 100);
+        check(v, iota(100));
+        REQUIRE_EQ(get<1>(v.front()), "");
+        REQUIRE_EQ(get<1>(v.back()), str(99));
+
+        // Offsets and values are contiguous arrays
+        const auto p = v.data<1>();
+        size_t total = 0;
+        for (int i = 0; i < 100; ++i)
+            total += str(i).size();
+        REQUIRE_EQ(p.ends()[99], total);
+        REQUIRE_EQ(string_view(p.values(), total).substr(0, 3), "bcc");
+        REQUIRE_EQ(p[3], "ddd");
+        REQUIRE_EQ(*(p + 2), "cc");
+
+        size_t n = 0;
+        v.for_each([&](auto f, auto l) {
+            if constexpr (is_same_v<decltype(f), dori::varlen_ptr<char>>)
+                for (; f != l; ++f)
+                    n += (*f).size();
+        });
+        REQUIRE_EQ(n, total);
+    }
+
+    TEST_CASE("emplace and push_back take views, values, and arguments")
+    {
+        dori::vector<dori::varlen<char>, dori::varlen<int>> v;
+        v.reserve(8);
+        const vector<int> xs{1, 2, 3};
+        v.push_back("ab", xs);
+        v.push_back(string{"cd"}, span<const int>{xs}.subspan(1));
+        v.emplace_back(piecewise_construct, tuple{"efgh", size_t{1}},
+                       tuple{xs.data(), size_t{2}});
+        v.emplace_back();
+        v.push_back(tuple{string{"ij"}, vector<int>{4}});
+        REQUIRE_EQ(v.size(), 5u);
+        REQUIRE_EQ(get<0>(v[0]), "ab");
+        REQUIRE_EQ(get<1>(v[1]).size(), 2u);
+        REQUIRE_EQ(get<1>(v[1])[0], 2);
+        REQUIRE_EQ(get<0>(v[2]), "e");
+        REQUIRE_EQ(get<1>(v[2]).size(), 2u);
+        REQUIRE(get<0>(v[3]).empty());
+        REQUIRE(get<1>(v[3]).empty());
+        REQUIRE_EQ(get<0>(v[4]), "ij");
+        REQUIRE_EQ(get<1>(v[4])[0], 4);
+
+        // Reserved values don't move as rows are appended
+        dori::vector<dori::varlen<char>> w;
+        w.reserve(64);
+        w.reserve_values<0>(64 * 3);
+        w.push_back("xyz");
+        const auto p = w.data<0>().values();
+        for (int i = 1; i < 64; ++i)
+            w.push_back("xyz");
+        REQUIRE_EQ(w.data<0>().values(), p);
+    }
+
+    TEST_CASE("erase and resize keep the values compact")
+    {
+        V v;
+        fill(v, 50);
+        auto is = iota(50);
+
+        v.erase(next(v.begin(), 10), next(v.begin(), 20));
+        is.erase(is.begin() + 10, is.begin() + 20);
+        check(v, is);
+        v.erase(v.begin());
+        is.erase(is.begin());
+        check(v, is);
+        v.erase(next(v.begin(), 38));
+        is.pop_back();
+        check(v, is);
+        v.erase(next(v.begin(), 5), next(v.begin(), 5));
+        check(v, is);
+
+        // Values past the last row are dropped
+        size_t total = 0;
+        for (auto i : is)
+            total += str(i).size();
+        REQUIRE_EQ(v.data<1>().ends()[v.size() - 1], total);
+
+        v.resize(20);
+        is.resize(20);
+        check(v, is);
+        v.resize(23);
+        REQUIRE(get<1>(v[21]).empty());
+        REQUIRE(get<2>(v[22]).empty());
+        v.resize(20);
+        fill(v, 5, 100);
+        for (int i = 100; i < 105; ++i)
+            is.push_back(i);
+        check(v, is);
+
+        v.clear();
+        fill(v, 3);
+        check(v, iota(3));
+    }
+
+    TEST_CASE("erasing from the front drops the values erased in bulk")
+    {
+        V v;
+        fill(v, 300);
+        auto is = iota(300);
+        // The values after an erased row stay put
+        const auto values = v.data<1>().values();
+        v.erase(v.begin(), next(v.begin(), 2));
+        is.erase(is.begin(), is.begin() + 2);
+        REQUIRE_EQ(v.data<1>().values(), values + str(1).size());
+        size_t dead = str(1).size();
+        for (int k = 2; k < 200; ++k) {
+            v.erase(v.begin());
+            is.erase(is.begin());
+            dead += str(k).size();
+            if (k % 37 == 0)
+                check(v, is);
+        }
+        check(v, is);
+        // until the values erased outnumber the rest and are dropped
+        REQUIRE_NE(v.data<1>().values(), values + dead);
+
+        // Rows go on past the dead values, and everything else drops them
+        fill(v, 20, 300);
+        for (int i = 300; i < 320; ++i)
+            is.push_back(i);
+        v.erase(next(v.begin(), 2), next(v.begin(), 4));
+        is.erase(is.begin() + 2, is.begin() + 4);
+        check(v, is);
+        V w = v;
+        check(w, is);
+        REQUIRE((w == v));
+        v.shrink_to_fit();
+        check(v, is);
+        v.reserve_values<2>(1000);
+        check(v, is);
+        v.erase(v.begin(), v.end());
+        REQUIRE(v.empty());
+        fill(v, 3);
+        check(v, iota(3));
+    }
+
+    TEST_CASE("append takes varlen_ptrs and iterators of rows")
+    {
+        V v;
+        fill(v, 40);
+        V w;
+        fill(w, 5, 100);
+        w.reserve(64);
+        // Rows 10..30 of v, by one copy of the values of each varlen column
+        w.append(20, v.data<0>() + 10, v.data<1>() + 10, v.data<2>() + 10);
+        auto is = iota(5);
+        for (auto &i : is)
+            i += 100;
+        for (int i = 10; i < 30; ++i)
+            is.push_back(i);
+        check(w, is);
+
+        // Any end offsets and values, and rows made of what views are
+        const size_t ends[]   = {2, 2, 5};
+        const uint16_t us[]   = {1, 2, 3, 4, 5};
+        const vector<int> ns  = {7, 8, 9};
+        const vector<string> ss{"ab", "", "cde"};
+        const vector<vector<uint16_t>> ls{{1}, {}, {2, 3}};
+        w.append(3, ns.begin(), dori::varlen_ptr<char, true>{ends, "abcde"},
+                 ls.begin());
+        w.append(3, ns.begin(), ss.begin(),
+                 dori::varlen_ptr<uint16_t, true>{ends, us});
+        REQUIRE_EQ(w.size(), 31u);
+        for (size_t i : {25u, 28u}) {
+            REQUIRE_EQ(get<0>(w[i]), 7);
+            REQUIRE_EQ(get<1>(w[i]), "ab");
+            REQUIRE(get<1>(w[i + 1]).empty());
+            REQUIRE_EQ(get<1>(w[i + 2]), "cde");
+        }
+        REQUIRE((vector<uint16_t>{get<2>(w[27]).begin(), get<2>(w[27]).end()} ==
+                 ls[2]));
+        REQUIRE_EQ(get<2>(w[30]).size(), 3u);
+        REQUIRE_EQ(get<2>(w[30])[2], 5);
+        w.append(0, ns.begin(), ss.begin(), v.data<2>());
+        REQUIRE_EQ(w.size(), 31u);
+
+        // A failed append leaves the rows as they were
+        dori::vector<dori::varlen<char>, boom> x;
+        x.reserve(8);
+        x.push_back("abc", 1);
+        const int bs[] = {1, -1};
+        REQUIRE_THROWS_AS(x.append(2, ss.begin(), bs), runtime_error);
+        REQUIRE_EQ(x.size(), 1u);
+        x.push_back("hi", 2);
+        REQUIRE_EQ(get<0>(x[1]), "hi");
+        REQUIRE_EQ(x.data<0>().ends()[1], 5u);
+    }
+
+    TEST_CASE("copies, moves, and swaps carry the values")
+    {
+        V v;
+        fill(v, 70);
+        V w = v;
+        check(w, iota(70));
+        REQUIRE((w == v));
+        w.erase(next(w.begin(), 3));
+        REQUIRE((w != v));
+        fill(w, 1, 3);
+        REQUIRE((w != v));
+
+        V u{std::move(w)};
+        REQUIRE_EQ(w.size(), 0u);
+        REQUIRE_EQ(u.size(), 70u);
+
+        V x;
+        fill(x, 2);
+        x = v;
+        check(x, iota(70));
+        REQUIRE((x == v));
+        x = std::move(u);
+        REQUIRE_EQ(get<1>(x[3]), str(4));
+
+        swap(x, v);
+        check(x, iota(70));
+        REQUIRE_EQ(get<1>(v[3]), str(4));
+
+        x.shrink_to_fit();
+        check(x, iota(70));
+
+        const vector<string> ss{"a", "bb", ""};
+        const vector<int> ns{1, 2, 3};
+        const dori::vector<int, dori::varlen<char>> y{
+            ns.begin(), ns.end(), ss.begin(), ss.end(),
+            dori::vector<int, dori::varlen<char>>::allocator_type{}};
+        REQUIRE_EQ(get<1>(y[1]), "bb");
+        REQUIRE(get<1>(y[2]).empty());
+    }
+
+    TEST_CASE("a failed push_back leaves the values as they were")
+    {
+        dori::vector<dori::varlen<char>, boom> v;
+        v.reserve(8);
+        v.push_back("abc", 1);
+        // The values go first in storage order, then the row fails
+        REQUIRE_THROWS_AS(v.push_back("defg", -1), runtime_error);
+        REQUIRE_EQ(v.size(), 1u);
+        v.push_back("hi", 2);
+        REQUIRE_EQ(get<0>(v[1]), "hi");
+        REQUIRE_EQ(v.data<0>().ends()[1], 5u);
+    }
+
+    TEST_CASE("the values are allocated through the vector's allocator")
+    {
+        using W = dori::vector_al<arena<byte>, int, dori::varlen<char>>;
+        size_t na = 0, nb = 0;
+        const arena<byte> a{&na}, b{&nb};
+        const auto fill_w = [](W &w) {
+            w.reserve(64);
+            for (int i = 0; i < 64; ++i)
+                w.push_back(i, string(40, 'x'));
+        };
+        W v{a};
+        fill_w(v);
+        REQUIRE(na >= 64 * 40);
+
+        W c{v};
+        W d{v, b};
+        REQUIRE(nb >= 64 * 40);
+        W e{W{v}, b};
+        REQUIRE((c == v));
+        REQUIRE((d == v));
+        REQUIRE((e == v));
+
+        // Copy and move assignment propagate the allocator
+        W f{b};
+        fill_w(f);
+        const auto nb0 = nb;
+        f              = v;
+        REQUIRE((f == v));
+        REQUIRE(f.get_allocator() == a);
+        f.reserve(128);
+        f.push_back(1, string(1000, 'y'));
+        REQUIRE_EQ(nb, nb0);
+        W g{b};
+        g = std::move(f);
+        REQUIRE(g.get_allocator() == a);
+        swap(g, d);
+        REQUIRE(d.get_allocator() == a);
+        REQUIRE_EQ(stray, 0u);
+    }
+}
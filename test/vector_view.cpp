@@ -0,0 +1,109 @@
+#include <dori/all.h>
+#include <memory>
+#include <numeric>
+#include <stdint.h>
+#include <tuple>
+#include <vector>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+using namespace std;
+
+using V = dori::vector<int64_t, dori::bit, float, uint8_t>;
+
+static V make(int n)
+{
+    V v;
+    v.reserve(n);
+    for (int i = 0; i < n; ++i)
+        v.push_back(i * 3, i % 3 == 0, i * 0.5f, static_cast<uint8_t>(i));
+    return v;
+}
+
+TEST_SUITE("dori::vector_view")
+{
+    TEST_CASE("views an allocation laid out as a vector")
+    {
+        using info     = dori::layout::info<V>;
+        const size_t c = info::granularity * 40;
+        const auto buf = make_unique<byte[]>(info::bytes(c) + info::alignment);
+        void *p        = buf.get();
+        size_t space   = info::bytes(c) + info::alignment;
+        REQUIRE(align(info::alignment, info::bytes(c), p, space));
+
+        dori::vector_view<int64_t, dori::bit, float, uint8_t> w{p, 100, c};
+        REQUIRE_EQ(w.size(), 100);
+        for (size_t i = 0; i < w.size(); ++i)
+            w[i] = tuple{i * 3, i % 3 == 0, i * 0.5f, static_cast<uint8_t>(i)};
+
+        // Rows land where a vector of that capacity would have them
+        const auto v = make(100);
+        for (size_t i = 0; i < v.size(); ++i)
+            REQUIRE((w[i] == v[i]));
+        const auto q = info::data<2>(static_cast<const byte *>(p), c);
+        REQUIRE_EQ(q, w.data<2>());
+        REQUIRE_EQ(get<2>(w.back()), 49.5f);
+
+        // Rows are as mutable through a copy
+        const auto x = w;
+        get<0>(x.front()) = -1;
+        REQUIRE_EQ(get<0>(w[0]), -1);
+
+        dori::const_vector_view<int64_t, dori::bit, float, uint8_t> cw = w;
+        REQUIRE_EQ(cw.data<0>(), w.data<0>());
+        REQUIRE_EQ(cw.size(), 100);
+        REQUIRE((!is_assignable_v<decltype(get<0>(cw[0])), int64_t>));
+    }
+
+    TEST_CASE("views columns given one by one")
+    {
+        vector<int> a(50);
+        vector<double> b(50);
+        iota(a.begin(), a.end(), 0);
+        dori::vector_view<int, double> w{a.size(), a.data(), b.data()};
+        w.for_each([](auto f, auto l) {
+            for (; f != l; ++f)
+                *f *= 2;
+        });
+        REQUIRE_EQ(a[49], 98);
+
+        int n = 0;
+        for (auto [x, y] : w) {
+            y = x + 0.5;
+            ++n;
+        }
+        REQUIRE_EQ(n, 50);
+        REQUIRE_EQ(b[10], 20.5);
+
+        const auto s = w.column<0>();
+        REQUIRE_EQ(accumulate(s.begin(), s.end(), 0), 49 * 50);
+        const auto r = w.query()
+                           .where<0>([](int x) { return x % 4 == 0; })
+                           .select<1>([](double y) { return y; })
+                           .reduce(plus<>{});
+        REQUIRE_EQ(r, 4 * (24 * 25 / 2) + 25 * 0.5);
+    }
+
+    TEST_CASE("views a vector")
+    {
+        auto v = make(77);
+        dori::vector_view<int64_t, dori::bit, float, uint8_t> w{v};
+        REQUIRE((w.data<1>() == v.data<1>()));
+        size_t bits = 0;
+        for (const auto b : w.column<1>())
+            bits += b;
+        REQUIRE_EQ(bits, 26);
+
+        const V &cv = v;
+        const dori::const_vector_view<int64_t, dori::bit, float, uint8_t> c{
+            cv};
+        REQUIRE_EQ(distance(c.begin(), c.end()), 77);
+        REQUIRE((*c.begin() == v[0]));
+
+        V e;
+        dori::vector_view<int64_t, dori::bit, float, uint8_t> ew{e};
+        REQUIRE(ew.empty());
+        REQUIRE((ew.begin() == ew.end()));
+    }
+}
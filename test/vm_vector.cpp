@@ -0,0 +1,96 @@
+#include <dori/all.h>
+#include <stdexcept>
+#include <stdint.h>
+#include <string>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <vector>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+using namespace std;
+
+// Whether the page holding p is resident
+static bool resident(const void *p)
+{
+    const auto pg = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    unsigned char vec;
+    const auto a  = reinterpret_cast<uintptr_t>(p) / pg * pg;
+    REQUIRE_EQ(mincore(reinterpret_cast<void *>(a), pg, &vec), 0);
+    return vec & 1;
+}
+
+TEST_SUITE("dori::vm_vector")
+{
+    TEST_CASE("growth commits pages and never moves the rows")
+    {
+        // 12 GiB of address space
+        dori::vm_vector<int, double> v{size_t{1} << 30};
+        REQUIRE_EQ(v.capacity(), size_t{1} << 30);
+        REQUIRE_EQ(v.committed(), 0);
+
+        v.push_back(0, 0.0);
+        const auto a = v.data<0>();
+        const auto b = v.data<1>();
+        REQUIRE_EQ(v.committed(), 1024);
+        for (int i = 1; i < 100'000; ++i)
+            v.push_back(i, i * 0.5);
+        REQUIRE_EQ(v.data<0>(), a);
+        REQUIRE_EQ(v.data<1>(), b);
+        REQUIRE(v.committed() >= v.size());
+        for (int i = 0; i < 100'000; ++i)
+            REQUIRE((a[i] == i && b[i] == i * 0.5));
+
+        v.resize(10);
+        v.shrink_to_fit();
+        REQUIRE_EQ(v.committed(), 10);
+        REQUIRE(!resident(a + 50'000));
+        REQUIRE(!resident(b + 50'000));
+        const vector<int> is(5000, 7);
+        v.append(is.size(), is.begin(), is.begin());
+        REQUIRE(v.committed() >= 5010);
+        REQUIRE_EQ(a[5009], 7);
+        REQUIRE_EQ(b[5009], 7.0);
+        v.resize(50'001);
+        REQUIRE_EQ(a[50'000], 0);
+        REQUIRE_EQ(b[9], 4.5);
+    }
+
+    TEST_CASE("packed and non-trivial columns, copies and moves")
+    {
+        using V = dori::vm_vector<string, dori::bit, uint16_t>;
+        V v{100'000};
+        for (int i = 0; i < 5000; ++i)
+            v.push_back(to_string(i), i % 2 == 0, static_cast<uint16_t>(i));
+        REQUIRE_EQ(dori::mask::count(v.data<1>(), v.size()), 2500);
+
+        V w = v;
+        REQUIRE(w == v);
+        REQUIRE_EQ(w.capacity(), v.capacity());
+        const auto p = w.data<0>();
+        V x          = std::move(w);
+        REQUIRE_EQ(x.data<0>(), p);
+        REQUIRE_EQ(get<0>(x[4999]), "4999");
+        REQUIRE(w.empty());
+
+        x.resize(3);
+        x.shrink_to_fit();
+        x.push_back("x", true, 7);
+        REQUIRE_EQ(get<0>(x.back()), "x");
+        REQUIRE(x != v);
+
+        // Copying more rows than fit throws, leaving the vector as it was
+        V y{16};
+        y.push_back("y", false, 1);
+        REQUIRE_THROWS_AS(y = v, length_error);
+        REQUIRE_EQ(y.size(), 1);
+        REQUIRE_EQ(get<0>(y[0]), "y");
+        V z;
+        REQUIRE_THROWS_AS(z = v, length_error);
+        REQUIRE(z.empty());
+        z = V{};
+        y = x;
+        REQUIRE(y == x);
+    }
+}